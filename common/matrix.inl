@@ -6,7 +6,7 @@
 //we are using a right-handed coordinate system with Z up (like Blender)
 static constexpr Vector UPVECTOR = { 0.0f, 0.0f, 1.0f, 0.0f };
 
-class __declspec(align(16)) Matrix
+class SB_ALIGN(16) Matrix
 {
 	Vector rows[4];
 	
@@ -2,8 +2,17 @@
 #include <math.h> //sqrtf, sinf, cosf
 #include <float.h> //finite
 
+//MSVC has its own spelling of the alignment and of the finiteness test
+#ifdef _MSC_VER
+#define SB_ALIGN(n) __declspec(align(n))
+#define SB_FINITE(x) _finite(x)
+#else
+#define SB_ALIGN(n) alignas(n)
+#define SB_FINITE(x) isfinite(x)
+#endif
+
 //main vector class
-class __declspec(align(4)) Vector
+class SB_ALIGN(4) Vector
 {
 public:
 	float x, y, z, w;
@@ -222,7 +231,7 @@ public:
 
 	bool Valid() const
 	{
-		return _finite(x) && _finite(y) && _finite(z);
+		return SB_FINITE(x) && SB_FINITE(y) && SB_FINITE(z);
 	}
 };
 static_assert(sizeof(Vector) == 16, "Vector MUST be 16 bytes, while it is not!");
@@ -4,6 +4,15 @@
 */
 
 #include "Document.hh"
+#include "spatial/bounds.hh"
+#include "spatial/collision.hh"
+#include <float.h> //FLT_MAX
+
+//size of the camera when colliding with the walls
+static constexpr float CAMERA_RADIUS = 24.0f;
+//how many objects, and faces of each, the camera is pushed out of at once
+static constexpr uint32_t MAX_CAMERA_OBJECTS = 16;
+static constexpr uint32_t MAX_CAMERA_CONTACTS = 16;
 
 bool Document::Load(const char *pathToFile)
 {
@@ -14,6 +23,47 @@ bool Document::Load(const char *pathToFile)
 	if (!result.IsOK())
 		return false;
 
+	if (!roomBVH.Build(world.rooms))
+	{
+		world.Release();
+		return false;
+	}
+	cameraRoomIndex = RoomBVH::INVALID_ROOM;
+
+	if (!portalGraph.Build(world.rooms))
+	{
+		roomBVH.Destroy();
+		world.Release();
+		return false;
+	}
+
+	if (!BuildPickingTrees())
+	{
+		portalGraph.Destroy();
+		roomBVH.Destroy();
+		world.Release();
+		return false;
+	}
+
+	if (!hullCollider.Build(world.rooms))
+	{
+		DestroyPickingTrees();
+		portalGraph.Destroy();
+		roomBVH.Destroy();
+		world.Release();
+		return false;
+	}
+
+	if (!BuildSpatialTrees())
+	{
+		hullCollider.Destroy();
+		DestroyPickingTrees();
+		portalGraph.Destroy();
+		roomBVH.Destroy();
+		world.Release();
+		return false;
+	}
+
 	levelLoaded = true;
 
 	return true;
@@ -26,11 +76,238 @@ void Document::Reset()
 
 	levelLoaded = false;
 
+	DestroySpatialTrees();
+	hullCollider.Destroy();
+	DestroyPickingTrees();
+	portalGraph.Destroy();
+	roomBVH.Destroy();
+	cameraRoomIndex = RoomBVH::INVALID_ROOM;
 	world.Release();
+	visibilitySolver.Destroy(); //the rooms may have been using its lists
+}
+
+bool Document::BuildPickingTrees()
+{
+	uint32_t numRooms = world.rooms.Count();
+	if (numRooms == 0)
+		return true;
+
+	if (!roomBoxes.Create(numRooms))
+		return false;
+	for (const auto &room : world.rooms)
+		roomBoxes.Add(ComputeRoomBBox(room));
+
+	uint32_t size = numRooms * sizeof(TriangleBVH) + roomBoxes.GetCapacity() * sizeof(RayBoxHit) + 2 * 16;
+	for (const auto &room : world.rooms)
+		size += TriangleBVH::GetMaxSize(room.mesh);
+	if (!pickingPool.Create(size))
+	{
+		roomBoxes.Destroy();
+		return false;
+	}
+
+	roomBoxHits = Array<RayBoxHit>(pickingPool.Allocate<RayBoxHit>(roomBoxes.GetCapacity()), roomBoxes.GetCapacity());
+	roomTriangleBVHs = pickingPool.CreateArray<TriangleBVH>(numRooms);
+	for (uint32_t i = 0; i < numRooms; i++)
+	{
+		if (!roomTriangleBVHs[i].Build(pickingPool, world.rooms[i].mesh))
+		{
+			DestroyPickingTrees();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Document::DestroyPickingTrees()
+{
+	roomTriangleBVHs = Array<TriangleBVH>();
+	roomBoxHits = Array<RayBoxHit>();
+	pickingPool.Destroy();
+	roomBoxes.Destroy();
+}
+
+//the triggers' heights were flipped when loaded, so their corners need sorting again
+static BBox ComputeTriggerBox(const Room &room, const Trigger &trigger)
+{
+	Vector position(room.position.x, room.position.y, room.position.z);
+	Vector a = Vector(trigger.min.x, trigger.min.y, trigger.min.z) * room.scale + position;
+	Vector b = Vector(trigger.max.x, trigger.max.y, trigger.max.z) * room.scale + position;
+	BBox box(a, a);
+	box.Expand(b);
+	return box;
+}
+
+bool Document::BuildSpatialTrees()
+{
+	uint32_t numRooms = world.rooms.Count();
+	if (numRooms == 0)
+		return true;
+
+	//both trees divide the space of the rooms, anything outside of it is kept at their roots
+	BBox bounds = ComputeRoomBBox(world.rooms[0]);
+	uint32_t numTriggers = 0;
+	for (const auto &room : world.rooms)
+	{
+		BBox roomBox = ComputeRoomBBox(room);
+		bounds.Expand(roomBox.min);
+		bounds.Expand(roomBox.max);
+		numTriggers += room.triggers.Count();
+	}
+
+	if (!spatialPool.Create((numRooms + numTriggers) * sizeof(uint32_t) + 2 * 16) ||
+		!objectOctree.Create(bounds, world.objects.Count()) ||
+		!triggerOctree.Create(bounds, numTriggers))
+	{
+		DestroySpatialTrees();
+		return false;
+	}
+
+	firstTriggers = Array<uint32_t>(spatialPool.Allocate<uint32_t>(numRooms), numRooms);
+	triggerRooms = Array<uint32_t>(spatialPool.Allocate<uint32_t>(numTriggers), numTriggers);
+
+	uint32_t triggerNumber = 0;
+	for (uint32_t r = 0; r < numRooms; r++)
+	{
+		const Room &room = world.rooms[r];
+		for (const Object *object = room.objects; object; object = object->next)
+			objectOctree.Insert(object->index, ComputeObjectBBox(world.meshes, room, object));
+
+		firstTriggers[r] = triggerNumber;
+		for (const auto &trigger : room.triggers)
+		{
+			triggerRooms[triggerNumber] = r;
+			triggerOctree.Insert(triggerNumber++, ComputeTriggerBox(room, trigger));
+		}
+	}
+
+	return true;
+}
+
+void Document::DestroySpatialTrees()
+{
+	firstTriggers = Array<uint32_t>();
+	triggerRooms = Array<uint32_t>();
+	spatialPool.Destroy();
+	triggerOctree.Destroy();
+	objectOctree.Destroy();
 }
 
 void Document::Tick(float dt)
 {
+	if (levelLoaded)
+		cameraRoomIndex = FindRoom(camera.GetPosition(), cameraRoomIndex);
+}
+
+void Document::MoveCamera(const Vector &movement)
+{
+	if (walkMode && levelLoaded)
+		camera.SetPosition(PushOutOfObjects(hullCollider.SlideSphere(camera.GetPosition(), movement, CAMERA_RADIUS), CAMERA_RADIUS));
+	else
+		camera.SetPosition(camera.GetPosition() + movement);
+}
+
+Vector Document::PushOutOfObjects(const Vector &center, float radius) const
+{
+	uint32_t objectIndices[MAX_CAMERA_OBJECTS];
+	uint32_t numObjects = objectOctree.QuerySphere(center, radius, objectIndices, MAX_CAMERA_OBJECTS);
+
+	Vector position = center;
+	for (uint32_t i = 0; i < numObjects; i++)
+	{
+		//only meshes have faces, and their sub-objects are left out
+		const Object &object = world.objects[objectIndices[i]];
+		uint32_t meshIndex = object.drawableNumber.GetID();
+		if (object.drawableNumber.GetMeshType() != MT_MESH || meshIndex >= world.meshes.Count() || object.scale <= 0.0f)
+			continue;
+
+		//the rooms' objects are located by their room's index, counting down from the top
+		const Room &room = world.rooms[0xFFFFFFFF - object.location];
+		Matrix parentTransform;
+		parentTransform.SetTranslation(Vector(room.position.x, room.position.y, room.position.z));
+		Matrix transform = ComputeObjectTransform(parentTransform, &object);
+
+		//into the object's space, where its rotation keeps the distances and its scale divides them
+		float invScaleSquared = 1.0f / (object.scale * object.scale);
+		Vector offset = position - transform[3];
+		Vector localCenter(offset.Dot(transform[0]) * invScaleSquared, offset.Dot(transform[1]) * invScaleSquared, offset.Dot(transform[2]) * invScaleSquared);
+		float localRadius = radius / object.scale;
+
+		SphereContact contacts[MAX_CAMERA_CONTACTS];
+		uint32_t numContacts = OverlapSphere(world.meshes[meshIndex], localCenter, localRadius, contacts, MAX_CAMERA_CONTACTS);
+		if (numContacts == 0)
+			continue;
+
+		//away from every face in turn, those already left behind by the previous pushes being skipped
+		for (uint32_t c = 0; c < numContacts; c++)
+		{
+			Vector away = localCenter - contacts[c].point;
+			float distance = away.Length();
+			if (distance > 1e-6f && distance < localRadius)
+				localCenter = localCenter + away * ((localRadius - distance) / distance);
+		}
+
+		Vector moved = transform[0] * localCenter.x + transform[1] * localCenter.y + transform[2] * localCenter.z + transform[3];
+		position = Vector(moved.x, moved.y, moved.z);
+	}
+	return position;
+}
+
+uint32_t Document::FindRoom(const Vector &position, uint32_t previousRoom) const
+{
+	return roomBVH.FindRoom(position, previousRoom);
+}
+
+bool Document::PickRoom(const Vector &rayStart, const Vector &rayDir, uint32_t &roomIndex, RayHit &hit)
+{
+	float closest = FLT_MAX;
+	roomIndex = RoomBVH::INVALID_ROOM;
+
+	//broad-phase, nearest boxes first
+	uint32_t numBoxHits = roomBoxes.IntersectRay(Ray(rayStart, rayDir), FLT_MAX, roomBoxHits.Data());
+	for (uint32_t h = 0; h < numBoxHits; h++)
+	{
+		//no room whose box starts beyond the closest hit can be any closer
+		if (roomBoxHits[h].distance >= closest)
+			break;
+
+		uint32_t i = roomBoxHits[h].boxIndex;
+		const auto &room = world.rooms[i];
+
+		//narrow-phase, in the room's space
+		float invScale = 1.0f / room.scale;
+		Vector localStart = (rayStart - Vector(room.position.x, room.position.y, room.position.z)) * invScale;
+		RayHit roomHit;
+		if (!roomTriangleBVHs[i].Intersect(localStart, rayDir, closest * invScale, roomHit))
+			continue;
+
+		roomHit.distance *= room.scale;
+		closest = roomHit.distance;
+		roomIndex = i;
+		hit = roomHit;
+	}
+
+	return roomIndex != RoomBVH::INVALID_ROOM;
+}
+
+bool Document::SolveVisibility(VisibilitySolver::Comparison &comparison)
+{
+	if (!levelLoaded || !visibilitySolver.Solve(world.rooms, roomBVH, roomBoxes, roomTriangleBVHs))
+		return false;
+
+	visibilitySolver.Compare(world.rooms, comparison);
+	return true;
+}
+
+bool Document::ApplyVisibility()
+{
+	if (!visibilitySolver.Apply(world.rooms))
+		return false;
+
+	//the portals only join rooms that see each other
+	portalGraph.Destroy();
+	return portalGraph.Build(world.rooms);
 }
 
 bool Document::IsSelected(uint32_t roomIndex) const
@@ -48,6 +325,24 @@ void Document::MarkAsSelected(uint32_t roomIndex)
 	roomsSelection.Add(roomIndex);
 }
 
+uint32_t Document::FindObjectsInTrigger(uint32_t roomIndex, uint32_t triggerIndex, uint32_t *results, uint32_t maxResults) const
+{
+	const Room &room = world.rooms[roomIndex];
+	return objectOctree.QueryBox(ComputeTriggerBox(room, room.triggers[triggerIndex]), results, maxResults);
+}
+
+uint32_t Document::FindTriggers(const Vector &position, uint32_t *roomIndices, uint32_t *triggerIndices, uint32_t maxResults) const
+{
+	uint32_t numResults = triggerOctree.QueryBox(BBox(position, position), triggerIndices, maxResults);
+	for (uint32_t i = 0; i < numResults; i++)
+	{
+		uint32_t roomIndex = triggerRooms[triggerIndices[i]];
+		roomIndices[i] = roomIndex;
+		triggerIndices[i] -= firstTriggers[roomIndex];
+	}
+	return numResults;
+}
+
 void Document::ResetSelection()
 {
 	roomsSelection.Flush();
@@ -1,6 +1,14 @@
 #pragma once
 #include "FreeLookCamera.hh"
 #include "GameWorld.hh"
+#include "spatial/RoomBVH.hh"
+#include "spatial/BoxSet.hh"
+#include "spatial/HullCollider.hh"
+#include "spatial/LooseOctree.hh"
+#include "spatial/PortalGraph.hh"
+#include "spatial/TriangleBVH.hh"
+#include "spatial/VisibilitySolver.hh"
+#include "sbmemory/MemoryPool.hh"
 #include "sbmemory/FixedArray.inl"
 
 //describes the world data
@@ -8,8 +16,23 @@ struct Document
 {
 	FreeLookCamera camera;
 	GameWorld world;
+	RoomBVH roomBVH; //finds which room a point is in
+	uint32_t cameraRoomIndex; //room the camera is in, updated every tick
+	PortalGraph portalGraph; //the openings between the rooms that see each other
+	HullCollider hullCollider; //keeps the camera out of the walls in walk mode
+	LooseOctree objectOctree; //the rooms' objects, by their index in the world's objects
+	LooseOctree triggerOctree; //the rooms' triggers, numbered across all rooms in order
+	MemoryPool spatialPool;
+	Array<uint32_t> firstTriggers; //number in triggerOctree of every room's first trigger
+	Array<uint32_t> triggerRooms; //room of every trigger in triggerOctree
+	VisibilitySolver visibilitySolver; //holds the rooms' viewable rooms once recomputed
+	BoxSet roomBoxes; //for picking, in the same order as the rooms
+	MemoryPool pickingPool;
+	Array<TriangleBVH> roomTriangleBVHs;
+	Array<RayBoxHit> roomBoxHits; //scratch for the broad-phase
 	bool levelLoaded; //has the level been loaded?
 	bool isDirty; //has something changed internally, that needs to be reflected in the UI?
+	bool walkMode; //does the camera collide with the rooms' hulls?
 
 	bool drawLights;
 	bool drawTriggers;
@@ -23,8 +46,10 @@ struct Document
 	FixedArray<uint32_t, 16> roomsSelection; //currently selected rooms, by index
 
 	Document():
+		cameraRoomIndex(RoomBVH::INVALID_ROOM),
 		levelLoaded(false),
 		isDirty(false),
+		walkMode(false),
 		drawLights(true),
 		drawTriggers(true),
 		drawRooms(true),
@@ -38,11 +63,47 @@ struct Document
 	bool Load(const char *pathToFile);
 	void Reset();
 
+	//builds the triangle trees used for picking, once the world is loaded
+	bool BuildPickingTrees();
+	void DestroyPickingTrees();
+
+	//builds the trees used to find objects and triggers, once the world is loaded
+	bool BuildSpatialTrees();
+	void DestroySpatialTrees();
+
 	//update the document data
 	void Tick(float dt);
 
+	//CAMERA
+	//moves the camera, sliding along the walls and kept out of the objects in walk mode
+	void MoveCamera(const Vector &movement);
+	//pushes a sphere out of the faces of the rooms' objects it overlaps, the objects having no hulls to slide along
+	Vector PushOutOfObjects(const Vector &center, float radius) const;
+
 	//ROOMS
+	//returns the room a position is in, for the camera and for objects that need a room
+	//@previousRoom is the room it was last in, if known
+	uint32_t FindRoom(const Vector &position, uint32_t previousRoom = RoomBVH::INVALID_ROOM) const;
+	/// <summary>
+	/// Casts a world-space ray against the triangles of every room, and finds the closest one it hits.
+	/// </summary>
+	/// <param name="hit">is in the room's space, except for the distance which is along the given ray</param>
+	bool PickRoom(const Vector &rayStart, const Vector &rayDir, uint32_t &roomIndex, RayHit &hit);
+	/// <summary>
+	/// Recomputes which rooms see each other from the rooms' geometry, and compares that to the rooms' stored lists.
+	/// </summary>
+	bool SolveVisibility(VisibilitySolver::Comparison &comparison);
+	//makes the rooms use the lists SolveVisibility computed
+	bool ApplyVisibility();
 	bool IsSelected(uint32_t roomIndex) const;
+
+	//OBJECTS
+	//writes the indices in the world's objects of the rooms' objects overlapping the trigger, bounded with their sub-objects
+	uint32_t FindObjectsInTrigger(uint32_t roomIndex, uint32_t triggerIndex, uint32_t *results, uint32_t maxResults) const;
+
+	//TRIGGERS
+	//writes the trigger indices of the triggers containing @position, @roomIndices receiving their room
+	uint32_t FindTriggers(const Vector &position, uint32_t *roomIndices, uint32_t *triggerIndices, uint32_t maxResults) const;
 	void MarkAsSelected(uint32_t roomIndex);
 
 	//...
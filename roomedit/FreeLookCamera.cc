@@ -41,6 +41,12 @@ const Matrix &FreeLookCamera::GetProjMatrix()
 	return projection;
 }
 
+float FreeLookCamera::GetProjectionScale() const
+{
+	//the projection maps the viewport's height to 2 units
+	return projection[1].y * viewport.height * 0.5f;
+}
+
 const Vector &FreeLookCamera::GetLookDirection() const
 {
 //	lookDirection = position - target;
@@ -58,7 +64,7 @@ void FreeLookCamera::Rotate(float x, float y)
 	pitch = fmaxf(-pitchLimit, fminf(pitchLimit, pitch));
 }
 
-void FreeLookCamera::Move(MovementDirection direction, float distance)
+Vector FreeLookCamera::GetMovement(MovementDirection direction, float distance) const
 {
 	Vector moveVector;
 
@@ -84,6 +90,12 @@ void FreeLookCamera::Move(MovementDirection direction, float distance)
 		break;
 	}
 
+	return moveVector;
+}
+
+void FreeLookCamera::Move(MovementDirection direction, float distance)
+{
+	Vector moveVector = GetMovement(direction, distance);
 	position += moveVector;
 //	target += moveVector;
 
@@ -91,6 +103,11 @@ void FreeLookCamera::Move(MovementDirection direction, float distance)
 //	view = Matrix::LookAtRH(position, position + lookDirection);
 }
 
+void FreeLookCamera::SetPosition(const Vector &newPosition)
+{
+	position = newPosition;
+}
+
 static bool UnProject(const Vector &screen, const Matrix &viewProjection, const Viewport &viewport, Vector &world)
 {
 	//transformation coordinates normalised between -1 and 1
@@ -47,8 +47,15 @@ public:
 	const Matrix &GetProjMatrix();
 	const Vector &GetLookDirection() const;
 
+	//how many pixels one unit covers on screen when seen from a distance of one unit
+	float GetProjectionScale() const;
+
 	void Rotate(float x, float y);
 	void Move(MovementDirection direction, float distance);
 
+	//what Move would add to the position, for moving the camera some other way
+	Vector GetMovement(MovementDirection direction, float distance) const;
+	void SetPosition(const Vector &newPosition);
+
 	bool UnProjectFromScreen(const Vector &screen, Vector &world);
 };
@@ -541,6 +541,8 @@ RESULT GameWorld::Load(const char *filePath)
 	}
 
 	//TEMP: go to textures directly
+	//the actor wad stays off until its reader gets through the cut-scenes and the texture infos,
+	//until then the world has no actors and the renderer draws none
 //	if (!actorWAD.Load(rs, pool))
 //		return RESULT::CODE::WORLD_OBJECTS_FAILED_TO_LOAD;
 
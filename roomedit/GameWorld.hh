@@ -1,5 +1,5 @@
 #pragma once
-#include "sbMemory/MemoryPool.hh"
+#include "sbmemory/MemoryPool.hh"
 #include "sbfilesystem/ReadStream.hh"
 #include "common/result.hh"
 
@@ -102,4 +102,20 @@ public:
 			textureIndex = surfaceMaterials[materialIndex].GetBaseTextureIndex() - NUM_SYSTEM_TEXTURES;
 		return textureIndex;
 	}
+
+	//whether the faces using this surface property hide what is behind them,
+	//neither their modulation nor their base texture letting anything through
+	bool IsSurfaceOpaque(int32_t index_surface_property) const
+	{
+		int32_t propertyIndex = index_surface_property - NUM_SYSTEM_TEXTURES;
+		if (propertyIndex >= 0 && propertyIndex < (int32_t)surfaceProperties.Count())
+		{
+			const SurfaceProperty& surfProp = surfaceProperties[propertyIndex];
+			if (surfProp.enable_modulate && surfProp.modulate_alpha != 0xFF)
+				return false;
+		}
+
+		int32_t textureIndex = GetBaseTextureIndex(index_surface_property);
+		return textureIndex < 0 || textureIndex >= (int32_t)textures.Count() || !textures[textureIndex].IsTransparent();
+	}
 };
@@ -163,31 +163,12 @@ void SceneView::OnLButtonDown(WPARAM wParam, LPARAM lParam)
 	Vector rayStart, rayDir;
 	FromScreenPointToWorldRays(p, rayStart, rayDir);
 
-	//test for hits against every room
+	//select the room whose triangles are hit the closest
 	//NEW IDEA FROM GUIDO: click twice to send ray further (handle DBLCLICK message)
-	for (uint32_t i = 0; i < document.world.rooms.Count(); i++)
-	{
-		const auto &room = document.world.rooms[i];
-
-		BBox box = ComputeRoomBBox(room);
-
-		Vector tempPnt;
-		//broad-phase intersection test
-		if (!box.IsIntersectRay(rayStart, rayDir, tempPnt))
-			continue;
-
-		//select this room
-		document.MarkAsSelected(i);
-
-		//TODO: narrow-phase
-
-//		float mindist = MathConstants::FLOAT_MAX;
-//		if (hc.dist < mindist)
-//		{
-//			mindist = hc.dist;
-//			selector.AddRoom();
-//		}
-	}
+	uint32_t roomIndex;
+	RayHit hit;
+	if (document.PickRoom(rayStart, rayDir, roomIndex, hit))
+		document.MarkAsSelected(roomIndex);
 }
 
 void SceneView::OnLButtonUp()
@@ -215,23 +196,25 @@ void SceneView::Tick(InputSystem &is, float dt)
 		constexpr float cameraSpeed = 2048.0f;
 		constexpr float rotationSpeed = 0.04f;
 
-		//keyboard input for camera movement
+		//keyboard input for camera movement, gathered so that walk mode sweeps it at once
+		Vector movement(0.0f, 0.0f, 0.0f);
 		if (is.IsKeyPressed('W'))
 		{
-			document.camera.Move(FreeLookCamera::MovementDirection::FORWARD, cameraSpeed * dt);
+			movement += document.camera.GetMovement(FreeLookCamera::MovementDirection::FORWARD, cameraSpeed * dt);
 		}
 		if (is.IsKeyPressed('A'))
 		{
-			document.camera.Move(FreeLookCamera::MovementDirection::LEFT, cameraSpeed * dt);
+			movement += document.camera.GetMovement(FreeLookCamera::MovementDirection::LEFT, cameraSpeed * dt);
 		}
 		if (is.IsKeyPressed('S'))
 		{
-			document.camera.Move(FreeLookCamera::MovementDirection::BACKWARD, cameraSpeed * dt);
+			movement += document.camera.GetMovement(FreeLookCamera::MovementDirection::BACKWARD, cameraSpeed * dt);
 		}
 		if (is.IsKeyPressed('D'))
 		{
-			document.camera.Move(FreeLookCamera::MovementDirection::RIGHT, cameraSpeed * dt);
+			movement += document.camera.GetMovement(FreeLookCamera::MovementDirection::RIGHT, cameraSpeed * dt);
 		}
+		document.MoveCamera(movement);
 
 		//process mouse right click
 		if (is.IsRightMousePressed())
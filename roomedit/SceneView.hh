@@ -38,4 +38,29 @@ public:
 
 	void Tick(InputSystem &is, float dt);
 	void Render();
+
+	const OcclusionCuller::Stats &GetOcclusionStats() const
+	{
+		return worldRenderer.GetOcclusionStats();
+	}
+
+	const DrawQueue::Stats &GetDrawStats() const
+	{
+		return worldRenderer.GetDrawStats();
+	}
+
+	const InstanceBatcher::Stats &GetInstanceStats() const
+	{
+		return worldRenderer.GetInstanceStats();
+	}
+
+	const TextureResidencyStats &GetTextureStats() const
+	{
+		return worldRenderer.GetTextureStats();
+	}
+
+	const sbStateFilter::Stats &GetStateStats() const
+	{
+		return renderer.GetStateStats();
+	}
 };
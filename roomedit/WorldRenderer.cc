@@ -4,42 +4,36 @@
 */
 
 #include "WorldRenderer.hh"
+#include "render/Frustum.hh"
 #include <assert.h>
+#include <float.h> //FLT_MAX
+#include <thread> //std::thread
 
-//for LIGHTMAPPED
-void WorldRenderer::UseDiffuseAndLightmap(uint32_t texindexDiffuse, uint32_t texindexLightmap)
-{
-	renderer.UseTwoTextures(texindexDiffuse, texindexLightmap);
-}
+//how far, in mesh radii, an object mesh starts being drawn with less detail
+static constexpr float LOD_DISTANCE_IN_RADII = 16.0f;
 
-//for LIGHTMAPPED
-void WorldRenderer::UseFullbrightDiffuse(uint32_t texindexDiffuse)
-{
-	renderer.UseTwoTextures(texindexDiffuse, FALLBACK_TEXTURE_INDEX);
-}
+//the most threads used when cooking the world
+static constexpr uint32_t MAX_COOKING_THREADS = 16;
 
-//for LIGHTMAPPED
-void WorldRenderer::UseFallbackDiffuseAndLightmap()
-{
-	renderer.UseTwoTextures(FALLBACK_TEXTURE_INDEX, FALLBACK_TEXTURE_INDEX);
-}
+//how many of the nearest rooms are rasterized as occluders every frame
+static constexpr uint32_t MAX_OCCLUDER_ROOMS = 8;
+static constexpr uint32_t MAX_OCCLUDER_TRIANGLES = 32768;
+static constexpr uint32_t MAX_OCCLUDER_POSITIONS = 8000; //the most positions a mesh can have
 
-void WorldRenderer::SetWorldViewProjectionMatrix(const Matrix &m)
-{
-	renderer.SetWorldViewProjectionMatrix(m);
-}
+//the most draws and transforms queued in a frame, those that do not fit are not drawn
+static constexpr uint32_t MAX_DRAW_PACKETS = 65536;
+static constexpr uint32_t MAX_DRAW_MATRICES = 16384;
 
-//for PHONG
-void WorldRenderer::UsePhongFallbackDiffuse()
-{
-	renderer.UseOneTexture(FALLBACK_TEXTURE_INDEX);
-}
+//the most objects and object parts drawn in a frame, their matrices are uploaded every frame when instancing
+static constexpr uint32_t MAX_INSTANCED_OBJECTS = 4096;
+static constexpr uint32_t MAX_INSTANCED_PARTS = 8192;
 
-//for PHONG
-void WorldRenderer::UsePhongDiffuse(uint32_t texindexDiffuse)
-{
-	renderer.UseOneTexture(texindexDiffuse);
-}
+//how many threads record the draws of a frame, 0 for one per core
+static constexpr uint32_t NUM_RECORDING_THREADS = 0;
+
+//the pipelines of the queued draws, in the order they are submitted
+static constexpr uint32_t LIGHTMAPPED_PIPELINE = 0;
+static constexpr uint32_t PHONG_PIPELINE = 1;
 
 bool WorldRenderer::Create()
 {
@@ -55,23 +49,25 @@ bool WorldRenderer::Create()
 		if (!renderer.CreatePipeline(psgPipeline)) //TODO: add cached state
 			return false;
 
+		//create instanced phong pipeline, without it the objects are drawn one by one
+		isInstancingSupported = renderer.CreatePipeline(psgInstancedPipeline);
+
 		//create colored pipeline
 		if (!renderer.CreatePipeline(csgPipeline)) //TODO: add cached state
 			return false;
 	}
 
-	//create the fallback texture
-	{
-		struct RGBAColor
-		{
-			uint8_t r, g, b, a;
-		};
-		RGBAColor data[1] =
-		{
-			255, 255, 255, 255
-		};
-		fallbackTexture = renderer.CreateTexture(data, sizeof(data), 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM, FALLBACK_TEXTURE_INDEX);
-	}
+	if (!occlusionCuller.Create(MAX_OCCLUDER_TRIANGLES, MAX_OCCLUDER_POSITIONS))
+		return false;
+
+	if (!drawQueue.Create(MAX_DRAW_PACKETS, MAX_DRAW_MATRICES))
+		return false;
+
+	if (!instanceBatcher.Create(MAX_INSTANCED_OBJECTS, MAX_INSTANCED_PARTS))
+		return false;
+
+	if (!drawRecorder.Create(NUM_RECORDING_THREADS, MAX_DRAW_PACKETS, MAX_DRAW_MATRICES, MAX_INSTANCED_OBJECTS, MAX_INSTANCED_PARTS))
+		return false;
 
 	//create the light mesh
 //	if (!lightBulbMesh.Create(renderer))
@@ -84,22 +80,366 @@ void WorldRenderer::Destroy()
 {
 //	lightBulbMesh.Destroy(renderer);
 
-	renderer.DestroyTexture(fallbackTexture);
+	drawRecorder.Destroy();
+	instanceBatcher.Destroy();
+	drawQueue.Destroy();
+	occlusionCuller.Destroy();
 
 	renderer.DestroyPipeline(csgPipeline);
+	renderer.DestroyPipeline(psgInstancedPipeline);
 	renderer.DestroyPipeline(psgPipeline);
 	renderer.DestroyPipeline(lmsgPipeline);
 }
 
+//a box that any point expands
+static BBox EmptyBBox()
+{
+	return BBox(Vector(FLT_MAX, FLT_MAX, FLT_MAX), Vector(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+}
+
+//grows the box around a face, using the extents stored in the file
+static void ExpandByFace(BBox &box, const Face &face)
+{
+	//the handedness conversion may have swapped the extents, so take both corners
+	box.Expand(Vector(face.minExtent.x, face.minExtent.y, face.minExtent.z));
+	box.Expand(Vector(face.maxExtent.x, face.maxExtent.y, face.maxExtent.z));
+}
+
+//turns a world mesh into phong vertices, and indices grouped into parts sharing the same surface property
+static void CookPhongMesh(
+	MemoryPool &pool,
+	const Mesh &wmesh,
+	Array<ObjectMeshPart> &parts,
+	PhongVertex *&verts, uint32_t &numCorners,
+	uint32_t *&indices, uint32_t &numIndices
+)
+{
+	//count how many parts/textures this mesh has
+	uint32_t numTextureIndexChanges = 0;
+	{
+		auto lastSeenTextureIndex = wmesh.faces[0].indexSurfaceProperty;
+		for (auto &face : wmesh.faces)
+		{
+			if (face.indexSurfaceProperty != lastSeenTextureIndex)
+			{
+				numTextureIndexChanges++;
+				lastSeenTextureIndex = face.indexSurfaceProperty;
+			}
+		}
+	}
+
+	uint32_t numParts = numTextureIndexChanges + 1;
+
+	parts = pool.CreateArray<ObjectMeshPart>(numParts);
+	uint32_t l = 0;
+	auto lastSeenTextureIndex = wmesh.faces[0].indexSurfaceProperty;
+
+	//count the number of indices this mesh is using, and bound every part
+	numIndices = 0;
+	uint32_t lastNumIndices = 0;
+	BBox partBounds = EmptyBBox();
+	for (uint32_t a = 0; a < wmesh.faces.Count(); a++)
+	{
+		auto &face = wmesh.faces[a];
+
+		if (face.indexSurfaceProperty == 3)
+			continue;
+
+		ExpandByFace(partBounds, face);
+
+		//has the texture index changed?
+		bool textureIndexChanged = face.indexSurfaceProperty != lastSeenTextureIndex;
+		if (textureIndexChanged)
+		{
+			lastNumIndices = numIndices;
+			lastSeenTextureIndex = face.indexSurfaceProperty;
+		}
+
+		assert(face.numVerts >= 3);
+		switch (face.typePoly)
+		{
+			/* QUAD (4 vertices, indices [0, 1, 2, 3], 6 index count ) */
+		case 4:
+			numIndices += face.numVerts;
+			break;
+
+			/* TRIANGLE (3 vertices = indices [0, 1, 2], 3 index nums used) */
+			/* 6 vertices, indices [0, 1, 2, 3, 4, 5], 12 index nums used */
+		case 6:
+			numIndices += 3 * face.numVerts - 6;
+			break;
+		default:
+			assert(0);
+		}
+
+		bool lastFace = a == (wmesh.faces.Count() - 1);
+		bool nextFaceHasDifferentTextureIndex = (!lastFace && wmesh.faces[a + 1].indexSurfaceProperty != face.indexSurfaceProperty);
+		if (lastFace || nextFaceHasDifferentTextureIndex)
+		{
+			//write how many indices did we have until now
+			parts[l].numIndices = numIndices - lastNumIndices;
+			parts[l].indexSurfaceProperty = face.indexSurfaceProperty;
+			parts[l].bounds = partBounds;
+			partBounds = EmptyBBox();
+			l++;
+		}
+	}
+
+	indices = pool.Allocate<uint32_t>(numIndices);
+	uint32_t *currentIndex = indices;
+
+	//form the indices
+	for (auto &face : wmesh.faces)
+	{
+		if (face.indexSurfaceProperty == 3)
+			continue;
+
+		switch (face.typePoly)
+		{
+		case 4:
+			for (uint32_t j = 0; j < face.numVerts; j++)
+				*currentIndex++ = face.vertexIndices[j];
+			break;
+		case 6:
+		{
+			const unsigned short startingIndex = face.vertexIndices[0];
+			const unsigned short *nextIndex = &face.vertexIndices[1];
+			for (uint32_t j = 2; j < face.numVerts; j++)
+			{
+				*currentIndex++ = startingIndex;
+				*currentIndex++ = *nextIndex++;
+				*currentIndex++ = *nextIndex;
+			}
+			break;
+		}
+		default:
+			assert(0);
+		}
+	}
+
+	//create the verts
+	numCorners = (uint32_t)wmesh.corners.Count();
+	verts = pool.Allocate<PhongVertex>(numCorners);
+	for (uint32_t j = 0; j < numCorners; j++)
+	{
+		unsigned short order = wmesh.corners[j].index;
+
+		//fill position
+		verts[j].position[0] = wmesh.positions[order].x;
+		verts[j].position[1] = wmesh.positions[order].y;
+		verts[j].position[2] = wmesh.positions[order].z;
+
+		//fill smooth normal
+		verts[j].normal[0] = wmesh.normals[order].x;
+		verts[j].normal[1] = wmesh.normals[order].y;
+		verts[j].normal[2] = wmesh.normals[order].z;
+
+		//fill texcoords
+		memcpy(&verts[j].texcoordDiffuse, &wmesh.corners[j].textureUV, 8);
+	}
+
+	//copy per-face normals if requested
+#if 0
+	if (wmesh.flags & 2)
+	{
+		for (auto &face : wmesh.faces)
+		{
+			for (auto &vertexIndex : face.vertexIndices)
+			{
+				memcpy(verts[vertexIndex].normal, &face.normal, sizeof(Vector3));
+			}
+		}
+	}
+#endif
+}
+
+//a mesh that has been cooked, but not placed in the shared buffers yet
+struct CookedMesh
+{
+	const PhongVertex *verts;
+	uint32_t numVerts;
+	const uint32_t *indices;
+	uint32_t numIndices;
+	const uint32_t *partNumIndices;
+};
+
+//simplifies every object mesh into levels of detail, spreading the meshes over all the cores
+//every thread builds into its own pool, the results are then moved into @pool
+static void BuildObjectMeshLods(MemoryPool &pool, const GameWorld &world, Array<ObjectMesh> &meshes, const CookedMesh *cookedMeshes)
+{
+	uint32_t numMeshes = meshes.Count();
+	uint32_t numThreads = std::thread::hardware_concurrency();
+	if (numThreads > MAX_COOKING_THREADS)
+		numThreads = MAX_COOKING_THREADS;
+	if (numThreads > numMeshes)
+		numThreads = numMeshes;
+	if (numThreads == 0)
+		return;
+
+	//thread t takes the meshes t, t + numThreads, t + 2 * numThreads...
+	MemoryPool threadPools[MAX_COOKING_THREADS];
+	for (uint32_t t = 0; t < numThreads; t++)
+	{
+		uint32_t size = 0;
+		for (uint32_t i = t; i < numMeshes; i += numThreads)
+			size += GetSimplifiedLodsMaxSize(cookedMeshes[i].numIndices, meshes[i].parts.Count());
+
+		if (size && !threadPools[t].Create(size))
+		{
+			//leave the meshes without levels of detail
+			for (uint32_t u = 0; u < t; u++)
+				threadPools[u].Destroy();
+			return;
+		}
+	}
+
+	auto buildLods = [&](uint32_t t)
+	{
+		for (uint32_t i = t; i < numMeshes; i += numThreads)
+		{
+			const CookedMesh &cooked = cookedMeshes[i];
+			if (cooked.numIndices == 0)
+				continue;
+
+			BuildSimplifiedLods(
+				meshes[i].lods, threadPools[t],
+				world.meshes[i],
+				cooked.indices, cooked.numIndices,
+				cooked.partNumIndices, meshes[i].parts.Count()
+			);
+		}
+	};
+
+	std::thread threads[MAX_COOKING_THREADS];
+	for (uint32_t t = 1; t < numThreads; t++)
+		threads[t] = std::thread(buildLods, t);
+	buildLods(0); //this thread helps too
+	for (uint32_t t = 1; t < numThreads; t++)
+		threads[t].join();
+
+	for (auto &mesh : meshes)
+		MoveLodSet(mesh.lods, pool);
+
+	for (uint32_t t = 0; t < numThreads; t++)
+		threadPools[t].Destroy();
+}
+
+bool WorldRenderer::CreateCullers(const GameWorld &world)
+{
+	uint32_t numRooms = world.rooms.Count();
+	if (!roomCuller.Create(numRooms))
+		return false;
+	for (const auto &room : world.rooms)
+		roomCuller.Add(ComputeRoomBBox(room));
+
+	uint32_t numObjects = 0;
+	for (const auto &room : world.rooms)
+	{
+		for (Object *object = room.objects; object; object = object->next)
+			numObjects++;
+	}
+
+	if (!objectCuller.Create(numObjects))
+		return false;
+	culledObjects = Array<CulledObject>(pool.Allocate<CulledObject>(numObjects), numObjects);
+	for (uint32_t i = 0; i < numRooms; i++)
+	{
+		const auto &room = world.rooms[i];
+
+		for (Object *object = room.objects; object; object = object->next)
+		{
+			uint32_t index = objectCuller.Add(ComputeObjectBBox(world.meshes, room, object));
+			culledObjects[index].object = object;
+			culledObjects[index].roomIndex = i;
+		}
+	}
+
+	visibleRoomIndices = Array<uint32_t>(pool.Allocate<uint32_t>(roomCuller.GetCapacity()), roomCuller.GetCapacity());
+	visibleObjectIndices = Array<uint32_t>(pool.Allocate<uint32_t>(objectCuller.GetCapacity()), objectCuller.GetCapacity());
+	isRoomVisible = Array<bool>(pool.Allocate<bool>(numRooms), numRooms);
+
+	return true;
+}
+
+bool WorldRenderer::CreateGeometryBuffers()
+{
+	//a buffer can not be empty, so only create those that will hold something
+	if (geometryLayout.GetNumVertices(roomVertexFormat) != 0)
+	{
+		roomVertexBuffer = renderer.CreateBuffer(geometryLayout.GetVertexBufferSize(roomVertexFormat));
+		if (!roomVertexBuffer)
+			return false;
+	}
+
+	if (geometryLayout.GetNumVertices(meshVertexFormat) != 0)
+	{
+		meshVertexBuffer = renderer.CreateBuffer(geometryLayout.GetVertexBufferSize(meshVertexFormat));
+		if (!meshVertexBuffer)
+			return false;
+	}
+
+	if (geometryLayout.GetNumIndices() != 0)
+	{
+		indexBuffer = renderer.CreateBuffer(geometryLayout.GetIndexBufferSize());
+		if (!indexBuffer)
+			return false;
+	}
+
+	return true;
+}
+
+bool WorldRenderer::UploadGeometry(const GeometryLayout::Range &range, GPUResource vertexBuffer, const void *verts, const uint32_t *indices, const LodSet *lods)
+{
+	//nothing was placed for this mesh
+	if (range.numIndices == 0)
+		return true;
+
+	uint32_t vertexDataSize = range.numVertices * geometryLayout.GetStride(range.format);
+	if (!renderer.UpdateBuffer(vertexBuffer, geometryLayout.GetVertexDataOffset(range), verts, vertexDataSize))
+		return false;
+
+	//the reduced levels of detail directly follow the full-detail indices
+	uint32_t numIndices = lods ? lods->levelNumIndices[0] : range.numIndices;
+	uint32_t indexDataOffset = geometryLayout.GetIndexDataOffset(range);
+	uint32_t indexDataSize = numIndices * sizeof(uint32_t);
+	if (!renderer.UpdateBuffer(indexBuffer, indexDataOffset, indices, indexDataSize))
+		return false;
+
+	if (!lods || lods->indices.Count() == 0)
+		return true;
+
+	return renderer.UpdateBuffer(indexBuffer, indexDataOffset + indexDataSize, lods->indices.Data(), lods->indices.Count() * sizeof(uint32_t));
+}
+
 bool WorldRenderer::LoadWorld(const GameWorld &world)
 {
+	//the draw queue's keys can not tell the textures past the fallback one apart from it
+	//nothing was allocated yet, so unloading the world after this does nothing
+	if (world.textures.Count() > FALLBACK_TEXTURE_INDEX)
+	{
+		DebugPrint("The world has more textures than the draw queue's keys can tell apart.");
+		return false;
+	}
+
 	//save the internal state of the renderer here so that whenever
 	//we want to free game world resources allocated using the renderer,
 	//we can just revert to that saved state
 	renderer.SaveInternalState();
+	isWorldLoaded = true;
 
 	pool.Create(1024 * 1024 * 20); //20MiB is sufficient to load any type of Eden level
 
+	//rooms and meshes each get their own vertex buffer, but share the index buffer
+	geometryLayout.Reset();
+	roomVertexFormat = geometryLayout.AddVertexFormat(sizeof(LightMappedVertex));
+	meshVertexFormat = geometryLayout.AddVertexFormat(sizeof(PhongVertex));
+
+	//we only know the size of the shared buffers once every mesh has been cooked,
+	//so keep the cooked data around until then
+	auto roomVertexData = pool.Allocate<const LightMappedVertex *>(world.rooms.Count());
+	auto roomIndexData = pool.Allocate<const uint32_t *>(world.rooms.Count());
+	auto cookedMeshes = pool.Allocate<CookedMesh>(world.meshes.Count());
+
 	//create a mesh buffer for all the rooms
 	roomMeshes = pool.CreateArray<RoomMesh>(world.rooms.Count());
 	for (uint32_t i = 0; i < world.rooms.Count(); i++)
@@ -132,9 +472,10 @@ bool WorldRenderer::LoadWorld(const GameWorld &world)
 		uint32_t l = 0;
 		auto lastSeenTextureIndex = roomMesh.faces[0].indexSurfaceProperty;
 
-		//count the number of indices this mesh is using
+		//count the number of indices this mesh is using, and bound every part
 		uint32_t numIndices = 0;
 		uint32_t lastNumIndices = 0;
+		BBox partBounds = EmptyBBox();
 		for (uint32_t a = 0; a < roomMesh.faces.Count(); a++)
 		{
 			auto &face = roomMesh.faces[a];
@@ -142,6 +483,8 @@ bool WorldRenderer::LoadWorld(const GameWorld &world)
 			if (face.indexSurfaceProperty == 3)
 				continue;
 
+			ExpandByFace(partBounds, face);
+
 			//has the texture index changed?
 			bool textureIndexChanged = face.indexSurfaceProperty != lastSeenTextureIndex;
 			if (textureIndexChanged)
@@ -175,6 +518,8 @@ bool WorldRenderer::LoadWorld(const GameWorld &world)
 				mesh.parts[l].numIndices = numIndices - lastNumIndices;
 				mesh.parts[l].indexSurfaceProperty = face.indexSurfaceProperty;
 				mesh.parts[l].texindexLightmap = face.lightmapIndex;
+				mesh.parts[l].bounds = partBounds;
+				partBounds = EmptyBBox();
 				l++;
 			}
 		}
@@ -243,10 +588,49 @@ bool WorldRenderer::LoadWorld(const GameWorld &world)
 		}
 #endif
 
-		mesh.mesh = renderer.CreateMesh(verts, numCorners, indices, numIndices);
-		roomMeshes[i] = std::move(mesh);
+		//the occlusion culler only needs the positions, and only of the faces nothing can be seen through
+		uint32_t numOccluderIndices = 0;
+		for (auto &face : roomMesh.faces)
+		{
+			if (face.indexSurfaceProperty != 3 && world.IsSurfaceOpaque(face.indexSurfaceProperty))
+				ForEachTriangle(face, [&](uint32_t, uint32_t, uint32_t) { numOccluderIndices += 3; });
+		}
+		mesh.occluderIndices = Array<uint32_t>(pool.Allocate<uint32_t>(numOccluderIndices), numOccluderIndices);
+		uint32_t *occluderIndex = mesh.occluderIndices.Data();
+		for (auto &face : roomMesh.faces)
+		{
+			if (face.indexSurfaceProperty == 3 || !world.IsSurfaceOpaque(face.indexSurfaceProperty))
+				continue;
+
+			ForEachTriangle(face, [&](uint32_t c0, uint32_t c1, uint32_t c2)
+			{
+				*occluderIndex++ = roomMesh.corners[c0].index;
+				*occluderIndex++ = roomMesh.corners[c1].index;
+				*occluderIndex++ = roomMesh.corners[c2].index;
+			});
+		}
+
+		mesh.range = geometryLayout.Place(roomVertexFormat, numCorners, numIndices);
+		roomVertexData[i] = verts;
+		roomIndexData[i] = indices;
+
+		//split the parts into meshlets, so that we can cull them individually
+		{
+			auto partNumIndices = pool.Allocate<uint32_t>(numParts);
+			for (uint32_t p = 0; p < numParts; p++)
+				partNumIndices[p] = mesh.parts[p].numIndices;
+
+			BuildMeshlets(
+				mesh.meshlets, pool,
+				verts[0].position, sizeof(LightMappedVertex), numCorners,
+				indices, numIndices,
+				partNumIndices, numParts
+			);
 		}
 
+		roomMeshes[i] = std::move(mesh);
+	}
+
 	//create a mesh buffer for all the meshes
 	meshes = pool.CreateArray<ObjectMesh>(world.meshes.Count());
 	for (uint32_t i = 0; i < world.meshes.Count(); i++)
@@ -257,146 +641,162 @@ bool WorldRenderer::LoadWorld(const GameWorld &world)
 		if (wmesh.numVerts == 0)
 			continue;
 
-		//count how many parts/textures this room mesh has
-		uint32_t numTextureIndexChanges = 0;
-		{
-			auto lastSeenTextureIndex = wmesh.faces[0].indexSurfaceProperty;
-			for (auto &face : wmesh.faces)
-			{
-				if (face.indexSurfaceProperty != lastSeenTextureIndex)
-				{
-					numTextureIndexChanges++;
-					lastSeenTextureIndex = face.indexSurfaceProperty;
-				}
-			}
-		}
+		ObjectMesh mesh;
+		PhongVertex *verts;
+		uint32_t numCorners;
+		uint32_t *indices;
+		uint32_t numIndices;
+		CookPhongMesh(pool, wmesh, mesh.parts, verts, numCorners, indices, numIndices);
+
+		Vector minExtent(wmesh.minExtent.x, wmesh.minExtent.y, wmesh.minExtent.z);
+		Vector maxExtent(wmesh.maxExtent.x, wmesh.maxExtent.y, wmesh.maxExtent.z);
+		mesh.lodDistance = fmaxf(minExtent.Length(), maxExtent.Length()) * LOD_DISTANCE_IN_RADII;
+
+		uint32_t numParts = mesh.parts.Count();
+		auto partNumIndices = pool.Allocate<uint32_t>(numParts);
+		for (uint32_t p = 0; p < numParts; p++)
+			partNumIndices[p] = mesh.parts[p].numIndices;
+
+		auto &cooked = cookedMeshes[i];
+		cooked.verts = verts;
+		cooked.numVerts = numCorners;
+		cooked.indices = indices;
+		cooked.numIndices = numIndices;
+		cooked.partNumIndices = partNumIndices;
+		meshes[i] = std::move(mesh);
+	}
 
-		uint32_t numParts = numTextureIndexChanges + 1;
+	//simplify the meshes, and only then place them since their levels of detail follow their indices
+	BuildObjectMeshLods(pool, world, meshes, cookedMeshes);
+	for (uint32_t i = 0; i < meshes.Count(); i++)
+	{
+		auto &mesh = meshes[i];
+		const auto &cooked = cookedMeshes[i];
+		if (cooked.numIndices == 0)
+			continue;
 
-		ObjectMesh mesh;
-		mesh.parts = pool.CreateArray<ObjectMeshPart>(numParts);
-		uint32_t l = 0;
-		auto lastSeenTextureIndex = wmesh.faces[0].indexSurfaceProperty;
+		//the simplifier leaves the levels empty if it could not run
+		if (mesh.lods.numLevels == 0)
+			InitSingleLod(mesh.lods, pool, cooked.numIndices, cooked.partNumIndices, mesh.parts.Count());
 
-		//count the number of indices this mesh is using
-		uint32_t numIndices = 0;
-		uint32_t lastNumIndices = 0;
-		for (uint32_t a = 0; a < wmesh.faces.Count(); a++)
-		{
-			auto &face = wmesh.faces[a];
+		mesh.range = geometryLayout.Place(meshVertexFormat, cooked.numVerts, mesh.lods.GetNumIndices());
+	}
 
-			if (face.indexSurfaceProperty == 3)
+	//create a mesh buffer for every mesh of the actors' current models
+	const auto &actors = world.actorWAD.actors;
+	uint32_t numActorMeshes = 0;
+	for (const auto &actor : actors)
+	{
+		if (actor.currModel >= actor.model.Count())
+			continue;
+		for (const auto &wmesh : actor.model[actor.currModel].meshes)
+			numActorMeshes += wmesh.numVerts != 0;
+	}
+	actorMeshes = pool.CreateArray<ActorMesh>(numActorMeshes);
+	firstActorMeshes = pool.CreateArray<uint32_t>(actors.Count() + 1);
+	auto actorVertexData = pool.Allocate<const PhongVertex *>(numActorMeshes);
+	auto actorIndexData = pool.Allocate<const uint32_t *>(numActorMeshes);
+	uint32_t actorMeshIndex = 0;
+	for (uint32_t i = 0; i < actors.Count(); i++)
+	{
+		firstActorMeshes[i] = actorMeshIndex;
+		const auto &actor = actors[i];
+		if (actor.currModel >= actor.model.Count())
+			continue;
+
+		//the progressive-reduction tables number the positions of every mesh of the model one after the other
+		const auto &model = actor.model[actor.currModel];
+		uint32_t firstPosition = 0;
+		for (uint32_t m = 0; m < model.meshes.Count(); m++)
+		{
+			const Mesh &wmesh = model.meshes[m];
+			uint32_t meshFirstPosition = firstPosition;
+			firstPosition += wmesh.numVerts;
+			if (wmesh.numVerts == 0)
 				continue;
 
-			//has the texture index changed?
-			bool textureIndexChanged = face.indexSurfaceProperty != lastSeenTextureIndex;
-			if (textureIndexChanged)
+			ActorMesh mesh;
+			PhongVertex *verts;
+			uint32_t numCorners;
+			uint32_t *indices;
+			uint32_t numIndices;
+			CookPhongMesh(pool, wmesh, mesh.parts, verts, numCorners, indices, numIndices);
+
+			Vector minExtent(wmesh.minExtent.x, wmesh.minExtent.y, wmesh.minExtent.z);
+			Vector maxExtent(wmesh.maxExtent.x, wmesh.maxExtent.y, wmesh.maxExtent.z);
+			mesh.radius = fmaxf(minExtent.Length(), maxExtent.Length());
+
+			uint32_t numParts = mesh.parts.Count();
+			auto partNumIndices = pool.Allocate<uint32_t>(numParts);
+			for (uint32_t p = 0; p < numParts; p++)
+				partNumIndices[p] = mesh.parts[p].numIndices;
+
+			//turn the progressive-reduction tables into levels of detail
+			const auto *remap = model.remap;
+			if (remap)
 			{
-				lastNumIndices = numIndices;
-				lastSeenTextureIndex = face.indexSurfaceProperty;
+				const auto *reduce = remap->reduce;
+				BuildProgressiveLods(
+					mesh.lods, pool,
+					wmesh,
+					indices, numIndices,
+					partNumIndices, numParts,
+					remap->remap.Data(), remap->remap.Count(), meshFirstPosition,
+					reduce ? reduce->vtable.Data() : nullptr, reduce ? reduce->vtable.Count() : 0
+				);
+				mesh.falloffNearSize = remap->falloff_near_size;
+				mesh.falloffFarSize = remap->falloff_far_size;
+				mesh.falloffPower = remap->falloff_power;
 			}
-
-			assert(face.numVerts >= 3);
-			switch (face.typePoly)
+			else
 			{
-				/* QUAD (4 vertices, indices [0, 1, 2, 3], 6 index count ) */
-			case 4:
-				numIndices += face.numVerts;
-				break;
-
-				/* TRIANGLE (3 vertices = indices [0, 1, 2], 3 index nums used) */
-				/* 6 vertices, indices [0, 1, 2, 3, 4, 5], 12 index nums used */
-			case 6:
-				numIndices += 3 * face.numVerts - 6;
-				break;
-			default:
-				assert(0);
+				InitSingleLod(mesh.lods, pool, numIndices, partNumIndices, numParts);
+				mesh.falloffNearSize = 0.0f;
+				mesh.falloffFarSize = 0.0f;
+				mesh.falloffPower = 1.0f;
 			}
 
-			bool lastFace = a == (wmesh.faces.Count() - 1);
-			bool nextFaceHasDifferentTextureIndex = (!lastFace && wmesh.faces[a + 1].indexSurfaceProperty != face.indexSurfaceProperty);
-			if (lastFace || nextFaceHasDifferentTextureIndex)
-			{
-				//write how many indices did we have until now
-				mesh.parts[l].numIndices = numIndices - lastNumIndices;
-				mesh.parts[l].indexSurfaceProperty = face.indexSurfaceProperty;
-				l++;
-			}
+			mesh.range = geometryLayout.Place(meshVertexFormat, numCorners, mesh.lods.GetNumIndices());
+			actorVertexData[actorMeshIndex] = verts;
+			actorIndexData[actorMeshIndex] = indices;
+			actorMeshes[actorMeshIndex++] = std::move(mesh);
 		}
+	}
+	firstActorMeshes[actors.Count()] = actorMeshIndex;
 
-		auto indices = pool.Allocate<uint32_t>(numIndices);
-		uint32_t *currentIndex = indices;
+	//create the shared buffers, and copy every mesh at its place
+	if (!CreateGeometryBuffers())
+		return false;
 
-		//form the indices
-		for (auto &face : wmesh.faces)
-		{
-			if (face.indexSurfaceProperty == 3)
-				continue;
+	for (uint32_t i = 0; i < roomMeshes.Count(); i++)
+	{
+		if (!UploadGeometry(roomMeshes[i].range, roomVertexBuffer, roomVertexData[i], roomIndexData[i]))
+			return false;
+	}
 
-			switch (face.typePoly)
-			{
-			case 4:
-				for (uint32_t j = 0; j < face.numVerts; j++)
-					*currentIndex++ = face.vertexIndices[j];
-				break;
-			case 6:
-			{
-				const unsigned short startingIndex = face.vertexIndices[0];
-				const unsigned short *nextIndex = &face.vertexIndices[1];
-				for (uint32_t j = 2; j < face.numVerts; j++)
-				{
-					*currentIndex++ = startingIndex;
-					*currentIndex++ = *nextIndex++;
-					*currentIndex++ = *nextIndex;
-				}
-				break;
-			}
-			default:
-				assert(0);
-			}
-		}
-
-		//create the verts
-		uint32_t numCorners = (uint32_t)wmesh.corners.Count();
-		auto *verts = pool.Allocate<PhongVertex>(numCorners);
-		for (uint32_t j = 0; j < numCorners; j++)
-		{
-			unsigned short order = wmesh.corners[j].index;
-
-			//fill position
-			verts[j].position[0] = wmesh.positions[order].x;
-			verts[j].position[1] = wmesh.positions[order].y;
-			verts[j].position[2] = wmesh.positions[order].z;
-
-			//fill smooth normal
-			verts[j].normal[0] = wmesh.normals[order].x;
-			verts[j].normal[1] = wmesh.normals[order].y;
-			verts[j].normal[2] = wmesh.normals[order].z;
+	for (uint32_t i = 0; i < meshes.Count(); i++)
+	{
+		const auto &mesh = meshes[i];
+		if (!UploadGeometry(mesh.range, meshVertexBuffer, cookedMeshes[i].verts, cookedMeshes[i].indices, &mesh.lods))
+			return false;
+	}
 
-			//fill texcoords
-			memcpy(&verts[j].texcoordDiffuse, &wmesh.corners[j].textureUV, 8);
-		}
+	for (uint32_t i = 0; i < actorMeshes.Count(); i++)
+	{
+		const auto &mesh = actorMeshes[i];
+		if (!UploadGeometry(mesh.range, meshVertexBuffer, actorVertexData[i], actorIndexData[i], &mesh.lods))
+			return false;
+	}
 
-		//copy per-face normals if requested
-#if 0
-		if (wmesh.flags & 2)
-		{
-			for (auto &face : wmesh.faces)
-			{
-				for (auto &vertexIndex : face.vertexIndices)
-				{
-					memcpy(verts[vertexIndex].normal, &face.normal, sizeof(Vector3));
-				}
-			}
-		}
-#endif
+	if (!CreateCullers(world))
+		return false;
 
-		mesh.mesh = renderer.CreateMesh(verts, numCorners, indices, numIndices);
-		meshes[i] = std::move(mesh);
-	}
+	//only the textures something draws with are created, the others would just take memory
+	auto isReachable = pool.CreateArray<bool>(world.textures.Count());
+	FindReachableTextures(world, isReachable);
 
-	//create a texture buffer for all the textures
-	textures = pool.CreateArray<GPUResource>(world.textures.Count());
+	textureStats = TextureResidencyStats();
+	textures = pool.CreateArray<sbTexture>(world.textures.Count());
 	for (uint32_t i = 0; i < world.textures.Count(); i++)
 	{
 		const auto &texture = world.textures[i];
@@ -404,7 +804,14 @@ bool WorldRenderer::LoadWorld(const GameWorld &world)
 			continue; //no texture to create here
 
 		const auto &frame = texture.GetFrame(0);
-		DXGI_FORMAT format;
+		if (!isReachable[i])
+		{
+			textureStats.numSkipped++;
+			textureStats.skippedSize += frame.size;
+			continue;
+		}
+
+		DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
 		switch (frame.magic)
 		{
 		case '1TXD':
@@ -418,146 +825,93 @@ bool WorldRenderer::LoadWorld(const GameWorld &world)
 			break;
 		default:
 			assert(0);
+			continue; //not a format the renderers can read
 		}
 
-		textures[i] = renderer.CreateTexture(frame.data, frame.size, frame.width, frame.height, format, i);
+		textures[i] = renderer.CreateTexture(frame.data, frame.size, frame.width, frame.height, format);
+		textureStats.numUploaded++;
+		textureStats.uploadedSize += frame.size;
 	}
 
 	return true;
 }
 
-void WorldRenderer::UnloadWorld()
+//flags a texture index resolved from the world, negative when there is no texture
+static void MarkReachable(Array<bool> &isReachable, int32_t textureIndex)
 {
-	for (auto &mesh : actorMeshes)
-		renderer.DestroyMesh(mesh.mesh);
-
-	for (auto &texture : textures)
-		renderer.DestroyTexture(texture);
-
-	for (auto &mesh : meshes)
-		renderer.DestroyMesh(mesh.mesh);
-
-	for (auto &roomMesh : roomMeshes)
-		renderer.DestroyMesh(roomMesh.mesh);
-
-	pool.Destroy();
-
-	//just restore the previously saved renderer state, simple as that!
-	renderer.RestoreInternalState();
-}
-
-static void TranslateRelative(Matrix &matrix, float x, float y, float z)
-{
-	matrix[3].x += x * matrix[0].x + y * matrix[1].x + z * matrix[2].x;
-	matrix[3].y += x * matrix[0].y + y * matrix[1].y + z * matrix[2].y;
-	matrix[3].z += x * matrix[0].z + y * matrix[1].z + z * matrix[2].z;
+	if (textureIndex >= 0 && (uint32_t)textureIndex < isReachable.Count())
+		isReachable[textureIndex] = true;
 }
 
-static void RotateXYZ(Matrix &matrix, float rx, float ry, float rz)
+void WorldRenderer::FindReachableTextures(const GameWorld &world, Array<bool> &isReachable) const
 {
-	float sinValue;
-	float cosValue;
-	Vector temp;
-
-	if (rz != 0.0f)
+	//the parts are drawn with the base texture of their surface property's selected material,
+	//resolved the same way as when they are queued, the materials' other textures are never bound
+	for (const auto &mesh : roomMeshes)
 	{
-		sinValue = sinf(rz);
-		cosValue = cosf(rz);
-
-		temp = matrix[0];
-		matrix[0] = temp * cosValue + matrix[1] * sinValue;
-		matrix[1] = matrix[1] * cosValue - temp * sinValue;
+		for (const auto &part : mesh.parts)
+		{
+			MarkReachable(isReachable, world.GetBaseTextureIndex(part.indexSurfaceProperty));
+			MarkReachable(isReachable, part.texindexLightmap - GameWorld::NUM_SYSTEM_TEXTURES);
+		}
 	}
-	if (rx != 0.0f)
-	{
-		sinValue = sinf(rx);
-		cosValue = cosf(rx);
 
-		temp = matrix[1];
-		matrix[1] = temp * cosValue + matrix[2] * sinValue;
-		matrix[2] = matrix[2] * cosValue - temp * sinValue;
-	}
-	if (ry != 0.0f)
+	for (const auto &mesh : meshes)
 	{
-		sinValue = sinf(ry);
-		cosValue = cosf(ry);
-
-		temp = matrix[2];
-		matrix[2] = temp * cosValue + matrix[0] * sinValue;
-		matrix[0] = matrix[0] * cosValue - temp * sinValue;
+		for (const auto &part : mesh.parts)
+			MarkReachable(isReachable, world.GetBaseTextureIndex(part.indexSurfaceProperty));
 	}
-}
 
-static void Scale(Matrix &matrix, float scale)
-{
-	matrix[0] *= scale;
-	matrix[1] *= scale;
-	matrix[2] *= scale;
-}
-
-#if 0
-class HierarchyRenderer
-{
-	sbRenderer &renderer;
-	const Matrix &viewProjection;
-
-	void SetSpecificPipeline(const GameWorld &world, const ObjectMeshPart &part)
+	for (const auto &mesh : actorMeshes)
 	{
-		int textureIndex = world.GetBaseTextureIndex(part.indexSurfaceProperty);
-		bool noDiffuse = textureIndex < 0;
-		if (noDiffuse)
-			renderer.UsePhongFallbackDiffuse();
-		else
-			renderer.UsePhongDiffuse(textureIndex);
+		for (const auto &part : mesh.parts)
+			MarkReachable(isReachable, world.GetBaseTextureIndex(part.indexSurfaceProperty));
 	}
+}
 
-public:
-	HierarchyRenderer(sbRenderer &renderer, const Matrix &viewProjection) :
-		renderer(renderer), viewProjection(viewProjection)
-	{}
+void WorldRenderer::UnloadWorld()
+{
+	//loading failed before saving the renderer's state, or the world was already unloaded
+	if (!isWorldLoaded)
+		return;
 
-	void Render(const GameWorld &world, uint32_t index)
-	{
-		const auto &actor = world.actorWAD.actors[index];
-		const auto &internalMesh = actorMeshes[index];
+	for (auto &texture : textures)
+		renderer.DestroyTexture(texture);
+	textures = Array<sbTexture>(); //lived in the pool
 
-		//if this actor mesh is empty, we skip it
-		if (internalMesh.mesh.numIndices == 0)
-			return;
+	objectCuller.Destroy();
+	roomCuller.Destroy();
 
-		//bind the actor mesh
-		renderer.BindMesh<PhongVertex>(internalMesh.mesh);
+	renderer.DestroyBuffer(indexBuffer);
+	renderer.DestroyBuffer(meshVertexBuffer);
+	renderer.DestroyBuffer(roomVertexBuffer);
+	geometryLayout.Reset();
 
-		//for every part of the mesh...
-		uint32_t startIndex = 0;
-		for (const auto &part : internalMesh.parts)
-		{
-			SetSpecificPipeline(world, part);
+	pool.Destroy();
 
-			//draw the adequate number of indices
-			renderer.DrawBoundMesh(part.numIndices, startIndex);
-			startIndex += part.numIndices;
-		}
-	}
-};
-#endif
+	//just restore the previously saved renderer state, simple as that!
+	renderer.RestoreInternalState();
+	isWorldLoaded = false;
+}
 
 class ObjectRenderer
 {
 	WorldRenderer &worldRenderer;
+	InstanceBatcher &instanceBatcher; //the frame's, or that of the thread recording the object
 	const Matrix &viewProjection;
+	const Vector &cameraPosition;
+	float projectionScale;
 
-	void SetSpecificPipeline(const GameWorld &world, const ObjectMeshPart &part)
+	//adds a part with its texture, to be drawn along with the same part of the other objects
+	void QueuePart(const GameWorld &world, const ObjectMeshPart &part, uint32_t transformIndex, float distance, uint32_t numIndices, uint32_t startIndex, int32_t baseVertex)
 	{
 		auto textureIndex = world.GetBaseTextureIndex(part.indexSurfaceProperty);
 		bool noDiffuse = textureIndex < 0;
-		if (noDiffuse)
-			worldRenderer.UsePhongFallbackDiffuse();
-		else
-			worldRenderer.UsePhongDiffuse(textureIndex);
+		uint32_t diffuseIndex = noDiffuse ? WorldRenderer::FALLBACK_TEXTURE_INDEX : textureIndex;
+		instanceBatcher.Add(diffuseIndex, numIndices, startIndex, baseVertex, transformIndex, distance);
 	}
 
-	void DrawMesh(const GameWorld &world, Object *object)
+	void DrawMesh(const GameWorld &world, Object *object, const Matrix &objectTransform, uint32_t transformIndex)
 	{
 		uint32_t index = object->drawableNumber.GetID();
 		assert(index < world.meshes.Count());
@@ -565,40 +919,81 @@ class ObjectRenderer
 		const ObjectMesh &mesh = worldRenderer.meshes[index];
 
 		//if this mesh is empty, we skip it
-		if (mesh.mesh.numIndices == 0)
+		if (mesh.range.numIndices == 0)
 			return;
 
-		worldRenderer.renderer.BindMesh<PhongVertex>(mesh.mesh);
 //		const Room &parentRoom = world.rooms[object->location];
 
-		//draw every part of the mesh
-		uint32_t startIndex = 0;
-		for (const auto &part : mesh.parts)
+		//pick the level of detail from the distance to the camera
+		float distance = (objectTransform.GetTranslation() - cameraPosition).Length();
+		float scale = objectTransform[0].Length(); //the transform holds the scale of the whole hierarchy
+		uint32_t level = SelectLodByDistance(mesh.lods, distance, mesh.lodDistance * scale);
+
+		//draw every part of that level that is on screen, the shared buffers are already bound
+		Frustum frustum(viewProjection * objectTransform);
+		uint32_t startIndex = mesh.range.startIndex + mesh.lods.levelStartIndex[level];
+		for (uint32_t p = 0; p < mesh.parts.Count(); p++)
 		{
-			SetSpecificPipeline(world, part);
+			uint32_t numIndices = mesh.lods.GetPartNumIndices(level, p);
+			if (numIndices == 0)
+				continue;
 
-			//draw the adequate number of indices
-			worldRenderer.renderer.DrawBoundMesh(part.numIndices, startIndex);
-			startIndex += part.numIndices;
+			if (frustum.IsBoxVisible(mesh.parts[p].bounds))
+				QueuePart(world, mesh.parts[p], transformIndex, distance, numIndices, startIndex, mesh.range.baseVertex);
+			startIndex += numIndices;
+		}
+	}
+
+	void DrawActor(const GameWorld &world, Object *object, const Matrix &objectTransform, uint32_t transformIndex)
+	{
+		//every mesh of the model picks its own level of detail
+		uint32_t index = object->drawableNumber.GetID();
+		for (uint32_t m = worldRenderer.firstActorMeshes[index]; m < worldRenderer.firstActorMeshes[index + 1]; m++)
+			DrawActorMesh(world, worldRenderer.actorMeshes[m], objectTransform, transformIndex);
+	}
+
+	void DrawActorMesh(const GameWorld &world, const ActorMesh &mesh, const Matrix &objectTransform, uint32_t transformIndex)
+	{
+		//if this mesh has nothing to draw, we skip it
+		if (mesh.range.numIndices == 0)
+			return;
+
+		//pick the level of detail from the size the actor takes on screen
+		uint32_t level = 0;
+		float distance = (objectTransform.GetTranslation() - cameraPosition).Length();
+		float radius = mesh.radius * objectTransform[0].Length(); //the transform holds the scale of the whole hierarchy
+		if (distance > radius)
+		{
+			float screenSize = 2.0f * radius * projectionScale / distance;
+			level = SelectLodByScreenSize(mesh.lods, screenSize, mesh.falloffNearSize, mesh.falloffFarSize, mesh.falloffPower);
+		}
+
+		//draw every part of that level, the shared buffers are already bound
+		uint32_t startIndex = mesh.range.startIndex + mesh.lods.levelStartIndex[level];
+		for (uint32_t p = 0; p < mesh.parts.Count(); p++)
+		{
+			uint32_t numIndices = mesh.lods.GetPartNumIndices(level, p);
+			if (numIndices == 0)
+				continue;
+
+			QueuePart(world, mesh.parts[p], transformIndex, distance, numIndices, startIndex, mesh.range.baseVertex);
+			startIndex += numIndices;
 		}
 	}
 
 public:
-	ObjectRenderer(WorldRenderer &worldRenderer, const Matrix &viewProjection):
-		worldRenderer(worldRenderer), viewProjection(viewProjection)
+	ObjectRenderer(WorldRenderer &worldRenderer, InstanceBatcher &instanceBatcher, const Matrix &viewProjection, const Vector &cameraPosition, float projectionScale):
+		worldRenderer(worldRenderer), instanceBatcher(instanceBatcher), viewProjection(viewProjection), cameraPosition(cameraPosition), projectionScale(projectionScale)
 	{}
 
 	void Render(const GameWorld &world, Object *object, const Matrix &parentTransform)
 	{
-		Matrix objectTransform = parentTransform; //make a copy
-//		Vector objectPosition = Vector(object->position.x, object->position.y, object->position.z);
-//		objectTransform.SetTranslation(parentTransform.GetTranslation() + objectPosition);
-//		objectTransform.SetScale(object->scale);
-		TranslateRelative(objectTransform, object->position.x, object->position.y, object->position.z);
-		RotateXYZ(objectTransform, object->rotation.x, object->rotation.y, object->rotation.z);
-		Scale(objectTransform, object->scale);
+		Matrix objectTransform = ComputeObjectTransform(parentTransform, object);
 
-		worldRenderer.renderer.SetWorldViewProjectionMatrix(viewProjection * objectTransform);
+		//the sub-objects are not drawn either when there is no room left for their transforms
+		uint32_t transformIndex = instanceBatcher.AddTransform(viewProjection * objectTransform);
+		if (transformIndex == InstanceBatcher::INVALID_INDEX)
+			return;
 
 		MESH_TYPE meshType = object->drawableNumber.GetMeshType();
 //		uint32_t index = object->drawableNumber.GetID();
@@ -606,7 +1001,7 @@ public:
 		{
 		case MT_MESH:
 		{
-			DrawMesh(world, object);
+			DrawMesh(world, object, objectTransform, transformIndex);
 			break;
 		}
 //		case MT_EMITTER:
@@ -614,10 +1009,15 @@ public:
 //			assert(index < world.emitters.Count());
 //			break;
 //		}
-//		case MT_HIERARCHY:
-//		{
-//			break;
-//		}
+		case MT_HIERARCHY:
+		{
+			//actors only exist once the actor WAD has been loaded
+			if (object->drawableNumber.GetID() + 1 >= worldRenderer.firstActorMeshes.Count())
+				return;
+
+			DrawActor(world, object, objectTransform, transformIndex);
+			break;
+		}
 //		case MT_TRIGGER:
 //		{
 //			break;
@@ -640,78 +1040,164 @@ class RoomRenderer
 {
 	WorldRenderer &worldRenderer; //the RoomRenderer cannot exist without a WorldRenderer
 	LineRenderer &lineRenderer;
+	DrawQueue &drawQueue; //the frame's, or that of the thread recording the room
+	InstanceBatcher &instanceBatcher; //same, for the room's objects
 	const Matrix &viewProjection;
+	const Vector &cameraPosition;
+	float projectionScale;
 	const bool &drawLighting;
 
-	void SetSpecificPipeline(const GameWorld &world, const RoomPart &part)
+	//queues a part with its diffuse texture and its lightmap
+	void QueuePart(const GameWorld &world, const RoomPart &part, uint32_t matrixIndex, float distance, uint32_t numIndices, uint32_t startIndex, int32_t baseVertex)
 	{
 		auto textureIndex = world.GetBaseTextureIndex(part.indexSurfaceProperty);
 		auto lightmapIndex = part.texindexLightmap - GameWorld::NUM_SYSTEM_TEXTURES;
 
-		//bind its textures...
+		uint32_t diffuseIndex = textureIndex;
+		uint32_t lightmapTextureIndex = lightmapIndex;
 		bool noDiffuse = textureIndex < 0;
 		bool noLightmap = lightmapIndex < 0 || !drawLighting;
 		if (noDiffuse || noLightmap)
-			worldRenderer.UseFallbackDiffuseAndLightmap();
+		{
+			diffuseIndex = WorldRenderer::FALLBACK_TEXTURE_INDEX;
+			lightmapTextureIndex = WorldRenderer::FALLBACK_TEXTURE_INDEX;
+		}
 //		else if (noLightmap)
-//			worldRenderer.UseFullbrightDiffuse(textureIndex);
-		else
-			worldRenderer.UseDiffuseAndLightmap(textureIndex, lightmapIndex);
+//			lightmapTextureIndex = WorldRenderer::FALLBACK_TEXTURE_INDEX;
+
+		drawQueue.Add(LIGHTMAPPED_PIPELINE, diffuseIndex, lightmapTextureIndex, matrixIndex, distance, numIndices, startIndex, baseVertex);
+	}
+
+	//draws the meshlets of a part that do not face away from the camera,
+	//consecutive meshlets are merged into a single draw
+	void DrawPartMeshlets(const GameWorld &world, const RoomMesh &internalMesh, uint32_t partIndex, uint32_t &meshletIndex, const Vector &localCameraPosition, uint32_t matrixIndex, float distance)
+	{
+		const auto &meshlets = internalMesh.meshlets.meshlets;
+
+		uint32_t runStartIndex = 0;
+		uint32_t runNumIndices = 0;
+		auto drawRun = [&]()
+		{
+			if (runNumIndices == 0)
+				return;
+
+			QueuePart(world, internalMesh.parts[partIndex], matrixIndex, distance, runNumIndices, internalMesh.range.startIndex + runStartIndex, internalMesh.range.baseVertex);
+			runNumIndices = 0;
+		};
+
+		for (; meshletIndex < meshlets.Count() && meshlets[meshletIndex].partIndex == partIndex; meshletIndex++)
+		{
+			const Meshlet &meshlet = meshlets[meshletIndex];
+			if (IsMeshletBackfacing(meshlet, localCameraPosition))
+				continue;
+
+			//extend the current run if this meshlet directly follows it
+			if (runNumIndices != 0 && runStartIndex + runNumIndices == meshlet.startIndex)
+			{
+				runNumIndices += meshlet.numTriangles * 3;
+				continue;
+			}
+
+			drawRun();
+			runStartIndex = meshlet.startIndex;
+			runNumIndices = meshlet.numTriangles * 3;
+		}
+		drawRun();
 	}
 
 public:
-	RoomRenderer(WorldRenderer &worldRenderer, LineRenderer &lineRenderer, const Matrix &viewProjection, const bool &drawLighting):
+	RoomRenderer(WorldRenderer &worldRenderer, LineRenderer &lineRenderer, DrawQueue &drawQueue, InstanceBatcher &instanceBatcher,
+		const Matrix &viewProjection, const Vector &cameraPosition, float projectionScale, const bool &drawLighting):
 		worldRenderer(worldRenderer),
 		lineRenderer(lineRenderer),
+		drawQueue(drawQueue),
+		instanceBatcher(instanceBatcher),
 		viewProjection(viewProjection),
+		cameraPosition(cameraPosition),
+		projectionScale(projectionScale),
 		drawLighting(drawLighting)
 	{}
 
-	void Render(const GameWorld &world, uint32_t roomIndex)
+	//if given, @occlusionCuller hides the parts that are behind the occluders
+	void Render(const GameWorld &world, uint32_t roomIndex, OcclusionCuller *occlusionCuller = nullptr)
 	{
 		const auto &room = world.rooms[roomIndex];
 		const auto &internalMesh = worldRenderer.roomMeshes[roomIndex];
 
 		//if this room is empty, we skip it
-		if (internalMesh.mesh.numIndices == 0)
+		if (internalMesh.range.numIndices == 0)
 			return;
 
 		//set transform
 		Matrix roomTransform;
 		roomTransform.SetTranslation(Vector(room.position.x, room.position.y, room.position.z));
 		roomTransform.SetScale(room.scale);
-		worldRenderer.SetWorldViewProjectionMatrix(viewProjection * roomTransform);
+		Matrix worldViewProjection = viewProjection * roomTransform;
+		uint32_t matrixIndex = drawQueue.AddMatrix(worldViewProjection);
+		if (matrixIndex == DrawQueue::INVALID_INDEX)
+			return;
 
-		//bind the room mesh
-		worldRenderer.renderer.BindMesh<LightMappedVertex>(internalMesh.mesh);
+		//parts are bounded in room space, so test them against the room's own frustum
+		Frustum frustum(worldViewProjection);
+		Vector roomPosition(room.position.x, room.position.y, room.position.z);
+		auto isPartVisible = [&](const RoomPart &part)
+		{
+			if (!frustum.IsBoxVisible(part.bounds))
+				return false;
 
-		//for every part of the mesh...
-		uint32_t startIndex = 0;
-		for (const auto &part : internalMesh.parts)
+			//a room made of a single part has already been tested as a whole
+			if (!occlusionCuller || internalMesh.parts.Count() == 1)
+				return true;
+			return occlusionCuller->IsBoxVisible(BBox(part.bounds.min * room.scale + roomPosition, part.bounds.max * room.scale + roomPosition));
+		};
+		auto getPartDistance = [&](const RoomPart &part)
 		{
-			SetSpecificPipeline(world, part);
+			return ((part.bounds.min + part.bounds.max) * (0.5f * room.scale) + roomPosition - cameraPosition).Length();
+		};
+
+		//if the room has been split into meshlets, only draw those that can face the camera
+		if (internalMesh.meshlets.meshlets.Count() != 0)
+		{
+			//bring the camera into the room's space
+			Vector localCameraPosition = (cameraPosition - roomPosition) * (1.0f / room.scale);
+
+			const auto &meshlets = internalMesh.meshlets.meshlets;
+			uint32_t meshletIndex = 0;
+			for (uint32_t p = 0; p < internalMesh.parts.Count(); p++)
+			{
+				if (isPartVisible(internalMesh.parts[p]))
+				{
+					DrawPartMeshlets(world, internalMesh, p, meshletIndex, localCameraPosition, matrixIndex, getPartDistance(internalMesh.parts[p]));
+					continue;
+				}
+
+				//skip the meshlets of the off-screen part
+				while (meshletIndex < meshlets.Count() && meshlets[meshletIndex].partIndex == p)
+					meshletIndex++;
+			}
+			return;
+		}
 
-			//draw the adequate number of indices
-			worldRenderer.renderer.DrawBoundMesh(part.numIndices, startIndex);
+		//for every part of the mesh that is on screen...
+		uint32_t startIndex = internalMesh.range.startIndex;
+		for (const auto &part : internalMesh.parts)
+		{
+			if (isPartVisible(part))
+				QueuePart(world, part, matrixIndex, getPartDistance(part), part.numIndices, startIndex, internalMesh.range.baseVertex);
 			startIndex += part.numIndices;
 		}
 	}
 
-	void RenderObjects(const GameWorld &world, uint32_t roomIndex)
+	//renders one of the room's top-level objects, along with its sub-objects
+	void RenderObject(const GameWorld &world, uint32_t roomIndex, Object *object)
 	{
 		const auto &room = world.rooms[roomIndex];
 
-		//render room's objects
-		bool drawObjects = true;
-		if (drawObjects)
-		{
-			Matrix parentTransform;
-			parentTransform.SetTranslation(Vector(room.position.x, room.position.y, room.position.z));
+		Matrix parentTransform;
+		parentTransform.SetTranslation(Vector(room.position.x, room.position.y, room.position.z));
 
-			ObjectRenderer objectRenderer(worldRenderer, viewProjection);
-			for (Object *object = room.objects; object; object = object->next)
-				objectRenderer.Render(world, object, parentTransform);
-		}
+		ObjectRenderer objectRenderer(worldRenderer, instanceBatcher, viewProjection, cameraPosition, projectionScale);
+		objectRenderer.Render(world, object, parentTransform);
 	}
 
 	void RenderTriggers(const GameWorld &world, uint32_t roomIndex)
@@ -734,75 +1220,288 @@ public:
 	}
 };
 
-void WorldRenderer::Render(const Document &document, const Matrix &viewProjection)
+//gives the sorted draws to the renderer, along with the buffers of their pipeline
+class PacketSubmitter
 {
-	const GameWorld &world = document.world;
+	WorldRenderer &worldRenderer;
+	uint32_t pipeline;
+	bool isInstancing; //the matrices of the objects are in the instance buffer
 
-	RoomRenderer roomRenderer(*this, lineRenderer, viewProjection, document.drawLights);
+public:
+	PacketSubmitter(WorldRenderer &worldRenderer):
+		worldRenderer(worldRenderer), pipeline(LIGHTMAPPED_PIPELINE), isInstancing(false)
+	{}
 
-	//render rooms
-	if (document.drawRooms)
+	void UsePipeline(uint32_t newPipeline)
 	{
-		renderer.UsePipeline(lmsgPipeline);
+		pipeline = newPipeline;
+		isInstancing = false;
 
-		if (document.drawHelpers) //TEMP! get drawVisibleRoomsOnly
+		auto &renderer = worldRenderer.renderer;
+		if (pipeline == LIGHTMAPPED_PIPELINE)
 		{
-			constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+			renderer.UsePipeline(worldRenderer.lmsgPipeline);
+			renderer.BindVertexBuffer<LightMappedVertex>(worldRenderer.roomVertexBuffer);
+		}
+		else
+		{
+			//the matrices of all of the objects' instances are uploaded at once
+			if (worldRenderer.isInstancingSupported)
+			{
+				const Matrix &firstMatrix = worldRenderer.drawQueue.GetMatrix(worldRenderer.firstInstanceMatrix);
+				isInstancing = renderer.BindInstanceData(&firstMatrix, sizeof(Matrix), worldRenderer.instanceBatcher.GetNumGatheredTransforms());
+			}
+
+			renderer.UsePipeline(isInstancing ? worldRenderer.psgInstancedPipeline : worldRenderer.psgPipeline);
+			renderer.BindVertexBuffer<PhongVertex>(worldRenderer.meshVertexBuffer);
+		}
+		renderer.BindIndexBuffer(worldRenderer.indexBuffer);
+	}
+
+	void UseTextures(uint32_t textureIndex0, uint32_t textureIndex1)
+	{
+		//the packets keep the world's texture indices, the renderer wants the descriptors of their slots
+		uint32_t descriptor0 = worldRenderer.GetTextureDescriptor(textureIndex0);
+		if (pipeline == LIGHTMAPPED_PIPELINE)
+			worldRenderer.renderer.UseTwoTextures(descriptor0, worldRenderer.GetTextureDescriptor(textureIndex1));
+		else
+			worldRenderer.renderer.UseOneTexture(descriptor0);
+	}
+
+	void SetMatrix(const Matrix &m)
+	{
+		if (!isInstancing)
+			worldRenderer.renderer.SetWorldViewProjectionMatrix(m);
+	}
+
+	void Draw(uint32_t numIndices, uint32_t startIndex, int32_t baseVertex, uint32_t matrixIndex, uint32_t numInstances)
+	{
+		auto &renderer = worldRenderer.renderer;
+		if (isInstancing)
+		{
+			renderer.DrawBoundMeshInstances(numIndices, numInstances, startIndex, baseVertex, matrixIndex - worldRenderer.firstInstanceMatrix);
+			return;
+		}
+
+		//the first matrix has already been set
+		renderer.DrawBoundMesh(numIndices, startIndex, baseVertex);
+		for (uint32_t i = 1; i < numInstances; i++)
+		{
+			renderer.SetWorldViewProjectionMatrix(worldRenderer.drawQueue.GetMatrix(matrixIndex + i));
+			renderer.DrawBoundMesh(numIndices, startIndex, baseVertex);
+		}
+	}
+};
 
-			//get the room the camera is in
-			uint32_t roomIndex = INVALID_INDEX;
-			Vector cameraPosition = document.camera.GetPosition();
-			for (uint32_t i = 0; i < world.rooms.Count(); i++)
+//queues the batches of object parts, the matrices of every batch's instances following each other
+void WorldRenderer::QueueObjectInstances()
+{
+	instanceBatcher.Build();
+	uint32_t numTransforms = instanceBatcher.GetNumGatheredTransforms();
+	if (numTransforms == 0)
+		return;
+
+	firstInstanceMatrix = drawQueue.AddMatrices(instanceBatcher.GetGatheredTransforms(), numTransforms);
+	if (firstInstanceMatrix == DrawQueue::INVALID_INDEX)
+		return;
+
+	for (uint32_t b = 0; b < instanceBatcher.GetNumBatches(); b++)
+	{
+		const auto &batch = instanceBatcher.GetBatch(b);
+		drawQueue.Add(PHONG_PIPELINE, batch.textureIndex, FALLBACK_TEXTURE_INDEX, firstInstanceMatrix + batch.firstInstance, batch.depth,
+			batch.numIndices, batch.startIndex, batch.baseVertex, batch.numInstances);
+	}
+}
+
+//fills visibleRoomIndices with the rooms to draw, and returns how many there are
+uint32_t WorldRenderer::FindVisibleRooms(const Document &document, const Frustum &frustum)
+{
+	const GameWorld &world = document.world;
+	uint32_t numVisible = roomCuller.Cull(frustum, visibleRoomIndices.Data());
+
+	if (!document.drawHelpers) //TEMP! get drawVisibleRoomsOnly
+		return numVisible;
+
+	//only keep the room the camera is in, found when ticking the document, and the rooms it sees
+	uint32_t roomIndex = document.cameraRoomIndex;
+	if (roomIndex == RoomBVH::INVALID_ROOM)
+		return 0;
+
+	for (auto &isVisible : isRoomVisible)
+		isVisible = false;
+
+	//where the openings are known, only the rooms seen through one on screen
+	const PortalGraph &portalGraph = document.portalGraph;
+	if (portalGraph.HasPortals(roomIndex))
+	{
+		visibleRoomIndices[0] = roomIndex;
+		numVisible = 1 + portalGraph.FindVisibleRooms(roomIndex, document.camera.GetPosition(), frustum, visibleRoomIndices.Data() + 1, isRoomVisible.Data());
+		isRoomVisible[roomIndex] = true;
+		if (portalGraph.IsSealed(roomIndex))
+			return numVisible;
+
+		//the gaps that are not portals may show any of the viewable rooms, so those on screen are kept as well
+		for (const auto &visibleRoomIndex : world.rooms[roomIndex].viewableRooms)
+		{
+			if (!isRoomVisible[visibleRoomIndex] && frustum.IsBoxVisible(roomCuller.GetBox(visibleRoomIndex)))
 			{
-				const auto &room = world.rooms[i];
-				auto bbox = ComputeRoomBBox(room);
-				bool isCameraInRoom = bbox.IsContainSphere(cameraPosition, 1.0f);
-				if (isCameraInRoom)
-				{
-					roomIndex = i;
-					break;
-				}
+				isRoomVisible[visibleRoomIndex] = true;
+				visibleRoomIndices[numVisible++] = visibleRoomIndex;
 			}
+		}
+		return numVisible;
+	}
+
+	for (uint32_t i = 0; i < numVisible; i++)
+		isRoomVisible[visibleRoomIndices[i]] = true;
+
+	numVisible = 0;
+	visibleRoomIndices[numVisible++] = roomIndex;
+	for (const auto &visibleRoomIndex : world.rooms[roomIndex].viewableRooms)
+	{
+		if (visibleRoomIndex != roomIndex && isRoomVisible[visibleRoomIndex])
+			visibleRoomIndices[numVisible++] = visibleRoomIndex;
+	}
+	return numVisible;
+}
+
+//rasterizes the rooms nearest to the camera as occluders, the culler finishing them on its worker threads
+void WorldRenderer::StartOcclusionCulling(const GameWorld &world, const Matrix &viewProjection, const Vector &cameraPosition, uint32_t numVisibleRooms)
+{
+	//keep the nearest visible rooms, sorted by the distance from the camera to their box
+	uint32_t occluders[MAX_OCCLUDER_ROOMS];
+	float occluderDistances[MAX_OCCLUDER_ROOMS];
+	uint32_t numOccluders = 0;
+	for (uint32_t i = 0; i < numVisibleRooms; i++)
+	{
+		uint32_t roomIndex = visibleRoomIndices[i];
+		if (roomMeshes[roomIndex].occluderIndices.Count() == 0)
+			continue;
+
+		BBox box = roomCuller.GetBox(roomIndex);
+		Vector closest(
+			fmaxf(box.min.x, fminf(cameraPosition.x, box.max.x)),
+			fmaxf(box.min.y, fminf(cameraPosition.y, box.max.y)),
+			fmaxf(box.min.z, fminf(cameraPosition.z, box.max.z))
+		);
+		float distance = (closest - cameraPosition).Length();
 
-			if (roomIndex != INVALID_INDEX)
+		uint32_t slot = numOccluders < MAX_OCCLUDER_ROOMS ? numOccluders++ : MAX_OCCLUDER_ROOMS;
+		for (; slot > 0 && occluderDistances[slot - 1] > distance; slot--)
+		{
+			if (slot < MAX_OCCLUDER_ROOMS)
 			{
-				//render that room and its visible rooms
-				roomRenderer.Render(world, roomIndex);
-				const auto &room = world.rooms[roomIndex];
-				for (const auto &visibleRoomIndex : room.viewableRooms)
-					roomRenderer.Render(world, visibleRoomIndex);
+				occluders[slot] = occluders[slot - 1];
+				occluderDistances[slot] = occluderDistances[slot - 1];
 			}
 		}
-		else
+		if (slot < MAX_OCCLUDER_ROOMS)
 		{
-			for (uint32_t i = 0; i < world.rooms.Count(); i++)
-				roomRenderer.Render(world, i);
+			occluders[slot] = roomIndex;
+			occluderDistances[slot] = distance;
 		}
 	}
 
-	//render rooms objects
-	if (document.drawObjects)
+	occlusionCuller.BeginFrame(viewProjection);
+	for (uint32_t i = 0; i < numOccluders; i++)
 	{
-		renderer.UsePipeline(psgPipeline);
-		for (uint32_t i = 0; i < world.rooms.Count(); i++)
-			roomRenderer.RenderObjects(world, i);
+		const auto &room = world.rooms[occluders[i]];
+		const auto &occluderIndices = roomMeshes[occluders[i]].occluderIndices;
+
+		Matrix roomTransform;
+		roomTransform.SetTranslation(Vector(room.position.x, room.position.y, room.position.z));
+		roomTransform.SetScale(room.scale);
+		occlusionCuller.AddOccluder(viewProjection * roomTransform, room.mesh.positions, room.mesh.numVerts, occluderIndices.Data(), occluderIndices.Count());
+	}
+	occlusionCuller.Rasterize();
+}
+
+void WorldRenderer::Render(const Document &document, const Matrix &viewProjection)
+{
+	const GameWorld &world = document.world;
+
+	Vector cameraPosition = document.camera.GetPosition();
+	float projectionScale = document.camera.GetProjectionScale();
+	RoomRenderer roomRenderer(*this, lineRenderer, drawQueue, instanceBatcher, viewProjection, cameraPosition, projectionScale, document.drawLights);
+
+	//only what is in the view frustum gets drawn
+	Frustum frustum(viewProjection);
+	uint32_t numVisibleRooms = FindVisibleRooms(document, frustum);
+
+	//the rooms only hide what is behind them if they are drawn
+	bool drawRooms = document.drawRooms && roomVertexBuffer;
+	StartOcclusionCulling(world, viewProjection, cameraPosition, drawRooms ? numVisibleRooms : 0);
+
+	//the rooms and the objects are queued, then drawn sorted by state
+	drawQueue.Reset();
+	instanceBatcher.Reset();
+
+	//nothing can hide the room the camera is in, so queue it while the occluders are being rasterized
+	uint32_t cameraRoomIndex = document.cameraRoomIndex;
+	uint32_t numRecordedRooms = drawRooms ? numVisibleRooms : 0;
+	for (uint32_t i = 0; i < numRecordedRooms; i++)
+	{
+		if (visibleRoomIndices[i] == cameraRoomIndex)
+			roomRenderer.Render(world, cameraRoomIndex);
 	}
+	occlusionCuller.Finish();
+
+	//the other rooms, then the rooms objects, are recorded on every core,
+	//and merged in that order as if they had been recorded one after the other
+	bool drawObjects = document.drawObjects && meshVertexBuffer;
+	uint32_t numRecordedObjects = drawObjects ? objectCuller.Cull(frustum, visibleObjectIndices.Data()) : 0;
+	auto record = [&](DrawRecorder::Stream &stream, uint32_t item)
+	{
+		RoomRenderer streamRenderer(*this, lineRenderer, stream.drawQueue, stream.instanceBatcher, viewProjection, cameraPosition, projectionScale, document.drawLights);
+		if (item < numRecordedRooms)
+		{
+			uint32_t roomIndex = visibleRoomIndices[item];
+			if (roomIndex != cameraRoomIndex && occlusionCuller.IsBoxVisible(roomCuller.GetBox(roomIndex)))
+				streamRenderer.Render(world, roomIndex, &occlusionCuller);
+			return;
+		}
+
+		uint32_t index = visibleObjectIndices[item - numRecordedRooms];
+		if (!occlusionCuller.IsBoxVisible(objectCuller.GetBox(index)))
+			return;
+
+		const auto &culledObject = culledObjects[index];
+		streamRenderer.RenderObject(world, culledObject.roomIndex, culledObject.object);
+	};
+	drawRecorder.Record(numRecordedRooms + numRecordedObjects, record);
+	drawRecorder.Merge(drawQueue, instanceBatcher);
+
+	if (drawObjects)
+		QueueObjectInstances();
+
+	drawQueue.Sort();
+	PacketSubmitter submitter(*this);
+	drawQueue.Submit(submitter);
 
 	//render rooms triggers
 	if (document.drawTriggers)
 	{
 		for (uint32_t i = 0; i < world.rooms.Count(); i++)
 			roomRenderer.RenderTriggers(world, i);
-	}
 
-	//render actors
-//	Matrix parentTransform;
-//	parentTransform.SetTranslation(Vector(room.position.x, room.position.y, room.position.z));
-
-//	HierarchyRenderer hierarchyRenderer(renderer, viewProjection);
-//	for (uint32_t i = 0; i < world.actorWAD.actors.Count(); i++)
-//	if (world.actorWAD.actors.Count())
-//		hierarchyRenderer.Render(world, 0); //TEMP!!!
+		//outline the objects inside the triggers the camera is in
+		static constexpr uint32_t MAX_HIGHLIGHTED = 8;
+		uint32_t triggerRooms[MAX_HIGHLIGHTED];
+		uint32_t triggerIndices[MAX_HIGHLIGHTED];
+		uint32_t numTriggers = document.FindTriggers(cameraPosition, triggerRooms, triggerIndices, MAX_HIGHLIGHTED);
+		for (uint32_t t = 0; t < numTriggers; t++)
+		{
+			uint32_t objectIndices[MAX_HIGHLIGHTED];
+			uint32_t numObjects = document.FindObjectsInTrigger(triggerRooms[t], triggerIndices[t], objectIndices, MAX_HIGHLIGHTED);
+			for (uint32_t o = 0; o < numObjects; o++)
+			{
+				//the rooms' objects are located by their room's index, counting down from the top
+				const Object &object = world.objects[objectIndices[o]];
+				static constexpr Vector yellowColor(1.0f, 1.0f, 0.0f);
+				lineRenderer.AddBox(ComputeObjectBBox(world.meshes, world.rooms[0xFFFFFFFF - object.location], &object), yellowColor);
+			}
+		}
+	}
 
 	//render lights
 #if 0
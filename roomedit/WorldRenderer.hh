@@ -2,6 +2,15 @@
 #include "shaders/ColoredSurfaceGraphicsPipeline.hh"
 #include "shaders/LightMappedSurfaceGraphicsPipeline.hh"
 #include "shaders/PhongSurfaceGraphicsPipeline.hh"
+#include "geometry/meshlets.hh"
+#include "geometry/progressive.hh"
+#include "geometry/simplify.hh"
+#include "render/BoxCuller.hh"
+#include "render/DrawQueue.hh"
+#include "render/DrawRecorder.hh"
+#include "render/GeometryLayout.hh"
+#include "render/InstanceBatcher.hh"
+#include "render/OcclusionCuller.hh"
 #include "Document.hh"
 #include "BBox.hh"
 
@@ -39,24 +48,64 @@ struct RoomPart
 	uint32_t numIndices;
 	int32_t indexSurfaceProperty;
 	int32_t texindexLightmap;
+	BBox bounds; //in room space
 };
 
 struct RoomMesh
 {
-	sbMesh mesh;
+	GeometryLayout::Range range; //where the mesh lives in the shared buffers
 	Array<RoomPart> parts;
+	MeshletSet meshlets; //clusters of the parts, ordered like the parts
+	Array<uint32_t> occluderIndices; //the triangles as position indices, for the occlusion culler
 };
 
 struct ObjectMeshPart
 {
 	uint32_t numIndices;
 	int32_t indexSurfaceProperty;
+	BBox bounds; //in mesh space
 };
 
 struct ObjectMesh
 {
-	sbMesh mesh;
+	GeometryLayout::Range range; //where the mesh and all its levels live in the shared buffers
 	Array<ObjectMeshPart> parts;
+	LodSet lods;
+	float lodDistance; //from which the first reduced level is drawn, at a scale of 1
+};
+
+//an actor's current model, along with the levels of detail built from its progressive-reduction tables
+struct ActorMesh
+{
+	GeometryLayout::Range range; //where the mesh and all its levels live in the shared buffers
+	Array<ObjectMeshPart> parts;
+	LodSet lods;
+
+	float radius; //of a sphere around the model's origin, enclosing it
+
+	//screen sizes, in pixels, between which the detail falls off
+	float falloffNearSize;
+	float falloffFarSize;
+	float falloffPower;
+};
+
+//a room's top-level object, culled along with all its sub-objects
+struct CulledObject
+{
+	Object *object;
+	uint32_t roomIndex;
+};
+
+//how many of the world's textures were uploaded when it was loaded, and how many nothing draws with
+struct TextureResidencyStats
+{
+	uint32_t numUploaded;
+	uint32_t numSkipped;
+	uint64_t uploadedSize;
+	uint64_t skippedSize;
+
+	TextureResidencyStats():
+		numUploaded(0), numSkipped(0), uploadedSize(0), skippedSize(0) {}
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -167,55 +216,97 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
-inline BBox ComputeRoomBBox(const Room &room)
-{
-	return BBox(
-		Vector(room.mesh.minExtent.x, room.mesh.minExtent.y, room.mesh.minExtent.z) * room.scale + Vector(room.position.x, room.position.y, room.position.z),
-		Vector(room.mesh.maxExtent.x, room.mesh.maxExtent.y, room.mesh.maxExtent.z) * room.scale + Vector(room.position.x, room.position.y, room.position.z)
-	);
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////
-
 class WorldRenderer
 {
 	friend class RoomRenderer; //we need to be able to access WorldRenderer's private contents from RoomRenderer
 	friend class ObjectRenderer; //same
+	friend class PacketSubmitter; //same
 
 	sbRenderer &renderer;
 
-	static constexpr uint32_t FALLBACK_TEXTURE_INDEX = 0;
-	GPUResource fallbackTexture; //the texture that is used in case one does not exist
+	//past the world's textures, drawn with the renderer's fallback texture, the draw queue's keys only having room for the indices below it
+	static constexpr uint32_t FALLBACK_TEXTURE_INDEX = (1 << DrawQueue::TEXTURE_BITS) - 1;
 
 	LineRenderer lineRenderer;
 
 	ColoredSurfaceGraphicsPipeline csgPipeline;
 	LightMappedSurfaceGraphicsPipeline lmsgPipeline;
 	PhongSurfaceGraphicsPipeline psgPipeline;
+	PhongSurfaceGraphicsPipeline psgInstancedPipeline;
+	bool isInstancingSupported; //only if its pipeline could be created
 
 	MemoryPool pool;
+	bool isWorldLoaded; //from the renderer's state being saved until it is restored, even if loading stopped halfway
+
+	//every mesh of the world is packed into these shared buffers,
+	//so that we only bind them once per pipeline
+	GeometryLayout geometryLayout;
+	uint32_t roomVertexFormat;
+	uint32_t meshVertexFormat;
+	GPUResource roomVertexBuffer;
+	GPUResource meshVertexBuffer;
+	GPUResource indexBuffer;
+
+	bool CreateGeometryBuffers();
+
+	//the descriptor the renderer binds for a world texture index, the fallback texture's if it has not been created
+	uint32_t GetTextureDescriptor(uint32_t index) const
+	{
+		return index < textures.Count() && textures[index].resource ? textures[index].descriptor : renderer.GetFallbackTexture().descriptor;
+	}
+	bool UploadGeometry(const GeometryLayout::Range &range, GPUResource vertexBuffer, const void *verts, const uint32_t *indices, const LodSet *lods = nullptr);
 
 	//device-specific buffers
 	Array<RoomMesh> roomMeshes;
 	Array<ObjectMesh> meshes;
-	Array<GPUResource> textures;
-	Array<ObjectMesh> actorMeshes;
+	Array<sbTexture> textures; //indexed like the world's textures, only those something draws with are created
+	TextureResidencyStats textureStats;
 
-public:
-	//TODO: put this in the Lightmapping pipeline
-	void UseDiffuseAndLightmap(uint32_t texindexDiffuse, uint32_t texindexLightmap);
-	void UseFullbrightDiffuse(uint32_t texindexDiffuse);
-	void UseFallbackDiffuseAndLightmap();
+	//flags the textures the rooms', objects' and actors' parts are drawn with, and the rooms' lightmaps
+	void FindReachableTextures(const GameWorld &world, Array<bool> &isReachable) const;
+	Array<ActorMesh> actorMeshes; //every mesh of the actors' current models, one actor after the other
+	Array<uint32_t> firstActorMeshes; //one per actor and one past the last, the meshes of an actor going up to those of the next one
+
+	//world-space bounds of the rooms and of the objects, culled every frame
+	BoxCuller roomCuller;
+	BoxCuller objectCuller;
+	Array<CulledObject> culledObjects; //ordered like the objects' boxes
+	Array<uint32_t> visibleRoomIndices;
+	Array<uint32_t> visibleObjectIndices;
+	Array<bool> isRoomVisible;
+
+	bool CreateCullers(const GameWorld &world);
+
+	//the nearest rooms hide what is behind them
+	OcclusionCuller occlusionCuller;
+
+	uint32_t FindVisibleRooms(const Document &document, const Frustum &frustum);
+	void StartOcclusionCulling(const GameWorld &world, const Matrix &viewProjection, const Vector &cameraPosition, uint32_t numVisibleRooms);
 
-	void SetWorldViewProjectionMatrix(const Matrix &m);
+	//the rooms and the objects queue their draws, which are sorted by state before reaching the renderer
+	DrawQueue drawQueue;
 
-	//TODO: put this in the Phong pipeline
-	void UsePhongFallbackDiffuse();
-	void UsePhongDiffuse(uint32_t texindexDiffuse);
+	//the objects sharing a mesh are drawn together, their matrices following each other in the queue
+	InstanceBatcher instanceBatcher;
+	uint32_t firstInstanceMatrix;
 
+	//the rooms and the objects are recorded on several threads, each into its own queue and batcher, then merged into the frame's
+	DrawRecorder drawRecorder;
+
+	void QueueObjectInstances();
+
+public:
 	WorldRenderer(sbRenderer &renderer):
 		renderer(renderer),
-		fallbackTexture()
+		psgInstancedPipeline(true),
+		isInstancingSupported(false),
+		isWorldLoaded(false),
+		roomVertexFormat(GeometryLayout::INVALID_FORMAT),
+		meshVertexFormat(GeometryLayout::INVALID_FORMAT),
+		roomVertexBuffer(),
+		meshVertexBuffer(),
+		indexBuffer(),
+		firstInstanceMatrix(0)
 	{}
 
 	bool Create();
@@ -225,4 +316,28 @@ public:
 	void UnloadWorld();
 
 	void Render(const Document &document, const Matrix &viewProjection);
+
+	//how many rooms, parts and objects the occlusion culling hid during the last frame
+	const OcclusionCuller::Stats &GetOcclusionStats() const
+	{
+		return occlusionCuller.GetStats();
+	}
+
+	//how many draws were queued during the last frame, and how many states they needed
+	const DrawQueue::Stats &GetDrawStats() const
+	{
+		return drawQueue.GetStats();
+	}
+
+	//how many object parts were drawn during the last frame, and in how many draws
+	const InstanceBatcher::Stats &GetInstanceStats() const
+	{
+		return instanceBatcher.GetStats();
+	}
+
+	//how many textures the loaded world uploaded, and how many were skipped since nothing refers to them
+	const TextureResidencyStats &GetTextureStats() const
+	{
+		return textureStats;
+	}
 };
@@ -0,0 +1,38 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "lod.hh"
+#include <memory.h>
+
+void InitSingleLod(
+	LodSet &lods,
+	MemoryPool &pool,
+	uint32_t numIndices,
+	const uint32_t *partNumIndices, uint32_t numParts
+)
+{
+	lods.numLevels = 1;
+	lods.numParts = numParts;
+	lods.levelStartIndex[0] = 0;
+	lods.levelNumIndices[0] = numIndices;
+	lods.indices = Array<uint32_t>();
+
+	lods.partNumIndices = Array<uint32_t>(pool.Allocate<uint32_t>(numParts), numParts);
+	for (uint32_t p = 0; p < numParts; p++)
+		lods.partNumIndices[p] = partNumIndices[p];
+}
+
+void MoveLodSet(LodSet &lods, MemoryPool &pool)
+{
+	uint32_t numIndices = lods.indices.Count();
+	uint32_t *indices = pool.Allocate<uint32_t>(numIndices);
+	memcpy(indices, lods.indices.Data(), numIndices * sizeof(uint32_t));
+	lods.indices = Array<uint32_t>(indices, numIndices);
+
+	uint32_t numPartNumIndices = lods.partNumIndices.Count();
+	uint32_t *partNumIndices = pool.Allocate<uint32_t>(numPartNumIndices);
+	memcpy(partNumIndices, lods.partNumIndices.Data(), numPartNumIndices * sizeof(uint32_t));
+	lods.partNumIndices = Array<uint32_t>(partNumIndices, numPartNumIndices);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include <math.h>
+#include <stdint.h>
+
+//the full-detail level included
+static constexpr uint32_t MAX_LOD_LEVELS = 4;
+
+/// <summary>
+/// Levels of detail of a mesh made of parts (material batches).
+/// Level 0 is the mesh's own index buffer; the reduced levels are stored in @indices, level after level,
+/// and are meant to be placed right after the full-detail indices so that every level shares the same vertices.
+/// Every level keeps the same parts, some of them possibly empty.
+/// </summary>
+struct LodSet
+{
+	uint32_t numLevels;
+	uint32_t numParts;
+
+	//ranges of each level, relative to the mesh's first index
+	uint32_t levelStartIndex[MAX_LOD_LEVELS];
+	uint32_t levelNumIndices[MAX_LOD_LEVELS];
+
+	Array<uint32_t> indices; //indices of the reduced levels (1 and up)
+	Array<uint32_t> partNumIndices; //numParts counts per level, level after level
+
+	LodSet() :
+		numLevels(0),
+		numParts(0),
+		levelStartIndex(),
+		levelNumIndices()
+	{}
+
+	//total number of indices, every level included
+	uint32_t GetNumIndices() const
+	{
+		return numLevels ? levelStartIndex[numLevels - 1] + levelNumIndices[numLevels - 1] : 0;
+	}
+
+	uint32_t GetPartNumIndices(uint32_t level, uint32_t part) const
+	{
+		return partNumIndices[level * numParts + part];
+	}
+};
+
+//moves the arrays of @lods into @pool, so that the pool they were built in can be freed
+void MoveLodSet(LodSet &lods, MemoryPool &pool);
+
+//makes @lods describe only the full-detail level
+void InitSingleLod(
+	LodSet &lods,
+	MemoryPool &pool,
+	uint32_t numIndices,
+	const uint32_t *partNumIndices, uint32_t numParts
+);
+
+//picks a level from the distance to the viewer:
+//the first reduced level is used from @firstDistance on, and every following one from twice the distance of the previous one
+inline uint32_t SelectLodByDistance(const LodSet &lods, float distance, float firstDistance)
+{
+	uint32_t level = 0;
+	while (level + 1 < lods.numLevels && distance >= firstDistance)
+	{
+		level++;
+		firstDistance *= 2.0f;
+	}
+	return level;
+}
+
+/// <summary>
+/// Picks a level from the size, in pixels, the mesh takes on screen.
+/// At nearSize pixels or more the full detail is drawn, at farSize or less the coarsest level.
+/// In between, the removed detail grows as ((nearSize - size) / (nearSize - farSize)) ^ power,
+/// so a higher power keeps the full detail for longer.
+/// </summary>
+inline uint32_t SelectLodByScreenSize(const LodSet &lods, float screenSize, float nearSize, float farSize, float power)
+{
+	if (lods.numLevels <= 1 || nearSize <= farSize)
+		return 0;
+
+	float t = (nearSize - screenSize) / (nearSize - farSize);
+	t = fmaxf(0.0f, fminf(1.0f, t));
+	float reduction = powf(t, power);
+
+	return (uint32_t)(reduction * (float)(lods.numLevels - 1) + 0.5f);
+}
@@ -0,0 +1,203 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "meshlets.hh"
+#include <math.h>
+
+static inline Vector GetPosition(const float *positions, uint32_t vertexStride, uint32_t index)
+{
+	const float *p = (const float *)((const uint8_t *)positions + (size_t)index * vertexStride);
+	return Vector(p[0], p[1], p[2]);
+}
+
+static inline uint32_t FindLocalIndex(const uint32_t *meshletVertices, uint32_t numVertices, uint32_t index)
+{
+	for (uint32_t i = 0; i < numVertices; i++)
+	{
+		if (meshletVertices[i] == index)
+			return i;
+	}
+	return MAX_MESHLET_VERTICES;
+}
+
+//walks the index buffer and greedily groups consecutive triangles into meshlets
+//if @set is null, only counts the meshlets and their vertices so we know how much to allocate
+static void SplitIntoMeshlets(
+	MeshletSet *set, uint32_t &numMeshlets, uint32_t &numMeshletVertices,
+	const uint32_t *indices, uint32_t numIndices, const uint32_t *partNumIndices, uint32_t numParts
+)
+{
+	numMeshlets = 0;
+	numMeshletVertices = 0;
+
+	uint32_t meshletVertices[MAX_MESHLET_VERTICES];
+	uint32_t numVertices = 0;
+	uint32_t numTriangles = 0;
+	uint32_t meshletStartIndex = 0;
+
+	auto closeMeshlet = [&](uint32_t partIndex)
+	{
+		if (numTriangles == 0)
+			return;
+
+		if (set)
+		{
+			Meshlet &meshlet = set->meshlets[numMeshlets];
+			meshlet.startIndex = meshletStartIndex;
+			meshlet.numTriangles = numTriangles;
+			meshlet.vertexOffset = numMeshletVertices;
+			meshlet.triangleOffset = meshletStartIndex / 3; //triangles follow the index buffer order
+			meshlet.numVertices = numVertices;
+			meshlet.partIndex = partIndex;
+			for (uint32_t i = 0; i < numVertices; i++)
+				set->vertices[numMeshletVertices + i] = meshletVertices[i];
+		}
+
+		numMeshlets++;
+		numMeshletVertices += numVertices;
+		numVertices = 0;
+		numTriangles = 0;
+	};
+
+	uint32_t startIndex = 0;
+	for (uint32_t p = 0; p < numParts; p++)
+	{
+		uint32_t endIndex = startIndex + partNumIndices[p];
+		if (endIndex > numIndices)
+			endIndex = numIndices; //never trust the part sizes to match the index buffer
+
+		meshletStartIndex = startIndex;
+		for (uint32_t i = startIndex; i + 3 <= endIndex; i += 3)
+		{
+			const uint32_t *triangle = &indices[i];
+
+			//how many vertices would this triangle add to the current meshlet?
+			uint32_t numNewVertices = 0;
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				bool alreadySeen = FindLocalIndex(meshletVertices, numVertices, triangle[k]) != MAX_MESHLET_VERTICES;
+				for (uint32_t j = 0; j < k; j++)
+					alreadySeen |= triangle[j] == triangle[k];
+				if (!alreadySeen)
+					numNewVertices++;
+			}
+
+			//start a new meshlet if this one is full
+			if (numVertices + numNewVertices > MAX_MESHLET_VERTICES || numTriangles == MAX_MESHLET_TRIANGLES)
+			{
+				closeMeshlet(p);
+				meshletStartIndex = i;
+			}
+
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				uint32_t localIndex = FindLocalIndex(meshletVertices, numVertices, triangle[k]);
+				if (localIndex == MAX_MESHLET_VERTICES)
+				{
+					localIndex = numVertices;
+					meshletVertices[numVertices++] = triangle[k];
+				}
+
+				if (set)
+					set->triangles[i + k] = (uint8_t)localIndex;
+			}
+			numTriangles++;
+		}
+
+		closeMeshlet(p);
+		startIndex = endIndex;
+	}
+}
+
+static void ComputeMeshletBounds(Meshlet &meshlet, const MeshletSet &set, const float *positions, uint32_t vertexStride)
+{
+	const uint32_t *vertices = &set.vertices[meshlet.vertexOffset];
+
+	//axis-aligned box
+	meshlet.min = GetPosition(positions, vertexStride, vertices[0]);
+	meshlet.max = meshlet.min;
+	for (uint32_t i = 1; i < meshlet.numVertices; i++)
+	{
+		Vector p = GetPosition(positions, vertexStride, vertices[i]);
+		meshlet.min = Vector(fminf(meshlet.min.x, p.x), fminf(meshlet.min.y, p.y), fminf(meshlet.min.z, p.z));
+		meshlet.max = Vector(fmaxf(meshlet.max.x, p.x), fmaxf(meshlet.max.y, p.y), fmaxf(meshlet.max.z, p.z));
+	}
+
+	//sphere around the box center, enclosing every vertex
+	meshlet.center = (meshlet.min + meshlet.max) * 0.5f;
+	float radiusSquared = 0.0f;
+	for (uint32_t i = 0; i < meshlet.numVertices; i++)
+	{
+		Vector p = GetPosition(positions, vertexStride, vertices[i]);
+		radiusSquared = fmaxf(radiusSquared, (p - meshlet.center).LengthSquared());
+	}
+	meshlet.radius = sqrtf(radiusSquared);
+
+	//normal cone
+	//NOTE: ConvertHandedness mirrors the geometry, so a front face's (b - a) x (c - a) points away from the viewer;
+	//we flip it here so that the cone axis points towards the side the triangles can be seen from
+	const uint8_t *triangles = &set.triangles[meshlet.triangleOffset * 3];
+	Vector normals[MAX_MESHLET_TRIANGLES];
+	uint32_t numNormals = 0;
+	Vector axis;
+	for (uint32_t i = 0; i < meshlet.numTriangles; i++)
+	{
+		Vector a = GetPosition(positions, vertexStride, vertices[triangles[i * 3 + 0]]);
+		Vector b = GetPosition(positions, vertexStride, vertices[triangles[i * 3 + 1]]);
+		Vector c = GetPosition(positions, vertexStride, vertices[triangles[i * 3 + 2]]);
+		Vector n = (c - a).Cross(b - a);
+		float length = n.Length();
+		if (length <= 0.0f)
+			continue; //degenerate triangle, it can not be seen anyway
+
+		n *= 1.0f / length;
+		normals[numNormals++] = n;
+		axis += n;
+	}
+
+	meshlet.coneAxis = Vector();
+	meshlet.coneCutoff = 1.0f;
+	float axisLength = axis.Length();
+	if (numNormals == 0 || axisLength <= 0.0f)
+		return;
+
+	axis *= 1.0f / axisLength;
+	float minDot = 1.0f;
+	for (uint32_t i = 0; i < numNormals; i++)
+		minDot = fminf(minDot, axis.Dot(normals[i]));
+
+	//if the normals spread over more than a hemisphere, there is always a side from which a triangle is visible
+	if (minDot <= 0.0f)
+		return;
+
+	meshlet.coneAxis = axis;
+	meshlet.coneCutoff = sqrtf(1.0f - minDot * minDot); //sine of the cone half-angle
+}
+
+void BuildMeshlets(
+	MeshletSet &set,
+	MemoryPool &pool,
+	const float *positions, uint32_t vertexStride, uint32_t numVerts,
+	const uint32_t *indices, uint32_t numIndices,
+	const uint32_t *partNumIndices, uint32_t numParts
+)
+{
+	if (numVerts == 0 || numIndices == 0)
+		return;
+
+	//first pass: count
+	uint32_t numMeshlets, numMeshletVertices;
+	SplitIntoMeshlets(nullptr, numMeshlets, numMeshletVertices, indices, numIndices, partNumIndices, numParts);
+
+	//second pass: fill
+	//NOTE: CreateArray has a sanity check on the element count, and these are plain data, so just allocate
+	set.meshlets = Array<Meshlet>(pool.Allocate<Meshlet>(numMeshlets, 16), numMeshlets);
+	set.vertices = Array<uint32_t>(pool.Allocate<uint32_t>(numMeshletVertices), numMeshletVertices);
+	set.triangles = Array<uint8_t>(pool.Allocate<uint8_t>(numIndices), numIndices);
+	SplitIntoMeshlets(&set, numMeshlets, numMeshletVertices, indices, numIndices, partNumIndices, numParts);
+
+	for (auto &meshlet : set.meshlets)
+		ComputeMeshletBounds(meshlet, set, positions, vertexStride);
+}
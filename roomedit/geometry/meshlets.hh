@@ -0,0 +1,66 @@
+#pragma once
+#include "common/vector.inl"
+#include "sbmemory/MemoryPool.hh"
+#include <stdint.h>
+
+//fixed meshlet limits, these are the sizes recommended for mesh shaders
+static constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+static constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+
+//a small cluster of triangles, taken from a contiguous range of a mesh's index buffer
+struct Meshlet
+{
+	//range of the mesh's index buffer covered by this meshlet, so it can be drawn directly
+	uint32_t startIndex;
+	uint32_t numTriangles;
+
+	//ranges in the MeshletSet vertex and triangle buffers (the mesh shader layout)
+	uint32_t vertexOffset;
+	uint32_t triangleOffset;
+	uint32_t numVertices;
+
+	//index of the part (material batch) this meshlet belongs to
+	uint32_t partIndex;
+
+	//bounds, in mesh space
+	Vector min;
+	Vector max;
+	Vector center;
+	float radius;
+
+	//normal cone, used for backface culling
+	//a cutoff of 1.0 means the triangles face too many directions to ever be culled
+	Vector coneAxis;
+	float coneCutoff;
+};
+
+struct MeshletSet
+{
+	Array<Meshlet> meshlets;
+	Array<uint32_t> vertices; //meshlet-local vertex to mesh vertex
+	Array<uint8_t> triangles; //3 meshlet-local vertex indices per triangle
+};
+
+/// <summary>
+/// Splits an indexed triangle list into meshlets, without reordering the triangles.
+/// The index buffer is made of consecutive parts, each of them holding partNumIndices[i] indices.
+/// A meshlet never spans two parts.
+/// </summary>
+/// <param name="positions">points to the first vertex position (3 floats), vertices being vertexStride bytes apart</param>
+void BuildMeshlets(
+	MeshletSet &set,
+	MemoryPool &pool,
+	const float *positions, uint32_t vertexStride, uint32_t numVerts,
+	const uint32_t *indices, uint32_t numIndices,
+	const uint32_t *partNumIndices, uint32_t numParts
+);
+
+//returns true if every triangle of the meshlet faces away from the given position (in mesh space)
+inline bool IsMeshletBackfacing(const Meshlet &meshlet, const Vector &viewPosition)
+{
+	if (meshlet.coneCutoff >= 1.0f)
+		return false;
+
+	Vector toCenter = meshlet.center - viewPosition;
+	return toCenter.Dot(meshlet.coneAxis) >= meshlet.coneCutoff * toCenter.Length() + meshlet.radius;
+}
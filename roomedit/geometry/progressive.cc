@@ -0,0 +1,187 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "progressive.hh"
+
+static constexpr uint32_t NO_CORNER = 0xFFFFFFFF;
+
+//follows the collapse map until the position is one of the first @numKept ones
+static inline uint32_t CollapsePosition(const uint16_t *remap, uint32_t numRemap, uint32_t position, uint32_t numKept)
+{
+	//a position that maps onto itself or forward can not collapse any further
+	while (position >= numKept && position < numRemap && remap[position] < position)
+		position = remap[position];
+	return position;
+}
+
+//keeps the triangles that survive when only @numKept positions remain
+//if @out is null, only counts the indices so we know how much to allocate
+static uint32_t ReduceLevel(
+	uint32_t *out, uint32_t *levelPartNumIndices,
+	const Mesh &mesh, const uint32_t *firstCornerOfPosition, uint32_t numKept,
+	const uint32_t *indices, uint32_t numIndices,
+	const uint32_t *partNumIndices, uint32_t numParts,
+	const uint16_t *remap, uint32_t numRemap, uint32_t firstPosition
+)
+{
+	uint32_t numOut = 0;
+	uint32_t startIndex = 0;
+	for (uint32_t p = 0; p < numParts; p++)
+	{
+		uint32_t endIndex = startIndex + partNumIndices[p];
+		if (endIndex > numIndices)
+			endIndex = numIndices; //never trust the part sizes to match the index buffer
+
+		uint32_t partStart = numOut;
+		for (uint32_t i = startIndex; i + 3 <= endIndex; i += 3)
+		{
+			uint32_t corners[3];
+			uint32_t positions[3];
+			bool valid = true;
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				uint32_t corner = indices[i + k];
+				uint32_t position = mesh.corners[corner].index;
+				positions[k] = CollapsePosition(remap, numRemap, firstPosition + position, numKept) - firstPosition;
+
+				//a collapsed corner takes the attributes of a corner already sitting on the target position,
+				//one that collapsed into another mesh (before the first position, so wrapped around) has none
+				if (positions[k] == position)
+					corners[k] = corner;
+				else
+					corners[k] = positions[k] < mesh.numVerts ? firstCornerOfPosition[positions[k]] : NO_CORNER;
+				valid &= corners[k] != NO_CORNER;
+			}
+
+			//the triangle has collapsed into a line or a point
+			if (!valid || positions[0] == positions[1] || positions[1] == positions[2] || positions[2] == positions[0])
+				continue;
+
+			if (out)
+			{
+				out[numOut + 0] = corners[0];
+				out[numOut + 1] = corners[1];
+				out[numOut + 2] = corners[2];
+			}
+			numOut += 3;
+		}
+
+		if (levelPartNumIndices)
+			levelPartNumIndices[p] = numOut - partStart;
+		startIndex = endIndex;
+	}
+
+	return numOut;
+}
+
+//returns the entry of the table closest to @target
+static uint32_t FindClosestCount(const uint16_t *counts, uint32_t numCounts, uint32_t target)
+{
+	uint32_t best = counts[0];
+	for (uint32_t i = 1; i < numCounts; i++)
+	{
+		uint32_t distance = counts[i] > target ? counts[i] - target : target - counts[i];
+		uint32_t bestDistance = best > target ? best - target : target - best;
+		if (distance < bestDistance)
+			best = counts[i];
+	}
+	return best;
+}
+
+void BuildProgressiveLods(
+	LodSet &lods,
+	MemoryPool &pool,
+	const Mesh &mesh,
+	const uint32_t *indices, uint32_t numIndices,
+	const uint32_t *partNumIndices, uint32_t numParts,
+	const uint16_t *remap, uint32_t numRemap, uint32_t firstPosition,
+	const uint16_t *levelNumPositions, uint32_t numLevelNumPositions
+)
+{
+	InitSingleLod(lods, pool, numIndices, partNumIndices, numParts);
+
+	//the map does not reach the mesh's positions, none of them collapse
+	uint32_t numPositions = mesh.numVerts;
+	if (!remap || numRemap <= firstPosition || numPositions == 0 || numIndices == 0)
+		return;
+
+	//every reduced level roughly halves the model's positions, using the authored position counts if there are any
+	uint32_t numModelPositions = numRemap > firstPosition + numPositions ? numRemap : firstPosition + numPositions;
+	uint32_t numKept[MAX_LOD_LEVELS];
+	uint32_t levelSizes[MAX_LOD_LEVELS];
+	uint32_t numLevels = 1;
+	levelSizes[0] = numIndices;
+	for (uint32_t l = 1; l < MAX_LOD_LEVELS; l++)
+	{
+		uint32_t target = numModelPositions >> l;
+		uint32_t count = numLevelNumPositions ? FindClosestCount(levelNumPositions, numLevelNumPositions, target) : target;
+		if (count < 3)
+			break;
+
+		numKept[numLevels] = count;
+		numLevels++;
+	}
+
+	//a position can only be replaced by a corner that sits on it
+	uint32_t *firstCornerOfPosition = pool.Allocate<uint32_t>(numPositions);
+	for (uint32_t v = 0; v < numPositions; v++)
+		firstCornerOfPosition[v] = NO_CORNER;
+	for (uint32_t c = 0; c < mesh.corners.Count(); c++)
+	{
+		uint32_t position = mesh.corners[c].index;
+		if (position < numPositions && firstCornerOfPosition[position] == NO_CORNER)
+			firstCornerOfPosition[position] = c;
+	}
+
+	//first pass: count, and only keep the levels that are noticeably lighter than the previous one
+	uint32_t numKeptLevels = 1;
+	for (uint32_t l = 1; l < numLevels; l++)
+	{
+		uint32_t size = ReduceLevel(
+			nullptr, nullptr,
+			mesh, firstCornerOfPosition, numKept[l],
+			indices, numIndices, partNumIndices, numParts,
+			remap, numRemap, firstPosition
+		);
+		if (size == 0 || size * 10 > levelSizes[numKeptLevels - 1] * 9)
+			continue;
+
+		numKept[numKeptLevels] = numKept[l];
+		levelSizes[numKeptLevels] = size;
+		numKeptLevels++;
+	}
+
+	if (numKeptLevels == 1)
+		return;
+
+	//second pass: fill
+	uint32_t numReducedIndices = 0;
+	for (uint32_t l = 1; l < numKeptLevels; l++)
+		numReducedIndices += levelSizes[l];
+
+	uint32_t *levelPartNumIndices = pool.Allocate<uint32_t>(numKeptLevels * numParts);
+	for (uint32_t p = 0; p < numParts; p++)
+		levelPartNumIndices[p] = partNumIndices[p];
+
+	uint32_t *reducedIndices = pool.Allocate<uint32_t>(numReducedIndices);
+	uint32_t offset = 0;
+	for (uint32_t l = 1; l < numKeptLevels; l++)
+	{
+		ReduceLevel(
+			reducedIndices + offset, levelPartNumIndices + l * numParts,
+			mesh, firstCornerOfPosition, numKept[l],
+			indices, numIndices, partNumIndices, numParts,
+			remap, numRemap, firstPosition
+		);
+
+		lods.levelStartIndex[l] = numIndices + offset;
+		lods.levelNumIndices[l] = levelSizes[l];
+		offset += levelSizes[l];
+	}
+
+	lods.numLevels = numKeptLevels;
+	lods.indices = Array<uint32_t>(reducedIndices, numReducedIndices);
+	lods.partNumIndices = Array<uint32_t>(levelPartNumIndices, numKeptLevels * numParts);
+}
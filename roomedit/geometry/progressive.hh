@@ -0,0 +1,24 @@
+#pragma once
+#include "lod.hh"
+#include "../world/Mesh.hh"
+
+/// <summary>
+/// Builds levels of detail out of a progressive-reduction collapse map (Actor::Model::PRRemap).
+/// The map works on the positions of the whole model, the meshes' positions following each other:
+/// remap[v] is the position v collapses into, which always comes before v,
+/// so keeping n positions means that every position v >= n follows the map until it lands below n.
+/// Triangles that lose an edge in the process, or whose corner collapses into another mesh, are dropped,
+/// the others are kept in their original order.
+/// </summary>
+/// <param name="indices">the full-detail index buffer, indexing the mesh's corners, made of numParts consecutive parts</param>
+/// <param name="firstPosition">where the mesh's positions start among the model's</param>
+/// <param name="levelNumPositions">how many of the model's positions each reduced level keeps, most detailed first; if there are none, the levels halve the positions</param>
+void BuildProgressiveLods(
+	LodSet &lods,
+	MemoryPool &pool,
+	const Mesh &mesh,
+	const uint32_t *indices, uint32_t numIndices,
+	const uint32_t *partNumIndices, uint32_t numParts,
+	const uint16_t *remap, uint32_t numRemap, uint32_t firstPosition,
+	const uint16_t *levelNumPositions, uint32_t numLevelNumPositions
+);
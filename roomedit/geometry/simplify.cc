@@ -0,0 +1,466 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "simplify.hh"
+#include "common/vector.inl"
+#include <float.h>
+#include <memory.h>
+#include <algorithm> //std::sort
+
+//the error budget of the first reduced level, as a fraction of the mesh's size
+//every following level doubles it, like the distance it is drawn from
+static constexpr float FIRST_LEVEL_MAX_ERROR = 0.02f;
+
+static constexpr uint32_t NONE = 0xFFFFFFFF;
+static constexpr uint32_t MANY = 0xFFFFFFFE;
+
+static constexpr uint8_t FLAG_LOCKED = 1;	//this corner never moves
+static constexpr uint8_t FLAG_TOUCHED = 2;	//this corner's neighbourhood changed during the current pass
+
+//symmetric 4x4 matrix measuring the sum of squared distances to a set of planes, weighted by the planes' areas
+struct Quadric
+{
+	double a00, a01, a02, a11, a12, a22;
+	double b0, b1, b2;
+	double c;
+	double weight;
+
+	void AddPlane(const Vector &n, float d, float w)
+	{
+		a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+		a11 += w * n.y * n.y; a12 += w * n.y * n.z;
+		a22 += w * n.z * n.z;
+		b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+		c += w * d * d;
+		weight += w;
+	}
+
+	void Add(const Quadric &q)
+	{
+		a00 += q.a00; a01 += q.a01; a02 += q.a02;
+		a11 += q.a11; a12 += q.a12;
+		a22 += q.a22;
+		b0 += q.b0; b1 += q.b1; b2 += q.b2;
+		c += q.c;
+		weight += q.weight;
+	}
+
+	//average squared distance from @p to the planes
+	float Evaluate(const Vector &p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		double e =
+			a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z +
+			a11 * y * y + 2.0 * a12 * y * z +
+			a22 * z * z +
+			2.0 * (b0 * x + b1 * y + b2 * z) + c;
+		return weight > 0.0 ? (float)(fabs(e) / weight) : 0.0f;
+	}
+};
+
+struct Simplifier
+{
+	const Mesh &mesh;
+	uint32_t numVerts;
+
+	//the current triangles, and the part each of them belongs to
+	uint32_t *indices;
+	uint32_t numIndices;
+	uint32_t *triangleParts;
+
+	Quadric *quadrics;
+	uint32_t *remap;
+	uint8_t *flags;
+
+	//triangles around every corner
+	uint32_t *adjacencyOffsets;
+	uint32_t *adjacency;
+
+	//best collapse of every corner
+	uint32_t *bestTargets;
+	float *bestCosts;
+	uint32_t *candidates;
+
+	Simplifier(const Mesh &mesh) :
+		mesh(mesh)
+	{}
+
+	Vector GetPosition(uint32_t corner) const
+	{
+		const Vector3 &p = mesh.positions[mesh.corners[corner].index];
+		return Vector(p.x, p.y, p.z);
+	}
+
+	bool Contains(uint32_t triangle, uint32_t corner) const
+	{
+		const uint32_t *t = &indices[triangle * 3];
+		return t[0] == corner || t[1] == corner || t[2] == corner;
+	}
+};
+
+static uint32_t ComputeScratchSize(uint32_t numVerts, uint32_t numPositions, uint32_t numIndices, uint32_t numParts)
+{
+	uint32_t numTriangles = numIndices / 3;
+	uint32_t size = 0;
+	size += numIndices * sizeof(uint32_t);					//indices
+	size += numTriangles * sizeof(uint32_t);				//triangleParts
+	size += numVerts * sizeof(Quadric);						//quadrics
+	size += numVerts * sizeof(uint32_t);					//remap
+	size += numVerts * sizeof(uint8_t);						//flags
+	size += (numVerts + 1) * sizeof(uint32_t);				//adjacencyOffsets
+	size += numIndices * sizeof(uint32_t);					//adjacency
+	size += numVerts * sizeof(uint32_t);					//bestTargets
+	size += numVerts * sizeof(float);						//bestCosts
+	size += numVerts * sizeof(uint32_t);					//candidates
+	size += numVerts * sizeof(uint32_t);					//corner parts
+	size += numPositions * sizeof(uint32_t);				//corners per position
+	size += (MAX_LOD_LEVELS - 1) * numIndices * sizeof(uint32_t); //levels
+	size += (MAX_LOD_LEVELS - 1) * numParts * sizeof(uint32_t); //levels' parts
+	size += 16 * 16;										//alignment
+	return size;
+}
+
+uint32_t GetSimplifiedLodsMaxSize(uint32_t numIndices, uint32_t numParts)
+{
+	return
+		numParts * sizeof(uint32_t) +							//full-detail parts
+		MAX_LOD_LEVELS * numParts * sizeof(uint32_t) +			//parts of every level
+		(MAX_LOD_LEVELS - 1) * numIndices * sizeof(uint32_t) +	//reduced levels
+		3 * 4;													//alignment
+}
+
+static void BuildAdjacency(Simplifier &s)
+{
+	memset(s.adjacencyOffsets, 0, (s.numVerts + 1) * sizeof(uint32_t));
+	for (uint32_t i = 0; i < s.numIndices; i++)
+		s.adjacencyOffsets[s.indices[i] + 1]++;
+	for (uint32_t v = 0; v < s.numVerts; v++)
+		s.adjacencyOffsets[v + 1] += s.adjacencyOffsets[v];
+
+	//the best targets are not in use yet, so they serve as write cursors
+	uint32_t *cursors = s.bestTargets;
+	memcpy(cursors, s.adjacencyOffsets, s.numVerts * sizeof(uint32_t));
+	for (uint32_t i = 0; i < s.numIndices; i++)
+		s.adjacency[cursors[s.indices[i]]++] = i / 3;
+}
+
+//locks the corners on UV seams, on part boundaries and on open borders
+static void LockCorners(Simplifier &s, uint32_t *cornerParts, uint32_t *cornersPerPosition, uint32_t numPositions)
+{
+	//UV seams: the position is shared with another corner
+	memset(cornersPerPosition, 0, numPositions * sizeof(uint32_t));
+	for (uint32_t c = 0; c < s.numVerts; c++)
+		cornersPerPosition[s.mesh.corners[c].index]++;
+	for (uint32_t c = 0; c < s.numVerts; c++)
+	{
+		if (cornersPerPosition[s.mesh.corners[c].index] > 1)
+			s.flags[c] |= FLAG_LOCKED;
+	}
+
+	//part boundaries: the corner is used by several parts
+	for (uint32_t c = 0; c < s.numVerts; c++)
+		cornerParts[c] = NONE;
+	for (uint32_t i = 0; i < s.numIndices; i++)
+	{
+		uint32_t c = s.indices[i];
+		uint32_t part = s.triangleParts[i / 3];
+		if (cornerParts[c] == NONE)
+			cornerParts[c] = part;
+		else if (cornerParts[c] != part)
+			cornerParts[c] = MANY;
+	}
+	for (uint32_t c = 0; c < s.numVerts; c++)
+	{
+		if (cornerParts[c] == MANY)
+			s.flags[c] |= FLAG_LOCKED;
+	}
+
+	//open borders: an edge that is not walked the other way by a neighbouring triangle
+	for (uint32_t a = 0; a < s.numVerts; a++)
+	{
+		for (uint32_t i = s.adjacencyOffsets[a]; i < s.adjacencyOffsets[a + 1]; i++)
+		{
+			const uint32_t *t = &s.indices[s.adjacency[i] * 3];
+			uint32_t k = t[0] == a ? 0 : t[1] == a ? 1 : 2;
+			uint32_t b = t[(k + 1) % 3];
+
+			bool hasTwin = false;
+			for (uint32_t j = s.adjacencyOffsets[b]; j < s.adjacencyOffsets[b + 1] && !hasTwin; j++)
+			{
+				const uint32_t *u = &s.indices[s.adjacency[j] * 3];
+				for (uint32_t l = 0; l < 3; l++)
+					hasTwin |= u[l] == b && u[(l + 1) % 3] == a;
+			}
+
+			if (!hasTwin)
+			{
+				s.flags[a] |= FLAG_LOCKED;
+				s.flags[b] |= FLAG_LOCKED;
+			}
+		}
+	}
+}
+
+static void ComputeQuadrics(Simplifier &s)
+{
+	memset(s.quadrics, 0, s.numVerts * sizeof(Quadric));
+	for (uint32_t i = 0; i + 3 <= s.numIndices; i += 3)
+	{
+		Vector a = s.GetPosition(s.indices[i + 0]);
+		Vector b = s.GetPosition(s.indices[i + 1]);
+		Vector c = s.GetPosition(s.indices[i + 2]);
+		Vector n = (b - a).Cross(c - a);
+		float length = n.Length();
+		if (length <= 0.0f)
+			continue;
+
+		n *= 1.0f / length;
+		float d = -n.Dot(a);
+		float area = length * 0.5f;
+		for (uint32_t k = 0; k < 3; k++)
+			s.quadrics[s.indices[i + k]].AddPlane(n, d, area);
+	}
+}
+
+//returns true if moving @a onto @b would turn a triangle around (or squash it)
+static bool CollapseFlipsTriangle(const Simplifier &s, uint32_t a, uint32_t b)
+{
+	Vector target = s.GetPosition(b);
+	for (uint32_t i = s.adjacencyOffsets[a]; i < s.adjacencyOffsets[a + 1]; i++)
+	{
+		uint32_t triangle = s.adjacency[i];
+		if (s.Contains(triangle, b))
+			continue; //this one disappears
+
+		const uint32_t *t = &s.indices[triangle * 3];
+		Vector p[3] = { s.GetPosition(t[0]), s.GetPosition(t[1]), s.GetPosition(t[2]) };
+		Vector before = (p[1] - p[0]).Cross(p[2] - p[0]);
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			if (t[k] == a)
+				p[k] = target;
+		}
+		Vector after = (p[1] - p[0]).Cross(p[2] - p[0]);
+
+		if (before.Dot(after) <= 0.25f * before.Length() * after.Length())
+			return true;
+	}
+	return false;
+}
+
+//collapses the cheapest edges until reaching @targetNumIndices, or until no edge is cheaper than @maxError
+static void Simplify(Simplifier &s, uint32_t targetNumIndices, float maxError)
+{
+	while (s.numIndices > targetNumIndices)
+	{
+		BuildAdjacency(s);
+
+		//find the cheapest collapse of every free corner
+		uint32_t numCandidates = 0;
+		for (uint32_t a = 0; a < s.numVerts; a++)
+		{
+			s.flags[a] &= ~FLAG_TOUCHED;
+			if (s.flags[a] & FLAG_LOCKED)
+				continue;
+
+			s.bestTargets[a] = NONE;
+			s.bestCosts[a] = FLT_MAX;
+			for (uint32_t i = s.adjacencyOffsets[a]; i < s.adjacencyOffsets[a + 1]; i++)
+			{
+				const uint32_t *t = &s.indices[s.adjacency[i] * 3];
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					uint32_t b = t[k];
+					if (b == a)
+						continue;
+
+					float cost = s.quadrics[a].Evaluate(s.GetPosition(b));
+					if (cost < s.bestCosts[a])
+					{
+						s.bestCosts[a] = cost;
+						s.bestTargets[a] = b;
+					}
+				}
+			}
+
+			if (s.bestTargets[a] != NONE && s.bestCosts[a] <= maxError)
+				s.candidates[numCandidates++] = a;
+		}
+
+		std::sort(s.candidates, s.candidates + numCandidates, [&s](uint32_t a, uint32_t b)
+		{
+			return s.bestCosts[a] < s.bestCosts[b];
+		});
+
+		//collapse the cheapest ones first, leaving alone the neighbourhoods that already changed in this pass
+		uint32_t numIndices = s.numIndices;
+		uint32_t numCollapsed = 0;
+		for (uint32_t i = 0; i < numCandidates && numIndices > targetNumIndices; i++)
+		{
+			uint32_t a = s.candidates[i];
+			uint32_t b = s.bestTargets[a];
+			if ((s.flags[a] | s.flags[b]) & FLAG_TOUCHED)
+				continue;
+
+			if (CollapseFlipsTriangle(s, a, b))
+				continue;
+
+			for (uint32_t j = s.adjacencyOffsets[a]; j < s.adjacencyOffsets[a + 1]; j++)
+			{
+				uint32_t triangle = s.adjacency[j];
+				if (s.Contains(triangle, b))
+					numIndices -= 3;
+
+				const uint32_t *t = &s.indices[triangle * 3];
+				for (uint32_t k = 0; k < 3; k++)
+					s.flags[t[k]] |= FLAG_TOUCHED;
+			}
+
+			s.remap[a] = b;
+			s.quadrics[b].Add(s.quadrics[a]);
+			numCollapsed++;
+		}
+
+		if (numCollapsed == 0)
+			break;
+
+		//apply the collapses and drop the triangles that vanished, keeping the order (and so the parts)
+		uint32_t numTriangles = s.numIndices / 3;
+		uint32_t numKept = 0;
+		for (uint32_t t = 0; t < numTriangles; t++)
+		{
+			uint32_t c0 = s.remap[s.indices[t * 3 + 0]];
+			uint32_t c1 = s.remap[s.indices[t * 3 + 1]];
+			uint32_t c2 = s.remap[s.indices[t * 3 + 2]];
+			if (c0 == c1 || c1 == c2 || c2 == c0)
+				continue;
+
+			s.indices[numKept * 3 + 0] = c0;
+			s.indices[numKept * 3 + 1] = c1;
+			s.indices[numKept * 3 + 2] = c2;
+			s.triangleParts[numKept] = s.triangleParts[t];
+			numKept++;
+		}
+		s.numIndices = numKept * 3;
+	}
+}
+
+void BuildSimplifiedLods(
+	LodSet &lods,
+	MemoryPool &pool,
+	const Mesh &mesh,
+	const uint32_t *indices, uint32_t numIndices,
+	const uint32_t *partNumIndices, uint32_t numParts
+)
+{
+	InitSingleLod(lods, pool, numIndices, partNumIndices, numParts);
+
+	uint32_t numVerts = mesh.corners.Count();
+	uint32_t numPositions = mesh.numVerts;
+	if (numVerts == 0 || numPositions == 0 || numIndices < 6)
+		return;
+
+	MemoryPool scratch;
+	if (!scratch.Create(ComputeScratchSize(numVerts, numPositions, numIndices, numParts)))
+		return;
+
+	Simplifier s(mesh);
+	s.numVerts = numVerts;
+	s.indices = scratch.Allocate<uint32_t>(numIndices);
+	s.triangleParts = scratch.Allocate<uint32_t>(numIndices / 3);
+	s.quadrics = scratch.Allocate<Quadric>(numVerts, 8);
+	s.remap = scratch.Allocate<uint32_t>(numVerts);
+	s.flags = scratch.Allocate<uint8_t>(numVerts);
+	s.adjacencyOffsets = scratch.Allocate<uint32_t>(numVerts + 1);
+	s.adjacency = scratch.Allocate<uint32_t>(numIndices);
+	s.bestTargets = scratch.Allocate<uint32_t>(numVerts);
+	s.bestCosts = scratch.Allocate<float>(numVerts);
+	s.candidates = scratch.Allocate<uint32_t>(numVerts);
+	uint32_t *cornerParts = scratch.Allocate<uint32_t>(numVerts);
+	uint32_t *cornersPerPosition = scratch.Allocate<uint32_t>(numPositions);
+	uint32_t *levelIndices = scratch.Allocate<uint32_t>((MAX_LOD_LEVELS - 1) * numIndices);
+	uint32_t *levelParts = scratch.Allocate<uint32_t>((MAX_LOD_LEVELS - 1) * numParts);
+
+	//copy the full-detail triangles, remembering their part
+	s.numIndices = 0;
+	uint32_t startIndex = 0;
+	for (uint32_t p = 0; p < numParts; p++)
+	{
+		uint32_t endIndex = startIndex + partNumIndices[p];
+		if (endIndex > numIndices)
+			endIndex = numIndices; //never trust the part sizes to match the index buffer
+
+		for (uint32_t i = startIndex; i + 3 <= endIndex; i += 3)
+		{
+			s.triangleParts[s.numIndices / 3] = p;
+			s.indices[s.numIndices++] = indices[i + 0];
+			s.indices[s.numIndices++] = indices[i + 1];
+			s.indices[s.numIndices++] = indices[i + 2];
+		}
+		startIndex = endIndex;
+	}
+
+	for (uint32_t c = 0; c < numVerts; c++)
+		s.remap[c] = c;
+
+	BuildAdjacency(s);
+	LockCorners(s, cornerParts, cornersPerPosition, numPositions);
+	ComputeQuadrics(s);
+
+	//error budgets are squared distances, relative to the mesh's size
+	Vector extent(mesh.maxExtent.x - mesh.minExtent.x, mesh.maxExtent.y - mesh.minExtent.y, mesh.maxExtent.z - mesh.minExtent.z);
+	float maxError = FIRST_LEVEL_MAX_ERROR * extent.Length();
+
+	//each level starts from the previous one
+	uint32_t levelSizes[MAX_LOD_LEVELS];
+	uint32_t numLevels = 1;
+	levelSizes[0] = s.numIndices;
+	for (uint32_t l = 1; l < MAX_LOD_LEVELS; l++, maxError *= 2.0f)
+	{
+		uint32_t target = (levelSizes[numLevels - 1] / 6) * 3;
+		Simplify(s, target, maxError * maxError);
+
+		if (s.numIndices == 0 || s.numIndices * 10 > levelSizes[numLevels - 1] * 9)
+			continue;
+
+		memcpy(levelIndices + (numLevels - 1) * numIndices, s.indices, s.numIndices * sizeof(uint32_t));
+		uint32_t *parts = levelParts + (numLevels - 1) * numParts; //the scratch memory starts zeroed
+		for (uint32_t t = 0; t < s.numIndices / 3; t++)
+			parts[s.triangleParts[t]] += 3;
+		levelSizes[numLevels] = s.numIndices;
+		numLevels++;
+	}
+
+	if (numLevels == 1)
+	{
+		scratch.Destroy();
+		return;
+	}
+
+	//store the kept levels
+	uint32_t numReducedIndices = 0;
+	for (uint32_t l = 1; l < numLevels; l++)
+		numReducedIndices += levelSizes[l];
+
+	uint32_t *partCounts = pool.Allocate<uint32_t>(numLevels * numParts);
+	memcpy(partCounts, partNumIndices, numParts * sizeof(uint32_t));
+	memcpy(partCounts + numParts, levelParts, (numLevels - 1) * numParts * sizeof(uint32_t));
+
+	uint32_t *reducedIndices = pool.Allocate<uint32_t>(numReducedIndices);
+	uint32_t offset = 0;
+	for (uint32_t l = 1; l < numLevels; l++)
+	{
+		memcpy(reducedIndices + offset, levelIndices + (l - 1) * numIndices, levelSizes[l] * sizeof(uint32_t));
+		lods.levelStartIndex[l] = numIndices + offset;
+		lods.levelNumIndices[l] = levelSizes[l];
+		offset += levelSizes[l];
+	}
+
+	lods.numLevels = numLevels;
+	lods.indices = Array<uint32_t>(reducedIndices, numReducedIndices);
+	lods.partNumIndices = Array<uint32_t>(partCounts, numLevels * numParts);
+
+	scratch.Destroy();
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "lod.hh"
+#include "../world/Mesh.hh"
+
+/// <summary>
+/// Builds levels of detail for a static mesh, collapsing edges in order of their quadric error (Garland and Heckbert).
+/// Only half-edge collapses are done, onto existing corners, so that every level shares the mesh's vertices.
+/// Corners sitting on UV seams (a position used by several corners), on part boundaries or on open borders never move,
+/// which keeps the parts (indexSurfaceProperty batches) and the texture mapping intact.
+/// Each level aims for half the triangles of the previous one, with an error budget that doubles with every level;
+/// levels that do not get noticeably lighter are dropped.
+/// Only @pool is written to, so many meshes can be simplified at once as long as each thread has its own pool.
+/// </summary>
+/// <param name="indices">the full-detail index buffer, indexing the mesh's corners, made of numParts consecutive parts</param>
+void BuildSimplifiedLods(
+	LodSet &lods,
+	MemoryPool &pool,
+	const Mesh &mesh,
+	const uint32_t *indices, uint32_t numIndices,
+	const uint32_t *partNumIndices, uint32_t numParts
+);
+
+//worst-case amount of memory BuildSimplifiedLods takes from its pool
+uint32_t GetSimplifiedLodsMaxSize(uint32_t numIndices, uint32_t numParts);
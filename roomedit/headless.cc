@@ -0,0 +1,119 @@
+/*
+*	Room Editor Application
+*	Renders a level with the software renderer, without any window, and writes the last frame along with the frame times.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "Document.hh"
+#include "WorldRenderer.hh"
+#include "spatial/bounds.hh"
+#include <stdio.h> //printf
+#include <stdlib.h> //atoi
+#include <chrono> //std::chrono::steady_clock
+
+#ifndef SOFTWARE_RASTER
+#error "The headless renderer needs the software renderer, configure with SOFTWARE_RASTER."
+#endif
+
+static constexpr uint32_t IMAGE_WIDTH = 1280;
+static constexpr uint32_t IMAGE_HEIGHT = 720;
+static constexpr uint32_t DEFAULT_NUM_FRAMES = 10;
+
+//too big for the stack
+static Document document;
+
+//the camera starts in the middle of the first room that can be drawn, the origin often being outside of every room
+static void PlaceCamera(Document &document)
+{
+	document.camera.Reset();
+	document.camera.ResizeViewport(IMAGE_WIDTH, IMAGE_HEIGHT);
+	for (const auto &room : document.world.rooms)
+	{
+		if (room.mesh.numVerts == 0)
+			continue;
+
+		BBox box = ComputeRoomBBox(room);
+		document.camera.SetPosition((box.min + box.max) * 0.5f);
+		return;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		printf("usage: %s <level.EDN> [image.tga] [frames] [threads]\n", argv[0]);
+		return 1;
+	}
+	const char *levelPath = argv[1];
+	const char *imagePath = argc > 2 ? argv[2] : "frame.tga";
+	int numFrames = argc > 3 ? atoi(argv[3]) : DEFAULT_NUM_FRAMES;
+	int numThreads = argc > 4 ? atoi(argv[4]) : 0; //one per core
+	if (numFrames < 1 || numThreads < 0)
+	{
+		printf("The number of frames must be positive, and the number of threads must not be negative.\n");
+		return 1;
+	}
+
+	if (!document.Load(levelPath))
+	{
+		printf("Failed to load %s.\n", levelPath);
+		return 1;
+	}
+
+	sbRenderer renderer;
+	if (!renderer.Create(IMAGE_WIDTH, IMAGE_HEIGHT, (uint32_t)numThreads))
+	{
+		printf("Failed to create the renderer.\n");
+		document.Reset();
+		return 1;
+	}
+
+	WorldRenderer worldRenderer(renderer);
+	if (!worldRenderer.Create() || !worldRenderer.LoadWorld(document.world))
+	{
+		printf("Failed to upload the level resources to the renderer.\n");
+		worldRenderer.UnloadWorld(); //whatever was loaded before it failed
+		worldRenderer.Destroy();
+		renderer.Destroy();
+		document.Reset();
+		return 1;
+	}
+	PlaceCamera(document);
+
+	//recording is the time spent by the world renderer, drawing is the time spent by the renderer once the frame ends
+	printf("frame\trecording (ms)\tdrawing (ms)\tdraws\ttriangles\n");
+	double totalRecording = 0.0;
+	double totalDrawing = 0.0;
+	int numDrawnFrames = 0;
+	for (int frame = 0; frame < numFrames; frame++)
+	{
+		document.Tick(0.0f);
+		if (!renderer.StartFrame())
+			break;
+
+		auto start = std::chrono::steady_clock::now();
+		Matrix viewProjection = document.camera.GetProjMatrix() * document.camera.GetViewMatrix();
+		worldRenderer.Render(document, viewProjection);
+		double recording = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		renderer.EndAndPresentFrame();
+		const auto &stats = renderer.GetStats();
+		printf("%d\t%.3f\t%.3f\t%u\t%u\n", frame, recording, stats.milliseconds, stats.numDraws, stats.numTriangles);
+		totalRecording += recording;
+		totalDrawing += stats.milliseconds;
+		numDrawnFrames++;
+	}
+	if (numDrawnFrames)
+		printf("average\t%.3f\t%.3f\n", totalRecording / numDrawnFrames, totalDrawing / numDrawnFrames);
+
+	bool saved = renderer.SaveImage(imagePath);
+	if (!saved)
+		printf("Failed to write %s.\n", imagePath);
+
+	worldRenderer.UnloadWorld();
+	worldRenderer.Destroy();
+	renderer.Destroy();
+	document.Reset();
+	return saved ? 0 : 1;
+}
@@ -15,6 +15,7 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <commctrl.h> //InitCommonControls
+#include <stdio.h> //snprintf
 
 //handle for the main window
 static HWND mainWnd;
@@ -26,6 +27,7 @@ static HMENU mainMenu;
 //submenus
 static HMENU fileSubMenu;
 static HMENU cameraSubMenu;
+static HMENU worldSubMenu;
 
 //world data
 static Document document;
@@ -49,7 +51,9 @@ enum MenuItem : unsigned int
 	IDM_FILE_CLOSE,
 	IDM_FILE_EXIT,
 	IDM_CAMERA_RESET,
-	IDM_CAMERA_SETTINGS
+	IDM_CAMERA_WALK,
+	IDM_CAMERA_SETTINGS,
+	IDM_WORLD_SOLVE_VISIBILITY
 };
 
 static void DisableMenuItem(HMENU subMenu, MenuItem mi)
@@ -292,10 +296,17 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lPara
 
 		cameraSubMenu = CreatePopupMenu();
 		AppendMenu(cameraSubMenu, MF_STRING, IDM_CAMERA_RESET, "&Reset");
+		AppendMenu(cameraSubMenu, MF_STRING, IDM_CAMERA_WALK, "&Walk Mode");
 		AppendMenu(cameraSubMenu, MF_STRING, IDM_CAMERA_SETTINGS, "&Settings...");
 
 		AppendMenu(mainMenu, MF_POPUP, (UINT_PTR)cameraSubMenu, "&Camera");
 
+		worldSubMenu = CreatePopupMenu();
+		AppendMenu(worldSubMenu, MF_STRING, IDM_WORLD_SOLVE_VISIBILITY, "Recompute &Visibility...");
+		DisableMenuItem(worldSubMenu, IDM_WORLD_SOLVE_VISIBILITY);
+
+		AppendMenu(mainMenu, MF_POPUP, (UINT_PTR)worldSubMenu, "&World");
+
 		//set the menu to the main window
 		SetMenu(hWnd, mainMenu);
 
@@ -404,12 +415,14 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lPara
 			if (!sceneView.CreateWorldRenderer())
 			{
 				MessageBox(hWnd, "Failed to upload the level resources to the graphics device.", WINDOW_TITLE, MB_ICONERROR);
+				sceneView.DestroyWorldRenderer(); //whatever was loaded before it failed
 				document.Reset();
 				break;
 			}
 
 			bottomBar.SetText(Part::FirstPart, ofn.lpstrFile);
 			EnableMenuItem(fileSubMenu, IDM_FILE_CLOSE); //allow closing the level file
+			EnableMenuItem(worldSubMenu, IDM_WORLD_SOLVE_VISIBILITY);
 			UpdateAllViews();
 			document.camera.Reset();
 			break;
@@ -420,6 +433,7 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lPara
 			bottomBar.SetDefaultText();
 			UpdateAllViews();
 			DisableMenuItem(fileSubMenu, IDM_FILE_CLOSE); //forbid closing the level file
+			DisableMenuItem(worldSubMenu, IDM_WORLD_SOLVE_VISIBILITY);
 			break;
 		case IDM_FILE_EXIT:
 			PostQuitMessage(0);
@@ -427,9 +441,41 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lPara
 		case IDM_CAMERA_RESET:
 			document.camera.Reset();
 			break;
+		case IDM_CAMERA_WALK:
+			document.walkMode = !document.walkMode;
+			CheckMenuItem(cameraSubMenu, IDM_CAMERA_WALK, MF_BYCOMMAND | (document.walkMode ? MF_CHECKED : MF_UNCHECKED));
+			break;
 		case IDM_CAMERA_SETTINGS:
 			MessageBox(hWnd, "Code me!", WINDOW_TITLE, MB_ICONINFORMATION);
 			break;
+		case IDM_WORLD_SOLVE_VISIBILITY:
+		{
+			HCURSOR previousCursor = SetCursor(LoadCursor(nullptr, IDC_WAIT));
+			ULONGLONG startTime = GetTickCount64();
+			VisibilitySolver::Comparison comparison;
+			bool solved = document.SolveVisibility(comparison);
+			ULONGLONG duration = GetTickCount64() - startTime;
+			SetCursor(previousCursor);
+			if (!solved)
+			{
+				MessageBox(hWnd, "Failed to recompute the visibility between the rooms.", WINDOW_TITLE, MB_ICONERROR);
+				break;
+			}
+
+			char message[512];
+			snprintf(message, sizeof(message),
+				"Cast %u rays in %.1f seconds.\n\n"
+				"%u rooms list rooms they cannot see (%u entries), drawing more than needed.\n"
+				"%u rooms miss rooms they can see (%u entries).\n\n"
+				"Use the recomputed lists?",
+				comparison.numRaysCast, duration / 1000.0,
+				comparison.numLooserRooms, comparison.numExtraEntries,
+				comparison.numTighterRooms, comparison.numMissingEntries
+			);
+			if (MessageBox(hWnd, message, WINDOW_TITLE, MB_ICONQUESTION | MB_YESNO) == IDYES && !document.ApplyVisibility())
+				MessageBox(hWnd, "Failed to use the recomputed lists.", WINDOW_TITLE, MB_ICONERROR);
+			break;
+		}
 		default:
 			break;
 		}
@@ -459,11 +505,16 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lPara
 
 class Application
 {
+	//how often, in seconds, the statistics shown in the status bar are refreshed
+	static constexpr float STATS_REFRESH_PERIOD = 0.5f;
+
 	HINSTANCE instance;
+	float statsTimer;
 
 public:
 	constexpr Application():
-		instance(nullptr)
+		instance(nullptr),
+		statsTimer(0.0f)
 	{}
 
 	bool Initialise(HINSTANCE hInstance, int nShowCmd = SW_SHOW)
@@ -541,6 +592,29 @@ public:
 		}
 
 		sceneView.Tick(input, dt);
+
+		//show how much the occlusion culling hides
+		statsTimer += dt;
+		if (document.levelLoaded && statsTimer >= STATS_REFRESH_PERIOD)
+		{
+			statsTimer = 0.0f;
+
+			const auto &stats = sceneView.GetOcclusionStats();
+			const auto &drawStats = sceneView.GetDrawStats();
+			const auto &stateStats = sceneView.GetStateStats();
+			const auto &instanceStats = sceneView.GetInstanceStats();
+			const auto &textureStats = sceneView.GetTextureStats();
+			char text[384];
+			snprintf(text, sizeof(text), "Occluded: %u/%u (%.0f%%), draws: %u, state changes: %u (%u unsorted), redundant calls skipped: %u/%u, object parts: %u in %u batches, "
+				"textures: %u (%u unreferenced skipped, %.1f MiB)",
+				stats.numCulled, stats.numTested, stats.GetCulledPercentage(),
+				drawStats.numPackets, drawStats.numStateChanges, drawStats.numUnsortedStateChanges,
+				stateStats.GetTotalSkipped(), stateStats.GetTotalSkipped() + stateStats.GetTotalIssued(),
+				instanceStats.numInstances, instanceStats.numBatches,
+				textureStats.numUploaded, textureStats.numSkipped, textureStats.skippedSize / (1024.0 * 1024.0));
+			bottomBar.SetText(Part::SecondPart, text);
+		}
+
 		return true;
 	}
 };
@@ -0,0 +1,93 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "BoxCuller.hh"
+#ifdef __AVX__
+#include <immintrin.h>
+#else
+#include <xmmintrin.h>
+#endif
+
+uint32_t BoxCuller::Cull(const Frustum &frustum, uint32_t *visibleIndices) const
+{
+	//for every plane, only the corner that goes the furthest along its normal needs testing,
+	//so pick its components once for all the boxes
+	const float *cornerX[Frustum::NUM_PLANES];
+	const float *cornerY[Frustum::NUM_PLANES];
+	const float *cornerZ[Frustum::NUM_PLANES];
+	for (uint32_t p = 0; p < Frustum::NUM_PLANES; p++)
+	{
+		const Vector &plane = frustum.GetPlane(p);
+		cornerX[p] = plane.x >= 0.0f ? maxX : minX;
+		cornerY[p] = plane.y >= 0.0f ? maxY : minY;
+		cornerZ[p] = plane.z >= 0.0f ? maxZ : minZ;
+	}
+
+	uint32_t numVisible = 0;
+
+#ifdef __AVX__
+	__m256 planeX[Frustum::NUM_PLANES], planeY[Frustum::NUM_PLANES], planeZ[Frustum::NUM_PLANES], planeW[Frustum::NUM_PLANES];
+	for (uint32_t p = 0; p < Frustum::NUM_PLANES; p++)
+	{
+		const Vector &plane = frustum.GetPlane(p);
+		planeX[p] = _mm256_set1_ps(plane.x);
+		planeY[p] = _mm256_set1_ps(plane.y);
+		planeZ[p] = _mm256_set1_ps(plane.z);
+		planeW[p] = _mm256_set1_ps(plane.w);
+	}
+
+	for (uint32_t i = 0; i < numBoxes; i += LANE_WIDTH)
+	{
+		//a box is outside as soon as its corner is behind one plane
+		__m256 outside = _mm256_setzero_ps();
+		for (uint32_t p = 0; p < Frustum::NUM_PLANES; p++)
+		{
+			__m256 distance = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(planeX[p], _mm256_load_ps(cornerX[p] + i)), _mm256_mul_ps(planeY[p], _mm256_load_ps(cornerY[p] + i))),
+				_mm256_add_ps(_mm256_mul_ps(planeZ[p], _mm256_load_ps(cornerZ[p] + i)), planeW[p])
+			);
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+		uint32_t visibleMask = ~(uint32_t)_mm256_movemask_ps(outside);
+#else
+	__m128 planeX[Frustum::NUM_PLANES], planeY[Frustum::NUM_PLANES], planeZ[Frustum::NUM_PLANES], planeW[Frustum::NUM_PLANES];
+	for (uint32_t p = 0; p < Frustum::NUM_PLANES; p++)
+	{
+		const Vector &plane = frustum.GetPlane(p);
+		planeX[p] = _mm_set1_ps(plane.x);
+		planeY[p] = _mm_set1_ps(plane.y);
+		planeZ[p] = _mm_set1_ps(plane.z);
+		planeW[p] = _mm_set1_ps(plane.w);
+	}
+
+	for (uint32_t i = 0; i < numBoxes; i += LANE_WIDTH)
+	{
+		//a box is outside as soon as its corner is behind one plane
+		__m128 outside = _mm_setzero_ps();
+		for (uint32_t p = 0; p < Frustum::NUM_PLANES; p++)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(planeX[p], _mm_load_ps(cornerX[p] + i)), _mm_mul_ps(planeY[p], _mm_load_ps(cornerY[p] + i))),
+				_mm_add_ps(_mm_mul_ps(planeZ[p], _mm_load_ps(cornerZ[p] + i)), planeW[p])
+			);
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+		}
+		uint32_t visibleMask = ~(uint32_t)_mm_movemask_ps(outside);
+#endif
+
+		//the padding after the last box is never reported
+		uint32_t numLanes = numBoxes - i < LANE_WIDTH ? numBoxes - i : LANE_WIDTH;
+		visibleMask &= (1u << numLanes) - 1;
+
+		//compact without branching, every lane writes but only the visible ones move the end forward
+		for (uint32_t lane = 0; lane < LANE_WIDTH; lane++)
+		{
+			visibleIndices[numVisible] = i + lane;
+			numVisible += (visibleMask >> lane) & 1;
+		}
+	}
+
+	return numVisible;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "../spatial/BoxSet.hh"
+#include "Frustum.hh"
+#include <stdint.h>
+
+/// <summary>
+/// Frustum-culls many boxes at once, a whole group of them being tested against a plane with a few SIMD instructions.
+/// It only depends on the math and memory modules, so it can be driven without any renderer.
+/// </summary>
+class BoxCuller final: public BoxSet
+{
+public:
+	/// <summary>
+	/// Writes the indices of the boxes that are not entirely behind one of the frustum's planes, in increasing order.
+	/// </summary>
+	/// <param name="visibleIndices">must hold GetCapacity() indices</param>
+	/// <returns>the number of visible boxes</returns>
+	uint32_t Cull(const Frustum &frustum, uint32_t *visibleIndices) const;
+};
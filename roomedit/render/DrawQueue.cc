@@ -0,0 +1,197 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "DrawQueue.hh"
+#include <string.h> //memcpy
+
+//the keys are sorted 11 bits at a time, in 6 passes
+static constexpr uint32_t RADIX_BITS = 11;
+static constexpr uint32_t RADIX_SIZE = 1 << RADIX_BITS;
+static constexpr uint32_t NUM_RADIX_PASSES = (64 + RADIX_BITS - 1) / RADIX_BITS;
+
+bool DrawQueue::Create(uint32_t maxPackets, uint32_t maxMatrices)
+{
+	assert(maxMatrices <= (1u << MESH_BITS));
+	if (!pool.Create(maxPackets * sizeof(Packet) + maxMatrices * sizeof(Matrix) + 2 * maxPackets * sizeof(SortEntry) + 4 * 16))
+		return false;
+
+	packets = Array<Packet>(pool.Allocate<Packet>(maxPackets, 16), maxPackets);
+	matrices = Array<Matrix>(pool.Allocate<Matrix>(maxMatrices, 16), maxMatrices);
+	entries = Array<SortEntry>(pool.Allocate<SortEntry>(maxPackets, 16), maxPackets);
+	scratch = Array<SortEntry>(pool.Allocate<SortEntry>(maxPackets, 16), maxPackets);
+	Reset();
+	return true;
+}
+
+void DrawQueue::Destroy()
+{
+	pool.Destroy();
+	packets = Array<Packet>();
+	matrices = Array<Matrix>();
+	entries = Array<SortEntry>();
+	scratch = Array<SortEntry>();
+	Reset();
+}
+
+void DrawQueue::Reset()
+{
+	sortedEntries = nullptr;
+	numPackets = 0;
+	numMatrices = 0;
+	stats = {};
+}
+
+uint32_t DrawQueue::AddMatrix(const Matrix &m)
+{
+	if (numMatrices == matrices.Count())
+		return INVALID_INDEX;
+
+	matrices[numMatrices] = m;
+	return numMatrices++;
+}
+
+uint32_t DrawQueue::AddMatrices(const Matrix *m, uint32_t count)
+{
+	if (count > matrices.Count() - numMatrices)
+		return INVALID_INDEX;
+
+	uint32_t first = numMatrices;
+	memcpy(matrices.Data() + first, m, count * sizeof(Matrix));
+	numMatrices += count;
+	return first;
+}
+
+uint64_t DrawQueue::MakeKey(uint32_t pipeline, uint32_t textureIndex0, uint32_t textureIndex1, uint32_t matrixIndex, float depth)
+{
+	assert(pipeline < (1u << PIPELINE_BITS));
+	assert(textureIndex0 < (1u << TEXTURE_BITS) && textureIndex1 < (1u << TEXTURE_BITS));
+	assert(matrixIndex < (1u << MESH_BITS));
+
+	//the bits of a positive float grow with it, so its upper bits keep the order with a relative precision
+	uint32_t depthBits;
+	if (depth > 0.0f)
+		memcpy(&depthBits, &depth, sizeof(depthBits));
+	else
+		depthBits = 0;
+	uint64_t quantizedDepth = depthBits >> (32 - 1 - DEPTH_BITS); //the sign bit is always 0
+
+	//the second texture is the lightmap of the rooms, shared by the parts of a room or of a few,
+	//so that the draws of a room stay together and do not keep changing the matrix
+	uint64_t key = pipeline;
+	key = (key << TEXTURE_BITS) | textureIndex1;
+	key = (key << TEXTURE_BITS) | textureIndex0;
+	key = (key << MESH_BITS) | matrixIndex;
+	key = (key << DEPTH_BITS) | quantizedDepth;
+	return key;
+}
+
+void DrawQueue::Add(uint32_t pipeline, uint32_t textureIndex0, uint32_t textureIndex1, uint32_t matrixIndex, float depth,
+	uint32_t numIndices, uint32_t startIndex, int32_t baseVertex, uint32_t numInstances)
+{
+	assert(numInstances != 0 && matrixIndex + numInstances <= numMatrices);
+	if (numPackets == packets.Count())
+	{
+		stats.numDropped++;
+		return;
+	}
+
+	Packet &packet = packets[numPackets];
+	packet.pipeline = pipeline;
+	packet.textureIndices[0] = textureIndex0;
+	packet.textureIndices[1] = textureIndex1;
+	packet.matrixIndex = matrixIndex;
+	packet.numIndices = numIndices;
+	packet.startIndex = startIndex;
+	packet.baseVertex = baseVertex;
+	packet.numInstances = numInstances;
+
+	entries[numPackets].key = MakeKey(pipeline, textureIndex0, textureIndex1, matrixIndex, depth);
+	entries[numPackets].packetIndex = numPackets;
+	numPackets++;
+}
+
+void DrawQueue::Append(const DrawQueue &source, uint32_t firstPacket, uint32_t count, uint32_t firstMatrix, uint32_t numSourceMatrices)
+{
+	assert(firstPacket + count <= source.numPackets && firstMatrix + numSourceMatrices <= source.numMatrices);
+	uint32_t matrixOffset = AddMatrices(source.matrices.Data() + firstMatrix, numSourceMatrices);
+	if (matrixOffset == INVALID_INDEX || count > packets.Count() - numPackets)
+	{
+		stats.numDropped += count;
+		return;
+	}
+
+	//only the matrix index changes, the rest of the key stays as it was made
+	static constexpr uint64_t MESH_MASK = ((1ull << MESH_BITS) - 1) << DEPTH_BITS;
+	for (uint32_t i = firstPacket; i < firstPacket + count; i++)
+	{
+		Packet &packet = packets[numPackets];
+		packet = source.packets[i];
+		assert(packet.matrixIndex >= firstMatrix && packet.matrixIndex + packet.numInstances <= firstMatrix + numSourceMatrices);
+		packet.matrixIndex = packet.matrixIndex - firstMatrix + matrixOffset;
+
+		entries[numPackets].key = (source.entries[i].key & ~MESH_MASK) | (uint64_t(packet.matrixIndex) << DEPTH_BITS);
+		entries[numPackets].packetIndex = numPackets;
+		numPackets++;
+	}
+}
+
+uint32_t DrawQueue::CountStateChanges(const Packet &previous, const Packet &packet)
+{
+	if (previous.pipeline != packet.pipeline)
+		return 3;
+
+	uint32_t numChanges = 0;
+	if (previous.textureIndices[0] != packet.textureIndices[0] || previous.textureIndices[1] != packet.textureIndices[1])
+		numChanges++;
+	if (previous.matrixIndex != packet.matrixIndex)
+		numChanges++;
+	return numChanges;
+}
+
+void DrawQueue::Sort()
+{
+	stats.numPackets = numPackets;
+	stats.numUnsortedStateChanges = numPackets ? 3 : 0;
+	for (uint32_t i = 1; i < numPackets; i++)
+		stats.numUnsortedStateChanges += CountStateChanges(packets[i - 1], packets[i]);
+
+	//count every digit of every key at once
+	uint32_t histograms[NUM_RADIX_PASSES][RADIX_SIZE] = {};
+	for (uint32_t i = 0; i < numPackets; i++)
+	{
+		uint64_t key = entries[i].key;
+		for (uint32_t pass = 0; pass < NUM_RADIX_PASSES; pass++)
+			histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+	}
+
+	//least significant digit first, each pass keeping the order of the previous one
+	SortEntry *source = entries.Data();
+	SortEntry *destination = scratch.Data();
+	for (uint32_t pass = 0; pass < NUM_RADIX_PASSES; pass++)
+	{
+		//a digit shared by all of the keys does not change their order
+		uint32_t *histogram = histograms[pass];
+		uint32_t shift = pass * RADIX_BITS;
+		if (numPackets == 0 || histogram[(source[0].key >> shift) & (RADIX_SIZE - 1)] == numPackets)
+			continue;
+
+		uint32_t offset = 0;
+		for (uint32_t b = 0; b < RADIX_SIZE; b++)
+		{
+			uint32_t count = histogram[b];
+			histogram[b] = offset;
+			offset += count;
+		}
+
+		for (uint32_t i = 0; i < numPackets; i++)
+			destination[histogram[(source[i].key >> shift) & (RADIX_SIZE - 1)]++] = source[i];
+
+		SortEntry *swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	sortedEntries = source;
+}
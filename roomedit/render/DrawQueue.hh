@@ -0,0 +1,160 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "common/matrix.inl"
+#include <stdint.h>
+#include <assert.h>
+
+/// <summary>
+/// Collects the draws of a frame as fixed-size packets, each with a 64-bit key made of, from the most significant bits,
+/// its pipeline, its pair of textures (the second one first), its mesh (the transform it is drawn with) and its depth.
+/// Once the whole frame is collected, the keys are radix-sorted and the packets are submitted in that order,
+/// the backend only being told about the states that change from one packet to the next.
+/// It only depends on the math and memory modules, so it can be driven without any renderer.
+/// </summary>
+class DrawQueue
+{
+public:
+	static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	//how the key is split, from the most significant bits
+	static constexpr uint32_t PIPELINE_BITS = 4;
+	static constexpr uint32_t TEXTURE_BITS = 12;
+	static constexpr uint32_t MESH_BITS = 18;
+	static constexpr uint32_t DEPTH_BITS = 64 - PIPELINE_BITS - 2 * TEXTURE_BITS - MESH_BITS;
+
+	struct Packet
+	{
+		uint32_t pipeline;
+		uint32_t textureIndices[2];
+		uint32_t matrixIndex;
+		uint32_t numIndices;
+		uint32_t startIndex;
+		int32_t baseVertex;
+		uint32_t numInstances; //drawn with the matrices that follow matrixIndex
+	};
+
+	struct Stats
+	{
+		uint32_t numPackets;
+		uint32_t numDropped; //the packets that did not fit
+		uint32_t numStateChanges; //pipelines, textures and matrices set while submitting
+		uint32_t numUnsortedStateChanges; //the same, had the packets been submitted in the order they were added
+	};
+
+private:
+	struct SortEntry
+	{
+		uint64_t key;
+		uint32_t packetIndex;
+		uint32_t padding;
+	};
+
+	MemoryPool pool;
+	Array<Packet> packets;
+	Array<Matrix> matrices;
+	Array<SortEntry> entries;
+	Array<SortEntry> scratch; //the radix sort goes back and forth between both
+	const SortEntry *sortedEntries;
+	uint32_t numPackets;
+	uint32_t numMatrices;
+	Stats stats;
+
+	static uint32_t CountStateChanges(const Packet &previous, const Packet &packet);
+
+public:
+	DrawQueue():
+		sortedEntries(nullptr),
+		numPackets(0),
+		numMatrices(0),
+		stats()
+	{}
+
+	bool Create(uint32_t maxPackets, uint32_t maxMatrices);
+	void Destroy();
+
+	//empties the queue, to be called at the start of every frame
+	void Reset();
+
+	//returns the index to give to the packets drawn with @m, or INVALID_INDEX if the queue is full
+	uint32_t AddMatrix(const Matrix &m);
+	//same, for matrices that have to follow each other
+	uint32_t AddMatrices(const Matrix *m, uint32_t count);
+
+	const Matrix &GetMatrix(uint32_t i) const
+	{
+		assert(i < numMatrices);
+		return matrices[i];
+	}
+
+	/// <summary>
+	/// Queues a draw of indexed triangles.
+	/// </summary>
+	/// <param name="matrixIndex">as returned by AddMatrix, or by AddMatrices when drawing several instances</param>
+	/// <param name="depth">the distance to the camera, nearer draws being submitted first among those sharing the same states</param>
+	void Add(uint32_t pipeline, uint32_t textureIndex0, uint32_t textureIndex1, uint32_t matrixIndex, float depth,
+		uint32_t numIndices, uint32_t startIndex, int32_t baseVertex, uint32_t numInstances = 1);
+
+	/// <summary>
+	/// Queues packets and matrices added to another queue, as if they had been added to this one.
+	/// The packets' matrices have to be among those appended along with them.
+	/// </summary>
+	void Append(const DrawQueue &source, uint32_t firstPacket, uint32_t count, uint32_t firstMatrix, uint32_t numSourceMatrices);
+
+	uint32_t GetNumPackets() const
+	{
+		return numPackets;
+	}
+
+	uint32_t GetNumMatrices() const
+	{
+		return numMatrices;
+	}
+
+	static uint64_t MakeKey(uint32_t pipeline, uint32_t textureIndex0, uint32_t textureIndex1, uint32_t matrixIndex, float depth);
+
+	//sorts the packets added since the last Reset by their keys
+	void Sort();
+
+	/// <summary>
+	/// Submits the sorted packets, calling on @backend:
+	/// UsePipeline(pipeline), UseTextures(textureIndex0, textureIndex1) and SetMatrix(m) whenever they change,
+	/// and Draw(numIndices, startIndex, baseVertex, matrixIndex, numInstances) for every packet.
+	/// </summary>
+	template <typename Backend>
+	void Submit(Backend &backend)
+	{
+		assert(sortedEntries || numPackets == 0);
+		stats.numStateChanges = 0;
+		const Packet *previous = nullptr;
+		for (uint32_t i = 0; i < numPackets; i++)
+		{
+			const Packet &packet = packets[sortedEntries[i].packetIndex];
+
+			//the pipeline resets the textures and the matrix it is used with
+			bool pipelineChanged = !previous || previous->pipeline != packet.pipeline;
+			if (pipelineChanged)
+			{
+				backend.UsePipeline(packet.pipeline);
+				stats.numStateChanges++;
+			}
+			if (pipelineChanged || previous->textureIndices[0] != packet.textureIndices[0] || previous->textureIndices[1] != packet.textureIndices[1])
+			{
+				backend.UseTextures(packet.textureIndices[0], packet.textureIndices[1]);
+				stats.numStateChanges++;
+			}
+			if (pipelineChanged || previous->matrixIndex != packet.matrixIndex)
+			{
+				backend.SetMatrix(matrices[packet.matrixIndex]);
+				stats.numStateChanges++;
+			}
+
+			backend.Draw(packet.numIndices, packet.startIndex, packet.baseVertex, packet.matrixIndex, packet.numInstances);
+			previous = &packet;
+		}
+	}
+
+	const Stats &GetStats() const
+	{
+		return stats;
+	}
+};
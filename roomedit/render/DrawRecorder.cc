@@ -0,0 +1,157 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "DrawRecorder.hh"
+
+bool DrawRecorder::Create(uint32_t numRequestedThreads, uint32_t maxPackets, uint32_t maxMatrices, uint32_t maxTransforms, uint32_t maxInstances)
+{
+	numThreads = numRequestedThreads != 0 ? numRequestedThreads : std::thread::hardware_concurrency();
+	if (numThreads > MAX_THREADS)
+		numThreads = MAX_THREADS;
+	if (numThreads == 0)
+		numThreads = 1;
+
+	for (uint32_t i = 0; i < numThreads; i++)
+	{
+		if (!streams[i].drawQueue.Create(maxPackets, maxMatrices) || !streams[i].instanceBatcher.Create(maxTransforms, maxInstances))
+		{
+			Destroy();
+			return false;
+		}
+	}
+
+	//the calling thread records too
+	quit = false;
+	jobNumber = 0;
+	for (uint32_t i = 1; i < numThreads; i++)
+		workers[i - 1] = std::thread(&DrawRecorder::WorkerLoop, this, i);
+	return true;
+}
+
+void DrawRecorder::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	jobStarted.notify_all();
+	for (uint32_t i = 1; i < numThreads; i++)
+	{
+		if (workers[i - 1].joinable())
+			workers[i - 1].join();
+	}
+
+	for (auto &stream : streams)
+	{
+		stream.instanceBatcher.Destroy();
+		stream.drawQueue.Destroy();
+	}
+	numThreads = 0;
+	numChunks = 0;
+}
+
+void DrawRecorder::RecordChunks(uint32_t streamIndex)
+{
+	Stream &stream = streams[streamIndex];
+	for (uint32_t c = nextChunk++; c < numChunks; c = nextChunk++)
+	{
+		//remember which part of the stream the chunk's items went to
+		Chunk &chunk = chunks[c];
+		chunk.streamIndex = streamIndex;
+		chunk.firstPacket = stream.drawQueue.GetNumPackets();
+		chunk.firstMatrix = stream.drawQueue.GetNumMatrices();
+		chunk.firstTransform = stream.instanceBatcher.GetNumTransforms();
+		chunk.firstInstance = stream.instanceBatcher.GetNumInstances();
+
+		for (uint32_t item = chunk.firstItem; item < chunk.firstItem + chunk.numItems; item++)
+			recordFunction(recordContext, stream, item);
+
+		chunk.numPackets = stream.drawQueue.GetNumPackets() - chunk.firstPacket;
+		chunk.numMatrices = stream.drawQueue.GetNumMatrices() - chunk.firstMatrix;
+		chunk.numTransforms = stream.instanceBatcher.GetNumTransforms() - chunk.firstTransform;
+		chunk.numInstances = stream.instanceBatcher.GetNumInstances() - chunk.firstInstance;
+		numChunksDone.fetch_add(1, std::memory_order_release);
+	}
+}
+
+void DrawRecorder::WorkerLoop(uint32_t streamIndex)
+{
+	uint32_t lastJobNumber = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobStarted.wait(lock, [&]() { return quit || jobNumber != lastJobNumber; });
+			if (quit)
+				return;
+			lastJobNumber = jobNumber;
+		}
+
+		RecordChunks(streamIndex);
+	}
+}
+
+void DrawRecorder::Run(uint32_t numItems, RecordFunction function, void *context)
+{
+	assert(numThreads != 0);
+	for (uint32_t i = 0; i < numThreads; i++)
+	{
+		streams[i].drawQueue.Reset();
+		streams[i].instanceBatcher.Reset();
+	}
+
+	//split the items into runs of about the same size
+	uint32_t chunkSize = (numItems + numThreads * CHUNKS_PER_THREAD - 1) / (numThreads * CHUNKS_PER_THREAD);
+	if (chunkSize < MIN_CHUNK_ITEMS)
+		chunkSize = MIN_CHUNK_ITEMS;
+	if (chunkSize * MAX_CHUNKS < numItems)
+		chunkSize = (numItems + MAX_CHUNKS - 1) / MAX_CHUNKS;
+
+	numChunks = 0;
+	for (uint32_t item = 0; item < numItems; item += chunkSize)
+	{
+		Chunk &chunk = chunks[numChunks++];
+		chunk.firstItem = item;
+		chunk.numItems = numItems - item < chunkSize ? numItems - item : chunkSize;
+	}
+
+	stats.numThreads = numThreads;
+	stats.numItems = numItems;
+	stats.numChunks = numChunks;
+
+	recordFunction = function;
+	recordContext = context;
+	nextChunk = 0;
+	numChunksDone = 0;
+
+	//wake the workers only if there is enough for them to do
+	if (numThreads > 1 && numChunks > 1)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobNumber++;
+		}
+		jobStarted.notify_all();
+	}
+
+	RecordChunks(0);
+
+	//the last chunks may still be in the hands of the workers
+	while (numChunksDone.load(std::memory_order_acquire) < numChunks)
+		std::this_thread::yield();
+}
+
+void DrawRecorder::Merge(DrawQueue &drawQueue, InstanceBatcher &instanceBatcher) const
+{
+	for (uint32_t c = 0; c < numChunks; c++)
+	{
+		const Chunk &chunk = chunks[c];
+		const Stream &stream = streams[chunk.streamIndex];
+		if (chunk.numPackets != 0)
+			drawQueue.Append(stream.drawQueue, chunk.firstPacket, chunk.numPackets, chunk.firstMatrix, chunk.numMatrices);
+		if (chunk.numInstances != 0)
+			instanceBatcher.Append(stream.instanceBatcher, chunk.firstTransform, chunk.numTransforms, chunk.firstInstance, chunk.numInstances);
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "DrawQueue.hh"
+#include "InstanceBatcher.hh"
+#include <stdint.h>
+#include <assert.h>
+#include <atomic> //std::atomic
+#include <condition_variable> //std::condition_variable
+#include <mutex> //std::mutex
+#include <thread> //std::thread
+
+/// <summary>
+/// Records the draws of a frame on several threads. The items to record are split into small runs of consecutive items,
+/// which the threads take one after the other, every thread recording into its own stream (a draw queue and an instance batcher).
+/// The runs are then appended to the frame's queue and batcher in the order of their items, so the merged draws are the same
+/// as if a single thread had recorded them all, whatever the number of threads and whichever thread took which run.
+/// It only knows about the queues, the recording being a callback, so it can be driven without any renderer.
+/// </summary>
+class DrawRecorder
+{
+public:
+	static constexpr uint32_t MAX_THREADS = 8; //the calling thread included
+	static constexpr uint32_t MAX_CHUNKS = 256;
+
+	//every thread gets a few runs, so that one taking longer does not hold the others back
+	static constexpr uint32_t CHUNKS_PER_THREAD = 8;
+	static constexpr uint32_t MIN_CHUNK_ITEMS = 4;
+
+	struct Stream
+	{
+		DrawQueue drawQueue;
+		InstanceBatcher instanceBatcher;
+	};
+
+	struct Stats
+	{
+		uint32_t numThreads;
+		uint32_t numItems;
+		uint32_t numChunks;
+	};
+
+private:
+	//a run of items, and where its thread recorded them
+	struct Chunk
+	{
+		uint32_t firstItem;
+		uint32_t numItems;
+		uint32_t streamIndex;
+		uint32_t firstPacket, numPackets;
+		uint32_t firstMatrix, numMatrices;
+		uint32_t firstTransform, numTransforms;
+		uint32_t firstInstance, numInstances;
+	};
+
+	typedef void (*RecordFunction)(void *context, Stream &stream, uint32_t item);
+
+	Stream streams[MAX_THREADS];
+	Chunk chunks[MAX_CHUNKS];
+	uint32_t numChunks;
+	Stats stats;
+
+	//worker threads, waiting for new items to record
+	std::thread workers[MAX_THREADS - 1];
+	uint32_t numThreads;
+	std::mutex mutex;
+	std::condition_variable jobStarted;
+	uint32_t jobNumber;
+	bool quit;
+
+	RecordFunction recordFunction;
+	void *recordContext;
+	std::atomic<uint32_t> nextChunk;
+	std::atomic<uint32_t> numChunksDone;
+
+	void RecordChunks(uint32_t streamIndex);
+	void WorkerLoop(uint32_t streamIndex);
+	void Run(uint32_t numItems, RecordFunction function, void *context);
+
+public:
+	DrawRecorder():
+		chunks(),
+		numChunks(0),
+		stats(),
+		numThreads(0),
+		jobNumber(0),
+		quit(false),
+		recordFunction(nullptr),
+		recordContext(nullptr),
+		nextChunk(0),
+		numChunksDone(0)
+	{}
+
+	/// <summary>
+	/// Creates the streams and starts the worker threads.
+	/// </summary>
+	/// <param name="numRequestedThreads">how many threads to record on, the calling thread included, 0 for one per core</param>
+	/// <param name="maxPackets">as many packets and matrices as the frame's queue, a thread possibly recording all of them</param>
+	/// <param name="maxTransforms">as many transforms and parts as the frame's batcher</param>
+	bool Create(uint32_t numRequestedThreads, uint32_t maxPackets, uint32_t maxMatrices, uint32_t maxTransforms, uint32_t maxInstances);
+	void Destroy();
+
+	/// <summary>
+	/// Calls work(stream, item) for every item from 0 to @numItems, on every thread, and returns once they are all recorded.
+	/// The calls for the same stream never overlap, but those for different streams do, so @work must only write to its stream.
+	/// </summary>
+	template <typename Work>
+	void Record(uint32_t numItems, Work &work)
+	{
+		Run(numItems, [](void *context, Stream &stream, uint32_t item) { (*(Work *)context)(stream, item); }, &work);
+	}
+
+	//appends what has been recorded to the frame's queue and batcher, in the order of the items
+	void Merge(DrawQueue &drawQueue, InstanceBatcher &instanceBatcher) const;
+
+	uint32_t GetNumThreads() const
+	{
+		return numThreads;
+	}
+
+	const Stats &GetStats() const
+	{
+		return stats;
+	}
+};
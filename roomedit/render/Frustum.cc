@@ -0,0 +1,49 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "Frustum.hh"
+
+//a + sign * b, on all 4 components (Vector's operators leave w alone)
+static inline Vector Combine(const Vector &a, const Vector &b, float sign)
+{
+	return Vector(a.x + sign * b.x, a.y + sign * b.y, a.z + sign * b.z, a.w + sign * b.w);
+}
+
+void Frustum::Extract(const Matrix &m)
+{
+	//points are transformed as row vectors, so each clip-space coordinate is the dot product with a column
+	Vector x(m[0].x, m[1].x, m[2].x, m[3].x);
+	Vector y(m[0].y, m[1].y, m[2].y, m[3].y);
+	Vector z(m[0].z, m[1].z, m[2].z, m[3].z);
+	Vector w(m[0].w, m[1].w, m[2].w, m[3].w);
+
+	planes[0] = Combine(w, x, 1.0f);	//left
+	planes[1] = Combine(w, x, -1.0f);	//right
+	planes[2] = Combine(w, y, 1.0f);	//bottom
+	planes[3] = Combine(w, y, -1.0f);	//top
+	planes[4] = z;						//near (depth goes from 0 to w)
+	planes[5] = Combine(w, z, -1.0f);	//far
+
+	for (auto &plane : planes)
+	{
+		float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		if (length > 0.0f)
+			plane = Vector(plane.x / length, plane.y / length, plane.z / length, plane.w / length);
+	}
+}
+
+bool Frustum::IsBoxVisible(const BBox &box) const
+{
+	for (const auto &plane : planes)
+	{
+		//test the corner that goes the furthest along the plane's normal
+		float x = plane.x >= 0.0f ? box.max.x : box.min.x;
+		float y = plane.y >= 0.0f ? box.max.y : box.min.y;
+		float z = plane.z >= 0.0f ? box.max.z : box.min.z;
+		if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "common/matrix.inl"
+#include "../BBox.hh"
+#include <stdint.h>
+
+/// <summary>
+/// The 6 planes bounding what a transform projects onto the screen.
+/// Extracted from a (world-)view-projection matrix, the planes live in the space that matrix transforms from,
+/// so a room's parts can be tested in room space by using the room's own world-view-projection.
+/// </summary>
+class Frustum
+{
+public:
+	static constexpr uint32_t NUM_PLANES = 6;
+
+private:
+	//normal (pointing inside) in xyz, distance in w
+	Vector planes[NUM_PLANES];
+
+public:
+	Frustum() = default;
+	Frustum(const Matrix &worldViewProjection)
+	{
+		Extract(worldViewProjection);
+	}
+
+	void Extract(const Matrix &worldViewProjection);
+
+	const Vector &GetPlane(uint32_t index) const
+	{
+		return planes[index];
+	}
+
+	//returns false only if the box is entirely behind one of the planes
+	bool IsBoxVisible(const BBox &box) const;
+};
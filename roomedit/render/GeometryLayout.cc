@@ -0,0 +1,72 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "GeometryLayout.hh"
+#include <assert.h>
+
+void GeometryLayout::Reset()
+{
+	numFormats = 0;
+	numIndices = 0;
+}
+
+uint32_t GeometryLayout::AddVertexFormat(uint32_t stride)
+{
+	assert(stride > 0);
+	if (numFormats == MAX_VERTEX_FORMATS)
+		return INVALID_FORMAT;
+
+	pools[numFormats].stride = stride;
+	pools[numFormats].numVertices = 0;
+	return numFormats++;
+}
+
+GeometryLayout::Range GeometryLayout::Place(uint32_t format, uint32_t numVertices, uint32_t numIndices)
+{
+	assert(format < numFormats);
+
+	Range range;
+	range.format = format;
+
+	//vertices are addressed through the base vertex, so no need to align them
+	range.baseVertex = pools[format].numVertices;
+	range.numVertices = numVertices;
+	pools[format].numVertices += numVertices;
+
+	range.startIndex = AlignUp(this->numIndices, INDEX_ALIGNMENT);
+	range.numIndices = numIndices;
+	this->numIndices = range.startIndex + numIndices;
+
+	return range;
+}
+
+uint32_t GeometryLayout::GetStride(uint32_t format) const
+{
+	assert(format < numFormats);
+	return pools[format].stride;
+}
+
+uint32_t GeometryLayout::GetNumVertices(uint32_t format) const
+{
+	assert(format < numFormats);
+	return pools[format].numVertices;
+}
+
+uint32_t GeometryLayout::GetVertexBufferSize(uint32_t format) const
+{
+	assert(format < numFormats);
+	return AlignUp(pools[format].numVertices * pools[format].stride, BUFFER_SIZE_ALIGNMENT);
+}
+
+uint32_t GeometryLayout::GetIndexBufferSize() const
+{
+	return AlignUp(numIndices * sizeof(uint32_t), BUFFER_SIZE_ALIGNMENT);
+}
+
+uint32_t GeometryLayout::GetVertexDataOffset(const Range &range) const
+{
+	assert(range.format < numFormats);
+	return range.baseVertex * pools[range.format].stride;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <stdint.h>
+
+/// <summary>
+/// Plans how meshes are packed into a few big shared buffers: one vertex buffer per vertex format,
+/// and a single index buffer shared by all the formats.
+/// Each mesh is then addressed by its base vertex and start index, so a whole pipeline's worth of
+/// meshes can be drawn with a single vertex/index buffer binding.
+/// This only computes offsets and sizes, it does not touch any graphics API.
+/// </summary>
+class GeometryLayout
+{
+public:
+	static constexpr uint32_t MAX_VERTEX_FORMATS = 4;
+	static constexpr uint32_t INVALID_FORMAT = 0xFFFFFFFF;
+
+	//every mesh's start index is a multiple of this many indices, which puts its 32-bit indices on a 16-byte boundary
+	static constexpr uint32_t INDEX_ALIGNMENT = 4;
+	//buffer sizes are rounded up to this many bytes
+	static constexpr uint32_t BUFFER_SIZE_ALIGNMENT = 256;
+
+	//where a mesh lives inside the shared buffers
+	struct Range
+	{
+		uint32_t format;
+		uint32_t baseVertex;
+		uint32_t numVertices;
+		uint32_t startIndex;
+		uint32_t numIndices;
+
+		constexpr Range() :
+			format(INVALID_FORMAT), baseVertex(0), numVertices(0), startIndex(0), numIndices(0)
+		{}
+	};
+
+private:
+	struct VertexPool
+	{
+		uint32_t stride;
+		uint32_t numVertices;
+	};
+	VertexPool pools[MAX_VERTEX_FORMATS];
+	uint32_t numFormats;
+	uint32_t numIndices;
+
+	static uint32_t AlignUp(uint32_t value, uint32_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+public:
+	constexpr GeometryLayout() :
+		pools(), numFormats(0), numIndices(0)
+	{}
+
+	//forgets every format and placed mesh
+	void Reset();
+
+	//registers a vertex format and returns its identifier, or INVALID_FORMAT if there are too many
+	uint32_t AddVertexFormat(uint32_t stride);
+
+	//reserves space for a mesh in the shared buffers
+	Range Place(uint32_t format, uint32_t numVertices, uint32_t numIndices);
+
+	uint32_t GetNumFormats() const
+	{
+		return numFormats;
+	}
+
+	uint32_t GetStride(uint32_t format) const;
+	uint32_t GetNumVertices(uint32_t format) const;
+	uint32_t GetNumIndices() const
+	{
+		return numIndices;
+	}
+
+	//sizes, in bytes, of the buffers to create
+	uint32_t GetVertexBufferSize(uint32_t format) const;
+	uint32_t GetIndexBufferSize() const;
+
+	//offsets, in bytes, of a placed mesh's data inside the buffers
+	uint32_t GetVertexDataOffset(const Range &range) const;
+	uint32_t GetIndexDataOffset(const Range &range) const
+	{
+		return range.startIndex * sizeof(uint32_t);
+	}
+};
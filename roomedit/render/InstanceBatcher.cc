@@ -0,0 +1,150 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "InstanceBatcher.hh"
+#include <algorithm> //std::sort
+#include <string.h> //memcpy
+
+bool InstanceBatcher::Create(uint32_t maxTransforms, uint32_t maxInstances)
+{
+	uint32_t size =
+		maxTransforms * sizeof(Matrix) +
+		maxInstances * sizeof(Instance) +
+		maxInstances * sizeof(SortEntry) +
+		maxInstances * sizeof(Batch) +
+		maxInstances * sizeof(Matrix) +
+		5 * 16;
+	if (!pool.Create(size))
+		return false;
+
+	transforms = Array<Matrix>(pool.Allocate<Matrix>(maxTransforms, 16), maxTransforms);
+	instances = Array<Instance>(pool.Allocate<Instance>(maxInstances, 16), maxInstances);
+	order = Array<SortEntry>(pool.Allocate<SortEntry>(maxInstances, 16), maxInstances);
+	batches = Array<Batch>(pool.Allocate<Batch>(maxInstances, 16), maxInstances);
+	gatheredTransforms = Array<Matrix>(pool.Allocate<Matrix>(maxInstances, 16), maxInstances);
+	Reset();
+	return true;
+}
+
+void InstanceBatcher::Destroy()
+{
+	pool.Destroy();
+	transforms = Array<Matrix>();
+	instances = Array<Instance>();
+	order = Array<SortEntry>();
+	batches = Array<Batch>();
+	gatheredTransforms = Array<Matrix>();
+	Reset();
+}
+
+void InstanceBatcher::Reset()
+{
+	numTransforms = 0;
+	numInstances = 0;
+	numBatches = 0;
+	stats = {};
+}
+
+uint32_t InstanceBatcher::AddTransform(const Matrix &m)
+{
+	if (numTransforms == transforms.Count())
+		return INVALID_INDEX;
+
+	transforms[numTransforms] = m;
+	return numTransforms++;
+}
+
+void InstanceBatcher::Add(uint32_t textureIndex, uint32_t numIndices, uint32_t startIndex, int32_t baseVertex, uint32_t transformIndex, float depth)
+{
+	assert(transformIndex < numTransforms);
+	if (numInstances == instances.Count())
+	{
+		stats.numDropped++;
+		return;
+	}
+
+	Instance &instance = instances[numInstances++];
+	instance.textureIndex = textureIndex;
+	instance.numIndices = numIndices;
+	instance.startIndex = startIndex;
+	instance.baseVertex = baseVertex;
+	instance.transformIndex = transformIndex;
+	instance.depth = depth;
+}
+
+void InstanceBatcher::Append(const InstanceBatcher &source, uint32_t firstTransform, uint32_t count, uint32_t firstInstance, uint32_t numSourceInstances)
+{
+	assert(firstTransform + count <= source.numTransforms && firstInstance + numSourceInstances <= source.numInstances);
+	if (count > transforms.Count() - numTransforms || numSourceInstances > instances.Count() - numInstances)
+	{
+		stats.numDropped += numSourceInstances;
+		return;
+	}
+
+	uint32_t transformOffset = numTransforms;
+	memcpy(transforms.Data() + numTransforms, source.transforms.Data() + firstTransform, count * sizeof(Matrix));
+	numTransforms += count;
+
+	for (uint32_t i = firstInstance; i < firstInstance + numSourceInstances; i++)
+	{
+		Instance &instance = instances[numInstances++];
+		instance = source.instances[i];
+		assert(instance.transformIndex >= firstTransform && instance.transformIndex < firstTransform + count);
+		instance.transformIndex = instance.transformIndex - firstTransform + transformOffset;
+	}
+}
+
+void InstanceBatcher::Build()
+{
+	//the parts drawing the same indices with the same texture end up next to each other,
+	//in the order they were added so that the batches do not change from a frame to the next
+	//the start index is enough to tell the parts apart, the other values only split the batches
+	for (uint32_t i = 0; i < numInstances; i++)
+	{
+		const Instance &instance = instances[i];
+		order[i].key = (uint64_t(instance.startIndex) << 32) | instance.textureIndex;
+		order[i].instanceIndex = i;
+	}
+	std::sort(order.Data(), order.Data() + numInstances, [](const SortEntry &a, const SortEntry &b)
+	{
+		return a.key != b.key ? a.key < b.key : a.instanceIndex < b.instanceIndex;
+	});
+
+	auto isSamePart = [](const Instance &a, const Instance &b)
+	{
+		return a.startIndex == b.startIndex && a.numIndices == b.numIndices && a.baseVertex == b.baseVertex && a.textureIndex == b.textureIndex;
+	};
+
+	numBatches = 0;
+	for (uint32_t i = 0; i < numInstances; i++)
+	{
+		const Instance &instance = instances[order[i].instanceIndex];
+		gatheredTransforms[i] = transforms[instance.transformIndex];
+
+		if (i != 0 && isSamePart(instances[order[i - 1].instanceIndex], instance))
+		{
+			Batch &batch = batches[numBatches - 1];
+			batch.numInstances++;
+			if (instance.depth < batch.depth)
+				batch.depth = instance.depth;
+			continue;
+		}
+
+		Batch &batch = batches[numBatches++];
+		batch.textureIndex = instance.textureIndex;
+		batch.numIndices = instance.numIndices;
+		batch.startIndex = instance.startIndex;
+		batch.baseVertex = instance.baseVertex;
+		batch.firstInstance = i;
+		batch.numInstances = 1;
+		batch.depth = instance.depth;
+	}
+
+	stats.numInstances = numInstances;
+	stats.numBatches = numBatches;
+	stats.numInstancedBatches = 0;
+	for (uint32_t b = 0; b < numBatches; b++)
+		stats.numInstancedBatches += batches[b].numInstances > 1 ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "common/matrix.inl"
+#include <stdint.h>
+#include <assert.h>
+
+/// <summary>
+/// Groups the parts of the objects that share the same mesh, so that all of their copies are drawn at once.
+/// Every visible part of an object is added along with the transform of its object, then the parts
+/// drawing the same indices with the same texture are gathered into batches whose transforms follow each other.
+/// It only depends on the math and memory modules, so it can be driven without any renderer.
+/// </summary>
+class InstanceBatcher
+{
+public:
+	static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	struct Batch
+	{
+		uint32_t textureIndex;
+		uint32_t numIndices;
+		uint32_t startIndex;
+		int32_t baseVertex;
+		uint32_t firstInstance; //in the gathered transforms
+		uint32_t numInstances;
+		float depth; //of the nearest instance
+	};
+
+	struct Stats
+	{
+		uint32_t numInstances; //the draws it would take without instancing
+		uint32_t numBatches; //the draws it takes
+		uint32_t numInstancedBatches; //those drawing more than one instance
+		uint32_t numDropped; //the parts that did not fit
+	};
+
+private:
+	struct Instance
+	{
+		uint32_t textureIndex;
+		uint32_t numIndices;
+		uint32_t startIndex;
+		int32_t baseVertex;
+		uint32_t transformIndex;
+		float depth;
+	};
+
+	struct SortEntry
+	{
+		uint64_t key; //the start index and the texture of the part
+		uint32_t instanceIndex;
+	};
+
+	MemoryPool pool;
+	Array<Matrix> transforms;
+	Array<Instance> instances;
+	Array<SortEntry> order; //the instances, sorted by what they draw
+	Array<Batch> batches;
+	Array<Matrix> gatheredTransforms; //the transforms of every batch's instances, batch after batch
+	uint32_t numTransforms;
+	uint32_t numInstances;
+	uint32_t numBatches;
+	Stats stats;
+
+public:
+	InstanceBatcher():
+		numTransforms(0),
+		numInstances(0),
+		numBatches(0),
+		stats()
+	{}
+
+	bool Create(uint32_t maxTransforms, uint32_t maxInstances);
+	void Destroy();
+
+	//empties the batcher, to be called at the start of every frame
+	void Reset();
+
+	//returns the index to give to the parts drawn with @m, or INVALID_INDEX if the batcher is full
+	uint32_t AddTransform(const Matrix &m);
+
+	/// <summary>
+	/// Adds a part of an object to draw, the parts sharing the same indices and texture being drawn together.
+	/// </summary>
+	/// <param name="transformIndex">as returned by AddTransform</param>
+	/// <param name="depth">the distance to the camera</param>
+	void Add(uint32_t textureIndex, uint32_t numIndices, uint32_t startIndex, int32_t baseVertex, uint32_t transformIndex, float depth);
+
+	/// <summary>
+	/// Adds transforms and parts added to another batcher, as if they had been added to this one.
+	/// The parts' transforms have to be among those appended along with them.
+	/// </summary>
+	void Append(const InstanceBatcher &source, uint32_t firstTransform, uint32_t count, uint32_t firstInstance, uint32_t numSourceInstances);
+
+	uint32_t GetNumTransforms() const
+	{
+		return numTransforms;
+	}
+
+	uint32_t GetNumInstances() const
+	{
+		return numInstances;
+	}
+
+	//groups the parts added since the last Reset into batches
+	void Build();
+
+	uint32_t GetNumBatches() const
+	{
+		return numBatches;
+	}
+
+	const Batch &GetBatch(uint32_t i) const
+	{
+		assert(i < numBatches);
+		return batches[i];
+	}
+
+	//as many as there are parts, the instances of a batch starting at its firstInstance
+	const Matrix *GetGatheredTransforms() const
+	{
+		return gatheredTransforms.Data();
+	}
+
+	uint32_t GetNumGatheredTransforms() const
+	{
+		return numInstances;
+	}
+
+	const Stats &GetStats() const
+	{
+		return stats;
+	}
+};
@@ -0,0 +1,413 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "OcclusionCuller.hh"
+#include <float.h> //FLT_MAX
+#include <xmmintrin.h>
+
+//occluder vertices closer than this (in clip-space w) are not rasterized
+static constexpr float NEAR_W = 1.0f;
+
+//a box is tested against at most this many texels per side, picking the level accordingly
+static constexpr uint32_t MAX_TEST_TEXELS = 4;
+
+static inline Vector TransformPoint(const Matrix &m, float x, float y, float z)
+{
+	return Vector(
+		x * m[0].x + y * m[1].x + z * m[2].x + m[3].x,
+		x * m[0].y + y * m[1].y + z * m[2].y + m[3].y,
+		x * m[0].z + y * m[1].z + z * m[2].z + m[3].z,
+		x * m[0].w + y * m[1].w + z * m[2].w + m[3].w
+	);
+}
+
+static inline uint32_t GetLevelWidth(uint32_t level)
+{
+	return OcclusionCuller::WIDTH >> level;
+}
+
+static inline uint32_t GetLevelHeight(uint32_t level)
+{
+	return OcclusionCuller::HEIGHT >> level;
+}
+
+bool OcclusionCuller::Create(uint32_t maxTriangles, uint32_t maxPositions)
+{
+	uint32_t levelsSize = 0;
+	for (uint32_t l = 0; l < NUM_HIZ_LEVELS; l++)
+		levelsSize += GetLevelWidth(l) * GetLevelHeight(l) * sizeof(float) + 16;
+
+	uint32_t size = levelsSize +
+		maxPositions * sizeof(Vector) + 16 +
+		maxTriangles * sizeof(Triangle) + 16 +
+		maxTriangles * NUM_TILES * sizeof(uint32_t) + 16;
+	if (!pool.Create(size))
+		return false;
+
+	for (uint32_t l = 0; l < NUM_HIZ_LEVELS; l++)
+		levels[l] = pool.Allocate<float>(GetLevelWidth(l) * GetLevelHeight(l), 16);
+
+	clipPositions = pool.Allocate<Vector>(maxPositions, 16);
+	this->maxPositions = maxPositions;
+
+	triangles = pool.Allocate<Triangle>(maxTriangles, 16);
+	numTriangles = 0;
+	this->maxTriangles = maxTriangles;
+
+	//a triangle may overlap every tile
+	binnedTriangles = pool.Allocate<uint32_t>(maxTriangles * NUM_TILES, 16);
+
+	//the calling thread helps too, so leave it a core
+	numWorkers = std::thread::hardware_concurrency();
+	numWorkers = numWorkers > 1 ? numWorkers - 1 : 0;
+	if (numWorkers > MAX_WORKERS)
+		numWorkers = MAX_WORKERS;
+
+	quit = false;
+	frameNumber = 0;
+	for (uint32_t i = 0; i < numWorkers; i++)
+		workers[i] = std::thread(&OcclusionCuller::WorkerLoop, this);
+
+	//nothing is hidden until a frame has been rasterized
+	BeginFrame(Matrix());
+	return true;
+}
+
+void OcclusionCuller::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	frameStarted.notify_all();
+	for (uint32_t i = 0; i < numWorkers; i++)
+		workers[i].join();
+	numWorkers = 0;
+
+	pool.Destroy();
+	for (auto &level : levels)
+		level = nullptr;
+	clipPositions = nullptr;
+	triangles = nullptr;
+	binnedTriangles = nullptr;
+	maxPositions = 0;
+	maxTriangles = 0;
+	numTriangles = 0;
+}
+
+void OcclusionCuller::BeginFrame(const Matrix &viewProjection)
+{
+	assert(!rasterizing);
+
+	this->viewProjection = viewProjection;
+	numTriangles = 0;
+
+	lastFrameStats.numTested = numTested.exchange(0, std::memory_order_relaxed);
+	lastFrameStats.numCulled = numCulled.exchange(0, std::memory_order_relaxed);
+
+	//everything starts as far as it can be
+	for (uint32_t l = 0; l < NUM_HIZ_LEVELS; l++)
+	{
+		float *level = levels[l];
+		for (uint32_t i = 0; i < GetLevelWidth(l) * GetLevelHeight(l); i++)
+			level[i] = 1.0f;
+	}
+}
+
+void OcclusionCuller::AddOccluder(const Matrix &worldViewProjection, const Vector3 *positions, uint32_t numPositions, const uint32_t *indices, uint32_t numIndices)
+{
+	assert(!rasterizing);
+	if (numPositions > maxPositions)
+		return;
+
+	//bring every position into the depth buffer's space, keeping w for the near-plane check
+	for (uint32_t i = 0; i < numPositions; i++)
+	{
+		Vector clip = TransformPoint(worldViewProjection, positions[i].x, positions[i].y, positions[i].z);
+		if (clip.w >= NEAR_W)
+		{
+			float invW = 1.0f / clip.w;
+			clip.x = (clip.x * invW * 0.5f + 0.5f) * (float)WIDTH;
+			clip.y = (0.5f - clip.y * invW * 0.5f) * (float)HEIGHT;
+			clip.z = clip.z * invW;
+		}
+		clipPositions[i] = clip;
+	}
+
+	for (uint32_t i = 0; i + 3 <= numIndices && numTriangles < maxTriangles; i += 3)
+	{
+		const Vector &v0 = clipPositions[indices[i + 0]];
+		const Vector &v1 = clipPositions[indices[i + 1]];
+		const Vector &v2 = clipPositions[indices[i + 2]];
+
+		//leaving out a triangle can only make things more visible
+		if (v0.w < NEAR_W || v1.w < NEAR_W || v2.w < NEAR_W)
+			continue;
+
+		float minX = fminf(v0.x, fminf(v1.x, v2.x));
+		float minY = fminf(v0.y, fminf(v1.y, v2.y));
+		float maxX = fmaxf(v0.x, fmaxf(v1.x, v2.x));
+		float maxY = fmaxf(v0.y, fmaxf(v1.y, v2.y));
+		if (maxX < 0.0f || maxY < 0.0f || minX >= (float)WIDTH || minY >= (float)HEIGHT)
+			continue;
+
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+		if (fabsf(area) < 1e-6f)
+			continue;
+
+		//occluders hide things whichever side they show, so orient every triangle the same way
+		const Vector *a = &v0;
+		const Vector *b = area > 0.0f ? &v1 : &v2;
+		const Vector *c = area > 0.0f ? &v2 : &v1;
+		float invArea = 1.0f / fabsf(area);
+
+		Triangle &triangle = triangles[numTriangles++];
+
+		//edge i is positive on the side of the triangle's inside, and 1 at the opposite vertex once scaled
+		const Vector *edgeStart[3] = { b, c, a };
+		const Vector *edgeEnd[3] = { c, a, b };
+		for (uint32_t e = 0; e < 3; e++)
+		{
+			triangle.edgeA[e] = (edgeStart[e]->y - edgeEnd[e]->y) * invArea;
+			triangle.edgeB[e] = (edgeEnd[e]->x - edgeStart[e]->x) * invArea;
+			triangle.edgeC[e] = (edgeStart[e]->x * edgeEnd[e]->y - edgeStart[e]->y * edgeEnd[e]->x) * invArea;
+		}
+
+		//the edge functions are the barycentric coordinates, which interpolate the depth
+		triangle.depthX = triangle.edgeA[0] * a->z + triangle.edgeA[1] * b->z + triangle.edgeA[2] * c->z;
+		triangle.depthY = triangle.edgeB[0] * a->z + triangle.edgeB[1] * b->z + triangle.edgeB[2] * c->z;
+		triangle.depth0 = triangle.edgeC[0] * a->z + triangle.edgeC[1] * b->z + triangle.edgeC[2] * c->z;
+
+		triangle.minX = minX < 0.0f ? 0 : (int32_t)minX;
+		triangle.minY = minY < 0.0f ? 0 : (int32_t)minY;
+		triangle.maxX = maxX >= (float)WIDTH ? WIDTH - 1 : (int32_t)maxX;
+		triangle.maxY = maxY >= (float)HEIGHT ? HEIGHT - 1 : (int32_t)maxY;
+	}
+}
+
+void OcclusionCuller::BinTriangles()
+{
+	for (uint32_t t = 0; t < NUM_TILES; t++)
+		tileNumTriangles[t] = 0;
+
+	//the triangles of a tile are stored after those of the previous tile, each tile having room for all of them
+	for (uint32_t t = 0; t < NUM_TILES; t++)
+		tileStart[t] = t * maxTriangles;
+
+	for (uint32_t i = 0; i < numTriangles; i++)
+	{
+		const Triangle &triangle = triangles[i];
+		uint32_t tileMinX = triangle.minX / TILE_SIZE;
+		uint32_t tileMinY = triangle.minY / TILE_SIZE;
+		uint32_t tileMaxX = triangle.maxX / TILE_SIZE;
+		uint32_t tileMaxY = triangle.maxY / TILE_SIZE;
+		for (uint32_t y = tileMinY; y <= tileMaxY; y++)
+		{
+			for (uint32_t x = tileMinX; x <= tileMaxX; x++)
+			{
+				uint32_t tile = y * NUM_TILES_X + x;
+				binnedTriangles[tileStart[tile] + tileNumTriangles[tile]++] = i;
+			}
+		}
+	}
+}
+
+void OcclusionCuller::RasterizeTile(uint32_t tileIndex)
+{
+	int32_t tileX = (int32_t)(tileIndex % NUM_TILES_X * TILE_SIZE);
+	int32_t tileY = (int32_t)(tileIndex / NUM_TILES_X * TILE_SIZE);
+	float *depth = levels[0];
+
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+
+	const uint32_t *binned = binnedTriangles + tileStart[tileIndex];
+	for (uint32_t i = 0; i < tileNumTriangles[tileIndex]; i++)
+	{
+		const Triangle &triangle = triangles[binned[i]];
+
+		//only the part of the triangle's rectangle inside the tile, in groups of 4 pixels
+		int32_t minX = (triangle.minX > tileX ? triangle.minX : tileX) & ~3;
+		int32_t minY = triangle.minY > tileY ? triangle.minY : tileY;
+		int32_t maxX = triangle.maxX < tileX + (int32_t)TILE_SIZE - 1 ? triangle.maxX : tileX + (int32_t)TILE_SIZE - 1;
+		int32_t maxY = triangle.maxY < tileY + (int32_t)TILE_SIZE - 1 ? triangle.maxY : tileY + (int32_t)TILE_SIZE - 1;
+
+		__m128 edgeA[3], edgeB[3], edgeC[3];
+		for (uint32_t e = 0; e < 3; e++)
+		{
+			edgeA[e] = _mm_set1_ps(triangle.edgeA[e]);
+			edgeB[e] = _mm_set1_ps(triangle.edgeB[e]);
+			edgeC[e] = _mm_set1_ps(triangle.edgeC[e]);
+		}
+		__m128 depthX = _mm_set1_ps(triangle.depthX);
+
+		for (int32_t y = minY; y <= maxY; y++)
+		{
+			__m128 pixelY = _mm_set1_ps((float)y + 0.5f);
+			__m128 rowEdge[3];
+			for (uint32_t e = 0; e < 3; e++)
+				rowEdge[e] = _mm_add_ps(_mm_mul_ps(edgeB[e], pixelY), edgeC[e]);
+			__m128 rowDepth = _mm_set1_ps(triangle.depthY * ((float)y + 0.5f) + triangle.depth0);
+
+			float *row = depth + y * WIDTH;
+			for (int32_t x = minX; x <= maxX; x += 4)
+			{
+				__m128 pixelX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+
+				//inside when every edge function is positive
+				__m128 e0 = _mm_add_ps(_mm_mul_ps(edgeA[0], pixelX), rowEdge[0]);
+				__m128 e1 = _mm_add_ps(_mm_mul_ps(edgeA[1], pixelX), rowEdge[1]);
+				__m128 e2 = _mm_add_ps(_mm_mul_ps(edgeA[2], pixelX), rowEdge[2]);
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				__m128 pixelDepth = _mm_add_ps(_mm_mul_ps(depthX, pixelX), rowDepth);
+				__m128 previousDepth = _mm_load_ps(row + x);
+				__m128 closestDepth = _mm_min_ps(previousDepth, pixelDepth);
+				_mm_store_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closestDepth), _mm_andnot_ps(inside, previousDepth)));
+			}
+		}
+	}
+}
+
+//claims tiles until none is left
+void OcclusionCuller::RasterizeTiles()
+{
+	for (uint32_t tile = nextTile++; tile < NUM_TILES; tile = nextTile++)
+	{
+		RasterizeTile(tile);
+		numTilesDone++;
+	}
+}
+
+void OcclusionCuller::WorkerLoop()
+{
+	uint32_t lastFrameNumber = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			frameStarted.wait(lock, [&]() { return quit || frameNumber != lastFrameNumber; });
+			if (quit)
+				return;
+			lastFrameNumber = frameNumber;
+		}
+
+		RasterizeTiles();
+	}
+}
+
+void OcclusionCuller::Rasterize()
+{
+	assert(!rasterizing);
+	BinTriangles();
+
+	nextTile = 0;
+	numTilesDone = 0;
+	rasterizing = true;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		frameNumber++;
+	}
+	frameStarted.notify_all();
+}
+
+void OcclusionCuller::BuildHierarchicalZ()
+{
+	//every texel keeps the farthest of the 4 it covers
+	for (uint32_t l = 1; l < NUM_HIZ_LEVELS; l++)
+	{
+		const float *source = levels[l - 1];
+		float *destination = levels[l];
+		uint32_t sourceWidth = GetLevelWidth(l - 1);
+		uint32_t width = GetLevelWidth(l);
+		uint32_t height = GetLevelHeight(l);
+		for (uint32_t y = 0; y < height; y++)
+		{
+			const float *row0 = source + (2 * y) * sourceWidth;
+			const float *row1 = row0 + sourceWidth;
+			for (uint32_t x = 0; x < width; x++)
+				destination[y * width + x] = fmaxf(fmaxf(row0[2 * x], row0[2 * x + 1]), fmaxf(row1[2 * x], row1[2 * x + 1]));
+		}
+	}
+}
+
+void OcclusionCuller::Finish()
+{
+	if (!rasterizing)
+		return;
+
+	RasterizeTiles();
+
+	//the last tiles may still be in the hands of the workers
+	while (numTilesDone < NUM_TILES)
+		std::this_thread::yield();
+	rasterizing = false;
+
+	BuildHierarchicalZ();
+}
+
+bool OcclusionCuller::IsBoxVisible(const BBox &box)
+{
+	assert(!rasterizing);
+	numTested.fetch_add(1, std::memory_order_relaxed);
+
+	//project the corners, and keep the rectangle they cover along with their nearest depth
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	float minDepth = FLT_MAX;
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		Vector clip = TransformPoint(
+			viewProjection,
+			i & 1 ? box.max.x : box.min.x,
+			i & 2 ? box.max.y : box.min.y,
+			i & 4 ? box.max.z : box.min.z
+		);
+
+		//a box reaching the camera can not be hidden
+		if (clip.w < NEAR_W)
+			return true;
+
+		float invW = 1.0f / clip.w;
+		float x = (clip.x * invW * 0.5f + 0.5f) * (float)WIDTH;
+		float y = (0.5f - clip.y * invW * 0.5f) * (float)HEIGHT;
+		minX = fminf(minX, x);
+		minY = fminf(minY, y);
+		maxX = fmaxf(maxX, x);
+		maxY = fmaxf(maxY, y);
+		minDepth = fminf(minDepth, clip.z * invW);
+	}
+
+	//what is off screen is left to the frustum culling
+	if (maxX < 0.0f || maxY < 0.0f || minX >= (float)WIDTH || minY >= (float)HEIGHT)
+		return true;
+
+	int32_t x0 = minX < 0.0f ? 0 : (int32_t)minX;
+	int32_t y0 = minY < 0.0f ? 0 : (int32_t)minY;
+	int32_t x1 = maxX >= (float)WIDTH ? WIDTH - 1 : (int32_t)maxX;
+	int32_t y1 = maxY >= (float)HEIGHT ? HEIGHT - 1 : (int32_t)maxY;
+
+	//pick the level on which the rectangle covers only a few texels
+	uint32_t level = 0;
+	while (level + 1 < NUM_HIZ_LEVELS && (uint32_t)((x1 >> level) - (x0 >> level)) >= MAX_TEST_TEXELS)
+		level++;
+	while (level + 1 < NUM_HIZ_LEVELS && (uint32_t)((y1 >> level) - (y0 >> level)) >= MAX_TEST_TEXELS)
+		level++;
+
+	const float *depth = levels[level];
+	uint32_t width = GetLevelWidth(level);
+	for (int32_t y = y0 >> level; y <= (y1 >> level); y++)
+	{
+		for (int32_t x = x0 >> level; x <= (x1 >> level); x++)
+		{
+			if (minDepth <= depth[y * width + x])
+				return true;
+		}
+	}
+
+	numCulled.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
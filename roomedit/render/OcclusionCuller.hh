@@ -0,0 +1,147 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "common/matrix.inl"
+#include "../world/Vector3.hh"
+#include "../BBox.hh"
+#include <stdint.h>
+#include <atomic> //std::atomic
+#include <condition_variable> //std::condition_variable
+#include <mutex> //std::mutex
+#include <thread> //std::thread
+
+/// <summary>
+/// Culls what is hidden behind the nearest geometry, without any help from the GPU.
+/// Every frame, a few occluder meshes are rasterized into a small depth buffer, split into tiles
+/// that worker threads fill in parallel, 4 pixels at a time, while the caller goes on recording draws.
+/// Once finished, a hierarchical-Z (a chain of downsampled buffers keeping the farthest depth) is built,
+/// and boxes are tested against it: a box is hidden if its nearest point is behind everything drawn over its screen rectangle.
+/// Occluder triangles crossing the near plane are dropped, so the result is always conservative.
+/// </summary>
+class OcclusionCuller
+{
+public:
+	//resolution of the depth buffer
+	static constexpr uint32_t WIDTH = 256;
+	static constexpr uint32_t HEIGHT = 128;
+
+	//the depth buffer is rasterized tile by tile, each tile by a single thread
+	static constexpr uint32_t TILE_SIZE = 32;
+	static constexpr uint32_t NUM_TILES_X = WIDTH / TILE_SIZE;
+	static constexpr uint32_t NUM_TILES_Y = HEIGHT / TILE_SIZE;
+	static constexpr uint32_t NUM_TILES = NUM_TILES_X * NUM_TILES_Y;
+
+	//the last level is WIDTH / 128 by HEIGHT / 128 pixels
+	static constexpr uint32_t NUM_HIZ_LEVELS = 8;
+
+	static constexpr uint32_t MAX_WORKERS = 8;
+
+	struct Stats
+	{
+		uint32_t numTested;
+		uint32_t numCulled;
+
+		float GetCulledPercentage() const
+		{
+			return numTested ? 100.0f * (float)numCulled / (float)numTested : 0.0f;
+		}
+	};
+
+private:
+	//a triangle ready to be rasterized: edge functions and depth plane, in pixels
+	struct Triangle
+	{
+		float edgeA[3], edgeB[3], edgeC[3];
+		float depth0, depthX, depthY;
+		int32_t minX, minY, maxX, maxY;
+	};
+
+	MemoryPool pool;
+
+	float *levels[NUM_HIZ_LEVELS]; //the depth buffer, then its downsampled versions
+
+	Matrix viewProjection;
+
+	Vector *clipPositions; //scratch for the occluder being added
+	uint32_t maxPositions;
+
+	Triangle *triangles;
+	uint32_t numTriangles;
+	uint32_t maxTriangles;
+
+	//triangles overlapping every tile, tile after tile
+	uint32_t tileStart[NUM_TILES];
+	uint32_t tileNumTriangles[NUM_TILES];
+	uint32_t *binnedTriangles;
+
+	//the boxes may be tested by several threads at once
+	std::atomic<uint32_t> numTested;
+	std::atomic<uint32_t> numCulled;
+	Stats lastFrameStats;
+
+	//worker threads, waiting for a new frame to rasterize
+	std::thread workers[MAX_WORKERS];
+	uint32_t numWorkers;
+	std::mutex mutex;
+	std::condition_variable frameStarted;
+	uint32_t frameNumber;
+	bool quit;
+
+	std::atomic<uint32_t> nextTile;
+	std::atomic<uint32_t> numTilesDone;
+	bool rasterizing;
+
+	void BinTriangles();
+	void RasterizeTile(uint32_t tileIndex);
+	void RasterizeTiles();
+	void BuildHierarchicalZ();
+	void WorkerLoop();
+
+public:
+	OcclusionCuller():
+		levels(),
+		clipPositions(nullptr),
+		maxPositions(0),
+		triangles(nullptr),
+		numTriangles(0),
+		maxTriangles(0),
+		tileStart(),
+		tileNumTriangles(),
+		binnedTriangles(nullptr),
+		numTested(0),
+		numCulled(0),
+		lastFrameStats(),
+		numWorkers(0),
+		frameNumber(0),
+		quit(false),
+		nextTile(0),
+		numTilesDone(0),
+		rasterizing(false)
+	{}
+
+	/// <param name="maxTriangles">how many occluder triangles a frame may hold, the others are ignored</param>
+	/// <param name="maxPositions">the most positions a single occluder may have</param>
+	bool Create(uint32_t maxTriangles, uint32_t maxPositions);
+	void Destroy();
+
+	//clears the depth buffer and forgets the previous occluders
+	void BeginFrame(const Matrix &viewProjection);
+
+	//transforms an occluder into the depth buffer's space, its triangles being 3 position indices each
+	void AddOccluder(const Matrix &worldViewProjection, const Vector3 *positions, uint32_t numPositions, const uint32_t *indices, uint32_t numIndices);
+
+	//starts rasterizing the occluders on the worker threads, and returns right away
+	void Rasterize();
+
+	//waits for (and helps) the workers, then builds the hierarchical-Z
+	void Finish();
+
+	//tells whether a world-space box may be visible, only call between Finish and the next BeginFrame
+	//it may be called from several threads at once
+	bool IsBoxVisible(const BBox &box);
+
+	//how many of the boxes tested during the previous frame were hidden
+	const Stats &GetStats() const
+	{
+		return lastFrameStats;
+	}
+};
@@ -4,6 +4,9 @@
 */
 
 #include "ColoredSurfaceGraphicsPipeline.hh"
+
+//the software renderer shades the pixels itself
+#ifndef SOFTWARE_RASTER
 #include "compiled/ColoredVS.h"
 #include "compiled/ColoredPS.h"
 
@@ -102,3 +105,5 @@ void ColoredSurfaceGraphicsPipeline::Use(ID3D12GraphicsCommandList *commandList)
 	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_LINELIST);
 	commandList->SetPipelineState(pipelineState);
 }
+
+#endif
@@ -4,6 +4,9 @@
 */
 
 #include "LightMappedSurfaceGraphicsPipeline.hh"
+
+//the software renderer shades the pixels itself
+#ifndef SOFTWARE_RASTER
 #include "compiled/LightMappedVS.h"
 #include "compiled/LightMappedPS.h"
 
@@ -124,3 +127,5 @@ void LightMappedSurfaceGraphicsPipeline::Use(ID3D12GraphicsCommandList *commandL
 	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	commandList->SetPipelineState(pipelineState);
 }
+
+#endif
@@ -2,9 +2,19 @@
 #include "sbgraphics/sbRenderer.hh"
 
 //defines the PSO for light-mapped surfaces
+#ifdef SOFTWARE_RASTER
+class LightMappedSurfaceGraphicsPipeline final: public Pipeline
+{
+public:
+	LightMappedSurfaceGraphicsPipeline():
+		Pipeline(SHADING_LIGHTMAPPED)
+	{}
+};
+#else
 class LightMappedSurfaceGraphicsPipeline final: public Pipeline
 {
 public:
 	bool Create(ID3D12Device *device, ID3D12RootSignature *rootSignature, ID3DBlob *blob) override;
 	void Use(ID3D12GraphicsCommandList *commandList) const override;
 };
+#endif
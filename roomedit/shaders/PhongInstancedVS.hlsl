@@ -0,0 +1,13 @@
+#include "globals.hlsl"
+
+PSPhongInput VSMain(VSPhongInstancedInput input)
+{
+	//every instance brings its own world-view-projection matrix, one row per attribute
+	float4x4 worldViewProjection = float4x4(input.transform0, input.transform1, input.transform2, input.transform3);
+
+	PSPhongInput output;
+	output.position = mul(float4(input.position, 1.0f), worldViewProjection);
+	output.normal = input.normal;
+	output.texcoordDiffuse = input.texcoordDiffuse;
+	return output;
+}
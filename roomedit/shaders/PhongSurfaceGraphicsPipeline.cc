@@ -4,8 +4,12 @@
 */
 
 #include "PhongSurfaceGraphicsPipeline.hh"
+
+//the software renderer shades the pixels itself
+#ifndef SOFTWARE_RASTER
 #include "compiled/PhongVS.h"
 #include "compiled/PhongPS.h"
+#include "compiled/PhongInstancedVS.h"
 
 bool PhongSurfaceGraphicsPipeline::Create(ID3D12Device *device, ID3D12RootSignature *rootSignature, ID3DBlob *blob)
 {
@@ -14,14 +18,28 @@ bool PhongSurfaceGraphicsPipeline::Create(ID3D12Device *device, ID3D12RootSignat
 	{
 		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
 		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		//the rows of the instance's matrix, only used when instanced
+		{ "TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 }
 	};
+	UINT numInputElements = isInstanced ? _countof(inputElementDescs) : 3;
 
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
 	psoDesc.pRootSignature = rootSignature;
 
-	psoDesc.VS.pShaderBytecode = g_VSMain;
-	psoDesc.VS.BytecodeLength = sizeof(g_VSMain);
+	if (isInstanced)
+	{
+		psoDesc.VS.pShaderBytecode = g_VSInstancedMain;
+		psoDesc.VS.BytecodeLength = sizeof(g_VSInstancedMain);
+	}
+	else
+	{
+		psoDesc.VS.pShaderBytecode = g_VSMain;
+		psoDesc.VS.BytecodeLength = sizeof(g_VSMain);
+	}
 	psoDesc.PS.pShaderBytecode = g_PSMain;
 	psoDesc.PS.BytecodeLength = sizeof(g_PSMain);
 
@@ -87,7 +105,7 @@ bool PhongSurfaceGraphicsPipeline::Create(ID3D12Device *device, ID3D12RootSignat
 		}
 	};
 	psoDesc.DepthStencilState = MY_DEPTH_STENCIL_DESC();
-	psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
+	psoDesc.InputLayout = { inputElementDescs, numInputElements };
 
 	psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
 
@@ -108,3 +126,5 @@ void PhongSurfaceGraphicsPipeline::Use(ID3D12GraphicsCommandList *commandList) c
 	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	commandList->SetPipelineState(pipelineState);
 }
+
+#endif
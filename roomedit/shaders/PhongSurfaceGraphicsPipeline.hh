@@ -2,9 +2,26 @@
 #include "sbgraphics/sbRenderer.hh"
 
 //defines the PSO for Phong-shaded surfaces
+//the instanced one reads the world-view-projection matrix of every instance from the second vertex buffer
+#ifdef SOFTWARE_RASTER
 class PhongSurfaceGraphicsPipeline final: public Pipeline
 {
 public:
+	PhongSurfaceGraphicsPipeline(bool isInstanced = false):
+		Pipeline(SHADING_PHONG, isInstanced)
+	{}
+};
+#else
+class PhongSurfaceGraphicsPipeline final: public Pipeline
+{
+	bool isInstanced;
+
+public:
+	PhongSurfaceGraphicsPipeline(bool isInstanced = false):
+		isInstanced(isInstanced)
+	{}
+
 	bool Create(ID3D12Device *device, ID3D12RootSignature *rootSignature, ID3DBlob *blob) override;
 	void Use(ID3D12GraphicsCommandList *commandList) const override;
 };
+#endif
@@ -6,4 +6,5 @@ dxc /T vs_6_0 /E VSMain /O2 /Fh compiled\LightMappedVS.h LightMappedVS.hlsl
 dxc /T ps_6_0 /E PSMain /O2 /Fh compiled\LightMappedPS.h LightMappedPS.hlsl
 dxc /T vs_6_0 /E VSMain /O2 /Fh compiled\PhongVS.h PhongVS.hlsl
 dxc /T ps_6_0 /E PSMain /O2 /Fh compiled\PhongPS.h PhongPS.hlsl
+dxc /T vs_6_0 /E VSMain /Vn g_VSInstancedMain /O2 /Fh compiled\PhongInstancedVS.h PhongInstancedVS.hlsl
 echo Finished
@@ -0,0 +1,464 @@
+#if 0
+;
+; Input signature:
+;
+; Name                 Index   Mask Register SysValue  Format   Used
+; -------------------- ----- ------ -------- -------- ------- ------
+; POSITION                 0   xyz         0     NONE   float   xyz 
+; NORMAL                   0   xyz         1     NONE   float   xyz 
+; TEXCOORD                 0   xy          2     NONE   float   xy  
+; TRANSFORM                0   xyzw        3     NONE   float   xyzw
+; TRANSFORM                1   xyzw        4     NONE   float   xyzw
+; TRANSFORM                2   xyzw        5     NONE   float   xyzw
+; TRANSFORM                3   xyzw        6     NONE   float   xyzw
+;
+;
+; Output signature:
+;
+; Name                 Index   Mask Register SysValue  Format   Used
+; -------------------- ----- ------ -------- -------- ------- ------
+; SV_Position              0   xyzw        0      POS   float   xyzw
+; NORMAL                   0   xyz         1     NONE   float   xyz 
+; TEXCOORD                 0   xy          2     NONE   float   xy  
+;
+; shader hash: 4023ed67e875f4319161284bd9e08233
+;
+; Pipeline Runtime Information: 
+;
+; Vertex Shader
+; OutputPositionPresent=1
+;
+;
+; Input signature:
+;
+; Name                 Index             InterpMode DynIdx
+; -------------------- ----- ---------------------- ------
+; POSITION                 0                              
+; NORMAL                   0                              
+; TEXCOORD                 0                              
+; TRANSFORM                0                              
+; TRANSFORM                1                              
+; TRANSFORM                2                              
+; TRANSFORM                3                              
+;
+; Output signature:
+;
+; Name                 Index             InterpMode DynIdx
+; -------------------- ----- ---------------------- ------
+; SV_Position              0          noperspective       
+; NORMAL                   0                 linear       
+; TEXCOORD                 0                 linear       
+;
+; ViewId state:
+;
+; Number of inputs: 28, outputs: 10
+; Outputs dependent on ViewId: {  }
+; Inputs contributing to computation of Outputs:
+;   output 0 depends on inputs: { 0, 1, 2, 12, 16, 20, 24 }
+;   output 1 depends on inputs: { 0, 1, 2, 13, 17, 21, 25 }
+;   output 2 depends on inputs: { 0, 1, 2, 14, 18, 22, 26 }
+;   output 3 depends on inputs: { 0, 1, 2, 15, 19, 23, 27 }
+;   output 4 depends on inputs: { 4 }
+;   output 5 depends on inputs: { 5 }
+;   output 6 depends on inputs: { 6 }
+;   output 8 depends on inputs: { 8 }
+;   output 9 depends on inputs: { 9 }
+;
+target datalayout = "e-m:e-p:32:32-i1:32-i8:32-i16:32-i32:32-i64:64-f16:32-f32:32-f64:64-n8:16:32:64"
+target triple = "dxil-ms-dx"
+
+define void @VSMain() {
+  %1 = call float @dx.op.loadInput.f32(i32 4, i32 2, i32 0, i8 0, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %2 = call float @dx.op.loadInput.f32(i32 4, i32 2, i32 0, i8 1, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %3 = call float @dx.op.loadInput.f32(i32 4, i32 1, i32 0, i8 0, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %4 = call float @dx.op.loadInput.f32(i32 4, i32 1, i32 0, i8 1, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %5 = call float @dx.op.loadInput.f32(i32 4, i32 1, i32 0, i8 2, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %6 = call float @dx.op.loadInput.f32(i32 4, i32 0, i32 0, i8 0, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %7 = call float @dx.op.loadInput.f32(i32 4, i32 0, i32 0, i8 1, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %8 = call float @dx.op.loadInput.f32(i32 4, i32 0, i32 0, i8 2, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %9 = call float @dx.op.loadInput.f32(i32 4, i32 3, i32 0, i8 0, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %10 = call float @dx.op.loadInput.f32(i32 4, i32 3, i32 0, i8 1, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %11 = call float @dx.op.loadInput.f32(i32 4, i32 3, i32 0, i8 2, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %12 = call float @dx.op.loadInput.f32(i32 4, i32 3, i32 0, i8 3, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %13 = call float @dx.op.loadInput.f32(i32 4, i32 4, i32 0, i8 0, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %14 = call float @dx.op.loadInput.f32(i32 4, i32 4, i32 0, i8 1, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %15 = call float @dx.op.loadInput.f32(i32 4, i32 4, i32 0, i8 2, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %16 = call float @dx.op.loadInput.f32(i32 4, i32 4, i32 0, i8 3, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %17 = call float @dx.op.loadInput.f32(i32 4, i32 5, i32 0, i8 0, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %18 = call float @dx.op.loadInput.f32(i32 4, i32 5, i32 0, i8 1, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %19 = call float @dx.op.loadInput.f32(i32 4, i32 5, i32 0, i8 2, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %20 = call float @dx.op.loadInput.f32(i32 4, i32 5, i32 0, i8 3, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %21 = call float @dx.op.loadInput.f32(i32 4, i32 6, i32 0, i8 0, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %22 = call float @dx.op.loadInput.f32(i32 4, i32 6, i32 0, i8 1, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %23 = call float @dx.op.loadInput.f32(i32 4, i32 6, i32 0, i8 2, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %24 = call float @dx.op.loadInput.f32(i32 4, i32 6, i32 0, i8 3, i32 undef)  ; LoadInput(inputSigId,rowIndex,colIndex,gsVertexAxis)
+  %25 = fmul fast float %9, %6
+  %26 = call float @dx.op.tertiary.f32(i32 46, float %7, float %13, float %25)  ; FMad(a,b,c)
+  %27 = call float @dx.op.tertiary.f32(i32 46, float %8, float %17, float %26)  ; FMad(a,b,c)
+  %28 = fadd fast float %27, %21
+  %29 = fmul fast float %10, %6
+  %30 = call float @dx.op.tertiary.f32(i32 46, float %7, float %14, float %29)  ; FMad(a,b,c)
+  %31 = call float @dx.op.tertiary.f32(i32 46, float %8, float %18, float %30)  ; FMad(a,b,c)
+  %32 = fadd fast float %31, %22
+  %33 = fmul fast float %11, %6
+  %34 = call float @dx.op.tertiary.f32(i32 46, float %7, float %15, float %33)  ; FMad(a,b,c)
+  %35 = call float @dx.op.tertiary.f32(i32 46, float %8, float %19, float %34)  ; FMad(a,b,c)
+  %36 = fadd fast float %35, %23
+  %37 = fmul fast float %12, %6
+  %38 = call float @dx.op.tertiary.f32(i32 46, float %7, float %16, float %37)  ; FMad(a,b,c)
+  %39 = call float @dx.op.tertiary.f32(i32 46, float %8, float %20, float %38)  ; FMad(a,b,c)
+  %40 = fadd fast float %39, %24
+  call void @dx.op.storeOutput.f32(i32 5, i32 0, i32 0, i8 0, float %28)  ; StoreOutput(outputSigId,rowIndex,colIndex,value)
+  call void @dx.op.storeOutput.f32(i32 5, i32 0, i32 0, i8 1, float %32)  ; StoreOutput(outputSigId,rowIndex,colIndex,value)
+  call void @dx.op.storeOutput.f32(i32 5, i32 0, i32 0, i8 2, float %36)  ; StoreOutput(outputSigId,rowIndex,colIndex,value)
+  call void @dx.op.storeOutput.f32(i32 5, i32 0, i32 0, i8 3, float %40)  ; StoreOutput(outputSigId,rowIndex,colIndex,value)
+  call void @dx.op.storeOutput.f32(i32 5, i32 1, i32 0, i8 0, float %3)  ; StoreOutput(outputSigId,rowIndex,colIndex,value)
+  call void @dx.op.storeOutput.f32(i32 5, i32 1, i32 0, i8 1, float %4)  ; StoreOutput(outputSigId,rowIndex,colIndex,value)
+  call void @dx.op.storeOutput.f32(i32 5, i32 1, i32 0, i8 2, float %5)  ; StoreOutput(outputSigId,rowIndex,colIndex,value)
+  call void @dx.op.storeOutput.f32(i32 5, i32 2, i32 0, i8 0, float %1)  ; StoreOutput(outputSigId,rowIndex,colIndex,value)
+  call void @dx.op.storeOutput.f32(i32 5, i32 2, i32 0, i8 1, float %2)  ; StoreOutput(outputSigId,rowIndex,colIndex,value)
+  ret void
+}
+
+; Function Attrs: nounwind readnone
+declare float @dx.op.loadInput.f32(i32, i32, i32, i8, i32) #0
+
+; Function Attrs: nounwind
+declare void @dx.op.storeOutput.f32(i32, i32, i32, i8, float) #1
+
+; Function Attrs: nounwind readnone
+declare float @dx.op.tertiary.f32(i32, float, float, float) #0
+
+attributes #0 = { nounwind readnone }
+attributes #1 = { nounwind }
+
+!llvm.ident = !{!0}
+!dx.version = !{!1}
+!dx.valver = !{!2}
+!dx.shaderModel = !{!3}
+!dx.viewIdState = !{!4}
+!dx.entryPoints = !{!5}
+
+!0 = !{!"clang version 3.7 (tags/RELEASE_370/final)"}
+!1 = !{i32 1, i32 0}
+!2 = !{i32 1, i32 6}
+!3 = !{!"vs", i32 6, i32 0}
+!4 = !{[30 x i32] [i32 28, i32 10, i32 15, i32 15, i32 15, i32 0, i32 16, i32 32, i32 64, i32 0, i32 256, i32 512, i32 0, i32 0, i32 1, i32 2, i32 4, i32 8, i32 1, i32 2, i32 4, i32 8, i32 1, i32 2, i32 4, i32 8, i32 1, i32 2, i32 4, i32 8]}
+!5 = !{void ()* @VSMain, !"VSMain", !6, null, null}
+!6 = !{!7, !22, null}
+!7 = !{!8, !11, !12, !14, !16, !18, !20}
+!8 = !{i32 0, !"POSITION", i8 9, i8 0, !9, i8 0, i32 1, i8 3, i32 0, i8 0, !10}
+!9 = !{i32 0}
+!10 = !{i32 3, i32 7}
+!11 = !{i32 1, !"NORMAL", i8 9, i8 0, !9, i8 0, i32 1, i8 3, i32 1, i8 0, !10}
+!12 = !{i32 2, !"TEXCOORD", i8 9, i8 0, !9, i8 0, i32 1, i8 2, i32 2, i8 0, !13}
+!13 = !{i32 3, i32 3}
+!14 = !{i32 3, !"TRANSFORM", i8 9, i8 0, !9, i8 0, i32 1, i8 4, i32 3, i8 0, !15}
+!15 = !{i32 3, i32 15}
+!16 = !{i32 4, !"TRANSFORM", i8 9, i8 0, !17, i8 0, i32 1, i8 4, i32 4, i8 0, !15}
+!17 = !{i32 1}
+!18 = !{i32 5, !"TRANSFORM", i8 9, i8 0, !19, i8 0, i32 1, i8 4, i32 5, i8 0, !15}
+!19 = !{i32 2}
+!20 = !{i32 6, !"TRANSFORM", i8 9, i8 0, !21, i8 0, i32 1, i8 4, i32 6, i8 0, !15}
+!21 = !{i32 3}
+!22 = !{!23, !24, !25}
+!23 = !{i32 0, !"SV_Position", i8 9, i8 3, !9, i8 4, i32 1, i8 4, i32 0, i8 0, !15}
+!24 = !{i32 1, !"NORMAL", i8 9, i8 0, !9, i8 2, i32 1, i8 3, i32 1, i8 0, !10}
+!25 = !{i32 2, !"TEXCOORD", i8 9, i8 0, !9, i8 2, i32 1, i8 2, i32 2, i8 0, !13}
+
+#endif
+
+const unsigned char g_VSInstancedMain[] = {
+  0x44, 0x58, 0x42, 0x43, 0x97, 0x47, 0x5a, 0x35, 0x51, 0x9e, 0x1a, 0x66,
+  0x77, 0xe5, 0x02, 0xa6, 0x95, 0x71, 0x61, 0xf9, 0x01, 0x00, 0x00, 0x00,
+  0xab, 0x0d, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00,
+  0x48, 0x00, 0x00, 0x00, 0x5b, 0x01, 0x00, 0x00, 0xe7, 0x01, 0x00, 0x00,
+  0x9b, 0x03, 0x00, 0x00, 0xb7, 0x03, 0x00, 0x00, 0x53, 0x46, 0x49, 0x30,
+  0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x49, 0x53, 0x47, 0x31, 0x0b, 0x01, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00,
+  0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe8, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x07, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0xf1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+  0x07, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x03, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+  0x03, 0x00, 0x00, 0x00, 0x0f, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+  0x0f, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x01, 0x01, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x03, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x0f, 0x0f, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00,
+  0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+  0x06, 0x00, 0x00, 0x00, 0x0f, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x50, 0x4f, 0x53, 0x49, 0x54, 0x49, 0x4f, 0x4e, 0x00, 0x4e, 0x4f, 0x52,
+  0x4d, 0x41, 0x4c, 0x00, 0x54, 0x45, 0x58, 0x43, 0x4f, 0x4f, 0x52, 0x44,
+  0x00, 0x54, 0x52, 0x41, 0x4e, 0x53, 0x46, 0x4f, 0x52, 0x4d, 0x00, 0x4f,
+  0x53, 0x47, 0x31, 0x84, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x08,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x68, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x74, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x07,
+  0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7b,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03,
+  0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x0c, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x53, 0x56, 0x5f, 0x50, 0x6f, 0x73, 0x69, 0x74, 0x69,
+  0x6f, 0x6e, 0x00, 0x4e, 0x4f, 0x52, 0x4d, 0x41, 0x4c, 0x00, 0x54, 0x45,
+  0x58, 0x43, 0x4f, 0x4f, 0x52, 0x44, 0x00, 0x50, 0x53, 0x56, 0x30, 0xac,
+  0x01, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x01, 0x00, 0x00, 0x00, 0x07,
+  0x03, 0x00, 0x07, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x54,
+  0x00, 0x00, 0x00, 0x00, 0x50, 0x4f, 0x53, 0x49, 0x54, 0x49, 0x4f, 0x4e,
+  0x00, 0x4e, 0x4f, 0x52, 0x4d, 0x41, 0x4c, 0x00, 0x54, 0x45, 0x58, 0x43,
+  0x4f, 0x4f, 0x52, 0x44, 0x00, 0x54, 0x52, 0x41, 0x4e, 0x53, 0x46, 0x4f,
+  0x52, 0x4d, 0x00, 0x54, 0x52, 0x41, 0x4e, 0x53, 0x46, 0x4f, 0x52, 0x4d,
+  0x00, 0x54, 0x52, 0x41, 0x4e, 0x53, 0x46, 0x4f, 0x52, 0x4d, 0x00, 0x54,
+  0x52, 0x41, 0x4e, 0x53, 0x46, 0x4f, 0x52, 0x4d, 0x00, 0x4e, 0x4f, 0x52,
+  0x4d, 0x41, 0x4c, 0x00, 0x54, 0x45, 0x58, 0x43, 0x4f, 0x4f, 0x52, 0x44,
+  0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+  0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x10,
+  0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+  0x00, 0x43, 0x00, 0x03, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x01, 0x01, 0x43, 0x00, 0x03, 0x00, 0x00, 0x00, 0x11,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x42, 0x00, 0x03,
+  0x00, 0x00, 0x00, 0x1a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+  0x03, 0x44, 0x00, 0x03, 0x00, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00, 0x01,
+  0x00, 0x00, 0x00, 0x01, 0x04, 0x44, 0x00, 0x03, 0x00, 0x00, 0x00, 0x2e,
+  0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x05, 0x44, 0x00, 0x03,
+  0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01,
+  0x06, 0x44, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x01, 0x00, 0x44, 0x03, 0x03, 0x04, 0x00, 0x00, 0x42,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x43, 0x00, 0x03,
+  0x02, 0x00, 0x00, 0x49, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+  0x02, 0x42, 0x00, 0x03, 0x02, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x0f,
+  0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10,
+  0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+  0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x01,
+  0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x08,
+  0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x04,
+  0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+  0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x48,
+  0x41, 0x53, 0x48, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40,
+  0x23, 0xed, 0x67, 0xe8, 0x75, 0xf4, 0x31, 0x91, 0x61, 0x28, 0x4b, 0xd9,
+  0xe0, 0x82, 0x33, 0x44, 0x58, 0x49, 0x4c, 0xec, 0x09, 0x00, 0x00, 0x60,
+  0x00, 0x01, 0x00, 0x7b, 0x02, 0x00, 0x00, 0x44, 0x58, 0x49, 0x4c, 0x00,
+  0x01, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0xd4, 0x09, 0x00, 0x00, 0x42,
+  0x43, 0xc0, 0xde, 0x21, 0x0c, 0x00, 0x00, 0x72, 0x02, 0x00, 0x00, 0x0b,
+  0x82, 0x20, 0x0a, 0x03, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x1b,
+  0x8c, 0xe0, 0xff, 0xff, 0xff, 0xff, 0x07, 0x40, 0x02, 0xa8, 0x0d, 0x84,
+  0xf0, 0xff, 0xff, 0xff, 0xff, 0x03, 0x20, 0x01, 0x00, 0x00, 0x00, 0x49,
+  0x18, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x13, 0x82, 0x60, 0x42, 0x20,
+  0x00, 0x00, 0x00, 0x89, 0x18, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x0b,
+  0x02, 0x67, 0x02, 0xb0, 0x4a, 0x00, 0x80, 0x21, 0x42, 0x00, 0x6c, 0x00,
+  0x76, 0x04, 0x60, 0xb0, 0x23, 0x40, 0x56, 0x1d, 0xc0, 0x40, 0x10, 0x44,
+  0x41, 0x0c, 0x11, 0x0c, 0x60, 0xd5, 0x01, 0x00, 0x04, 0x41, 0x14, 0xc3,
+  0x10, 0x01, 0x01, 0x56, 0x19, 0xc0, 0x40, 0x0c, 0xc3, 0x30, 0x44, 0x50,
+  0x80, 0x41, 0xc0, 0x16, 0xc1, 0x23, 0x00, 0x13, 0x14, 0x72, 0xc0, 0x87,
+  0x74, 0x60, 0x87, 0x36, 0x68, 0x87, 0x79, 0x68, 0x03, 0x72, 0xc0, 0x87,
+  0x0d, 0xaf, 0x50, 0x0e, 0x6d, 0xd0, 0x0e, 0x7a, 0x50, 0x0e, 0x6d, 0x00,
+  0x0f, 0x7a, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x6d, 0x90,
+  0x0e, 0x71, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x6d, 0x90, 0x0e, 0x78, 0xa0,
+  0x07, 0x73, 0x20, 0x07, 0x6d, 0x90, 0x0e, 0x71, 0x60, 0x07, 0x7a, 0x30,
+  0x07, 0x72, 0xd0, 0x06, 0xe9, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x73, 0x20,
+  0x07, 0x6d, 0x90, 0x0e, 0x76, 0x40, 0x07, 0x7a, 0x60, 0x07, 0x74, 0xd0,
+  0x06, 0xe6, 0x10, 0x07, 0x76, 0xa0, 0x07, 0x73, 0x20, 0x07, 0x6d, 0x60,
+  0x0e, 0x73, 0x20, 0x07, 0x7a, 0x30, 0x07, 0x72, 0xd0, 0x06, 0xe6, 0x60,
+  0x07, 0x74, 0xa0, 0x07, 0x76, 0x40, 0x07, 0x6d, 0xe0, 0x0e, 0x78, 0xa0,
+  0x07, 0x71, 0x60, 0x07, 0x7a, 0x30, 0x07, 0x72, 0xa0, 0x07, 0x76, 0x40,
+  0x07, 0x43, 0x9e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x86, 0x3c, 0x06, 0x10, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x0c, 0x79, 0x10, 0x20, 0x00, 0x04, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x18, 0xf2, 0x28, 0x40, 0x00, 0x04, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x90, 0x85, 0x01, 0x00, 0x00, 0x00, 0x14,
+  0x00, 0x00, 0x00, 0x0b, 0x02, 0x62, 0x44, 0x20, 0x4c, 0x00, 0x46, 0x04,
+  0xcc, 0x82, 0xa0, 0x99, 0xe5, 0x71, 0xca, 0xf3, 0x3c, 0x00, 0x04, 0x06,
+  0xa0, 0x00, 0x80, 0x08, 0x08, 0x01, 0x40, 0x20, 0x10, 0x48, 0x20, 0x10,
+  0x48, 0x20, 0x10, 0x48, 0x20, 0x10, 0xc8, 0x82, 0xa0, 0x18, 0x11, 0x48,
+  0x13, 0x80, 0x11, 0x81, 0xb1, 0x20, 0x20, 0x46, 0x04, 0xc6, 0x88, 0xc0,
+  0x19, 0x11, 0x10, 0x0b, 0x82, 0x62, 0x44, 0x40, 0x8c, 0x08, 0x90, 0x05,
+  0x01, 0x31, 0x22, 0xf0, 0x46, 0x04, 0xc8, 0x88, 0x40, 0x01, 0x00, 0x79,
+  0x18, 0x00, 0x00, 0x09, 0x01, 0x00, 0x00, 0x0b, 0xd4, 0x60, 0x1c, 0xd8,
+  0x21, 0x1c, 0xdc, 0xe1, 0x1c, 0xc0, 0xc0, 0x1e, 0xca, 0x41, 0x1e, 0xe6,
+  0x21, 0x1d, 0xde, 0xc1, 0x1d, 0xc0, 0x60, 0x0e, 0xdc, 0xe0, 0x0e, 0xc0,
+  0x00, 0x0d, 0xe8, 0x21, 0x1c, 0xce, 0x61, 0x1e, 0xde, 0x40, 0x16, 0x4a,
+  0x81, 0x15, 0x4a, 0x21, 0x14, 0x66, 0xa1, 0x14, 0x7e, 0x61, 0x0e, 0xee,
+  0x00, 0x0e, 0xde, 0xc0, 0x1c, 0xd2, 0xc1, 0x1d, 0xc2, 0x81, 0x1d, 0xd2,
+  0x60, 0x43, 0x10, 0x4c, 0x10, 0x08, 0x62, 0x82, 0x40, 0x14, 0x1b, 0x84,
+  0x81, 0x98, 0x20, 0x10, 0xc4, 0x04, 0x81, 0x30, 0x36, 0x08, 0xc6, 0xb1,
+  0x40, 0xb0, 0x87, 0x79, 0x98, 0x20, 0x10, 0xc6, 0x04, 0x81, 0x28, 0x36,
+  0x0c, 0x89, 0xb2, 0x4c, 0x10, 0x9a, 0x63, 0x43, 0xd0, 0x4c, 0x10, 0x88,
+  0x62, 0x01, 0x02, 0x0b, 0xaf, 0x30, 0x0b, 0xa9, 0x40, 0x0b, 0xa9, 0xf0,
+  0x0a, 0xae, 0x30, 0x41, 0x28, 0x90, 0x09, 0x42, 0x91, 0x4c, 0x10, 0x88,
+  0x62, 0x43, 0x30, 0x4d, 0x10, 0x8a, 0x64, 0x82, 0x40, 0x10, 0x13, 0x84,
+  0x42, 0x99, 0x20, 0x10, 0xc5, 0x04, 0xa1, 0x48, 0x26, 0x08, 0xc4, 0x32,
+  0x41, 0x20, 0x98, 0x0d, 0x82, 0xb6, 0x6d, 0x58, 0x1e, 0x28, 0x92, 0xa8,
+  0xca, 0xba, 0xb0, 0x8c, 0x9b, 0x20, 0x10, 0xc4, 0x02, 0xc3, 0x15, 0x5e,
+  0x41, 0x16, 0x5a, 0x21, 0x14, 0x58, 0x61, 0x82, 0x50, 0x20, 0x13, 0x84,
+  0x22, 0x99, 0x20, 0x10, 0xc5, 0x86, 0x40, 0x0c, 0x26, 0x08, 0x45, 0x32,
+  0x41, 0x20, 0x88, 0x09, 0x42, 0xa1, 0x4c, 0x10, 0x08, 0x62, 0x82, 0x50,
+  0x24, 0x13, 0x04, 0x62, 0x99, 0x20, 0x10, 0xcc, 0x06, 0x21, 0x0d, 0xd4,
+  0x60, 0xc3, 0xe2, 0x7d, 0x60, 0x10, 0x06, 0x63, 0x40, 0x06, 0x65, 0x60,
+  0x06, 0x67, 0x80, 0x06, 0x6b, 0x30, 0x41, 0x20, 0x9a, 0x05, 0x08, 0x2d,
+  0x94, 0x02, 0x2e, 0x8c, 0xc2, 0x2b, 0xbc, 0x82, 0x2c, 0x90, 0xc2, 0x04,
+  0xa1, 0x40, 0x26, 0x08, 0x45, 0x32, 0x41, 0x20, 0x8a, 0x0d, 0x41, 0x1c,
+  0x4c, 0x10, 0x8a, 0x64, 0x82, 0x40, 0x10, 0x13, 0x84, 0xc2, 0x99, 0x20,
+  0x10, 0xcd, 0x04, 0xa1, 0x48, 0x26, 0x08, 0xc4, 0x32, 0x41, 0x20, 0x96,
+  0x0d, 0x02, 0x1e, 0xe4, 0xc1, 0x86, 0xa5, 0x0d, 0xdc, 0xe0, 0x0d, 0xe0,
+  0x40, 0x0e, 0xe6, 0x80, 0x0e, 0xea, 0xc0, 0x0e, 0xee, 0x40, 0x0f, 0x26,
+  0x08, 0xc4, 0xb2, 0x20, 0xa1, 0x05, 0x59, 0x08, 0x05, 0x57, 0x98, 0x05,
+  0x53, 0x78, 0x05, 0x59, 0x68, 0x85, 0x09, 0x42, 0x81, 0x4c, 0x10, 0x8a,
+  0x64, 0x82, 0x40, 0x14, 0x1b, 0x02, 0x50, 0x98, 0x20, 0x14, 0xc9, 0x04,
+  0x81, 0x20, 0x26, 0x08, 0xc5, 0x33, 0x41, 0x20, 0x96, 0x09, 0x42, 0x91,
+  0x4c, 0x10, 0x88, 0x65, 0x82, 0x40, 0x40, 0x1b, 0x84, 0x53, 0x40, 0x85,
+  0x0d, 0x0b, 0x1f, 0xf4, 0x81, 0x1f, 0xfc, 0x41, 0x28, 0x88, 0xc2, 0x28,
+  0x90, 0x42, 0x29, 0x98, 0x42, 0x2a, 0x4c, 0x10, 0x88, 0x68, 0x41, 0x42,
+  0x0b, 0xb2, 0x10, 0x0a, 0xae, 0x30, 0x0b, 0xa6, 0xf0, 0x0a, 0xb2, 0xd0,
+  0x0a, 0x13, 0x84, 0x02, 0x99, 0x20, 0x14, 0xc9, 0x04, 0x81, 0x20, 0x36,
+  0x04, 0xaf, 0x30, 0x41, 0x28, 0x92, 0x09, 0x02, 0x41, 0x4c, 0x10, 0x8a,
+  0x67, 0x82, 0x40, 0x44, 0x13, 0x84, 0x22, 0x99, 0x20, 0x10, 0xcb, 0x04,
+  0x81, 0x80, 0x36, 0x08, 0xb6, 0x70, 0x0b, 0x1b, 0x96, 0x55, 0x60, 0x85,
+  0x56, 0x70, 0x05, 0x58, 0x88, 0x05, 0x59, 0x98, 0x05, 0x5a, 0xa8, 0x05,
+  0x5c, 0x98, 0x20, 0x10, 0xd2, 0x82, 0x84, 0x16, 0x64, 0x21, 0x14, 0x5c,
+  0x61, 0x16, 0x4c, 0xe1, 0x15, 0x64, 0xa1, 0x15, 0x26, 0x08, 0x05, 0x32,
+  0x41, 0x28, 0x92, 0x09, 0x02, 0xd1, 0x6c, 0x08, 0x7c, 0x61, 0x82, 0x50,
+  0x24, 0x13, 0x04, 0x82, 0x98, 0x20, 0x14, 0xcf, 0x04, 0x81, 0x90, 0x26,
+  0x08, 0x45, 0x32, 0x41, 0x20, 0x96, 0x09, 0x02, 0x01, 0x6d, 0x10, 0xca,
+  0xc1, 0x1c, 0x36, 0x2c, 0xba, 0xb0, 0x0b, 0xbc, 0xd0, 0x0b, 0xbf, 0x00,
+  0x0e, 0xe1, 0x20, 0x0e, 0xe3, 0x40, 0x0e, 0xe7, 0x30, 0x41, 0x20, 0x8c,
+  0x05, 0x09, 0x2d, 0xc8, 0x42, 0x28, 0xb8, 0xc2, 0x2c, 0x98, 0xc2, 0x2b,
+  0xc8, 0x42, 0x2b, 0x4c, 0x10, 0x0a, 0x64, 0x82, 0x50, 0x24, 0x13, 0x04,
+  0x62, 0xd9, 0x10, 0xb4, 0xc3, 0x04, 0xa1, 0x48, 0x26, 0x08, 0x04, 0x31,
+  0x41, 0x28, 0x9e, 0x09, 0x02, 0x61, 0x4c, 0x10, 0x8a, 0x64, 0x82, 0x40,
+  0x2c, 0x13, 0x04, 0x02, 0xda, 0x20, 0xd0, 0x43, 0x3d, 0x6c, 0x58, 0xd2,
+  0x41, 0x1d, 0xd6, 0x81, 0x1d, 0xdc, 0xe1, 0x1d, 0xe0, 0x21, 0x1e, 0xe4,
+  0x61, 0x1e, 0xec, 0x61, 0x82, 0x40, 0x14, 0x0b, 0x96, 0x59, 0xb0, 0x85,
+  0x5f, 0x80, 0x85, 0x77, 0x98, 0x87, 0x74, 0xa0, 0x87, 0x74, 0x78, 0x07,
+  0x77, 0x98, 0x20, 0x14, 0xc8, 0x04, 0xa1, 0x50, 0x26, 0x08, 0x44, 0xb1,
+  0x21, 0xe0, 0x87, 0x09, 0x42, 0xf1, 0x4c, 0x10, 0x08, 0x62, 0x82, 0x50,
+  0x3c, 0x13, 0x04, 0xa2, 0x98, 0x20, 0x14, 0xc9, 0x04, 0x81, 0x58, 0x26,
+  0x08, 0x04, 0xb4, 0x41, 0x18, 0x09, 0x92, 0xd8, 0xb0, 0xe0, 0x43, 0x3e,
+  0xe8, 0xc3, 0x3e, 0xf4, 0x83, 0x3f, 0xfc, 0x03, 0x48, 0x84, 0x84, 0x48,
+  0x94, 0xc4, 0x04, 0x81, 0x20, 0x16, 0x18, 0xae, 0xf0, 0x0a, 0xb2, 0xd0,
+  0x0a, 0xa1, 0xc0, 0x0a, 0x13, 0x84, 0x02, 0x99, 0x20, 0x14, 0xc9, 0x04,
+  0x81, 0x28, 0x36, 0x04, 0x2b, 0x31, 0x41, 0x28, 0x9c, 0x09, 0x02, 0x41,
+  0x4c, 0x10, 0x0a, 0x65, 0x82, 0x40, 0x10, 0x13, 0x84, 0x22, 0x99, 0x20,
+  0x10, 0xcb, 0x04, 0x81, 0x60, 0x36, 0x08, 0x32, 0x31, 0x13, 0x1b, 0x96,
+  0x93, 0x40, 0x89, 0x94, 0x50, 0x09, 0x96, 0x68, 0x09, 0x97, 0x78, 0x09,
+  0x98, 0x88, 0x09, 0x9a, 0x98, 0x20, 0x10, 0xcd, 0x02, 0x84, 0x16, 0x4a,
+  0x01, 0x17, 0x46, 0xe1, 0x15, 0x5e, 0x41, 0x16, 0x48, 0x61, 0x82, 0x50,
+  0x20, 0x13, 0x84, 0x22, 0x99, 0x20, 0x10, 0xc5, 0x86, 0x40, 0x27, 0x26,
+  0x08, 0x85, 0x33, 0x41, 0x20, 0x88, 0x09, 0x42, 0xe1, 0x4c, 0x10, 0x88,
+  0x66, 0x82, 0x50, 0x24, 0x13, 0x04, 0x62, 0x99, 0x20, 0x10, 0xcb, 0x06,
+  0x21, 0x2c, 0xc4, 0x62, 0xc3, 0x62, 0x13, 0x37, 0x81, 0x13, 0x39, 0xb1,
+  0x13, 0x3c, 0xd1, 0x13, 0x3e, 0xf1, 0x13, 0x60, 0x31, 0x16, 0x1b, 0x8e,
+  0x8e, 0x0d, 0xf6, 0x40, 0x15, 0x72, 0x01, 0x1d, 0xee, 0x61, 0xc3, 0x60,
+  0x12, 0x35, 0x41, 0x16, 0x1b, 0x86, 0xb2, 0x30, 0x0b, 0x60, 0x82, 0x20,
+  0x00, 0x0b, 0x0c, 0x5b, 0x98, 0x85, 0x56, 0x08, 0x87, 0x74, 0x70, 0x87,
+  0x0d, 0x05, 0x5a, 0xa4, 0xc5, 0x59, 0x00, 0xc0, 0x08, 0x85, 0x1d, 0xd8,
+  0xc1, 0x1e, 0xda, 0xc1, 0x0d, 0xd2, 0x81, 0x1c, 0xca, 0xc1, 0x1d, 0xe8,
+  0x61, 0x4a, 0x10, 0x8c, 0x50, 0xc8, 0x01, 0x1f, 0xdc, 0xc0, 0x1e, 0xca,
+  0x41, 0x1e, 0xe6, 0x21, 0x1d, 0xde, 0xc1, 0x1d, 0xa6, 0x04, 0xc4, 0x88,
+  0x84, 0x1c, 0xf0, 0xc1, 0x0d, 0xec, 0x21, 0x1c, 0xd8, 0xc1, 0x1e, 0xca,
+  0x41, 0x1e, 0xa6, 0x04, 0xc7, 0x08, 0x87, 0x1c, 0xf0, 0xc1, 0x0d, 0xe6,
+  0x01, 0x1d, 0xc2, 0x81, 0x1c, 0xca, 0x41, 0x1e, 0x5a, 0xe1, 0x1d, 0xc8,
+  0xa1, 0x1c, 0xd8, 0x61, 0x4a, 0xb0, 0x8c, 0x70, 0xc8, 0x01, 0x1f, 0xdc,
+  0xc0, 0x1e, 0xd2, 0xa1, 0x1c, 0xee, 0x21, 0x15, 0xc8, 0x61, 0x16, 0xe8,
+  0x21, 0x1c, 0xe8, 0xa1, 0x1c, 0xa6, 0x04, 0xcd, 0x08, 0x87, 0x1c, 0xf0,
+  0xc1, 0x0d, 0xca, 0xc1, 0x1d, 0xe8, 0x41, 0x1e, 0xf2, 0x01, 0x16, 0xde,
+  0x21, 0x1d, 0xdc, 0x81, 0x1e, 0xe6, 0x61, 0x4a, 0x90, 0x16, 0x00, 0x79,
+  0x18, 0x00, 0x00, 0x49, 0x00, 0x00, 0x00, 0x33, 0x08, 0x80, 0x1c, 0xc4,
+  0xe1, 0x1c, 0x66, 0x14, 0x01, 0x3d, 0x88, 0x43, 0x38, 0x84, 0xc3, 0x8c,
+  0x42, 0x80, 0x07, 0x79, 0x78, 0x07, 0x73, 0x98, 0x71, 0x0c, 0xe6, 0x00,
+  0x0f, 0xed, 0x10, 0x0e, 0xf4, 0x80, 0x0e, 0x33, 0x0c, 0x42, 0x1e, 0xc2,
+  0xc1, 0x1d, 0xce, 0xa1, 0x1c, 0x66, 0x30, 0x05, 0x3d, 0x88, 0x43, 0x38,
+  0x84, 0x83, 0x1b, 0xcc, 0x03, 0x3d, 0xc8, 0x43, 0x3d, 0x8c, 0x03, 0x3d,
+  0xcc, 0x78, 0x8c, 0x74, 0x70, 0x07, 0x7b, 0x08, 0x07, 0x79, 0x48, 0x87,
+  0x70, 0x70, 0x07, 0x7a, 0x70, 0x03, 0x76, 0x78, 0x87, 0x70, 0x20, 0x87,
+  0x19, 0xcc, 0x11, 0x0e, 0xec, 0x90, 0x0e, 0xe1, 0x30, 0x0f, 0x6e, 0x30,
+  0x0f, 0xe3, 0xf0, 0x0e, 0xf0, 0x50, 0x0e, 0x33, 0x10, 0xc4, 0x1d, 0xde,
+  0x21, 0x1c, 0xd8, 0x21, 0x1d, 0xc2, 0x61, 0x1e, 0x66, 0x30, 0x89, 0x3b,
+  0xbc, 0x83, 0x3b, 0xd0, 0x43, 0x39, 0xb4, 0x03, 0x3c, 0xbc, 0x83, 0x3c,
+  0x84, 0x03, 0x3b, 0xcc, 0xf0, 0x14, 0x76, 0x60, 0x07, 0x7b, 0x68, 0x07,
+  0x37, 0x68, 0x87, 0x72, 0x68, 0x07, 0x37, 0x80, 0x87, 0x70, 0x90, 0x87,
+  0x70, 0x60, 0x07, 0x76, 0x28, 0x07, 0x76, 0xf8, 0x05, 0x76, 0x78, 0x87,
+  0x77, 0x80, 0x87, 0x5f, 0x08, 0x87, 0x71, 0x18, 0x87, 0x72, 0x98, 0x87,
+  0x79, 0x98, 0x81, 0x2c, 0xee, 0xf0, 0x0e, 0xee, 0xe0, 0x0e, 0xf5, 0xc0,
+  0x0e, 0xec, 0x30, 0x03, 0x62, 0xc8, 0xa1, 0x1c, 0xe4, 0xa1, 0x1c, 0xcc,
+  0xa1, 0x1c, 0xe4, 0xa1, 0x1c, 0xdc, 0x61, 0x1c, 0xca, 0x21, 0x1c, 0xc4,
+  0x81, 0x1d, 0xca, 0x61, 0x06, 0xd6, 0x90, 0x43, 0x39, 0xc8, 0x43, 0x39,
+  0x98, 0x43, 0x39, 0xc8, 0x43, 0x39, 0xb8, 0xc3, 0x38, 0x94, 0x43, 0x38,
+  0x88, 0x03, 0x3b, 0x94, 0xc3, 0x2f, 0xbc, 0x83, 0x3c, 0xfc, 0x82, 0x3b,
+  0xd4, 0x03, 0x3b, 0xb0, 0xc3, 0x8c, 0xc8, 0x21, 0x07, 0x7c, 0x70, 0x03,
+  0x72, 0x10, 0x87, 0x73, 0x70, 0x03, 0x7b, 0x08, 0x07, 0x79, 0x60, 0x87,
+  0x70, 0xc8, 0x87, 0x77, 0xa8, 0x07, 0x7a, 0x00, 0x00, 0x00, 0x00, 0x71,
+  0x18, 0x00, 0x00, 0x1b, 0x00, 0x00, 0x00, 0x0b, 0x0e, 0xc0, 0x16, 0x66,
+  0xa1, 0x15, 0xc2, 0x21, 0x1d, 0xdc, 0x61, 0x01, 0x15, 0x90, 0x03, 0x3e,
+  0xb8, 0xc1, 0x3b, 0xc0, 0x83, 0x1b, 0xb0, 0xc3, 0x3b, 0x84, 0x03, 0x39,
+  0xa4, 0x82, 0x3b, 0xc0, 0x43, 0x3d, 0xd0, 0x83, 0x1b, 0x98, 0xc3, 0x1c,
+  0xc8, 0xc1, 0x02, 0x4b, 0x20, 0x07, 0x7c, 0x70, 0x83, 0x77, 0x80, 0x07,
+  0x37, 0x98, 0x07, 0x7a, 0x78, 0x07, 0x79, 0x28, 0x87, 0x57, 0xa8, 0x07,
+  0x7a, 0x80, 0x87, 0x7a, 0xa0, 0x07, 0x37, 0x30, 0x87, 0x39, 0x90, 0x83,
+  0x05, 0xd3, 0x40, 0x0e, 0xf8, 0xe0, 0x06, 0xef, 0x00, 0x0f, 0x6e, 0x40,
+  0x0f, 0xe5, 0x20, 0x0f, 0xf4, 0x90, 0x0e, 0xe1, 0x20, 0x0f, 0xf9, 0xe0,
+  0x06, 0xe6, 0x30, 0x07, 0x72, 0x00, 0x00, 0x61, 0x18, 0x00, 0x00, 0x99,
+  0x00, 0x00, 0x00, 0x0b, 0x82, 0x20, 0x0b, 0x03, 0x00, 0x00, 0x00, 0x05,
+  0x00, 0x00, 0x00, 0x0b, 0x02, 0x62, 0x03, 0xb0, 0x20, 0x28, 0x46, 0x04,
+  0xc2, 0x82, 0x80, 0x18, 0x11, 0xf0, 0x02, 0x00, 0x00, 0x00, 0x00, 0x13,
+  0x83, 0x04, 0x00, 0x41, 0x30, 0x30, 0xaa, 0x22, 0x89, 0x9a, 0x61, 0x62,
+  0x90, 0x00, 0x20, 0x08, 0x06, 0x86, 0x65, 0x28, 0xd2, 0x40, 0x4c, 0x0c,
+  0x12, 0x00, 0x04, 0xc1, 0xc0, 0xb8, 0x0e, 0x6a, 0x7a, 0x8a, 0x89, 0x41,
+  0x02, 0x80, 0x20, 0x18, 0x18, 0x18, 0x52, 0x51, 0x85, 0x31, 0x31, 0x48,
+  0x00, 0x10, 0x04, 0x03, 0x23, 0x4b, 0xac, 0x8a, 0x39, 0x26, 0x06, 0x09,
+  0x00, 0x82, 0x60, 0x60, 0x68, 0x8a, 0x65, 0x49, 0xc8, 0xc4, 0x20, 0x01,
+  0x40, 0x10, 0x0c, 0x8c, 0x6d, 0xb9, 0x2e, 0x24, 0x99, 0x18, 0x24, 0x00,
+  0x08, 0x82, 0x81, 0xc1, 0x31, 0x18, 0xf6, 0x28, 0x13, 0x83, 0x04, 0x00,
+  0x41, 0x30, 0x30, 0xba, 0x66, 0xca, 0xaa, 0x65, 0x62, 0x90, 0x00, 0x20,
+  0x08, 0x06, 0x86, 0xe7, 0x50, 0xda, 0xc2, 0x4c, 0x0c, 0x12, 0x00, 0x04,
+  0xc1, 0xc0, 0xf8, 0x9e, 0x6a, 0x93, 0x9a, 0x89, 0x41, 0x02, 0x80, 0x20,
+  0x18, 0x18, 0x60, 0x00, 0x59, 0xdc, 0xe5, 0x4c, 0x0c, 0x12, 0x00, 0x04,
+  0xc1, 0xc0, 0x08, 0x83, 0x28, 0xea, 0xb2, 0x67, 0x62, 0x90, 0x00, 0x20,
+  0x08, 0x06, 0x86, 0x18, 0x48, 0x92, 0xf7, 0x40, 0x13, 0x83, 0x04, 0x00,
+  0x41, 0x30, 0x30, 0xc6, 0x60, 0x9a, 0x3e, 0x2b, 0x9a, 0x18, 0x24, 0x00,
+  0x08, 0x82, 0x81, 0x41, 0x06, 0x14, 0x05, 0x06, 0x9b, 0x34, 0x31, 0x48,
+  0x00, 0x10, 0x04, 0x03, 0xa3, 0x0c, 0x2a, 0x2a, 0x0c, 0xba, 0x69, 0x62,
+  0x90, 0x00, 0x20, 0x08, 0x06, 0x86, 0x19, 0x58, 0x95, 0x18, 0x4c, 0xd4,
+  0xc4, 0x20, 0x01, 0x40, 0x10, 0x0c, 0x8c, 0x33, 0xb8, 0xac, 0x31, 0xd0,
+  0xaa, 0x89, 0x41, 0x02, 0x80, 0x20, 0x18, 0x18, 0x68, 0x80, 0x5d, 0x64,
+  0xf0, 0x59, 0x13, 0x83, 0x04, 0x00, 0x41, 0x30, 0x30, 0xd2, 0x20, 0x23,
+  0x83, 0x32, 0x08, 0x83, 0x6b, 0x62, 0x90, 0x00, 0x20, 0x08, 0x06, 0x86,
+  0x1a, 0x68, 0x65, 0x60, 0x06, 0x17, 0x36, 0x31, 0x48, 0x00, 0x10, 0x04,
+  0x03, 0x63, 0x0d, 0x36, 0x33, 0x38, 0x03, 0x2f, 0x9b, 0x18, 0x24, 0x00,
+  0x08, 0x82, 0x81, 0xc1, 0x06, 0xdc, 0x19, 0xa0, 0xc1, 0x18, 0x68, 0x13,
+  0x08, 0x68, 0x12, 0xbe, 0x89, 0x01, 0x02, 0x80, 0x20, 0x18, 0x28, 0x6c,
+  0xa0, 0x4d, 0x4d, 0x30, 0x31, 0x40, 0x00, 0x10, 0x04, 0x03, 0xa5, 0x0d,
+  0xb6, 0x49, 0x09, 0x26, 0x10, 0xc1, 0x01, 0x74, 0x13, 0x88, 0xe9, 0x12,
+  0xbe, 0x89, 0x01, 0x02, 0x80, 0x20, 0x18, 0x28, 0x70, 0xe0, 0x5d, 0x50,
+  0x30, 0x31, 0x40, 0x00, 0x10, 0x04, 0x03, 0x25, 0x0e, 0xbe, 0xab, 0x09,
+  0x26, 0x10, 0x81, 0x02, 0x74, 0x13, 0x08, 0x6b, 0x13, 0xbe, 0x89, 0x01,
+  0x02, 0x80, 0x20, 0x18, 0x28, 0x74, 0x20, 0x06, 0xdb, 0x14, 0x4c, 0x0c,
+  0x10, 0x00, 0x04, 0xc1, 0x40, 0xa9, 0x83, 0x31, 0xd8, 0xa0, 0x60, 0x02,
+  0x11, 0x34, 0x40, 0x37, 0x81, 0xc8, 0x3e, 0xe1, 0x9b, 0x18, 0x20, 0x00,
+  0x08, 0x82, 0x81, 0x82, 0x07, 0x66, 0xf0, 0x59, 0xc1, 0xc4, 0x00, 0x01,
+  0x40, 0x10, 0x0c, 0x94, 0x3c, 0x38, 0x83, 0x6f, 0x0a, 0x26, 0x10, 0x01,
+  0x04, 0x74, 0x13, 0x83, 0x04, 0x00, 0x41, 0x30, 0x40, 0xf8, 0x80, 0x0d,
+  0xf2, 0x20, 0x0f, 0xea, 0xa0, 0x99, 0x18, 0x24, 0x00, 0x08, 0x82, 0x01,
+  0xc2, 0x07, 0x6c, 0x90, 0x07, 0x79, 0xa0, 0x06, 0xc9, 0xc4, 0x20, 0x01,
+  0x40, 0x10, 0x0c, 0x10, 0x3e, 0x60, 0x83, 0x3c, 0xc8, 0x03, 0x38, 0x28,
+  0x26, 0x06, 0x09, 0x00, 0x82, 0x60, 0x80, 0xf0, 0x01, 0x1b, 0xe4, 0x41,
+  0x1e, 0xd0, 0x41, 0x30, 0x31, 0x48, 0x00, 0x10, 0x04, 0x03, 0x84, 0x0f,
+  0xd8, 0x40, 0x0f, 0xf2, 0xa0, 0x0e, 0xcc, 0x60, 0x62, 0x90, 0x00, 0x20,
+  0x08, 0x06, 0x08, 0x1f, 0xb0, 0x81, 0x1e, 0xe4, 0x81, 0x1a, 0x94, 0xc1,
+  0xc4, 0x20, 0x01, 0x40, 0x10, 0x0c, 0x10, 0x3e, 0x60, 0x03, 0x3d, 0xc8,
+  0x03, 0x38, 0x20, 0x83, 0x89, 0x41, 0x02, 0x80, 0x20, 0x18, 0x20, 0x7c,
+  0xc0, 0x06, 0x71, 0x90, 0x07, 0x75, 0x80, 0x06, 0x13, 0x83, 0x04, 0x00,
+  0x41, 0x30, 0x40, 0xf8, 0x80, 0x0d, 0xe2, 0x20, 0x0f, 0xd4, 0xe0, 0x0c,
+  0xa6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
@@ -39,6 +39,17 @@ struct VSPhongInput
     float2 texcoordDiffuse : TEXCOORD;
 };
 
+struct VSPhongInstancedInput
+{
+    float3 position : POSITION;
+    float3 normal : NORMAL;
+    float2 texcoordDiffuse : TEXCOORD;
+    float4 transform0 : TRANSFORM0;
+    float4 transform1 : TRANSFORM1;
+    float4 transform2 : TRANSFORM2;
+    float4 transform3 : TRANSFORM3;
+};
+
 struct PSPhongInput
 {
     float4 position : SV_POSITION;
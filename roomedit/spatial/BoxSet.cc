@@ -0,0 +1,216 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "BoxSet.hh"
+#ifdef __AVX__
+#include <immintrin.h>
+#else
+#include <xmmintrin.h>
+#endif
+#include <algorithm> //std::sort
+
+static constexpr uint32_t LANE_ALIGNMENT = BoxSet::LANE_WIDTH * sizeof(float);
+
+bool BoxSet::Create(uint32_t maxBoxes)
+{
+	capacity = (maxBoxes + LANE_WIDTH - 1) / LANE_WIDTH * LANE_WIDTH;
+	if (capacity == 0)
+		capacity = LANE_WIDTH;
+
+	if (!pool.Create(6 * (capacity * sizeof(float) + LANE_ALIGNMENT)))
+		return false;
+
+	minX = pool.Allocate<float>(capacity, LANE_ALIGNMENT);
+	minY = pool.Allocate<float>(capacity, LANE_ALIGNMENT);
+	minZ = pool.Allocate<float>(capacity, LANE_ALIGNMENT);
+	maxX = pool.Allocate<float>(capacity, LANE_ALIGNMENT);
+	maxY = pool.Allocate<float>(capacity, LANE_ALIGNMENT);
+	maxZ = pool.Allocate<float>(capacity, LANE_ALIGNMENT);
+	numBoxes = 0;
+
+	return true;
+}
+
+void BoxSet::Destroy()
+{
+	pool.Destroy();
+	minX = minY = minZ = nullptr;
+	maxX = maxY = maxZ = nullptr;
+	numBoxes = 0;
+	capacity = 0;
+}
+
+uint32_t BoxSet::Add(const BBox &box)
+{
+	assert(numBoxes < capacity);
+	uint32_t index = numBoxes++;
+	Set(index, box);
+	return index;
+}
+
+void BoxSet::Set(uint32_t index, const BBox &box)
+{
+	assert(index < numBoxes);
+	minX[index] = box.min.x;
+	minY[index] = box.min.y;
+	minZ[index] = box.min.z;
+	maxX[index] = box.max.x;
+	maxY[index] = box.max.y;
+	maxZ[index] = box.max.z;
+}
+
+//the box tests, written once for both lane widths
+#ifdef __AVX__
+typedef __m256 Lanes;
+static inline Lanes Load(const float *p) { return _mm256_load_ps(p); }
+static inline Lanes Set1(float f) { return _mm256_set1_ps(f); }
+static inline Lanes Sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+static inline Lanes Mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+static inline Lanes Min(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+static inline Lanes Max(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+static inline Lanes LessEqual(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline Lanes And(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+static inline uint32_t Mask(Lanes a) { return (uint32_t)_mm256_movemask_ps(a); }
+static inline void Store(float *p, Lanes a) { _mm256_storeu_ps(p, a); }
+#else
+typedef __m128 Lanes;
+static inline Lanes Load(const float *p) { return _mm_load_ps(p); }
+static inline Lanes Set1(float f) { return _mm_set1_ps(f); }
+static inline Lanes Sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+static inline Lanes Mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+static inline Lanes Min(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+static inline Lanes Max(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+static inline Lanes LessEqual(Lanes a, Lanes b) { return _mm_cmple_ps(a, b); }
+static inline Lanes And(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+static inline uint32_t Mask(Lanes a) { return (uint32_t)_mm_movemask_ps(a); }
+static inline void Store(float *p, Lanes a) { _mm_storeu_ps(p, a); }
+#endif
+
+static inline uint32_t IntersectSlabs(
+	Lanes minX, Lanes minY, Lanes minZ, Lanes maxX, Lanes maxY, Lanes maxZ,
+	Lanes originX, Lanes originY, Lanes originZ, Lanes invDirectionX, Lanes invDirectionY, Lanes invDirectionZ,
+	Lanes maxDistance, Lanes &enter)
+{
+	Lanes t0x = Mul(Sub(minX, originX), invDirectionX);
+	Lanes t1x = Mul(Sub(maxX, originX), invDirectionX);
+	Lanes t0y = Mul(Sub(minY, originY), invDirectionY);
+	Lanes t1y = Mul(Sub(maxY, originY), invDirectionY);
+	Lanes t0z = Mul(Sub(minZ, originZ), invDirectionZ);
+	Lanes t1z = Mul(Sub(maxZ, originZ), invDirectionZ);
+
+	//rays starting inside a box enter it at 0
+	enter = Max(Max(Min(t0x, t1x), Min(t0y, t1y)), Max(Min(t0z, t1z), Set1(0.0f)));
+	Lanes exit = Min(Min(Max(t0x, t1x), Max(t0y, t1y)), Min(Max(t0z, t1z), maxDistance));
+	return Mask(LessEqual(enter, exit));
+}
+
+uint32_t BoxSet::IntersectRay(const Ray &ray, float maxDistance, RayBoxHit *hits) const
+{
+	Lanes originX = Set1(ray.origin.x);
+	Lanes originY = Set1(ray.origin.y);
+	Lanes originZ = Set1(ray.origin.z);
+	Lanes invDirectionX = Set1(ray.invDirection.x);
+	Lanes invDirectionY = Set1(ray.invDirection.y);
+	Lanes invDirectionZ = Set1(ray.invDirection.z);
+	Lanes maxDistances = Set1(maxDistance);
+
+	uint32_t numHits = 0;
+	for (uint32_t i = 0; i < numBoxes; i += LANE_WIDTH)
+	{
+		Lanes enter;
+		uint32_t hitMask = IntersectSlabs(
+			Load(minX + i), Load(minY + i), Load(minZ + i), Load(maxX + i), Load(maxY + i), Load(maxZ + i),
+			originX, originY, originZ, invDirectionX, invDirectionY, invDirectionZ,
+			maxDistances, enter
+		);
+
+		//the padding after the last box is never reported
+		uint32_t numLanes = numBoxes - i < LANE_WIDTH ? numBoxes - i : LANE_WIDTH;
+		hitMask &= (1u << numLanes) - 1;
+		if (!hitMask)
+			continue;
+
+		//compact without branching, every lane writes but only the hit ones move the end forward
+		alignas(LANE_ALIGNMENT) float distances[LANE_WIDTH];
+		Store(distances, enter);
+		for (uint32_t lane = 0; lane < LANE_WIDTH; lane++)
+		{
+			hits[numHits].boxIndex = i + lane;
+			hits[numHits].distance = distances[lane];
+			numHits += (hitMask >> lane) & 1;
+		}
+	}
+
+	std::sort(hits, hits + numHits, [](const RayBoxHit &a, const RayBoxHit &b) { return a.distance < b.distance; });
+	return numHits;
+}
+
+uint32_t BoxSet::OverlapBox(const BBox &box, uint32_t first, uint32_t count, uint32_t *indices, uint32_t maxIndices) const
+{
+	assert(first % LANE_WIDTH == 0);
+	assert(first + count <= numBoxes);
+
+	Lanes boxMinX = Set1(box.min.x);
+	Lanes boxMinY = Set1(box.min.y);
+	Lanes boxMinZ = Set1(box.min.z);
+	Lanes boxMaxX = Set1(box.max.x);
+	Lanes boxMaxY = Set1(box.max.y);
+	Lanes boxMaxZ = Set1(box.max.z);
+
+	uint32_t numOverlaps = 0;
+	uint32_t end = first + count;
+	for (uint32_t i = first; i < end; i += LANE_WIDTH)
+	{
+		//every lane may be written below
+		if (numOverlaps + LANE_WIDTH > maxIndices)
+			break;
+
+		Lanes overlap = And(
+			And(And(LessEqual(Load(minX + i), boxMaxX), LessEqual(boxMinX, Load(maxX + i))), And(LessEqual(Load(minY + i), boxMaxY), LessEqual(boxMinY, Load(maxY + i)))),
+			And(LessEqual(Load(minZ + i), boxMaxZ), LessEqual(boxMinZ, Load(maxZ + i)))
+		);
+		uint32_t overlapMask = Mask(overlap);
+
+		uint32_t numLanes = end - i < LANE_WIDTH ? end - i : LANE_WIDTH;
+		overlapMask &= (1u << numLanes) - 1;
+
+		for (uint32_t lane = 0; lane < LANE_WIDTH; lane++)
+		{
+			indices[numOverlaps] = i + lane;
+			numOverlaps += (overlapMask >> lane) & 1;
+		}
+	}
+
+	return numOverlaps;
+}
+
+bool RayPacket::Add(const Ray &ray)
+{
+	if (numRays == BoxSet::LANE_WIDTH)
+		return false;
+
+	originX[numRays] = ray.origin.x;
+	originY[numRays] = ray.origin.y;
+	originZ[numRays] = ray.origin.z;
+	invDirectionX[numRays] = ray.invDirection.x;
+	invDirectionY[numRays] = ray.invDirection.y;
+	invDirectionZ[numRays] = ray.invDirection.z;
+	numRays++;
+	return true;
+}
+
+uint32_t RayPacket::IntersectBox(const BBox &box, float maxDistance, float *distances) const
+{
+	Lanes enter;
+	uint32_t hitMask = IntersectSlabs(
+		Set1(box.min.x), Set1(box.min.y), Set1(box.min.z), Set1(box.max.x), Set1(box.max.y), Set1(box.max.z),
+		Load(originX), Load(originY), Load(originZ), Load(invDirectionX), Load(invDirectionY), Load(invDirectionZ),
+		Set1(maxDistance), enter
+	);
+	Store(distances, enter);
+
+	//lanes past the last ray are not rays
+	return hitMask & ((1u << numRays) - 1);
+}
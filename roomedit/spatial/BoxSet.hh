@@ -0,0 +1,121 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "../BBox.hh"
+#include "Ray.hh"
+#include <stdint.h>
+
+//a box a ray goes through
+struct RayBoxHit
+{
+	uint32_t boxIndex;
+	float distance; //where the ray enters the box, 0 if it starts inside
+};
+
+/// <summary>
+/// Many boxes stored as structure-of-arrays, so that a whole group of them is tested with a few SIMD instructions:
+/// 8 boxes at a time when building with AVX, 4 otherwise.
+/// Rays are tested with the slab method, either one ray against all the boxes,
+/// or a packet of rays (see RayPacket) against a single box. Boxes can be tested against a range of the set.
+/// </summary>
+class BoxSet
+{
+public:
+#ifdef __AVX__
+	static constexpr uint32_t LANE_WIDTH = 8;
+#else
+	static constexpr uint32_t LANE_WIDTH = 4;
+#endif
+
+protected:
+	MemoryPool pool;
+
+	//one array per box component, padded to a multiple of LANE_WIDTH
+	float *minX, *minY, *minZ;
+	float *maxX, *maxY, *maxZ;
+	uint32_t numBoxes;
+	uint32_t capacity;
+
+public:
+	BoxSet():
+		minX(nullptr), minY(nullptr), minZ(nullptr),
+		maxX(nullptr), maxY(nullptr), maxZ(nullptr),
+		numBoxes(0),
+		capacity(0)
+	{}
+
+	bool Create(uint32_t maxBoxes);
+	void Destroy();
+
+	//forgets every box
+	void Clear()
+	{
+		numBoxes = 0;
+	}
+
+	//returns the index of the box, the one reported by the queries
+	uint32_t Add(const BBox &box);
+	void Set(uint32_t index, const BBox &box);
+
+	BBox GetBox(uint32_t index) const
+	{
+		assert(index < numBoxes);
+		return BBox(Vector(minX[index], minY[index], minZ[index]), Vector(maxX[index], maxY[index], maxZ[index]));
+	}
+
+	uint32_t GetNumBoxes() const
+	{
+		return numBoxes;
+	}
+
+	//how many indices or hits a query may write, which is a bit more than the number of boxes
+	uint32_t GetCapacity() const
+	{
+		return capacity;
+	}
+
+	/// <summary>
+	/// Finds the boxes the ray goes through before @maxDistance, sorted from the nearest to the farthest.
+	/// </summary>
+	/// <param name="hits">must hold GetCapacity() hits</param>
+	/// <returns>the number of boxes hit</returns>
+	uint32_t IntersectRay(const Ray &ray, float maxDistance, RayBoxHit *hits) const;
+
+	/// <summary>
+	/// Finds the boxes of the range [@first, @first + @count) that overlap @box, in increasing order.
+	/// </summary>
+	/// <param name="first">has to be a multiple of LANE_WIDTH</param>
+	/// <param name="indices">receives at most @maxIndices - LANE_WIDTH + 1 indices, the remaining boxes are not tested</param>
+	/// <returns>the number of overlapping boxes</returns>
+	uint32_t OverlapBox(const BBox &box, uint32_t first, uint32_t count, uint32_t *indices, uint32_t maxIndices) const;
+};
+
+/// <summary>
+/// LANE_WIDTH rays stored as structure-of-arrays, tested all at once against a box,
+/// for when many rays are cast over the same area, like a selection rectangle.
+/// </summary>
+struct RayPacket
+{
+	alignas(BoxSet::LANE_WIDTH * sizeof(float)) float originX[BoxSet::LANE_WIDTH];
+	alignas(BoxSet::LANE_WIDTH * sizeof(float)) float originY[BoxSet::LANE_WIDTH];
+	alignas(BoxSet::LANE_WIDTH * sizeof(float)) float originZ[BoxSet::LANE_WIDTH];
+	alignas(BoxSet::LANE_WIDTH * sizeof(float)) float invDirectionX[BoxSet::LANE_WIDTH];
+	alignas(BoxSet::LANE_WIDTH * sizeof(float)) float invDirectionY[BoxSet::LANE_WIDTH];
+	alignas(BoxSet::LANE_WIDTH * sizeof(float)) float invDirectionZ[BoxSet::LANE_WIDTH];
+	uint32_t numRays;
+
+	RayPacket():
+		originX(), originY(), originZ(),
+		invDirectionX(), invDirectionY(), invDirectionZ(),
+		numRays(0)
+	{}
+
+	//returns false once the packet is full
+	bool Add(const Ray &ray);
+
+	/// <summary>
+	/// Tests every ray of the packet against the box.
+	/// </summary>
+	/// <param name="distances">receives, for every ray hitting the box, where it enters it</param>
+	/// <returns>a mask with bit i set if ray i hits the box before @maxDistance</returns>
+	uint32_t IntersectBox(const BBox &box, float maxDistance, float *distances) const;
+};
@@ -0,0 +1,328 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "HullCollider.hh"
+#include <float.h> //FLT_MAX
+#include <math.h> //sqrtf
+
+//how many polygons a sweep looks at per room, the farther ones are ignored beyond that
+static constexpr uint32_t MAX_CANDIDATES = 512;
+
+//how many times the movement is redirected along the hulls, before giving up on the rest of it
+static constexpr uint32_t MAX_SLIDE_ITERATIONS = 4;
+
+//spheres stop this far from the hulls, so that the next sweep does not start touching them
+static constexpr float SKIN_DISTANCE = 0.05f;
+
+//movements shorter than this are not worth sweeping
+static constexpr float MIN_MOVEMENT = 0.001f;
+
+static inline bool IsHullUsable(const Face &face)
+{
+	return face.hull.valid && face.hull.vertices.Count() >= 3;
+}
+
+static inline BBox EmptyBox()
+{
+	return BBox(Vector(FLT_MAX, FLT_MAX, FLT_MAX), Vector(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+}
+
+bool HullCollider::Build(const Array<Room> &rooms)
+{
+	uint32_t numRooms = rooms.Count();
+	if (numRooms == 0)
+		return true;
+
+	//count first, every room's polygons being padded to a whole group of lanes
+	uint32_t numPolygons = 0;
+	uint32_t numVertices = 0;
+	for (const auto &room : rooms)
+	{
+		uint32_t numRoomPolygons = 0;
+		for (const auto &face : room.mesh.faces)
+		{
+			if (!IsHullUsable(face))
+				continue;
+			numRoomPolygons++;
+			numVertices += face.hull.vertices.Count();
+		}
+		numPolygons += (numRoomPolygons + BoxSet::LANE_WIDTH - 1) / BoxSet::LANE_WIDTH * BoxSet::LANE_WIDTH;
+	}
+
+	uint32_t size = numPolygons * sizeof(Polygon) + numVertices * sizeof(Vector) + numRooms * sizeof(RoomRange) + 3 * 16;
+	if (!pool.Create(size) || !roomBoxes.Create(numRooms) || !polygonBoxes.Create(numPolygons))
+	{
+		Destroy();
+		return false;
+	}
+
+	polygons = Array<Polygon>(pool.Allocate<Polygon>(numPolygons, 16), numPolygons);
+	vertices = Array<Vector>(pool.Allocate<Vector>(numVertices, 16), numVertices);
+	roomRanges = Array<RoomRange>(pool.Allocate<RoomRange>(numRooms), numRooms);
+
+	uint32_t polygonIndex = 0;
+	uint32_t vertexIndex = 0;
+	for (uint32_t r = 0; r < numRooms; r++)
+	{
+		const Room &room = rooms[r];
+		Vector position(room.position.x, room.position.y, room.position.z);
+		BBox roomBox = EmptyBox();
+
+		roomRanges[r].firstPolygon = polygonIndex;
+		for (uint32_t f = 0; f < room.mesh.faces.Count(); f++)
+		{
+			const Face &face = room.mesh.faces[f];
+			if (!IsHullUsable(face))
+				continue;
+
+			Polygon &polygon = polygons[polygonIndex];
+			polygon.firstVertex = vertexIndex;
+			polygon.numVertices = face.hull.vertices.Count();
+			polygon.roomIndex = r;
+			polygon.faceIndex = f;
+
+			//the plane is recomputed from the vertices with Newell's method, which copes with slightly non-planar polygons
+			BBox box = EmptyBox();
+			Vector normal(0.0f, 0.0f, 0.0f);
+			Vector center(0.0f, 0.0f, 0.0f);
+			for (uint32_t i = 0; i < polygon.numVertices; i++)
+			{
+				const Vector3 &v = face.hull.vertices[i];
+				const Vector3 &next = face.hull.vertices[(i + 1) % polygon.numVertices];
+				normal.x += (v.y - next.y) * (v.z + next.z);
+				normal.y += (v.z - next.z) * (v.x + next.x);
+				normal.z += (v.x - next.x) * (v.y + next.y);
+
+				Vector world = Vector(v.x, v.y, v.z) * room.scale + position;
+				vertices[vertexIndex + i] = world;
+				center += world;
+				box.Expand(world);
+			}
+
+			//degenerate polygons would collide with nothing anyway
+			float length = normal.Length();
+			if (length < FLT_EPSILON)
+				continue;
+
+			center *= 1.0f / (float)polygon.numVertices;
+			polygon.normal = normal * (1.0f / length);
+			polygon.distance = -polygon.normal.Dot(center);
+
+			polygonBoxes.Add(box);
+			roomBox.Expand(box.min);
+			roomBox.Expand(box.max);
+			vertexIndex += polygon.numVertices;
+			polygonIndex++;
+		}
+		roomRanges[r].numPolygons = polygonIndex - roomRanges[r].firstPolygon;
+
+		//pad with polygons that never overlap anything
+		while (polygonIndex % BoxSet::LANE_WIDTH)
+		{
+			polygons[polygonIndex].numVertices = 0;
+			polygonBoxes.Add(EmptyBox());
+			polygonIndex++;
+		}
+
+		roomBoxes.Add(roomBox);
+	}
+
+	return true;
+}
+
+void HullCollider::Destroy()
+{
+	polygonBoxes.Destroy();
+	roomBoxes.Destroy();
+	pool.Destroy();
+	polygons = Array<Polygon>();
+	vertices = Array<Vector>();
+	roomRanges = Array<RoomRange>();
+}
+
+/// <summary>
+/// Finds when a*t^2 + b*t + c, the squared distance to a vertex or an edge minus the squared radius, first reaches 0 in [0, maxTime).
+/// A sphere already overlapping is hit right away if it is getting closer, and not at all otherwise.
+/// </summary>
+static bool SolveSweep(float a, float b, float c, float maxTime, float &time)
+{
+	if (c < 0.0f)
+	{
+		if (b >= 0.0f || maxTime <= 0.0f)
+			return false;
+		time = 0.0f;
+		return true;
+	}
+
+	//both roots have the same sign, the entry is the smallest one
+	float determinant = b * b - 4.0f * a * c;
+	if (determinant < 0.0f || a < FLT_EPSILON)
+		return false;
+
+	float root = (-b - sqrtf(determinant)) / (2.0f * a);
+	if (root < 0.0f || root >= maxTime)
+		return false;
+
+	time = root;
+	return true;
+}
+
+static bool IsPointInPolygon(const Vector &point, const Vector *vertices, uint32_t numVertices, const Vector &normal)
+{
+	//inside a convex polygon, the point is on the same side of every edge, whatever the winding
+	bool anyPositive = false;
+	bool anyNegative = false;
+	for (uint32_t i = 0; i < numVertices; i++)
+	{
+		const Vector &a = vertices[i];
+		const Vector &b = vertices[(i + 1) % numVertices];
+		float side = (b - a).Cross(point - a).Dot(normal);
+		anyPositive |= side > 0.0f;
+		anyNegative |= side < 0.0f;
+	}
+	return !(anyPositive && anyNegative);
+}
+
+/// <summary>
+/// Sweeps a sphere against the polygon's plane, then against its edges and vertices, as described by Kasper Fauerby.
+/// Only hits earlier than the current @hit replace it.
+/// </summary>
+void HullCollider::SweepPolygon(const Polygon &polygon, const Vector &start, const Vector &movement, float radius, SweepHit &hit, bool &found) const
+{
+	const Vector *polygonVertices = vertices.Data() + polygon.firstVertex;
+
+	float startDistance = polygon.normal.Dot(start) + polygon.distance;
+	float side = startDistance >= 0.0f ? 1.0f : -1.0f;
+	Vector sideNormal = polygon.normal * side;
+	startDistance *= side;
+	float approachSpeed = -sideNormal.Dot(movement); //positive when getting closer to the plane
+
+	auto record = [&](float time, const Vector &contact)
+	{
+		Vector normal = start + movement * time - contact;
+		float length = normal.Length();
+		hit.time = time;
+		hit.normal = length > FLT_EPSILON ? normal * (1.0f / length) : sideNormal;
+		hit.roomIndex = polygon.roomIndex;
+		hit.faceIndex = polygon.faceIndex;
+		found = true;
+	};
+
+	if (startDistance < radius)
+	{
+		//already touching the plane, blocked right away if that is inside the polygon
+		Vector projected = start - sideNormal * startDistance;
+		if (IsPointInPolygon(projected, polygonVertices, polygon.numVertices, polygon.normal))
+		{
+			if (approachSpeed > 0.0f)
+				record(0.0f, projected);
+			return;
+		}
+	}
+	else
+	{
+		if (approachSpeed <= 0.0f)
+			return;
+
+		//the earliest a polygon can be touched is on its plane, if that point is inside it nothing else can come first
+		float time = (startDistance - radius) / approachSpeed;
+		if (time >= hit.time)
+			return;
+
+		Vector contact = start + movement * time - sideNormal * radius;
+		if (IsPointInPolygon(contact, polygonVertices, polygon.numVertices, polygon.normal))
+		{
+			record(time, contact);
+			return;
+		}
+	}
+
+	//the sphere may still catch a vertex or an edge
+	float speedSquared = movement.Dot(movement);
+	float radiusSquared = radius * radius;
+	for (uint32_t i = 0; i < polygon.numVertices; i++)
+	{
+		const Vector &a = polygonVertices[i];
+		const Vector &b = polygonVertices[(i + 1) % polygon.numVertices];
+
+		float time;
+		Vector toVertex = start - a;
+		if (SolveSweep(speedSquared, 2.0f * movement.Dot(toVertex), toVertex.Dot(toVertex) - radiusSquared, hit.time, time))
+			record(time, a);
+
+		//the distance to the edge's line, scaled by the edge's squared length
+		Vector edge = b - a;
+		Vector baseToVertex = a - start;
+		float edgeSquared = edge.Dot(edge);
+		float edgeDotMovement = edge.Dot(movement);
+		float edgeDotBase = edge.Dot(baseToVertex);
+		float qa = edgeSquared * speedSquared - edgeDotMovement * edgeDotMovement;
+		float qb = 2.0f * edgeDotMovement * edgeDotBase - edgeSquared * 2.0f * movement.Dot(baseToVertex);
+		float qc = edgeSquared * (baseToVertex.Dot(baseToVertex) - radiusSquared) - edgeDotBase * edgeDotBase;
+		if (edgeSquared > FLT_EPSILON && SolveSweep(qa, qb, qc, hit.time, time))
+		{
+			//only the segment counts, its ends were tested as vertices
+			float along = (edgeDotMovement * time - edgeDotBase) / edgeSquared;
+			if (along >= 0.0f && along <= 1.0f)
+				record(time, a + edge * along);
+		}
+	}
+}
+
+bool HullCollider::SweepSphere(const Vector &start, const Vector &movement, float radius, SweepHit &hit) const
+{
+	//the box around the whole path
+	Vector end = start + movement;
+	Vector extent(radius, radius, radius);
+	BBox sweptBox(start - extent, start + extent);
+	sweptBox.Expand(end - extent);
+	sweptBox.Expand(end + extent);
+
+	bool found = false;
+	hit.time = 1.0f;
+
+	uint32_t roomIndices[MAX_CANDIDATES];
+	uint32_t numRooms = roomBoxes.OverlapBox(sweptBox, 0, roomBoxes.GetNumBoxes(), roomIndices, MAX_CANDIDATES);
+	for (uint32_t r = 0; r < numRooms; r++)
+	{
+		const RoomRange &range = roomRanges[roomIndices[r]];
+
+		uint32_t candidates[MAX_CANDIDATES];
+		uint32_t numCandidates = polygonBoxes.OverlapBox(sweptBox, range.firstPolygon, range.numPolygons, candidates, MAX_CANDIDATES);
+		for (uint32_t c = 0; c < numCandidates; c++)
+			SweepPolygon(polygons[candidates[c]], start, movement, radius, hit, found);
+	}
+
+	return found;
+}
+
+//the collide-and-slide loop: move up to the contact, then go on with what is left of the movement, along the contact's plane
+Vector HullCollider::SlideSphere(const Vector &start, const Vector &movement, float radius) const
+{
+	Vector position = start;
+	Vector remaining = movement;
+
+	for (uint32_t i = 0; i < MAX_SLIDE_ITERATIONS; i++)
+	{
+		float length = remaining.Length();
+		if (length < MIN_MOVEMENT)
+			break;
+
+		SweepHit hit;
+		if (!SweepSphere(position, remaining, radius, hit))
+		{
+			position += remaining;
+			break;
+		}
+
+		float travel = fmaxf(hit.time * length - SKIN_DISTANCE, 0.0f);
+		position += remaining * (travel / length);
+
+		Vector rest = remaining * (1.0f - hit.time);
+		remaining = rest - hit.normal * rest.Dot(hit.normal);
+	}
+
+	return position;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "../world/Room.hh"
+#include "BoxSet.hh"
+#include <stdint.h>
+
+/// <summary>
+/// Collides spheres against the rooms' hulls, the convex polygons the game itself uses for collisions.
+/// The hulls are moved into world space once, with a box around every room and every polygon,
+/// so that a sweep only looks at the polygons of the rooms its path goes through.
+/// Polygons are two-sided, a sphere is stopped by whichever side it comes from.
+/// </summary>
+class HullCollider
+{
+public:
+	//where a sweep first touches a hull
+	struct SweepHit
+	{
+		float time; //fraction of the movement done before touching
+		Vector normal; //pushes the sphere away from the hull
+		uint32_t roomIndex;
+		uint32_t faceIndex;
+	};
+
+private:
+	struct Polygon
+	{
+		Vector normal; //the plane is normal.Dot(p) + distance = 0
+		float distance;
+		uint32_t firstVertex;
+		uint32_t numVertices; //0 for the padding between rooms
+		uint32_t roomIndex;
+		uint32_t faceIndex;
+	};
+
+	//the polygons of a room start on a multiple of BoxSet::LANE_WIDTH
+	struct RoomRange
+	{
+		uint32_t firstPolygon;
+		uint32_t numPolygons;
+	};
+
+	MemoryPool pool;
+	Array<Polygon> polygons; //in the same order as polygonBoxes
+	Array<Vector> vertices;
+	Array<RoomRange> roomRanges;
+	BoxSet roomBoxes;
+	BoxSet polygonBoxes;
+
+	void SweepPolygon(const Polygon &polygon, const Vector &start, const Vector &movement, float radius, SweepHit &hit, bool &found) const;
+
+public:
+	bool Build(const Array<Room> &rooms);
+	void Destroy();
+
+	/// <summary>
+	/// Moves a sphere along @movement, and finds the first hull polygon it touches.
+	/// </summary>
+	bool SweepSphere(const Vector &start, const Vector &movement, float radius, SweepHit &hit) const;
+
+	/// <summary>
+	/// Moves a sphere along @movement, sliding along the hulls it touches instead of stopping, and returns where it ends.
+	/// </summary>
+	Vector SlideSphere(const Vector &start, const Vector &movement, float radius) const;
+};
@@ -0,0 +1,269 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "LooseOctree.hh"
+#include <math.h> //fmaxf
+
+//every node pushes at most 8 children, and only the deepest pushed node can be popped next
+static constexpr uint32_t MAX_STACK_SIZE = 8 * (LooseOctree::MAX_DEPTH + 1);
+
+static inline float GetLargestHalfExtent(const BBox &box)
+{
+	Vector extent = box.max - box.min;
+	return 0.5f * fmaxf(extent.x, fmaxf(extent.y, extent.z));
+}
+
+static inline bool IsBoxOverlappingSphere(const BBox &box, const Vector &center, float radius)
+{
+	float dx = fmaxf(fmaxf(box.min.x - center.x, center.x - box.max.x), 0.0f);
+	float dy = fmaxf(fmaxf(box.min.y - center.y, center.y - box.max.y), 0.0f);
+	float dz = fmaxf(fmaxf(box.min.z - center.z, center.z - box.max.z), 0.0f);
+	return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+bool LooseOctree::Create(const BBox &bounds, uint32_t maxItems)
+{
+	maxDepth = 1;
+	for (uint32_t numCells = 8; numCells < maxItems && maxDepth < MAX_DEPTH; numCells *= 8)
+		maxDepth++;
+
+	//the worst case is every item alone at the end of its own branch
+	uint32_t maxNodes = maxItems * maxDepth + 1;
+	if (!pool.Create(maxNodes * sizeof(Node) + maxItems * sizeof(Item) + 2 * 16))
+		return false;
+
+	nodes = Array<Node>(pool.Allocate<Node>(maxNodes, 16), maxNodes);
+	items = Array<Item>(pool.Allocate<Item>(maxItems, 16), maxItems);
+	for (auto &item : items)
+		item.node = INVALID_INDEX;
+
+	numNodes = 0;
+	firstFreeNode = INVALID_INDEX;
+	Vector center = (bounds.min + bounds.max) * 0.5f;
+	AllocateNode(INVALID_INDEX, center, GetLargestHalfExtent(bounds));
+
+	return true;
+}
+
+void LooseOctree::Destroy()
+{
+	pool.Destroy();
+	nodes = Array<Node>();
+	items = Array<Item>();
+	numNodes = 0;
+	firstFreeNode = INVALID_INDEX;
+}
+
+uint32_t LooseOctree::AllocateNode(uint32_t parent, const Vector &center, float halfSize)
+{
+	uint32_t nodeIndex;
+	if (firstFreeNode != INVALID_INDEX)
+	{
+		nodeIndex = firstFreeNode;
+		firstFreeNode = nodes[nodeIndex].firstItem;
+	}
+	else if (numNodes < nodes.Count())
+		nodeIndex = numNodes++;
+	else
+		return INVALID_INDEX;
+
+	Node &node = nodes[nodeIndex];
+	node.center = center;
+	node.halfSize = halfSize;
+	node.parent = parent;
+	for (auto &child : node.children)
+		child = INVALID_INDEX;
+	node.numChildren = 0;
+	node.firstItem = INVALID_INDEX;
+	return nodeIndex;
+}
+
+//goes down as long as the box fits in the child holding its center, creating the nodes on the way
+uint32_t LooseOctree::FindNode(const BBox &box)
+{
+	Vector center = (box.min + box.max) * 0.5f;
+	float halfExtent = GetLargestHalfExtent(box);
+
+	uint32_t nodeIndex = 0;
+	for (uint32_t depth = 0; depth < maxDepth; depth++)
+	{
+		const Node &node = nodes[nodeIndex];
+		float childHalfSize = node.halfSize * 0.5f;
+		if (halfExtent > childHalfSize)
+			break;
+
+		//only the root can be given a box whose center is outside of its cell
+		Vector offset = center - node.center;
+		if (fabsf(offset.x) > node.halfSize || fabsf(offset.y) > node.halfSize || fabsf(offset.z) > node.halfSize)
+			break;
+
+		uint32_t octant = (offset.x >= 0.0f ? 1 : 0) | (offset.y >= 0.0f ? 2 : 0) | (offset.z >= 0.0f ? 4 : 0);
+		uint32_t child = node.children[octant];
+		if (child == INVALID_INDEX)
+		{
+			Vector childCenter(
+				node.center.x + (octant & 1 ? childHalfSize : -childHalfSize),
+				node.center.y + (octant & 2 ? childHalfSize : -childHalfSize),
+				node.center.z + (octant & 4 ? childHalfSize : -childHalfSize)
+			);
+			child = AllocateNode(nodeIndex, childCenter, childHalfSize);
+			if (child == INVALID_INDEX)
+				break;
+
+			nodes[nodeIndex].children[octant] = child;
+			nodes[nodeIndex].numChildren++;
+		}
+		nodeIndex = child;
+	}
+
+	return nodeIndex;
+}
+
+bool LooseOctree::IsInNode(const BBox &box, uint32_t nodeIndex) const
+{
+	const Node &node = nodes[nodeIndex];
+	Vector offset = (box.min + box.max) * 0.5f - node.center;
+	return fabsf(offset.x) <= node.halfSize && fabsf(offset.y) <= node.halfSize && fabsf(offset.z) <= node.halfSize &&
+		GetLargestHalfExtent(box) <= node.halfSize;
+}
+
+void LooseOctree::Link(uint32_t itemIndex, uint32_t nodeIndex)
+{
+	Item &item = items[itemIndex];
+	Node &node = nodes[nodeIndex];
+	item.node = nodeIndex;
+	item.previous = INVALID_INDEX;
+	item.next = node.firstItem;
+	if (node.firstItem != INVALID_INDEX)
+		items[node.firstItem].previous = itemIndex;
+	node.firstItem = itemIndex;
+}
+
+void LooseOctree::Unlink(uint32_t itemIndex)
+{
+	Item &item = items[itemIndex];
+	if (item.previous != INVALID_INDEX)
+		items[item.previous].next = item.next;
+	else
+		nodes[item.node].firstItem = item.next;
+	if (item.next != INVALID_INDEX)
+		items[item.next].previous = item.previous;
+	item.node = INVALID_INDEX;
+}
+
+//gives back the node and its ancestors as long as they hold nothing anymore, except for the root
+void LooseOctree::PruneNode(uint32_t nodeIndex)
+{
+	while (nodeIndex != 0)
+	{
+		Node &node = nodes[nodeIndex];
+		if (node.firstItem != INVALID_INDEX || node.numChildren != 0)
+			return;
+
+		Node &parent = nodes[node.parent];
+		for (auto &child : parent.children)
+		{
+			if (child == nodeIndex)
+				child = INVALID_INDEX;
+		}
+		parent.numChildren--;
+
+		uint32_t parentIndex = node.parent;
+		node.firstItem = firstFreeNode;
+		firstFreeNode = nodeIndex;
+		nodeIndex = parentIndex;
+	}
+}
+
+void LooseOctree::Insert(uint32_t itemIndex, const BBox &box)
+{
+	assert(items[itemIndex].node == INVALID_INDEX);
+	items[itemIndex].box = box;
+	Link(itemIndex, FindNode(box));
+}
+
+void LooseOctree::Remove(uint32_t itemIndex)
+{
+	uint32_t nodeIndex = items[itemIndex].node;
+	if (nodeIndex == INVALID_INDEX)
+		return;
+
+	Unlink(itemIndex);
+	PruneNode(nodeIndex);
+}
+
+void LooseOctree::Update(uint32_t itemIndex, const BBox &box)
+{
+	Item &item = items[itemIndex];
+	if (item.node != INVALID_INDEX && IsInNode(box, item.node))
+	{
+		item.box = box;
+		return;
+	}
+
+	Remove(itemIndex);
+	Insert(itemIndex, box);
+}
+
+template <typename Overlaps, typename Accept>
+uint32_t LooseOctree::Query(Overlaps overlaps, Accept accept, uint32_t *results, uint32_t maxResults) const
+{
+	if (nodes.Count() == 0)
+		return 0;
+
+	uint32_t numResults = 0;
+	uint32_t stack[MAX_STACK_SIZE];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const Node &node = nodes[nodeIndex];
+
+		//the root also holds what is outside of it, so it is always visited
+		float looseHalfSize = node.halfSize * 2.0f;
+		Vector looseExtent(looseHalfSize, looseHalfSize, looseHalfSize);
+		if (nodeIndex != 0 && !overlaps(BBox(node.center - looseExtent, node.center + looseExtent)))
+			continue;
+
+		for (uint32_t itemIndex = node.firstItem; itemIndex != INVALID_INDEX; itemIndex = items[itemIndex].next)
+		{
+			if (!accept(items[itemIndex].box))
+				continue;
+
+			results[numResults++] = itemIndex;
+			if (numResults == maxResults)
+				return numResults;
+		}
+
+		for (uint32_t child : node.children)
+		{
+			if (child == INVALID_INDEX)
+				continue;
+			assert(stackSize < MAX_STACK_SIZE);
+			stack[stackSize++] = child;
+		}
+	}
+
+	return numResults;
+}
+
+uint32_t LooseOctree::QuerySphere(const Vector &center, float radius, uint32_t *results, uint32_t maxResults) const
+{
+	auto overlaps = [&](const BBox &box) { return IsBoxOverlappingSphere(box, center, radius); };
+	return Query(overlaps, overlaps, results, maxResults);
+}
+
+uint32_t LooseOctree::QueryBox(const BBox &box, uint32_t *results, uint32_t maxResults) const
+{
+	auto overlaps = [&](const BBox &other) { return box.IsIntersectBox(other); };
+	return Query(overlaps, overlaps, results, maxResults);
+}
+
+uint32_t LooseOctree::QueryFrustum(const Frustum &frustum, uint32_t *results, uint32_t maxResults) const
+{
+	auto overlaps = [&](const BBox &box) { return frustum.IsBoxVisible(box); };
+	return Query(overlaps, overlaps, results, maxResults);
+}
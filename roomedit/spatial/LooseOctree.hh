@@ -0,0 +1,77 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "../render/Frustum.hh"
+#include "../BBox.hh"
+#include <stdint.h>
+
+/// <summary>
+/// A loose octree over boxes identified by small integers, for finding what is inside a sphere, a box or a frustum.
+/// Every node's bounds are twice the size of its cell, so an item is stored in the single node whose cell holds its center,
+/// at the deepest level where it still fits, and moving an item only relinks it when it leaves that cell.
+/// Nodes are created as items need them, and given back once empty.
+/// </summary>
+class LooseOctree
+{
+public:
+	static constexpr uint32_t MAX_DEPTH = 8;
+	static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+private:
+	struct Node
+	{
+		Vector center; //of the cell
+		float halfSize; //of the cell, the node's bounds reach twice as far
+		uint32_t parent;
+		uint32_t children[8]; //indexed by the octant, with x in bit 0, y in bit 1 and z in bit 2
+		uint32_t numChildren;
+		uint32_t firstItem; //or the next free node, once given back
+	};
+
+	struct Item
+	{
+		BBox box;
+		uint32_t node; //INVALID_INDEX when not in the tree
+		uint32_t previous; //in the node's list
+		uint32_t next;
+	};
+
+	MemoryPool pool;
+	Array<Node> nodes;
+	uint32_t numNodes;
+	uint32_t firstFreeNode;
+	uint32_t maxDepth; //about one cell per item at the deepest level, nodes beyond that only cost time
+	Array<Item> items; //indexed by the item's identifier
+
+	uint32_t AllocateNode(uint32_t parent, const Vector &center, float halfSize);
+	uint32_t FindNode(const BBox &box);
+	void Link(uint32_t itemIndex, uint32_t nodeIndex);
+	void Unlink(uint32_t itemIndex);
+	void PruneNode(uint32_t nodeIndex);
+	bool IsInNode(const BBox &box, uint32_t nodeIndex) const;
+
+	template <typename Overlaps, typename Accept>
+	uint32_t Query(Overlaps overlaps, Accept accept, uint32_t *results, uint32_t maxResults) const;
+
+public:
+	LooseOctree():
+		numNodes(0),
+		firstFreeNode(INVALID_INDEX),
+		maxDepth(0)
+	{}
+
+	/// <param name="bounds">the space the tree divides, items outside of it still work but stay at the root</param>
+	/// <param name="maxItems">items are identified by an index below this</param>
+	bool Create(const BBox &bounds, uint32_t maxItems);
+	void Destroy();
+
+	void Insert(uint32_t itemIndex, const BBox &box);
+	void Remove(uint32_t itemIndex);
+
+	//moves an item, cheaply as long as it stays in the same cell and keeps about the same size
+	void Update(uint32_t itemIndex, const BBox &box);
+
+	//the queries write the indices of the items found, at most @maxResults of them, in no particular order
+	uint32_t QuerySphere(const Vector &center, float radius, uint32_t *results, uint32_t maxResults) const;
+	uint32_t QueryBox(const BBox &box, uint32_t *results, uint32_t maxResults) const;
+	uint32_t QueryFrustum(const Frustum &frustum, uint32_t *results, uint32_t maxResults) const;
+};
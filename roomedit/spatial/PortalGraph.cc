@@ -0,0 +1,528 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "PortalGraph.hh"
+#include "bounds.hh"
+#include <algorithm> //std::sort
+#include <float.h> //FLT_EPSILON
+#include <string.h> //memcpy
+
+static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+//longer loops are the outline of a whole piece of terrain, not a doorway
+static constexpr uint32_t MAX_LOOP_VERTICES = 256;
+
+//how far from their plane the vertices of an opening can be, relative to its size
+static constexpr float PLANARITY_TOLERANCE = 0.05f;
+
+//how far apart the centers of two openings can be while still being the same doorway, relative to their size
+static constexpr float MATCH_TOLERANCE = 0.1f;
+static constexpr float MIN_MATCH_COSINE = 0.98f;
+
+//an eye closer than this to a portal's plane looks through it without narrowing the view
+static constexpr float MIN_EYE_DISTANCE = 1.0f;
+
+static constexpr uint32_t MAX_PORTAL_DEPTH = 16;
+
+//portals a traversal goes through at most, as rooms can be reached again along other paths
+static constexpr uint32_t MAX_PORTAL_VISITS = 4096;
+
+//a convex polygon gains at most one vertex per plane it is clipped by
+static constexpr uint32_t MAX_CLIP_VERTICES = 64;
+
+//with the vertices welded, the smallest index first, and the direction the triangle walks it in
+struct Edge
+{
+	uint32_t a;
+	uint32_t b;
+	uint32_t from;
+	uint32_t to;
+};
+
+//a flat loop of boundary edges, before knowing where it leads
+struct Opening
+{
+	Vector normal;
+	Vector center;
+	float radius;
+	uint32_t firstVertex;
+	uint32_t numVertices;
+	uint32_t toRoom;
+};
+
+static inline Vector GetWorldPosition(const Room &room, uint32_t positionIndex)
+{
+	const Vector3 &p = room.mesh.positions[positionIndex];
+	return Vector(p.x, p.y, p.z) * room.scale + Vector(room.position.x, room.position.y, room.position.z);
+}
+
+template <typename Function>
+static void ForEachVisibleTriangle(const Mesh &mesh, Function function)
+{
+	for (const auto &face : mesh.faces)
+	{
+		if (face.indexSurfaceProperty != 3)
+			ForEachTriangle(face, function);
+	}
+}
+
+static uint32_t GetBoundaryEdgesMaxSize(const Mesh &mesh)
+{
+	uint32_t numTriangles = 0;
+	ForEachVisibleTriangle(mesh, [&](uint32_t, uint32_t, uint32_t) { numTriangles++; });
+
+	//welding, walking the loops, then the edges and whether they were walked
+	return mesh.numVerts * 3 * sizeof(uint32_t) + numTriangles * 3 * (sizeof(Edge) + sizeof(bool)) + 4 * 16;
+}
+
+//finds the edges used by a single visible triangle, with the vertices sharing a position welded together
+static uint32_t FindBoundaryEdges(const Mesh &mesh, MemoryPool &scratch, Edge *&edges)
+{
+	uint32_t numVerts = mesh.numVerts;
+	const Vector3 *positions = mesh.positions;
+	uint32_t *order = scratch.Allocate<uint32_t>(numVerts);
+	uint32_t *welded = scratch.Allocate<uint32_t>(numVerts);
+	for (uint32_t i = 0; i < numVerts; i++)
+		order[i] = i;
+	std::sort(order, order + numVerts, [positions](uint32_t i, uint32_t j)
+	{
+		const Vector3 &a = positions[i];
+		const Vector3 &b = positions[j];
+		if (a.x != b.x)
+			return a.x < b.x;
+		if (a.y != b.y)
+			return a.y < b.y;
+		return a.z < b.z;
+	});
+	for (uint32_t i = 0; i < numVerts; i++)
+	{
+		const Vector3 &a = positions[order[i]];
+		bool isSame = i > 0 && a.x == positions[order[i - 1]].x && a.y == positions[order[i - 1]].y && a.z == positions[order[i - 1]].z;
+		welded[order[i]] = isSame ? welded[order[i - 1]] : order[i];
+	}
+
+	uint32_t numTriangles = 0;
+	ForEachVisibleTriangle(mesh, [&](uint32_t, uint32_t, uint32_t) { numTriangles++; });
+	edges = scratch.Allocate<Edge>(numTriangles * 3);
+
+	uint32_t numEdges = 0;
+	ForEachVisibleTriangle(mesh, [&](uint32_t c0, uint32_t c1, uint32_t c2)
+	{
+		uint32_t v[3] = { welded[mesh.corners[c0].index], welded[mesh.corners[c1].index], welded[mesh.corners[c2].index] };
+		if (v[0] == v[1] || v[1] == v[2] || v[2] == v[0])
+			return;
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			Edge &edge = edges[numEdges++];
+			edge.from = v[i];
+			edge.to = v[(i + 1) % 3];
+			edge.a = edge.from < edge.to ? edge.from : edge.to;
+			edge.b = edge.from < edge.to ? edge.to : edge.from;
+		}
+	});
+
+	//keep the edges found only once
+	std::sort(edges, edges + numEdges, [](const Edge &x, const Edge &y) { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+	uint32_t numBoundaryEdges = 0;
+	for (uint32_t i = 0; i < numEdges;)
+	{
+		uint32_t end = i + 1;
+		while (end < numEdges && edges[end].a == edges[i].a && edges[end].b == edges[i].b)
+			end++;
+		if (end == i + 1)
+			edges[numBoundaryEdges++] = edges[i];
+		i = end;
+	}
+
+	return numBoundaryEdges;
+}
+
+/// <summary>
+/// Keeps a loop as an opening if it is flat, replacing it with its convex hull on its plane.
+/// </summary>
+static bool MakeOpening(const Vector *loop, uint32_t numLoopVertices, Opening &opening, Vector *vertices)
+{
+	Vector normal(0.0f, 0.0f, 0.0f);
+	Vector center(0.0f, 0.0f, 0.0f);
+	for (uint32_t i = 0; i < numLoopVertices; i++)
+	{
+		const Vector &v = loop[i];
+		const Vector &next = loop[(i + 1) % numLoopVertices];
+		normal.x += (v.y - next.y) * (v.z + next.z);
+		normal.y += (v.z - next.z) * (v.x + next.x);
+		normal.z += (v.x - next.x) * (v.y + next.y);
+		center += v;
+	}
+
+	float length = normal.Length();
+	if (length < FLT_EPSILON)
+		return false;
+	normal *= 1.0f / length;
+	center *= 1.0f / (float)numLoopVertices;
+
+	float radius = 0.0f;
+	for (uint32_t i = 0; i < numLoopVertices; i++)
+		radius = fmaxf(radius, (loop[i] - center).Length());
+	for (uint32_t i = 0; i < numLoopVertices; i++)
+	{
+		if (fabsf(normal.Dot(loop[i] - center)) > PLANARITY_TOLERANCE * radius)
+			return false;
+	}
+
+	//Andrew's monotone chain, on the plane
+	Vector axis = fabsf(normal.x) < 0.9f ? Vector(1.0f, 0.0f, 0.0f) : Vector(0.0f, 1.0f, 0.0f);
+	Vector u = normal.Cross(axis);
+	u *= 1.0f / u.Length();
+	Vector v = normal.Cross(u);
+
+	struct Point
+	{
+		float x;
+		float y;
+		uint32_t index;
+	};
+	Point points[MAX_LOOP_VERTICES];
+	for (uint32_t i = 0; i < numLoopVertices; i++)
+		points[i] = { u.Dot(loop[i] - center), v.Dot(loop[i] - center), i };
+	std::sort(points, points + numLoopVertices, [](const Point &a, const Point &b) { return a.x != b.x ? a.x < b.x : a.y < b.y; });
+
+	auto turn = [](const Point &o, const Point &a, const Point &b) { return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x); };
+	Point hull[2 * MAX_LOOP_VERTICES];
+	uint32_t numHull = 0;
+	for (uint32_t i = 0; i < numLoopVertices; i++)
+	{
+		while (numHull >= 2 && turn(hull[numHull - 2], hull[numHull - 1], points[i]) <= 0.0f)
+			numHull--;
+		hull[numHull++] = points[i];
+	}
+	for (uint32_t i = numLoopVertices - 1, lower = numHull + 1; i-- > 0;)
+	{
+		while (numHull >= lower && turn(hull[numHull - 2], hull[numHull - 1], points[i]) <= 0.0f)
+			numHull--;
+		hull[numHull++] = points[i];
+	}
+	numHull--; //the first point was added again
+
+	if (numHull < 3 || numHull > PortalGraph::MAX_PORTAL_VERTICES)
+		return false;
+
+	//flattened onto the plane
+	for (uint32_t i = 0; i < numHull; i++)
+	{
+		const Vector &p = loop[hull[i].index];
+		vertices[i] = p - normal * normal.Dot(p - center);
+	}
+
+	opening.normal = normal;
+	opening.center = center;
+	opening.radius = radius;
+	opening.numVertices = numHull;
+	opening.toRoom = INVALID_INDEX;
+	return true;
+}
+
+//chains the boundary edges of the room into loops, and keeps the flat ones, counting every loop in @numLoops
+static uint32_t FindOpenings(const Room &room, MemoryPool &scratch, Opening *openings, Vector *vertices, uint32_t &numVertices, uint32_t &numLoops)
+{
+	uint32_t offset = scratch.GetOffset();
+
+	Edge *edges;
+	uint32_t numEdges = FindBoundaryEdges(room.mesh, scratch, edges);
+
+	uint32_t *outgoing = scratch.Allocate<uint32_t>(room.mesh.numVerts);
+	bool *isWalked = scratch.Allocate<bool>(numEdges);
+	for (uint32_t i = 0; i < room.mesh.numVerts; i++)
+		outgoing[i] = INVALID_INDEX;
+	for (uint32_t e = 0; e < numEdges; e++)
+	{
+		isWalked[e] = false;
+		if (outgoing[edges[e].from] == INVALID_INDEX)
+			outgoing[edges[e].from] = e;
+	}
+
+	uint32_t numOpenings = 0;
+	numLoops = 0;
+	for (uint32_t start = 0; start < numEdges; start++)
+	{
+		//vertices where several loops meet may split a loop, which then stays open
+		Vector loop[MAX_LOOP_VERTICES];
+		uint32_t numLoopVertices = 0;
+		bool isClosed = false;
+		for (uint32_t e = start; e != INVALID_INDEX && !isWalked[e] && numLoopVertices < MAX_LOOP_VERTICES; e = outgoing[edges[e].to])
+		{
+			isWalked[e] = true;
+			loop[numLoopVertices++] = GetWorldPosition(room, edges[e].from);
+			if (outgoing[edges[e].to] == start)
+			{
+				isClosed = true;
+				break;
+			}
+		}
+
+		if (numLoopVertices > 0)
+			numLoops++;
+		if (!isClosed || numLoopVertices < 3)
+			continue;
+
+		Opening &opening = openings[numOpenings];
+		opening.firstVertex = numVertices;
+		if (MakeOpening(loop, numLoopVertices, opening, vertices + numVertices))
+		{
+			numVertices += opening.numVertices;
+			numOpenings++;
+		}
+	}
+
+	scratch.FlushFrom(offset);
+	return numOpenings;
+}
+
+static bool AreOpeningsMatching(const Opening &a, const Opening &b)
+{
+	float tolerance = MATCH_TOLERANCE * fmaxf(a.radius, b.radius);
+	return (a.center - b.center).Length() <= tolerance && fabsf(a.normal.Dot(b.normal)) >= MIN_MATCH_COSINE;
+}
+
+bool PortalGraph::Build(const Array<Room> &rooms)
+{
+	uint32_t numRooms = rooms.Count();
+	if (numRooms == 0)
+		return true;
+
+	//a loop has at least 3 edges, so the boundary edges bound the openings
+	MemoryPool edgeScratch;
+	uint32_t edgeScratchSize = 0;
+	for (const auto &room : rooms)
+	{
+		uint32_t size = GetBoundaryEdgesMaxSize(room.mesh);
+		edgeScratchSize = size > edgeScratchSize ? size : edgeScratchSize;
+	}
+	if (!edgeScratch.Create(edgeScratchSize))
+		return false;
+
+	uint32_t maxOpeningVertices = 0;
+	for (const auto &room : rooms)
+	{
+		Edge *edges;
+		maxOpeningVertices += FindBoundaryEdges(room.mesh, edgeScratch, edges);
+		edgeScratch.FlushFrom(0);
+	}
+
+	MemoryPool openingScratch;
+	uint32_t maxOpenings = maxOpeningVertices / 3;
+	if (!openingScratch.Create(maxOpenings * sizeof(Opening) + maxOpeningVertices * sizeof(Vector) + (numRooms * 2 + 1) * sizeof(uint32_t) + 4 * 16))
+	{
+		edgeScratch.Destroy();
+		return false;
+	}
+	Opening *openings = openingScratch.Allocate<Opening>(maxOpenings, 16);
+	Vector *openingVertices = openingScratch.Allocate<Vector>(maxOpeningVertices, 16);
+	uint32_t *firstOpenings = openingScratch.Allocate<uint32_t>(numRooms + 1);
+	uint32_t *numLoops = openingScratch.Allocate<uint32_t>(numRooms);
+
+	uint32_t numOpenings = 0;
+	uint32_t numOpeningVertices = 0;
+	for (uint32_t r = 0; r < numRooms; r++)
+	{
+		firstOpenings[r] = numOpenings;
+		numOpenings += FindOpenings(rooms[r], edgeScratch, openings + numOpenings, openingVertices, numOpeningVertices, numLoops[r]);
+	}
+	firstOpenings[numRooms] = numOpenings;
+	edgeScratch.Destroy();
+
+	//an opening becomes a portal if a room it lists as viewable has the same opening
+	uint32_t numPortals = 0;
+	uint32_t numPortalVertices = 0;
+	for (uint32_t a = 0; a < numRooms; a++)
+	{
+		for (uint32_t i = firstOpenings[a]; i < firstOpenings[a + 1]; i++)
+		{
+			Opening &opening = openings[i];
+			for (uint32_t b : rooms[a].viewableRooms)
+			{
+				if (b == a || b >= numRooms)
+					continue;
+
+				for (uint32_t j = firstOpenings[b]; j < firstOpenings[b + 1] && opening.toRoom == INVALID_INDEX; j++)
+				{
+					if (AreOpeningsMatching(opening, openings[j]))
+						opening.toRoom = b;
+				}
+				if (opening.toRoom != INVALID_INDEX)
+					break;
+			}
+
+			if (opening.toRoom != INVALID_INDEX)
+			{
+				numPortals++;
+				numPortalVertices += opening.numVertices;
+			}
+		}
+	}
+
+	if (!pool.Create(numPortals * sizeof(Portal) + numPortalVertices * sizeof(Vector) + numRooms * sizeof(RoomRange) + 3 * 16))
+	{
+		openingScratch.Destroy();
+		return false;
+	}
+	portals = Array<Portal>(pool.Allocate<Portal>(numPortals, 16), numPortals);
+	vertices = Array<Vector>(pool.Allocate<Vector>(numPortalVertices, 16), numPortalVertices);
+	roomRanges = Array<RoomRange>(pool.Allocate<RoomRange>(numRooms), numRooms);
+
+	uint32_t portalIndex = 0;
+	uint32_t vertexIndex = 0;
+	for (uint32_t a = 0; a < numRooms; a++)
+	{
+		BBox boxA = ComputeRoomBBox(rooms[a]);
+		roomRanges[a].firstPortal = portalIndex;
+		for (uint32_t i = firstOpenings[a]; i < firstOpenings[a + 1]; i++)
+		{
+			const Opening &opening = openings[i];
+			if (opening.toRoom == INVALID_INDEX)
+				continue;
+
+			//the room it leads to is mostly on the other side
+			BBox boxB = ComputeRoomBBox(rooms[opening.toRoom]);
+			Vector direction = (boxB.min + boxB.max) * 0.5f - (boxA.min + boxA.max) * 0.5f;
+
+			Portal &portal = portals[portalIndex++];
+			portal.normal = direction.Dot(opening.normal) >= 0.0f ? opening.normal : -opening.normal;
+			portal.distance = -portal.normal.Dot(opening.center);
+			portal.toRoom = opening.toRoom;
+			portal.firstVertex = vertexIndex;
+			portal.numVertices = opening.numVertices;
+			memcpy(vertices.Data() + vertexIndex, openingVertices + opening.firstVertex, opening.numVertices * sizeof(Vector));
+			vertexIndex += opening.numVertices;
+		}
+		roomRanges[a].numPortals = portalIndex - roomRanges[a].firstPortal;
+		roomRanges[a].numLoops = numLoops[a];
+	}
+
+	openingScratch.Destroy();
+	return true;
+}
+
+void PortalGraph::Destroy()
+{
+	pool.Destroy();
+	portals = Array<Portal>();
+	vertices = Array<Vector>();
+	roomRanges = Array<RoomRange>();
+}
+
+//Sutherland-Hodgman, keeping what is on the positive side of the plane
+static uint32_t ClipPolygon(const Vector *in, uint32_t numIn, const Vector &plane, Vector *out)
+{
+	uint32_t numOut = 0;
+	for (uint32_t i = 0; i < numIn && numOut + 2 <= MAX_CLIP_VERTICES; i++)
+	{
+		const Vector &a = in[i];
+		const Vector &b = in[(i + 1) % numIn];
+		float distanceA = plane.Dot(a) + plane.w;
+		float distanceB = plane.Dot(b) + plane.w;
+		if (distanceA >= 0.0f)
+			out[numOut++] = a;
+		if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+			out[numOut++] = a + (b - a) * (distanceA / (distanceA - distanceB));
+	}
+	return numOut;
+}
+
+void PortalGraph::VisitRoom(uint32_t roomIndex, const Vector &eye, const Vector *planes, uint32_t numPlanes, uint32_t depth,
+	uint32_t *path, uint32_t *visibleRooms, uint32_t &numVisible, bool *isRoomVisible, uint32_t &budget) const
+{
+	const RoomRange &range = roomRanges[roomIndex];
+	for (uint32_t p = range.firstPortal; p < range.firstPortal + range.numPortals && budget; p++)
+	{
+		budget--;
+		const Portal &portal = portals[p];
+
+		//going back through a room of the path would only see what was already seen
+		bool isOnPath = false;
+		for (uint32_t i = 0; i <= depth; i++)
+			isOnPath |= path[i] == portal.toRoom;
+		if (isOnPath)
+			continue;
+
+		//only the portals the eye is in front of lead anywhere
+		float eyeDistance = portal.normal.Dot(eye) + portal.distance;
+		if (eyeDistance > MIN_EYE_DISTANCE)
+			continue;
+
+		Vector clipped[2][MAX_CLIP_VERTICES];
+		uint32_t numClipped = portal.numVertices;
+		memcpy(clipped[0], vertices.Data() + portal.firstVertex, numClipped * sizeof(Vector));
+		uint32_t current = 0;
+		for (uint32_t i = 0; i < numPlanes && numClipped >= 3; i++)
+		{
+			numClipped = ClipPolygon(clipped[current], numClipped, planes[i], clipped[current ^ 1]);
+			current ^= 1;
+		}
+		if (numClipped < 3)
+			continue;
+
+		if (!isRoomVisible[portal.toRoom])
+		{
+			isRoomVisible[portal.toRoom] = true;
+			visibleRooms[numVisible++] = portal.toRoom;
+		}
+
+		if (depth + 1 >= MAX_PORTAL_DEPTH)
+			continue;
+		path[depth + 1] = portal.toRoom;
+
+		//standing in the opening, there is nothing to narrow the view with
+		if (eyeDistance > -MIN_EYE_DISTANCE)
+		{
+			VisitRoom(portal.toRoom, eye, planes, numPlanes, depth + 1, path, visibleRooms, numVisible, isRoomVisible, budget);
+			continue;
+		}
+
+		//the planes going through the eye and the edges of what is seen of the portal, and the portal itself
+		const Vector *polygon = clipped[current];
+		Vector centroid(0.0f, 0.0f, 0.0f);
+		for (uint32_t i = 0; i < numClipped; i++)
+			centroid += polygon[i];
+		centroid *= 1.0f / (float)numClipped;
+
+		Vector portalPlanes[MAX_CLIP_VERTICES + 1];
+		uint32_t numPortalPlanes = 0;
+		for (uint32_t i = 0; i < numClipped; i++)
+		{
+			Vector normal = (polygon[i] - eye).Cross(polygon[(i + 1) % numClipped] - eye);
+			float length = normal.Length();
+			if (length < FLT_EPSILON)
+				continue;
+
+			normal *= 1.0f / length;
+			if (normal.Dot(centroid - eye) < 0.0f)
+				normal = -normal;
+			portalPlanes[numPortalPlanes++] = Vector(normal.x, normal.y, normal.z, -normal.Dot(eye));
+		}
+		portalPlanes[numPortalPlanes++] = Vector(portal.normal.x, portal.normal.y, portal.normal.z, portal.distance);
+
+		VisitRoom(portal.toRoom, eye, portalPlanes, numPortalPlanes, depth + 1, path, visibleRooms, numVisible, isRoomVisible, budget);
+	}
+}
+
+uint32_t PortalGraph::FindVisibleRooms(uint32_t roomIndex, const Vector &eye, const Frustum &frustum, uint32_t *visibleRooms, bool *isRoomVisible) const
+{
+	if (!HasPortals(roomIndex))
+		return 0;
+
+	Vector planes[Frustum::NUM_PLANES];
+	for (uint32_t i = 0; i < Frustum::NUM_PLANES; i++)
+		planes[i] = frustum.GetPlane(i);
+
+	//the path always starts in the eye's room, so it is never found again
+	uint32_t path[MAX_PORTAL_DEPTH];
+	path[0] = roomIndex;
+
+	uint32_t numVisible = 0;
+	uint32_t budget = MAX_PORTAL_VISITS;
+	VisitRoom(roomIndex, eye, planes, Frustum::NUM_PLANES, 0, path, visibleRooms, numVisible, isRoomVisible, budget);
+	return numVisible;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "../world/Room.hh"
+#include "../render/Frustum.hh"
+#include <stdint.h>
+
+/// <summary>
+/// The openings through which the rooms see each other, found where the room meshes meet.
+/// An opening is a loop of edges used by a single visible triangle of a room, flat enough to be a doorway,
+/// that lines up with an opening of a room the first one lists as viewable.
+/// From the room the camera is in, the view frustum is narrowed through every opening on screen,
+/// so that only the rooms seen through an opening are found visible.
+/// </summary>
+class PortalGraph
+{
+public:
+	static constexpr uint32_t MAX_PORTAL_VERTICES = 32;
+
+private:
+	//convex, in world space
+	struct Portal
+	{
+		Vector normal; //pointing into the room the portal leads to
+		float distance; //the plane is normal.Dot(p) + distance = 0
+		uint32_t toRoom;
+		uint32_t firstVertex;
+		uint32_t numVertices;
+	};
+
+	struct RoomRange
+	{
+		uint32_t firstPortal;
+		uint32_t numPortals;
+		uint32_t numLoops; //the loops of boundary edges, whether they became portals or not
+	};
+
+	MemoryPool pool;
+	Array<Portal> portals; //the portals of every room, room after room
+	Array<Vector> vertices;
+	Array<RoomRange> roomRanges;
+
+	void VisitRoom(uint32_t roomIndex, const Vector &eye, const Vector *planes, uint32_t numPlanes, uint32_t depth,
+		uint32_t *path, uint32_t *visibleRooms, uint32_t &numVisible, bool *isRoomVisible, uint32_t &budget) const;
+
+public:
+	bool Build(const Array<Room> &rooms);
+	void Destroy();
+
+	bool HasPortals(uint32_t roomIndex) const
+	{
+		return roomIndex < roomRanges.Count() && roomRanges[roomIndex].numPortals != 0;
+	}
+
+	//whether every loop of boundary edges of the room is a portal, so that nothing can be seen through a gap the graph does not know
+	bool IsSealed(uint32_t roomIndex) const
+	{
+		return HasPortals(roomIndex) && roomRanges[roomIndex].numPortals == roomRanges[roomIndex].numLoops;
+	}
+
+	uint32_t GetNumPortals() const
+	{
+		return portals.Count();
+	}
+
+	/// <summary>
+	/// Finds the rooms seen through the portals on screen, going from room to room.
+	/// </summary>
+	/// <param name="eye">where the camera is, in @roomIndex</param>
+	/// <param name="visibleRooms">receives the rooms found, not including @roomIndex</param>
+	/// <param name="isRoomVisible">one per room, all false on entry, set for every room found</param>
+	uint32_t FindVisibleRooms(uint32_t roomIndex, const Vector &eye, const Frustum &frustum, uint32_t *visibleRooms, bool *isRoomVisible) const;
+};
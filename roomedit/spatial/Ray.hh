@@ -0,0 +1,38 @@
+#pragma once
+#include "common/vector.inl"
+#include <stdint.h>
+#include <math.h> //copysignf
+
+//a ray whose inverse direction is computed once, for testing it against many boxes
+struct Ray
+{
+	Vector origin;
+	Vector direction;
+	Vector invDirection;
+
+	//a huge but finite inverse for axis-parallel rays, as an infinite one would turn into NaN
+	//for a ray starting right on a box's side, a ray sliding along a side may hit the box or not
+	static float Invert(float f)
+	{
+		return f != 0.0f ? 1.0f / f : copysignf(1e30f, f);
+	}
+
+	Ray() = default;
+	Ray(const Vector &origin, const Vector &direction):
+		origin(origin),
+		direction(direction),
+		invDirection(Invert(direction.x), Invert(direction.y), Invert(direction.z))
+	{}
+};
+
+//where a ray hit a mesh
+struct RayHit
+{
+	float distance; //along the ray, in the space the ray was given in
+	uint32_t faceIndex; //in the mesh's faces
+	int32_t indexSurfaceProperty;
+
+	//barycentric coordinates of the hit point, relative to the triangle's second and third corners
+	float u;
+	float v;
+};
@@ -0,0 +1,311 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "RoomBVH.hh"
+#include <float.h> //FLT_MAX
+#include <algorithm> //std::nth_element
+
+//the most rooms a leaf holds
+static constexpr uint32_t MAX_ROOMS_PER_LEAF = 2;
+
+//nodes are split at their median, so the tree stays well below this depth
+static constexpr uint32_t MAX_DEPTH = 64;
+
+//how many overlapping rooms are compared at most when a point is in several of them
+static constexpr uint32_t MAX_CANDIDATES = 16;
+
+//how far inside a room's box a point has to be to be considered in that room
+static constexpr float CONTAINMENT_MARGIN = 1.0f;
+
+static inline bool IsPointInBox(const BBox &box, const Vector &point)
+{
+	return point.x >= box.min.x && point.x <= box.max.x &&
+		point.y >= box.min.y && point.y <= box.max.y &&
+		point.z >= box.min.z && point.z <= box.max.z;
+}
+
+static inline float GetAxis(const Vector &v, uint32_t axis)
+{
+	return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+uint32_t RoomBVH::BuildNode(uint32_t first, uint32_t count, const Vector *centers, uint32_t &numNodes)
+{
+	uint32_t nodeIndex = numNodes++;
+	Node &node = nodes[nodeIndex];
+
+	node.bounds = roomBoxes[roomIndices[first]];
+	BBox centerBounds(centers[roomIndices[first]], centers[roomIndices[first]]);
+	for (uint32_t i = first + 1; i < first + count; i++)
+	{
+		const BBox &box = roomBoxes[roomIndices[i]];
+		node.bounds.Expand(box.min);
+		node.bounds.Expand(box.max);
+		centerBounds.Expand(centers[roomIndices[i]]);
+	}
+
+	if (count <= MAX_ROOMS_PER_LEAF)
+	{
+		node.rightChildOrFirstRoom = first;
+		node.numRooms = count;
+		return nodeIndex;
+	}
+
+	//split along the axis the centers are the most spread on, half of the rooms on each side
+	Vector extent = centerBounds.max - centerBounds.min;
+	uint32_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+	uint32_t half = count / 2;
+	uint32_t *indices = roomIndices.Data() + first;
+	std::nth_element(
+		indices, indices + half, indices + count,
+		[&](uint32_t a, uint32_t b) { return GetAxis(centers[a], axis) < GetAxis(centers[b], axis); }
+	);
+
+	BuildNode(first, half, centers, numNodes);
+	uint32_t rightChild = BuildNode(first + half, count - half, centers, numNodes);
+
+	//the node reference may not be used anymore after recursing, so index again
+	nodes[nodeIndex].rightChildOrFirstRoom = rightChild;
+	nodes[nodeIndex].numRooms = 0;
+	return nodeIndex;
+}
+
+bool RoomBVH::Build(const Array<Room> &rooms)
+{
+	this->rooms = &rooms;
+
+	uint32_t numRooms = rooms.Count();
+	if (numRooms == 0)
+		return true;
+
+	uint32_t maxNodes = 2 * numRooms - 1;
+	uint32_t size = maxNodes * sizeof(Node) + numRooms * (sizeof(uint32_t) + sizeof(BBox) + sizeof(bool) + sizeof(Vector)) + 64;
+	if (!pool.Create(size))
+		return false;
+
+	nodes = Array<Node>(pool.Allocate<Node>(maxNodes), maxNodes);
+	roomIndices = Array<uint32_t>(pool.Allocate<uint32_t>(numRooms), numRooms);
+	roomBoxes = Array<BBox>(pool.Allocate<BBox>(numRooms), numRooms);
+	isRoomOverlapped = Array<bool>(pool.Allocate<bool>(numRooms), numRooms);
+
+	uint32_t scratchOffset = pool.GetOffset();
+	auto centers = pool.Allocate<Vector>(numRooms);
+	for (uint32_t i = 0; i < numRooms; i++)
+	{
+		roomBoxes[i] = ComputeRoomBBox(rooms[i]);
+		centers[i] = (roomBoxes[i].min + roomBoxes[i].max) * 0.5f;
+		roomIndices[i] = i;
+	}
+
+	uint32_t numNodes = 0;
+	BuildNode(0, numRooms, centers, numNodes);
+	nodes = Array<Node>(nodes.Data(), numNodes);
+	pool.FlushFrom(scratchOffset);
+
+	//rooms that overlap no other one never need their mesh checked
+	for (uint32_t i = 0; i < numRooms; i++)
+	{
+		const BBox &box = roomBoxes[i];
+		isRoomOverlapped[i] = false;
+
+		uint32_t stack[MAX_DEPTH];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize && !isRoomOverlapped[i])
+		{
+			const Node &node = nodes[stack[--stackSize]];
+			if (!node.bounds.IsIntersectBox(box))
+				continue;
+
+			if (node.numRooms == 0)
+			{
+				assert(stackSize + 2 <= MAX_DEPTH);
+				stack[stackSize++] = node.rightChildOrFirstRoom;
+				stack[stackSize++] = (uint32_t)(&node - nodes.Data()) + 1;
+				continue;
+			}
+
+			for (uint32_t r = 0; r < node.numRooms; r++)
+			{
+				uint32_t other = roomIndices[node.rightChildOrFirstRoom + r];
+				if (other != i && roomBoxes[other].IsIntersectBox(box))
+					isRoomOverlapped[i] = true;
+			}
+		}
+	}
+
+	return true;
+}
+
+void RoomBVH::Destroy()
+{
+	pool.Destroy();
+	nodes = Array<Node>();
+	roomIndices = Array<uint32_t>();
+	roomBoxes = Array<BBox>();
+	isRoomOverlapped = Array<bool>();
+	rooms = nullptr;
+}
+
+//gathers the rooms whose box contains the point
+uint32_t RoomBVH::FindCandidates(const Vector &point, uint32_t *candidates, uint32_t maxCandidates) const
+{
+	uint32_t numCandidates = 0;
+
+	uint32_t stack[MAX_DEPTH];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const Node &node = nodes[nodeIndex];
+		if (!IsPointInBox(node.bounds, point))
+			continue;
+
+		if (node.numRooms == 0)
+		{
+			assert(stackSize + 2 <= MAX_DEPTH);
+			stack[stackSize++] = node.rightChildOrFirstRoom;
+			stack[stackSize++] = nodeIndex + 1;
+			continue;
+		}
+
+		for (uint32_t r = 0; r < node.numRooms; r++)
+		{
+			uint32_t roomIndex = roomIndices[node.rightChildOrFirstRoom + r];
+			if (numCandidates < maxCandidates && roomBoxes[roomIndex].IsContainSphere(point, CONTAINMENT_MARGIN))
+				candidates[numCandidates++] = roomIndex;
+		}
+	}
+
+	return numCandidates;
+}
+
+//returns the distance along the ray to the triangle, or a negative value if it is missed
+static float IntersectTriangle(const Vector &origin, const Vector &dir, const Vector &a, const Vector &b, const Vector &c)
+{
+	Vector edge1 = b - a;
+	Vector edge2 = c - a;
+	Vector p = dir.Cross(edge2);
+	float det = edge1.Dot(p);
+	if (fabsf(det) < 1e-8f)
+		return -1.0f;
+
+	float invDet = 1.0f / det;
+	Vector s = origin - a;
+	float u = s.Dot(p) * invDet;
+	if (u < 0.0f || u > 1.0f)
+		return -1.0f;
+
+	Vector q = s.Cross(edge1);
+	float v = dir.Dot(q) * invDet;
+	if (v < 0.0f || u + v > 1.0f)
+		return -1.0f;
+
+	return edge2.Dot(q) * invDet;
+}
+
+/// <summary>
+/// Tells how much the point looks to be inside the room, by casting a ray along each axis.
+/// Seen from the inside, the closest wall a ray hits faces the point; seen from the outside, it faces away.
+/// Rays escaping through an opening say nothing. The higher the score, the more likely the point is inside.
+/// </summary>
+int32_t RoomBVH::ScoreContainment(uint32_t roomIndex, const Vector &point) const
+{
+	const Room &room = (*rooms)[roomIndex];
+	const Mesh &mesh = room.mesh;
+
+	//bring the point into the room's space
+	Vector localPoint = (point - Vector(room.position.x, room.position.y, room.position.z)) * (1.0f / room.scale);
+
+	static const Vector directions[6] = {
+		Vector(1.0f, 0.0f, 0.0f), Vector(-1.0f, 0.0f, 0.0f),
+		Vector(0.0f, 1.0f, 0.0f), Vector(0.0f, -1.0f, 0.0f),
+		Vector(0.0f, 0.0f, 1.0f), Vector(0.0f, 0.0f, -1.0f)
+	};
+	float closestDistances[6] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+	bool closestFacesPoint[6] = {};
+
+	auto testTriangle = [&](uint32_t ia, uint32_t ib, uint32_t ic)
+	{
+		const Vector3 &pa = mesh.positions[mesh.corners[ia].index];
+		const Vector3 &pb = mesh.positions[mesh.corners[ib].index];
+		const Vector3 &pc = mesh.positions[mesh.corners[ic].index];
+		Vector a(pa.x, pa.y, pa.z);
+		Vector b(pb.x, pb.y, pb.z);
+		Vector c(pc.x, pc.y, pc.z);
+		Vector normal = (c - a).Cross(b - a); //same winding as the renderer's front faces
+
+		for (uint32_t d = 0; d < 6; d++)
+		{
+			float distance = IntersectTriangle(localPoint, directions[d], a, b, c);
+			if (distance < 0.0f || distance >= closestDistances[d])
+				continue;
+
+			closestDistances[d] = distance;
+			closestFacesPoint[d] = normal.Dot(directions[d]) < 0.0f;
+		}
+	};
+
+	for (const auto &face : mesh.faces)
+	{
+		//invisible faces do not bound the room
+		if (face.indexSurfaceProperty != 3)
+			ForEachTriangle(face, testTriangle);
+	}
+
+	int32_t score = 0;
+	for (uint32_t d = 0; d < 6; d++)
+	{
+		if (closestDistances[d] == FLT_MAX)
+			continue;
+		score += closestFacesPoint[d] ? 1 : -1;
+	}
+	return score;
+}
+
+uint32_t RoomBVH::FindRoom(const Vector &point, uint32_t previousRoom) const
+{
+	if (nodes.Count() == 0)
+		return INVALID_ROOM;
+
+	//most of the time the point has not left its room, and most rooms do not overlap
+	bool hasPreviousRoom = previousRoom < roomBoxes.Count();
+	if (hasPreviousRoom && !isRoomOverlapped[previousRoom] && roomBoxes[previousRoom].IsContainSphere(point, CONTAINMENT_MARGIN))
+		return previousRoom;
+
+	uint32_t candidates[MAX_CANDIDATES];
+	uint32_t numCandidates = FindCandidates(point, candidates, MAX_CANDIDATES);
+	if (numCandidates == 0)
+		return INVALID_ROOM;
+	if (numCandidates == 1)
+		return candidates[0];
+
+	//several boxes contain the point, let the meshes decide
+	//on equal scores, keep the previous room, otherwise take the smallest one
+	uint32_t bestRoom = INVALID_ROOM;
+	int32_t bestScore = 0;
+	float bestVolume = 0.0f;
+	for (uint32_t i = 0; i < numCandidates; i++)
+	{
+		uint32_t roomIndex = candidates[i];
+		int32_t score = ScoreContainment(roomIndex, point);
+
+		Vector extent = roomBoxes[roomIndex].max - roomBoxes[roomIndex].min;
+		float volume = extent.x * extent.y * extent.z;
+
+		bool better = bestRoom == INVALID_ROOM || score > bestScore;
+		if (!better && score == bestScore && bestRoom != previousRoom)
+			better = roomIndex == previousRoom || volume < bestVolume;
+		if (!better)
+			continue;
+
+		bestRoom = roomIndex;
+		bestScore = score;
+		bestVolume = volume;
+	}
+
+	return bestRoom;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "bounds.hh"
+#include <stdint.h>
+
+/// <summary>
+/// A bounding volume hierarchy over the rooms' boxes, built once when the world is loaded,
+/// used to find which room a point is in without testing every room.
+/// Room boxes often overlap, so when a point is in several of them the room meshes themselves decide.
+/// </summary>
+class RoomBVH
+{
+public:
+	static constexpr uint32_t INVALID_ROOM = 0xFFFFFFFF;
+
+private:
+	//nodes are stored depth-first, the left child of an inner node directly follows it
+	struct Node
+	{
+		BBox bounds;
+		uint32_t rightChildOrFirstRoom;
+		uint32_t numRooms; //0 for inner nodes
+	};
+
+	MemoryPool pool;
+	const Array<Room> *rooms;
+
+	Array<Node> nodes;
+	Array<uint32_t> roomIndices; //rooms referenced by the leaves
+	Array<BBox> roomBoxes;
+	Array<bool> isRoomOverlapped; //does the room's box overlap another one?
+
+	uint32_t BuildNode(uint32_t first, uint32_t count, const Vector *centers, uint32_t &numNodes);
+	uint32_t FindCandidates(const Vector &point, uint32_t *candidates, uint32_t maxCandidates) const;
+	int32_t ScoreContainment(uint32_t roomIndex, const Vector &point) const;
+
+public:
+	RoomBVH():
+		rooms(nullptr)
+	{}
+
+	bool Build(const Array<Room> &rooms);
+	void Destroy();
+
+	/// <summary>
+	/// Returns the room the point is in, or INVALID_ROOM if it is in none.
+	/// </summary>
+	/// <param name="previousRoom">the room the point was last found in, tried first and preferred on ties</param>
+	uint32_t FindRoom(const Vector &point, uint32_t previousRoom = INVALID_ROOM) const;
+};
@@ -0,0 +1,349 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "TriangleBVH.hh"
+#include <float.h> //FLT_MAX
+#include <algorithm> //std::partition
+
+//leaves are split as long as the heuristic finds it worth it, but never kept bigger than this
+static constexpr uint32_t MAX_TRIANGLES_PER_LEAF = 8;
+
+//centroids are sorted into this many bins along each axis when looking for the best split
+static constexpr uint32_t NUM_SAH_BINS = 12;
+
+//relative cost of visiting a node compared to intersecting a triangle
+static constexpr float TRAVERSAL_COST = 1.0f;
+
+static constexpr uint32_t MAX_DEPTH = 64;
+
+static inline float GetAxis(const Vector &v, uint32_t axis)
+{
+	return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+}
+
+static inline float GetSurfaceArea(const BBox &box)
+{
+	Vector extent = box.max - box.min;
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+static inline BBox EmptyBox()
+{
+	return BBox(Vector(FLT_MAX, FLT_MAX, FLT_MAX), Vector(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+}
+
+static inline Vector GetPosition(const Mesh &mesh, uint32_t corner)
+{
+	const Vector3 &p = mesh.positions[mesh.corners[corner].index];
+	return Vector(p.x, p.y, p.z);
+}
+
+//calls @function with the 3 corners of every triangle of the visible faces
+template <typename Function>
+static void ForEachVisibleTriangle(const Mesh &mesh, Function function)
+{
+	for (uint32_t f = 0; f < mesh.faces.Count(); f++)
+	{
+		const Face &face = mesh.faces[f];
+		if (face.indexSurfaceProperty == 3)
+			continue;
+
+		ForEachTriangle(face, [&](uint32_t c0, uint32_t c1, uint32_t c2) { function(f, c0, c1, c2); });
+	}
+}
+
+static uint32_t CountTriangles(const Mesh &mesh)
+{
+	uint32_t numTriangles = 0;
+	ForEachVisibleTriangle(mesh, [&](uint32_t, uint32_t, uint32_t, uint32_t) { numTriangles++; });
+	return numTriangles;
+}
+
+uint32_t TriangleBVH::GetMaxSize(const Mesh &mesh)
+{
+	uint32_t numTriangles = CountTriangles(mesh);
+	if (numTriangles == 0)
+		return 0;
+	return (2 * numTriangles - 1) * sizeof(Node) + numTriangles * sizeof(Triangle) + 2 * 16;
+}
+
+//what the build works on, only needed until the tree is flattened
+struct BuildTriangle
+{
+	BBox bounds;
+	Vector centroid;
+	Vector v0, v1, v2;
+	uint32_t faceIndex;
+};
+
+//finds the best split of the range with the surface area heuristic, returns false if it is better not to split
+static bool FindSplit(const BuildTriangle *triangles, const uint32_t *order, uint32_t count, const BBox &bounds, const BBox &centroidBounds, uint32_t &bestAxis, float &bestPosition)
+{
+	float leafCost = (float)count;
+	float bestCost = FLT_MAX;
+	float invParentArea = 1.0f / fmaxf(GetSurfaceArea(bounds), FLT_MIN);
+
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		float axisMin = GetAxis(centroidBounds.min, axis);
+		float axisMax = GetAxis(centroidBounds.max, axis);
+		if (axisMax - axisMin <= 0.0f)
+			continue;
+
+		BBox binBounds[NUM_SAH_BINS];
+		uint32_t binCounts[NUM_SAH_BINS] = {};
+		for (auto &box : binBounds)
+			box = EmptyBox();
+
+		float scale = (float)NUM_SAH_BINS / (axisMax - axisMin);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const BuildTriangle &triangle = triangles[order[i]];
+			uint32_t bin = (uint32_t)((GetAxis(triangle.centroid, axis) - axisMin) * scale);
+			if (bin >= NUM_SAH_BINS)
+				bin = NUM_SAH_BINS - 1;
+			binCounts[bin]++;
+			binBounds[bin].Expand(triangle.bounds.min);
+			binBounds[bin].Expand(triangle.bounds.max);
+		}
+
+		//sweep from the right to know the cost of every right side, then from the left
+		float rightAreas[NUM_SAH_BINS];
+		uint32_t rightCounts[NUM_SAH_BINS];
+		BBox rightBounds = EmptyBox();
+		uint32_t rightCount = 0;
+		for (uint32_t b = NUM_SAH_BINS - 1; b > 0; b--)
+		{
+			rightCount += binCounts[b];
+			if (binCounts[b])
+			{
+				rightBounds.Expand(binBounds[b].min);
+				rightBounds.Expand(binBounds[b].max);
+			}
+			rightAreas[b] = rightCount ? GetSurfaceArea(rightBounds) : 0.0f;
+			rightCounts[b] = rightCount;
+		}
+
+		BBox leftBounds = EmptyBox();
+		uint32_t leftCount = 0;
+		for (uint32_t b = 0; b + 1 < NUM_SAH_BINS; b++)
+		{
+			leftCount += binCounts[b];
+			if (binCounts[b])
+			{
+				leftBounds.Expand(binBounds[b].min);
+				leftBounds.Expand(binBounds[b].max);
+			}
+			if (leftCount == 0 || rightCounts[b + 1] == 0)
+				continue;
+
+			float cost = TRAVERSAL_COST + (GetSurfaceArea(leftBounds) * leftCount + rightAreas[b + 1] * rightCounts[b + 1]) * invParentArea;
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestPosition = axisMin + (float)(b + 1) / scale;
+			}
+		}
+	}
+
+	if (bestCost == FLT_MAX)
+		return false;
+
+	return bestCost < leafCost || count > MAX_TRIANGLES_PER_LEAF;
+}
+
+uint32_t TriangleBVH::BuildNode(BuildTriangle *buildTriangles, uint32_t *order, uint32_t first, uint32_t count, uint32_t depth, uint32_t &numNodes)
+{
+	uint32_t nodeIndex = numNodes++;
+
+	BBox bounds = EmptyBox();
+	BBox centroidBounds = EmptyBox();
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		const BuildTriangle &triangle = buildTriangles[order[i]];
+		bounds.Expand(triangle.bounds.min);
+		bounds.Expand(triangle.bounds.max);
+		centroidBounds.Expand(triangle.centroid);
+	}
+	nodes[nodeIndex].bounds = bounds;
+
+	//the split may fail to separate anything, in which case this becomes a leaf
+	uint32_t numLeft = 0;
+	uint32_t axis = 0;
+	float position = 0.0f;
+	if (depth + 1 < MAX_DEPTH && FindSplit(buildTriangles, order + first, count, bounds, centroidBounds, axis, position))
+	{
+		uint32_t *middle = std::partition(order + first, order + first + count, [&](uint32_t i)
+		{
+			return GetAxis(buildTriangles[i].centroid, axis) < position;
+		});
+		numLeft = (uint32_t)(middle - (order + first));
+	}
+
+	if (numLeft == 0 || numLeft == count)
+	{
+		//leaves point straight into the reordered triangles
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			const BuildTriangle &source = buildTriangles[order[i]];
+			Triangle &triangle = triangles[i];
+			triangle.v0 = source.v0;
+			triangle.edge1 = source.v1 - source.v0;
+			triangle.edge2 = source.v2 - source.v0;
+			triangle.faceIndex = source.faceIndex;
+		}
+
+		nodes[nodeIndex].rightChildOrFirstTriangle = first;
+		nodes[nodeIndex].numTriangles = count;
+		return nodeIndex;
+	}
+
+	BuildNode(buildTriangles, order, first, numLeft, depth + 1, numNodes);
+	uint32_t rightChild = BuildNode(buildTriangles, order, first + numLeft, count - numLeft, depth + 1, numNodes);
+
+	nodes[nodeIndex].rightChildOrFirstTriangle = rightChild;
+	nodes[nodeIndex].numTriangles = 0;
+	return nodeIndex;
+}
+
+bool TriangleBVH::Build(MemoryPool &pool, const Mesh &mesh)
+{
+	this->mesh = &mesh;
+
+	uint32_t numTriangles = CountTriangles(mesh);
+	if (numTriangles == 0)
+		return true;
+
+	MemoryPool scratch;
+	if (!scratch.Create(numTriangles * (sizeof(BuildTriangle) + sizeof(uint32_t)) + 2 * 16))
+		return false;
+
+	BuildTriangle *buildTriangles = scratch.Allocate<BuildTriangle>(numTriangles, 16);
+	uint32_t *order = scratch.Allocate<uint32_t>(numTriangles);
+	uint32_t t = 0;
+	ForEachVisibleTriangle(mesh, [&](uint32_t faceIndex, uint32_t c0, uint32_t c1, uint32_t c2)
+	{
+		BuildTriangle &triangle = buildTriangles[t];
+		triangle.v0 = GetPosition(mesh, c0);
+		triangle.v1 = GetPosition(mesh, c1);
+		triangle.v2 = GetPosition(mesh, c2);
+		triangle.bounds = BBox(triangle.v0, triangle.v0);
+		triangle.bounds.Expand(triangle.v1);
+		triangle.bounds.Expand(triangle.v2);
+		triangle.centroid = (triangle.v0 + triangle.v1 + triangle.v2) * (1.0f / 3.0f);
+		triangle.faceIndex = faceIndex;
+		order[t] = t;
+		t++;
+	});
+
+	uint32_t maxNodes = 2 * numTriangles - 1;
+	nodes = Array<Node>(pool.Allocate<Node>(maxNodes, 16), maxNodes);
+	triangles = Array<Triangle>(pool.Allocate<Triangle>(numTriangles, 16), numTriangles);
+
+	uint32_t numNodes = 0;
+	BuildNode(buildTriangles, order, 0, numTriangles, 0, numNodes);
+	nodes = Array<Node>(nodes.Data(), numNodes);
+
+	scratch.Destroy();
+	return true;
+}
+
+//returns the distance at which the ray enters the box, or FLT_MAX if it misses it before @maxDistance
+static inline float IntersectBox(const BBox &box, const Vector &origin, const Vector &invDirection, float maxDistance)
+{
+	float t0x = (box.min.x - origin.x) * invDirection.x;
+	float t1x = (box.max.x - origin.x) * invDirection.x;
+	float t0y = (box.min.y - origin.y) * invDirection.y;
+	float t1y = (box.max.y - origin.y) * invDirection.y;
+	float t0z = (box.min.z - origin.z) * invDirection.z;
+	float t1z = (box.max.z - origin.z) * invDirection.z;
+
+	float enter = fmaxf(fmaxf(fminf(t0x, t1x), fminf(t0y, t1y)), fmaxf(fminf(t0z, t1z), 0.0f));
+	float exit = fminf(fminf(fmaxf(t0x, t1x), fmaxf(t0y, t1y)), fminf(fmaxf(t0z, t1z), maxDistance));
+	return enter <= exit ? enter : FLT_MAX;
+}
+
+bool TriangleBVH::Intersect(const Vector &origin, const Vector &direction, float maxDistance, RayHit &hit) const
+{
+	if (nodes.Count() == 0)
+		return false;
+
+	Vector invDirection = Ray(origin, direction).invDirection;
+
+	bool found = false;
+	float closest = maxDistance;
+
+	uint32_t stack[MAX_DEPTH];
+	uint32_t stackSize = 0;
+	if (IntersectBox(nodes[0].bounds, origin, invDirection, closest) != FLT_MAX)
+		stack[stackSize++] = 0;
+
+	while (stackSize)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const Node &node = nodes[nodeIndex];
+
+		if (node.numTriangles)
+		{
+			for (uint32_t i = node.rightChildOrFirstTriangle; i < node.rightChildOrFirstTriangle + node.numTriangles; i++)
+			{
+				//Moller-Trumbore, both sides
+				const Triangle &triangle = triangles[i];
+				Vector p = direction.Cross(triangle.edge2);
+				float det = triangle.edge1.Dot(p);
+				if (fabsf(det) < 1e-12f)
+					continue;
+
+				float invDet = 1.0f / det;
+				Vector s = origin - triangle.v0;
+				float u = s.Dot(p) * invDet;
+				if (u < 0.0f || u > 1.0f)
+					continue;
+
+				Vector q = s.Cross(triangle.edge1);
+				float v = direction.Dot(q) * invDet;
+				if (v < 0.0f || u + v > 1.0f)
+					continue;
+
+				float distance = triangle.edge2.Dot(q) * invDet;
+				if (distance < 0.0f || distance >= closest)
+					continue;
+
+				closest = distance;
+				found = true;
+				hit.distance = distance;
+				hit.faceIndex = triangle.faceIndex;
+				hit.indexSurfaceProperty = mesh->faces[triangle.faceIndex].indexSurfaceProperty;
+				hit.u = u;
+				hit.v = v;
+			}
+			continue;
+		}
+
+		//visit the nearest child first, so that the farther one is more likely to be skipped
+		uint32_t left = nodeIndex + 1;
+		uint32_t right = node.rightChildOrFirstTriangle;
+		float leftDistance = IntersectBox(nodes[left].bounds, origin, invDirection, closest);
+		float rightDistance = IntersectBox(nodes[right].bounds, origin, invDirection, closest);
+		if (leftDistance > rightDistance)
+		{
+			uint32_t swapIndex = left;
+			left = right;
+			right = swapIndex;
+			float swapDistance = leftDistance;
+			leftDistance = rightDistance;
+			rightDistance = swapDistance;
+		}
+
+		assert(stackSize + 2 <= MAX_DEPTH);
+		if (rightDistance != FLT_MAX)
+			stack[stackSize++] = right;
+		if (leftDistance != FLT_MAX)
+			stack[stackSize++] = left;
+	}
+
+	return found;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "../world/Mesh.hh"
+#include "../BBox.hh"
+#include "Ray.hh"
+#include <stdint.h>
+
+struct BuildTriangle;
+
+/// <summary>
+/// A bounding volume hierarchy over the triangles of a mesh, split using the surface area heuristic,
+/// for casting rays against the mesh without testing all of its triangles.
+/// The tree is flattened depth-first, with the triangles reordered so that every leaf refers to a contiguous range.
+/// </summary>
+class TriangleBVH
+{
+	struct Node
+	{
+		BBox bounds;
+		uint32_t rightChildOrFirstTriangle; //the left child directly follows its parent
+		uint32_t numTriangles; //0 for inner nodes
+	};
+
+	//ready for intersecting
+	struct Triangle
+	{
+		Vector v0;
+		Vector edge1;
+		Vector edge2;
+		uint32_t faceIndex;
+	};
+
+	Array<Node> nodes;
+	Array<Triangle> triangles; //ordered like the leaves
+	const Mesh *mesh;
+
+	uint32_t BuildNode(BuildTriangle *buildTriangles, uint32_t *order, uint32_t first, uint32_t count, uint32_t depth, uint32_t &numNodes);
+
+public:
+	TriangleBVH():
+		mesh(nullptr)
+	{}
+
+	//worst-case amount of memory Build takes from its pool
+	static uint32_t GetMaxSize(const Mesh &mesh);
+
+	//builds the tree of the mesh's visible faces, the mesh has to outlive it
+	bool Build(MemoryPool &pool, const Mesh &mesh);
+
+	/// <summary>
+	/// Finds the closest triangle the ray hits, in the mesh's space.
+	/// </summary>
+	/// <param name="maxDistance">hits farther than this are ignored</param>
+	bool Intersect(const Vector &origin, const Vector &direction, float maxDistance, RayHit &hit) const;
+};
@@ -0,0 +1,279 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "VisibilitySolver.hh"
+#include <atomic> //std::atomic
+#include <float.h> //FLT_EPSILON
+#include <string.h> //memcpy
+#include <thread> //std::thread
+
+//points sampled inside every room, the rays go from the points of one room to the points of the other
+static constexpr uint32_t NUM_SAMPLES = 32;
+
+//random points tried per room, most rooms fill only part of their box
+static constexpr uint32_t MAX_SAMPLE_ATTEMPTS = 1024;
+
+//rays cast between a pair of rooms before deciding they cannot see each other
+static constexpr uint32_t MAX_RAYS_PER_PAIR = 256;
+
+//boxes closer than this are considered touching
+static constexpr float TOUCH_DISTANCE = 1.0f;
+
+static constexpr uint32_t MAX_SOLVER_THREADS = 16;
+
+//xorshift, seeded per room and per pair so that the results do not depend on the threads
+static inline uint32_t NextRandom(uint32_t &state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static inline float RandomFloat(uint32_t &state)
+{
+	return (float)(NextRandom(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+static uint32_t GetNumThreads(uint32_t numItems)
+{
+	uint32_t numThreads = std::thread::hardware_concurrency();
+	if (numThreads > MAX_SOLVER_THREADS)
+		numThreads = MAX_SOLVER_THREADS;
+	if (numThreads > numItems)
+		numThreads = numItems;
+	if (numThreads == 0)
+		numThreads = 1;
+	return numThreads;
+}
+
+//calls work(item, thread) for every item, the threads taking the next item as soon as they are done with theirs
+template <typename Work>
+static void RunOnAllCores(uint32_t numItems, uint32_t numThreads, Work work)
+{
+	std::atomic<uint32_t> nextItem(0);
+	auto loop = [&](uint32_t t)
+	{
+		for (uint32_t i = nextItem++; i < numItems; i = nextItem++)
+			work(i, t);
+	};
+
+	std::thread threads[MAX_SOLVER_THREADS];
+	for (uint32_t t = 1; t < numThreads; t++)
+		threads[t] = std::thread(loop, t);
+	loop(0); //this thread helps too
+	for (uint32_t t = 1; t < numThreads; t++)
+		threads[t].join();
+}
+
+static bool AreBoxesTouching(const BBox &a, const BBox &b)
+{
+	Vector margin(TOUCH_DISTANCE, TOUCH_DISTANCE, TOUCH_DISTANCE);
+	return BBox(a.min - margin, a.max + margin).IsIntersectBox(b);
+}
+
+//does nothing the renderer draws stand between @start and @end?
+static bool IsSegmentClear(const Vector &start, const Vector &end, const Array<Room> &rooms, const BoxSet &roomBoxes, const Array<TriangleBVH> &roomTriangleBVHs, RayBoxHit *boxHits)
+{
+	Vector direction = end - start;
+	float length = direction.Length();
+	if (length < FLT_EPSILON)
+		return true;
+	direction *= 1.0f / length;
+
+	uint32_t numBoxHits = roomBoxes.IntersectRay(Ray(start, direction), length, boxHits);
+	for (uint32_t h = 0; h < numBoxHits; h++)
+	{
+		uint32_t r = boxHits[h].boxIndex;
+		const Room &room = rooms[r];
+
+		float invScale = 1.0f / room.scale;
+		Vector localStart = (start - Vector(room.position.x, room.position.y, room.position.z)) * invScale;
+		RayHit hit;
+		if (roomTriangleBVHs[r].Intersect(localStart, direction, length * invScale, hit))
+			return false;
+	}
+
+	return true;
+}
+
+bool VisibilitySolver::Solve(const Array<Room> &rooms, const RoomBVH &roomBVH, const BoxSet &roomBoxes, const Array<TriangleBVH> &roomTriangleBVHs)
+{
+	//the lists already applied stay, the rooms are using them
+	pool.Destroy();
+	numRaysCast = 0;
+
+	uint32_t numRooms = rooms.Count();
+	if (numRooms == 0)
+		return true;
+
+	uint32_t numThreads = GetNumThreads(numRooms);
+	uint32_t numPairs = numRooms * numRooms;
+	uint32_t size =
+		numRooms * NUM_SAMPLES * sizeof(Vector) +
+		numRooms * sizeof(uint32_t) +
+		numPairs * sizeof(uint8_t) +
+		numPairs * sizeof(uint32_t) +
+		(numRooms + 1) * sizeof(uint32_t) +
+		numThreads * roomBoxes.GetCapacity() * sizeof(RayBoxHit) +
+		6 * 16;
+	if (!pool.Create(size))
+		return false;
+
+	samples = Array<Vector>(pool.Allocate<Vector>(numRooms * NUM_SAMPLES, 16), numRooms * NUM_SAMPLES);
+	numSamples = Array<uint32_t>(pool.Allocate<uint32_t>(numRooms), numRooms);
+	isVisible = Array<uint8_t>(pool.Allocate<uint8_t>(numPairs), numPairs);
+	viewableRooms = Array<uint32_t>(pool.Allocate<uint32_t>(numPairs), numPairs);
+	firstViewableRooms = Array<uint32_t>(pool.Allocate<uint32_t>(numRooms + 1), numRooms + 1);
+	RayBoxHit *boxHits = pool.Allocate<RayBoxHit>(numThreads * roomBoxes.GetCapacity());
+
+	//sample points that are really in their room, and not only in its box
+	RunOnAllCores(numRooms, numThreads, [&](uint32_t r, uint32_t)
+	{
+		BBox box = roomBoxes.GetBox(r);
+		Vector extent = box.max - box.min;
+		Vector *roomSamples = samples.Data() + r * NUM_SAMPLES;
+		uint32_t count = 0;
+
+		uint32_t state = (0x9E3779B9u ^ (r * 0x85EBCA6Bu)) | 1;
+		for (uint32_t i = 0; i < MAX_SAMPLE_ATTEMPTS && count < NUM_SAMPLES; i++)
+		{
+			Vector point(
+				box.min.x + extent.x * RandomFloat(state),
+				box.min.y + extent.y * RandomFloat(state),
+				box.min.z + extent.z * RandomFloat(state)
+			);
+			if (roomBVH.FindRoom(point, r) == r)
+				roomSamples[count++] = point;
+		}
+
+		//a room too thin to be found still gets a chance
+		if (count == 0)
+			roomSamples[count++] = (box.min + box.max) * 0.5f;
+		numSamples[r] = count;
+	});
+
+	//every row fills the pairs with the rooms after it, the rest is mirrored afterwards
+	uint32_t threadRaysCast[MAX_SOLVER_THREADS] = {};
+	RunOnAllCores(numRooms, numThreads, [&](uint32_t a, uint32_t t)
+	{
+		RayBoxHit *threadBoxHits = boxHits + t * roomBoxes.GetCapacity();
+		BBox boxA = roomBoxes.GetBox(a);
+		const Vector *samplesA = samples.Data() + a * NUM_SAMPLES;
+
+		isVisible[a * numRooms + a] = 0;
+		for (uint32_t b = a + 1; b < numRooms; b++)
+		{
+			uint8_t &visible = isVisible[a * numRooms + b];
+			visible = AreBoxesTouching(boxA, roomBoxes.GetBox(b));
+			if (visible)
+				continue;
+
+			const Vector *samplesB = samples.Data() + b * NUM_SAMPLES;
+			uint32_t state = ((a * 0x9E3779B1u) ^ (b * 0x85EBCA77u)) | 1;
+			for (uint32_t i = 0; i < MAX_RAYS_PER_PAIR && !visible; i++)
+			{
+				const Vector &start = samplesA[NextRandom(state) % numSamples[a]];
+				const Vector &end = samplesB[NextRandom(state) % numSamples[b]];
+				visible = IsSegmentClear(start, end, rooms, roomBoxes, roomTriangleBVHs, threadBoxHits);
+				threadRaysCast[t]++;
+			}
+		}
+	});
+
+	numRaysCast = 0;
+	for (uint32_t t = 0; t < numThreads; t++)
+		numRaysCast += threadRaysCast[t];
+
+	uint32_t numViewableRooms = 0;
+	for (uint32_t a = 0; a < numRooms; a++)
+	{
+		firstViewableRooms[a] = numViewableRooms;
+		for (uint32_t b = 0; b < numRooms; b++)
+		{
+			if (b < a)
+				isVisible[a * numRooms + b] = isVisible[b * numRooms + a];
+			if (isVisible[a * numRooms + b])
+				viewableRooms[numViewableRooms++] = b;
+		}
+	}
+	firstViewableRooms[numRooms] = numViewableRooms;
+
+	return true;
+}
+
+void VisibilitySolver::Destroy()
+{
+	pool.Destroy();
+	appliedPools[0].Destroy();
+	appliedPools[1].Destroy();
+	samples = Array<Vector>();
+	numSamples = Array<uint32_t>();
+	isVisible = Array<uint8_t>();
+	viewableRooms = Array<uint32_t>();
+	firstViewableRooms = Array<uint32_t>();
+	numRaysCast = 0;
+}
+
+void VisibilitySolver::Compare(const Array<Room> &rooms, Comparison &comparison) const
+{
+	comparison = {};
+	comparison.numRaysCast = numRaysCast;
+
+	uint32_t numRooms = rooms.Count();
+	if (firstViewableRooms.Count() != numRooms + 1)
+		return;
+
+	for (uint32_t a = 0; a < numRooms; a++)
+	{
+		const Array<uint32_t> &stored = rooms[a].viewableRooms;
+
+		uint32_t numExtra = 0;
+		for (uint32_t b : stored)
+		{
+			if (b != a && (b >= numRooms || !isVisible[a * numRooms + b]))
+				numExtra++;
+		}
+
+		uint32_t numMissing = 0;
+		for (uint32_t i = firstViewableRooms[a]; i < firstViewableRooms[a + 1]; i++)
+		{
+			bool isStored = false;
+			for (uint32_t b : stored)
+				isStored |= b == viewableRooms[i];
+			numMissing += isStored ? 0 : 1;
+		}
+
+		comparison.numExtraEntries += numExtra;
+		comparison.numLooserRooms += numExtra ? 1 : 0;
+		comparison.numMissingEntries += numMissing;
+		comparison.numTighterRooms += numMissing ? 1 : 0;
+	}
+}
+
+bool VisibilitySolver::Apply(Array<Room> &rooms)
+{
+	uint32_t numRooms = rooms.Count();
+	if (firstViewableRooms.Count() != numRooms + 1)
+		return false;
+
+	//the rooms keep their current lists until the new ones are ready
+	MemoryPool &appliedPool = appliedPools[appliedPoolIndex ^ 1];
+	uint32_t numViewableRooms = firstViewableRooms[numRooms];
+	if (!appliedPool.Create(numViewableRooms * sizeof(uint32_t) + 16))
+		return false;
+
+	uint32_t *lists = appliedPool.Allocate<uint32_t>(numViewableRooms);
+	memcpy(lists, viewableRooms.Data(), numViewableRooms * sizeof(uint32_t));
+	for (uint32_t r = 0; r < numRooms; r++)
+	{
+		uint32_t first = firstViewableRooms[r];
+		rooms[r].viewableRooms = Array<uint32_t>(lists + first, firstViewableRooms[r + 1] - first);
+	}
+
+	appliedPools[appliedPoolIndex].Destroy();
+	appliedPoolIndex ^= 1;
+	return true;
+}
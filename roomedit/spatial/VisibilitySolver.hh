@@ -0,0 +1,59 @@
+#pragma once
+#include "sbmemory/MemoryPool.hh"
+#include "../world/Room.hh"
+#include "BoxSet.hh"
+#include "RoomBVH.hh"
+#include "TriangleBVH.hh"
+#include <stdint.h>
+
+/// <summary>
+/// Recomputes which rooms can see each other, to replace the viewable rooms stored in the level once its geometry changed.
+/// Points are sampled inside every room, and rays are cast between the points of every pair of rooms against the triangles of all the rooms,
+/// a pair being visible as soon as one ray gets through. The source rooms are spread over all the cores.
+/// Rooms whose boxes touch are always visible from each other, as the openings between them are where sampling is the weakest.
+/// </summary>
+class VisibilitySolver
+{
+public:
+	//how the solved lists differ from the ones stored in the rooms
+	struct Comparison
+	{
+		uint32_t numLooserRooms; //rooms listing rooms that were found hidden, drawing more than needed
+		uint32_t numExtraEntries;
+		uint32_t numTighterRooms; //rooms missing rooms that were found visible, which can pop in and out
+		uint32_t numMissingEntries;
+		uint32_t numRaysCast;
+	};
+
+private:
+	MemoryPool pool;
+	MemoryPool appliedPools[2]; //the lists the rooms use, the previous ones are freed once replaced
+	uint32_t appliedPoolIndex;
+	Array<Vector> samples; //NUM_SAMPLES per room
+	Array<uint32_t> numSamples;
+	Array<uint8_t> isVisible; //numRooms * numRooms, row after row
+	Array<uint32_t> viewableRooms; //every room's list, one after the other
+	Array<uint32_t> firstViewableRooms; //where every room's list starts, with one more for the end
+	uint32_t numRaysCast;
+
+public:
+	VisibilitySolver():
+		appliedPoolIndex(0),
+		numRaysCast(0)
+	{}
+
+	/// <summary>
+	/// Solves the visibility between all of the rooms, using the picking data of the document.
+	/// </summary>
+	/// <param name="roomBoxes">the rooms' world-space boxes, in the same order as the rooms</param>
+	/// <param name="roomTriangleBVHs">the rooms' triangles, in the rooms' space</param>
+	bool Solve(const Array<Room> &rooms, const RoomBVH &roomBVH, const BoxSet &roomBoxes, const Array<TriangleBVH> &roomTriangleBVHs);
+	//to be called once the rooms are not used anymore, as they may be using the solver's lists
+	void Destroy();
+
+	//compares the solved lists to the ones stored in the rooms, a room never being counted as seeing itself
+	void Compare(const Array<Room> &rooms, Comparison &comparison) const;
+
+	//replaces the rooms' lists with copies of the solved ones, which live as long as the solver
+	bool Apply(Array<Room> &rooms);
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include "common/matrix.inl"
+#include "../world/Room.hh"
+#include "../BBox.hh"
+#include <float.h> //FLT_MAX
+
+//the mesh's extents are kept as stored in the file, so flip them the same way the positions were
+inline BBox ComputeMeshBBox(const Mesh &mesh)
+{
+	return BBox(
+		Vector(mesh.minExtent.x, -mesh.maxExtent.y, mesh.minExtent.z),
+		Vector(mesh.maxExtent.x, -mesh.minExtent.y, mesh.maxExtent.z)
+	);
+}
+
+inline BBox ComputeRoomBBox(const Room &room)
+{
+	BBox box = ComputeMeshBBox(room.mesh);
+	Vector position(room.position.x, room.position.y, room.position.z);
+	return BBox(box.min * room.scale + position, box.max * room.scale + position);
+}
+
+//the box enclosing @box once transformed (points being row vectors)
+inline BBox TransformBBox(const BBox &box, const Matrix &transform)
+{
+	Vector center = (box.min + box.max) * 0.5f;
+	Vector extent = (box.max - box.min) * 0.5f;
+
+	Vector newCenter = transform[0] * center.x + transform[1] * center.y + transform[2] * center.z + transform[3];
+	Vector newExtent(
+		fabsf(transform[0].x) * extent.x + fabsf(transform[1].x) * extent.y + fabsf(transform[2].x) * extent.z,
+		fabsf(transform[0].y) * extent.x + fabsf(transform[1].y) * extent.y + fabsf(transform[2].y) * extent.z,
+		fabsf(transform[0].z) * extent.x + fabsf(transform[1].z) * extent.y + fabsf(transform[2].z) * extent.z
+	);
+	return BBox(newCenter - newExtent, newCenter + newExtent);
+}
+
+inline void TranslateRelative(Matrix &matrix, float x, float y, float z)
+{
+	matrix[3].x += x * matrix[0].x + y * matrix[1].x + z * matrix[2].x;
+	matrix[3].y += x * matrix[0].y + y * matrix[1].y + z * matrix[2].y;
+	matrix[3].z += x * matrix[0].z + y * matrix[1].z + z * matrix[2].z;
+}
+
+inline void RotateXYZ(Matrix &matrix, float rx, float ry, float rz)
+{
+	float sinValue;
+	float cosValue;
+	Vector temp;
+
+	if (rz != 0.0f)
+	{
+		sinValue = sinf(rz);
+		cosValue = cosf(rz);
+
+		temp = matrix[0];
+		matrix[0] = temp * cosValue + matrix[1] * sinValue;
+		matrix[1] = matrix[1] * cosValue - temp * sinValue;
+	}
+	if (rx != 0.0f)
+	{
+		sinValue = sinf(rx);
+		cosValue = cosf(rx);
+
+		temp = matrix[1];
+		matrix[1] = temp * cosValue + matrix[2] * sinValue;
+		matrix[2] = matrix[2] * cosValue - temp * sinValue;
+	}
+	if (ry != 0.0f)
+	{
+		sinValue = sinf(ry);
+		cosValue = cosf(ry);
+
+		temp = matrix[2];
+		matrix[2] = temp * cosValue + matrix[0] * sinValue;
+		matrix[0] = matrix[0] * cosValue - temp * sinValue;
+	}
+}
+
+inline void ScaleRelative(Matrix &matrix, float scale)
+{
+	matrix[0] *= scale;
+	matrix[1] *= scale;
+	matrix[2] *= scale;
+}
+
+//places an object relative to its parent, the same way it is drawn
+inline Matrix ComputeObjectTransform(const Matrix &parentTransform, const Object *object)
+{
+	Matrix objectTransform = parentTransform; //make a copy
+//	Vector objectPosition = Vector(object->position.x, object->position.y, object->position.z);
+//	objectTransform.SetTranslation(parentTransform.GetTranslation() + objectPosition);
+//	objectTransform.SetScale(object->scale);
+	TranslateRelative(objectTransform, object->position.x, object->position.y, object->position.z);
+	RotateXYZ(objectTransform, object->rotation.x, object->rotation.y, object->rotation.z);
+	ScaleRelative(objectTransform, object->scale);
+	return objectTransform;
+}
+
+//grows the box around an object and all its sub-objects, rotated and scaled with them, in world space
+inline void ExpandByObject(BBox &box, const Array<Mesh> &meshes, const Object *object, const Matrix &parentTransform)
+{
+	Matrix objectTransform = ComputeObjectTransform(parentTransform, object);
+
+	//only meshes have proper extents, anything else is bounded by its radius
+	BBox localBox;
+	uint32_t index = object->drawableNumber.GetID();
+	if (object->drawableNumber.GetMeshType() == MT_MESH && index < meshes.Count())
+		localBox = ComputeMeshBBox(meshes[index]);
+	else
+		localBox = BBox(Vector(-object->radius, -object->radius, -object->radius), Vector(object->radius, object->radius, object->radius));
+
+	BBox worldBox = TransformBBox(localBox, objectTransform);
+	box.Expand(worldBox.min);
+	box.Expand(worldBox.max);
+
+	for (const Object *subObject = object->objects; subObject; subObject = subObject->next)
+		ExpandByObject(box, meshes, subObject, objectTransform);
+}
+
+//the box around one of the rooms' top-level objects and its sub-objects, in world space
+inline BBox ComputeObjectBBox(const Array<Mesh> &meshes, const Room &room, const Object *object)
+{
+	//objects are placed relative to their room's position
+	Matrix parentTransform;
+	parentTransform.SetTranslation(Vector(room.position.x, room.position.y, room.position.z));
+
+	BBox box(Vector(FLT_MAX, FLT_MAX, FLT_MAX), Vector(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+	ExpandByObject(box, meshes, object, parentTransform);
+	return box;
+}
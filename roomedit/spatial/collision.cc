@@ -0,0 +1,227 @@
+/*
+*	Room Editor Application
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "collision.hh"
+#include <float.h> //FLT_MAX
+
+static inline Vector ToVector(const Vector3 &v)
+{
+	return Vector(v.x, v.y, v.z);
+}
+
+//visits the nodes @overlaps accepts, and every face they list
+//the depth of the tree comes from the file, so recursing is safer than a fixed-size stack
+template <typename Overlaps, typename Visit>
+static void VisitHitTree(const HitTree &tree, uint32_t nodeIndex, Overlaps overlaps, Visit visit)
+{
+	const HitTree::Node &node = tree.nodes[nodeIndex];
+	if (!overlaps(node))
+		return;
+
+	for (uint32_t f = node.firstFace; f < node.firstFace + node.numFaces; f++)
+		visit(tree.faceIndices[f]);
+
+	for (uint32_t child : node.children)
+	{
+		if (child != HitTree::NO_CHILD)
+			VisitHitTree(tree, child, overlaps, visit);
+	}
+}
+
+static inline bool IntersectNode(const HitTree::Node &node, const Ray &ray, float maxDistance)
+{
+	float t0x = (node.minExtent.x - ray.origin.x) * ray.invDirection.x;
+	float t1x = (node.maxExtent.x - ray.origin.x) * ray.invDirection.x;
+	float t0y = (node.minExtent.y - ray.origin.y) * ray.invDirection.y;
+	float t1y = (node.maxExtent.y - ray.origin.y) * ray.invDirection.y;
+	float t0z = (node.minExtent.z - ray.origin.z) * ray.invDirection.z;
+	float t1z = (node.maxExtent.z - ray.origin.z) * ray.invDirection.z;
+
+	float enter = fmaxf(fmaxf(fminf(t0x, t1x), fminf(t0y, t1y)), fmaxf(fminf(t0z, t1z), 0.0f));
+	float exit = fminf(fminf(fmaxf(t0x, t1x), fmaxf(t0y, t1y)), fminf(fmaxf(t0z, t1z), maxDistance));
+	return enter <= exit;
+}
+
+//the closest hit, with the normal of the triangle hit, facing the side the renderer draws
+static bool Raycast(const Mesh &mesh, const Ray &ray, float maxDistance, RayHit &hit, Vector &normal)
+{
+	if (mesh.hitTree.nodes.Count() == 0)
+		return false;
+
+	bool found = false;
+	float closest = maxDistance;
+
+	VisitHitTree(mesh.hitTree, 0,
+		[&](const HitTree::Node &node) { return IntersectNode(node, ray, closest); },
+		[&](uint32_t faceIndex)
+		{
+			const Face &face = mesh.faces[faceIndex];
+			ForEachTriangle(face, [&](uint32_t c0, uint32_t c1, uint32_t c2)
+			{
+				//Moller-Trumbore, both sides
+				Vector a = ToVector(mesh.positions[mesh.corners[c0].index]);
+				Vector edge1 = ToVector(mesh.positions[mesh.corners[c1].index]) - a;
+				Vector edge2 = ToVector(mesh.positions[mesh.corners[c2].index]) - a;
+				Vector p = ray.direction.Cross(edge2);
+				float det = edge1.Dot(p);
+				if (fabsf(det) < 1e-12f)
+					return;
+
+				float invDet = 1.0f / det;
+				Vector s = ray.origin - a;
+				float u = s.Dot(p) * invDet;
+				if (u < 0.0f || u > 1.0f)
+					return;
+
+				Vector q = s.Cross(edge1);
+				float v = ray.direction.Dot(q) * invDet;
+				if (v < 0.0f || u + v > 1.0f)
+					return;
+
+				float distance = edge2.Dot(q) * invDet;
+				if (distance < 0.0f || distance >= closest)
+					return;
+
+				closest = distance;
+				found = true;
+				hit.distance = distance;
+				hit.faceIndex = faceIndex;
+				hit.indexSurfaceProperty = face.indexSurfaceProperty;
+				hit.u = u;
+				hit.v = v;
+				normal = edge2.Cross(edge1); //same winding as the renderer's front faces
+			});
+		}
+	);
+
+	return found;
+}
+
+bool RaycastMesh(const Mesh &mesh, const Ray &ray, float maxDistance, RayHit &hit)
+{
+	Vector normal;
+	return Raycast(mesh, ray, maxDistance, hit, normal);
+}
+
+bool IsPointInSolid(const Mesh &mesh, const Vector &point)
+{
+	static const Vector directions[6] = {
+		Vector(1.0f, 0.0f, 0.0f), Vector(-1.0f, 0.0f, 0.0f),
+		Vector(0.0f, 1.0f, 0.0f), Vector(0.0f, -1.0f, 0.0f),
+		Vector(0.0f, 0.0f, 1.0f), Vector(0.0f, 0.0f, -1.0f)
+	};
+
+	//rays escaping through an opening say nothing
+	int32_t score = 0;
+	for (const auto &direction : directions)
+	{
+		RayHit hit;
+		Vector normal;
+		if (Raycast(mesh, Ray(point, direction), FLT_MAX, hit, normal))
+			score += normal.Dot(direction) > 0.0f ? 1 : -1;
+	}
+	return score > 0;
+}
+
+//Ericson's closest point on a triangle, going through the regions of its corners and edges
+static Vector ClosestPointOnTriangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
+{
+	Vector ab = b - a;
+	Vector ac = c - a;
+	Vector ap = p - a;
+	float d1 = ab.Dot(ap);
+	float d2 = ac.Dot(ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+		return a;
+
+	Vector bp = p - b;
+	float d3 = ab.Dot(bp);
+	float d4 = ac.Dot(bp);
+	if (d3 >= 0.0f && d4 <= d3)
+		return b;
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		return a + ab * (d1 / (d1 - d3));
+
+	Vector cp = p - c;
+	float d5 = ab.Dot(cp);
+	float d6 = ac.Dot(cp);
+	if (d6 >= 0.0f && d5 <= d6)
+		return c;
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		return a + ac * (d2 / (d2 - d6));
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+	float denom = 1.0f / (va + vb + vc);
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+uint32_t OverlapSphere(const Mesh &mesh, const Vector &center, float radius, SphereContact *contacts, uint32_t maxContacts)
+{
+	if (mesh.hitTree.nodes.Count() == 0)
+		return 0;
+
+	uint32_t numContacts = 0;
+	float radiusSquared = radius * radius;
+
+	VisitHitTree(mesh.hitTree, 0,
+		[&](const HitTree::Node &node)
+		{
+			if (numContacts == maxContacts)
+				return false;
+
+			float dx = fmaxf(fmaxf(node.minExtent.x - center.x, center.x - node.maxExtent.x), 0.0f);
+			float dy = fmaxf(fmaxf(node.minExtent.y - center.y, center.y - node.maxExtent.y), 0.0f);
+			float dz = fmaxf(fmaxf(node.minExtent.z - center.z, center.z - node.maxExtent.z), 0.0f);
+			return dx * dx + dy * dy + dz * dz <= radiusSquared;
+		},
+		[&](uint32_t faceIndex)
+		{
+			if (numContacts == maxContacts)
+				return;
+
+			//a face may be listed by several nodes
+			for (uint32_t i = 0; i < numContacts; i++)
+			{
+				if (contacts[i].faceIndex == faceIndex)
+					return;
+			}
+
+			float closestSquared = FLT_MAX;
+			Vector closestPoint;
+			ForEachTriangle(mesh.faces[faceIndex], [&](uint32_t c0, uint32_t c1, uint32_t c2)
+			{
+				Vector point = ClosestPointOnTriangle(center,
+					ToVector(mesh.positions[mesh.corners[c0].index]),
+					ToVector(mesh.positions[mesh.corners[c1].index]),
+					ToVector(mesh.positions[mesh.corners[c2].index])
+				);
+				Vector offset = point - center;
+				float distanceSquared = offset.Dot(offset);
+				if (distanceSquared < closestSquared)
+				{
+					closestSquared = distanceSquared;
+					closestPoint = point;
+				}
+			});
+
+			if (closestSquared > radiusSquared)
+				return;
+
+			SphereContact &contact = contacts[numContacts++];
+			contact.faceIndex = faceIndex;
+			contact.point = closestPoint;
+			contact.distance = sqrtf(closestSquared);
+		}
+	);
+
+	return numContacts;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "../world/Mesh.hh"
+#include "Ray.hh"
+#include <stdint.h>
+
+//queries on a mesh's HitTree, in the mesh's space
+//unlike picking, invisible faces are included, as the game uses them to block the way
+
+//a face touching a sphere
+struct SphereContact
+{
+	uint32_t faceIndex;
+	Vector point; //closest point of the face to the sphere's center
+	float distance; //from the sphere's center to that point
+};
+
+//finds the closest face the ray hits before @maxDistance
+bool RaycastMesh(const Mesh &mesh, const Ray &ray, float maxDistance, RayHit &hit);
+
+/// <summary>
+/// Tells whether a point is behind the mesh's faces: inside an object, or outside the walls of a room.
+/// Rays are cast along the axes, and the point is in the solid when most of the faces they hit first are seen from behind.
+/// </summary>
+bool IsPointInSolid(const Mesh &mesh, const Vector &point);
+
+/// <summary>
+/// Finds the faces closer than @radius to @center.
+/// </summary>
+/// <param name="contacts">receives one contact per face, at most @maxContacts, the others are dropped</param>
+/// <returns>the number of contacts written</returns>
+uint32_t OverlapSphere(const Mesh &mesh, const Vector &center, float radius, SphereContact *contacts, uint32_t maxContacts);
@@ -5,23 +5,165 @@
 
 #include "Mesh.hh"
 #include "common.hh"
+#include <float.h> //FLT_MAX
+#include <math.h> //fminf
 
-static void ReadRecursiveSec(ReadStream &rs)
+//first pass over the HIT_DATA, to know how much memory the tree takes
+//a node with a negative number of faces makes the tree invalid, it is then read as if it had none
+static void CountHitNodes(ReadStream &rs, uint32_t &numNodes, uint32_t &numFaceIndices, bool &valid)
 {
-	char bRead;
-	rs >> bRead;
-	if (bRead)
+	char hasNode;
+	rs >> hasNode;
+	if (!hasNode)
+		return;
+
+	rs.AdvanceBy(9); //the split
+
+	short numFaces;
+	rs >> numFaces;
+	if (numFaces < 0)
+	{
+		valid = false;
+		numFaces = 0;
+	}
+	if (numFaces)
+		rs.AdvanceBy((size_t)numFaces * 2);
+
+	numNodes++;
+	numFaceIndices += numFaces;
+
+	/* dwa razy! */
+	CountHitNodes(rs, numNodes, numFaceIndices, valid);
+	CountHitNodes(rs, numNodes, numFaceIndices, valid);
+}
+
+//returns the index of the node read, if there was one
+static uint32_t ReadHitNode(ReadStream &rs, HitTree &tree, uint32_t &numNodes, uint32_t &numFaceIndices)
+{
+	char hasNode;
+	rs >> hasNode;
+	if (!hasNode)
+		return HitTree::NO_CHILD;
+
+	//9 bytes describe how the node splits its space, they are not understood well enough to be relied upon
+	rs.AdvanceBy(9);
+
+	uint32_t nodeIndex = numNodes++;
+
+	short numFaces;
+	rs >> numFaces;
+	if (numFaces < 0)
+		numFaces = 0; //the counting pass has rejected the tree, this only keeps the reads in bounds
+	tree.nodes[nodeIndex].firstFace = numFaceIndices;
+	tree.nodes[nodeIndex].numFaces = numFaces;
+	rs.Read(tree.faceIndices.Data() + numFaceIndices, numFaces * sizeof(uint16_t)); //read directly
+	numFaceIndices += numFaces;
+
+	uint32_t leftChild = ReadHitNode(rs, tree, numNodes, numFaceIndices);
+	uint32_t rightChild = ReadHitNode(rs, tree, numNodes, numFaceIndices);
+	tree.nodes[nodeIndex].children[0] = leftChild;
+	tree.nodes[nodeIndex].children[1] = rightChild;
+	return nodeIndex;
+}
+
+static HitTree ReadHitTree(ReadStream &rs, MemoryPool &pool)
+{
+	HitTree tree;
+
+	ReadStream counter = rs;
+	uint32_t numNodes = 0;
+	uint32_t numFaceIndices = 0;
+	bool valid = true;
+	CountHitNodes(counter, numNodes, numFaceIndices, valid);
+	if (!valid)
+	{
+		//skip the whole tree, an empty one gets replaced by a single node holding all the faces
+		rs = counter;
+		return tree;
+	}
+
+	tree.nodes = Array<HitTree::Node>(pool.Allocate<HitTree::Node>(numNodes), numNodes);
+	tree.faceIndices = Array<uint16_t>(pool.Allocate<uint16_t>(numFaceIndices), numFaceIndices);
+
+	numNodes = 0;
+	numFaceIndices = 0;
+	ReadHitNode(rs, tree, numNodes, numFaceIndices);
+
+	return tree;
+}
+
+//the queries need every face to be reachable, so a tree that does not make sense is replaced by a single node holding all the faces
+static void ValidateHitTree(Mesh &mesh, MemoryPool &pool)
+{
+	uint32_t numFaces = mesh.faces.Count();
+	if (numFaces == 0)
 	{
-		rs.AdvanceBy(9);
+		mesh.hitTree = HitTree();
+		return;
+	}
+
+	bool valid = mesh.hitTree.nodes.Count() != 0;
+	for (uint16_t faceIndex : mesh.hitTree.faceIndices)
+	{
+		if (faceIndex >= numFaces)
+			valid = false;
+	}
+
+	if (!valid)
+	{
+		HitTree &tree = mesh.hitTree;
+		tree.nodes = Array<HitTree::Node>(pool.Allocate<HitTree::Node>(1), 1);
+		tree.faceIndices = Array<uint16_t>(pool.Allocate<uint16_t>(numFaces), numFaces);
+		for (uint32_t i = 0; i < numFaces; i++)
+			tree.faceIndices[i] = (uint16_t)i;
+		tree.nodes[0].children[0] = HitTree::NO_CHILD;
+		tree.nodes[0].children[1] = HitTree::NO_CHILD;
+		tree.nodes[0].firstFace = 0;
+		tree.nodes[0].numFaces = numFaces;
+	}
+}
+
+//children come after their parent, so going backwards every node sees its children's extents already computed
+static void ComputeHitTreeExtents(Mesh &mesh)
+{
+	HitTree &tree = mesh.hitTree;
+	for (uint32_t i = tree.nodes.Count(); i-- > 0;)
+	{
+		HitTree::Node &node = tree.nodes[i];
+		Vector3 minExtent, maxExtent;
+		minExtent.x = minExtent.y = minExtent.z = FLT_MAX;
+		maxExtent.x = maxExtent.y = maxExtent.z = -FLT_MAX;
+
+		auto expand = [&](const Vector3 &p)
+		{
+			minExtent.x = fminf(minExtent.x, p.x);
+			minExtent.y = fminf(minExtent.y, p.y);
+			minExtent.z = fminf(minExtent.z, p.z);
+			maxExtent.x = fmaxf(maxExtent.x, p.x);
+			maxExtent.y = fmaxf(maxExtent.y, p.y);
+			maxExtent.z = fmaxf(maxExtent.z, p.z);
+		};
+
+		for (uint32_t f = node.firstFace; f < node.firstFace + node.numFaces; f++)
+		{
+			ForEachTriangle(mesh.faces[tree.faceIndices[f]], [&](uint32_t c0, uint32_t c1, uint32_t c2)
+			{
+				expand(mesh.positions[mesh.corners[c0].index]);
+				expand(mesh.positions[mesh.corners[c1].index]);
+				expand(mesh.positions[mesh.corners[c2].index]);
+			});
+		}
 
-		short unk10;
-		rs >> unk10;
-		if (unk10)
-			rs.AdvanceBy((size_t)unk10 * 2);
+		for (uint32_t child : node.children)
+		{
+			if (child == HitTree::NO_CHILD)
+				continue;
+			expand(tree.nodes[child].minExtent);
+			expand(tree.nodes[child].maxExtent);
+		}
 
-		/* dwa razy! */
-		ReadRecursiveSec(rs);
-		ReadRecursiveSec(rs);
+		node.minExtent = minExtent;
+		node.maxExtent = maxExtent;
 	}
 }
 
@@ -163,7 +305,9 @@ Mesh ReadMesh(ReadStream &rs, MemoryPool &pool)
 	short unk5;
 	rs >> unk5;
 	if (unk5)
-		ReadRecursiveSec(rs);
+		mesh.hitTree = ReadHitTree(rs, pool);
+	ValidateHitTree(mesh, pool);
+	ComputeHitTreeExtents(mesh);
 
 	return mesh;
 }
@@ -70,6 +70,46 @@ struct Face
 	{}
 };
 
+//calls @function with the 3 corner indices of every triangle of the face
+template <typename Function>
+inline void ForEachTriangle(const Face &face, Function function)
+{
+	switch (face.typePoly)
+	{
+	case 4: //triangle list
+		for (uint32_t j = 0; j + 3 <= face.numVerts; j += 3)
+			function(face.vertexIndices[j], face.vertexIndices[j + 1], face.vertexIndices[j + 2]);
+		break;
+	case 6: //fan
+		for (uint32_t j = 2; j < face.numVerts; j++)
+			function(face.vertexIndices[0], face.vertexIndices[j - 1], face.vertexIndices[j]);
+		break;
+	default:
+		break;
+	}
+}
+
+//the HIT_DATA of a mesh, a tree the game uses for collisions, each node listing some of the faces
+struct HitTree
+{
+	static constexpr uint32_t NO_CHILD = 0xFFFFFFFF;
+
+	//stored depth-first, in the order of the file
+	struct Node
+	{
+		//rebuilt from the faces of the node and of its children, the split stored in the file is not used
+		Vector3 minExtent;
+		Vector3 maxExtent;
+
+		uint32_t children[2];
+		uint32_t firstFace; //in faceIndices
+		uint32_t numFaces;
+	};
+
+	Array<Node> nodes;
+	Array<uint16_t> faceIndices; //in the mesh's faces
+};
+
 struct Mesh
 {
 	char name[MAX_DRAWABLE_NAME_LENGTH];
@@ -83,6 +123,7 @@ struct Mesh
 
 	Array<Corner> corners;
 	Array<Face> faces;
+	HitTree hitTree; //always has at least a root node when the mesh has faces
 
 	constexpr Mesh() :
 		name(),
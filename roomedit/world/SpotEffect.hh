@@ -34,28 +34,30 @@ struct SpotEffect
 	};
 	Type type;
 
-	union
+	//declared outside of the union, as only MSVC allows types inside an anonymous one
+	struct SpotEffectLight
 	{
-		struct SpotEffectLight
-		{
 
-		};
-		SpotEffectLight light;
+	};
 
-		struct SpotEffectCameraShake
-		{
-			float life_max;
-			float life_loop;
-			bool looping;
-			bool scale_with_distance;
-			bool verticle_rectify;
-		};
-		SpotEffectCameraShake cameraShake;
+	struct SpotEffectCameraShake
+	{
+		float life_max;
+		float life_loop;
+		bool looping;
+		bool scale_with_distance;
+		bool verticle_rectify;
+	};
 
-		struct SpotEffectCutScene
-		{
-			int cutsceneId;
-		};
+	struct SpotEffectCutScene
+	{
+		int cutsceneId;
+	};
+
+	union
+	{
+		SpotEffectLight light;
+		SpotEffectCameraShake cameraShake;
 		SpotEffectCutScene cutScene;
 	};
 
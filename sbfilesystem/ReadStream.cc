@@ -5,10 +5,18 @@
 */
 
 #include "ReadStream.hh"
+#include <string.h>
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
-#include <string.h>
+#else
+#include <fcntl.h> //open
+#include <sys/mman.h> //mmap
+#include <sys/stat.h> //fstat
+#include <unistd.h> //close
+#endif
 
+#ifdef _WIN32
 int ReadStream::Open(const char* filePath)
 {
 	handle = CreateFile(filePath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
@@ -36,6 +44,37 @@ void ReadStream::Close()
 	UnmapViewOfFile(originalPointer);
 	CloseHandle(handle);
 }
+#else
+//the mapping keeps the file alive, so the descriptor is closed right away
+int ReadStream::Open(const char* filePath)
+{
+	int fd = open(filePath, O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return 0;
+	}
+	size = (uint32_t)st.st_size;
+
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return 0;
+
+	originalPointer = (char*)mapping;
+	currentPointer = originalPointer;
+	return 1;
+}
+
+void ReadStream::Close()
+{
+	munmap(originalPointer, size);
+}
+#endif
 
 void ReadStream::Read(void* out, uint32_t size)
 {
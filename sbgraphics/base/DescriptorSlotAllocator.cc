@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////////////////////
+//	Sabre Engine Graphics - descriptor slot allocator
+//	(C) Moczulski Alan, 2023.
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DescriptorSlotAllocator.hh"
+#include <stdlib.h> //malloc
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool DescriptorSlotAllocator::Create(uint32_t numSlots)
+{
+	assert(numSlots != 0 && numSlots <= MAX_SLOTS);
+	generations = (uint16_t *)malloc(numSlots * sizeof(uint16_t));
+	nextFreeSlots = (uint32_t *)malloc(numSlots * sizeof(uint32_t));
+	if (!generations || !nextFreeSlots)
+		return false;
+
+	//the slots are set up once they are first handed out
+	maxSlots = numSlots;
+	firstFreeSlot = INVALID_SLOT;
+	numUsedSlots = 0;
+	numAllocated = 0;
+	return true;
+}
+
+void DescriptorSlotAllocator::Destroy()
+{
+	free(nextFreeSlots);
+	free(generations);
+	nextFreeSlots = nullptr;
+	generations = nullptr;
+	maxSlots = 0;
+	firstFreeSlot = INVALID_SLOT;
+	numUsedSlots = 0;
+	numAllocated = 0;
+}
+
+uint32_t DescriptorSlotAllocator::Allocate()
+{
+	//a freed slot first, so that the table does not grow
+	uint32_t slot = firstFreeSlot;
+	if (slot != INVALID_SLOT)
+		firstFreeSlot = nextFreeSlots[slot];
+	else if (numUsedSlots < maxSlots)
+	{
+		slot = numUsedSlots++;
+		generations[slot] = 0;
+	}
+	else
+		return INVALID_HANDLE;
+
+	generations[slot] = (generations[slot] + 1) & MAX_GENERATION;
+	numAllocated++;
+	return MakeHandle(slot, generations[slot]);
+}
+
+bool DescriptorSlotAllocator::Free(uint32_t handle)
+{
+	if (!IsValid(handle))
+		return false;
+
+	uint32_t slot = GetSlot(handle);
+	generations[slot] = (generations[slot] + 1) & MAX_GENERATION;
+	nextFreeSlots[slot] = firstFreeSlot;
+	firstFreeSlot = slot;
+	numAllocated--;
+	return true;
+}
+
+bool DescriptorSlotAllocator::IsValid(uint32_t handle) const
+{
+	uint32_t slot = GetSlot(handle);
+	uint32_t generation = handle >> SLOT_BITS;
+	return slot < numUsedSlots && (generation & 1) && generations[slot] == generation;
+}
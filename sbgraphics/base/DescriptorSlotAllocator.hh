@@ -0,0 +1,75 @@
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+
+/// <summary>
+/// Hands out the slots of a bindless descriptor table, one for every texture that exists.
+/// A handle is the slot along with the generation of the slot when it was handed out, the generation changing whenever the slot is freed,
+/// so that a handle kept after freeing its texture is told apart from that of the texture which took the slot afterwards.
+/// It only deals with numbers, so it can be driven without any device.
+/// </summary>
+class DescriptorSlotAllocator
+{
+public:
+	//0 is never handed out, so that zeroed handles are invalid
+	static constexpr uint32_t INVALID_HANDLE = 0;
+
+	static constexpr uint32_t SLOT_BITS = 20;
+	static constexpr uint32_t MAX_SLOTS = 1 << SLOT_BITS;
+
+private:
+	static constexpr uint32_t SLOT_MASK = MAX_SLOTS - 1;
+	static constexpr uint32_t GENERATION_BITS = 32 - SLOT_BITS;
+	static constexpr uint32_t MAX_GENERATION = (1 << GENERATION_BITS) - 1;
+	static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFF;
+
+	uint16_t *generations; //odd while the slot is handed out
+	uint32_t *nextFreeSlots;
+	uint32_t maxSlots;
+	uint32_t firstFreeSlot;
+	uint32_t numUsedSlots; //the slots handed out at least once, the others have never been touched
+	uint32_t numAllocated;
+
+	static uint32_t MakeHandle(uint32_t slot, uint32_t generation)
+	{
+		return (generation << SLOT_BITS) | slot;
+	}
+
+public:
+	constexpr DescriptorSlotAllocator():
+		generations(nullptr),
+		nextFreeSlots(nullptr),
+		maxSlots(0),
+		firstFreeSlot(INVALID_SLOT),
+		numUsedSlots(0),
+		numAllocated(0)
+	{}
+
+	bool Create(uint32_t numSlots);
+	void Destroy();
+
+	//returns INVALID_HANDLE once every slot is taken
+	uint32_t Allocate();
+
+	//returns false if the handle is stale or has already been freed
+	bool Free(uint32_t handle);
+
+	//whether the slot of the handle has not been freed since the handle was handed out
+	bool IsValid(uint32_t handle) const;
+
+	static uint32_t GetSlot(uint32_t handle)
+	{
+		return handle & SLOT_MASK;
+	}
+
+	//how many descriptors the table needs to cover, the freed slots being reused first
+	uint32_t GetNumUsedSlots() const
+	{
+		return numUsedSlots;
+	}
+
+	uint32_t GetNumAllocated() const
+	{
+		return numAllocated;
+	}
+};
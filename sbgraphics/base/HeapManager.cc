@@ -17,6 +17,9 @@
 static constexpr UINT64 ONE_MEGABYTE = 1024 * 1024;
 static constexpr UINT64 VRAM_BUDGET = ONE_MEGABYTE * 128;
 
+//the allocation of a placed resource is kept in its private data, so that it can be freed with the resource
+static constexpr GUID HEAP_ALLOCATION_GUID = { 0x5b0e3a7d, 0x2f41, 0x4c6e, { 0x9a, 0x18, 0x63, 0xd2, 0x7c, 0x05, 0xb4, 0x91 } };
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 bool HeapManager::Create(ID3D12Device *device)
@@ -41,6 +44,13 @@ bool HeapManager::Create(ID3D12Device *device)
 		}
 	}
 
+	if (!allocator.Create(VRAM_BUDGET, MAX_HEAP_ALLOCATIONS))
+		return false;
+
+	pendingFrees = new PendingFree[MAX_PENDING_FREES];
+	firstPendingFree = 0;
+	numPendingFrees = 0;
+
 	//create upload heap
 	if (!uploadHeap.Create(device))
 		return false;
@@ -56,32 +66,30 @@ void HeapManager::Destroy()
 {
 	dynamicHeap.Destroy();
 	uploadHeap.Destroy();
+	delete[] pendingFrees;
+	pendingFrees = nullptr;
+	allocator.Destroy();
 	if (heap)
 		heap->Release();
 }
 
 /*
-*	Allocates space in static VRAM to store a given buffer (for example: vertex, index buffers).
+*	Finds room in the default heap for a resource, and creates it there.
 */
-bool HeapManager::AllocateAndFillBuffer(
+bool HeapManager::PlaceResource(
 	ID3D12Device *device,
 	const D3D12_RESOURCE_DESC *desc,
-	const void *data,
 	D3D12_RESOURCE_STATES initialStates,
+	const D3D12_CLEAR_VALUE *clearValue,
 	ID3D12Resource **resource
 )
 {
-	//TODO: aren't all resources' initial states set to D3D12_RESOURCE_STATE_COPY_DEST?
-	//because we need to initialise them by copying from the upload heap...
-
 	assert(heap);
 
 	//get the size we need to use on the heap as well as the alignment
 	D3D12_RESOURCE_ALLOCATION_INFO ai = device->GetResourceAllocationInfo(0, 1, desc);
-	UINT64 newStartOffsetForResource = AlignOffset(currentOffset, ai.Alignment);
-
-	//check if it will fit in our budget
-	if (newStartOffsetForResource + ai.SizeInBytes > VRAM_BUDGET)
+	HeapAllocator::Allocation allocation = allocator.Allocate(ai.SizeInBytes, ai.Alignment);
+	if (!allocation.IsValid())
 	{
 		DebugPrint("Out of GPU memory budget!");
 		return false;
@@ -89,27 +97,50 @@ bool HeapManager::AllocateAndFillBuffer(
 
 	if FAILED(device->CreatePlacedResource(
 		heap,
-		newStartOffsetForResource,
+		allocation.offset,
 		desc,
 		initialStates,
-		nullptr,
+		clearValue, //should be nullptr on non-depth-stencil images
 		IID_PPV_ARGS(resource)
 	))
 	{
+		allocator.Free(allocation);
 		DebugPrint("Failed to create the resource on the GPU's default heap.");
 		return false;
 	}
 
-	currentOffset = newStartOffsetForResource + ai.SizeInBytes;
+	(*resource)->SetPrivateData(HEAP_ALLOCATION_GUID, sizeof(allocation), &allocation);
+	return true;
+}
 
-	return uploadHeap.ImmediatelyUploadToHeap(device, desc, &ai, data, initialStates, resource);
+/*
+*	Allocates space in static VRAM to store a given buffer, without filling it.
+*/
+bool HeapManager::AllocateBuffer(
+	ID3D12Device *device,
+	const D3D12_RESOURCE_DESC *desc,
+	D3D12_RESOURCE_STATES initialStates,
+	ID3D12Resource **resource
+)
+{
+	return PlaceResource(device, desc, initialStates, nullptr, resource);
 }
 
-bool HeapManager::AllocateAndFillTexture(
+/*
+*	Copies data to a region of an already allocated buffer.
+*/
+bool HeapManager::FillBuffer(ID3D12Device *device, ID3D12Resource *buffer, UINT64 offset, const void *data, UINT64 size)
+{
+	return uploadHeap.UploadToBuffer(device, data, size, buffer, offset);
+}
+
+/*
+*	Allocates space in static VRAM to store a given buffer (for example: vertex, index buffers).
+*/
+bool HeapManager::AllocateAndFillBuffer(
 	ID3D12Device *device,
 	const D3D12_RESOURCE_DESC *desc,
 	const void *data,
-	UINT32 dataSize,
 	D3D12_RESOURCE_STATES initialStates,
 	ID3D12Resource **resource
 )
@@ -117,35 +148,30 @@ bool HeapManager::AllocateAndFillTexture(
 	//TODO: aren't all resources' initial states set to D3D12_RESOURCE_STATE_COPY_DEST?
 	//because we need to initialise them by copying from the upload heap...
 
-	assert(heap);
+	if (!AllocateBuffer(device, desc, initialStates, resource))
+		return false;
 
-	//get the size we need to use on the heap as well as the alignment
 	D3D12_RESOURCE_ALLOCATION_INFO ai = device->GetResourceAllocationInfo(0, 1, desc);
-	UINT64 newStartOffsetForResource = AlignOffset(currentOffset, ai.Alignment);
+	return uploadHeap.UploadToHeap(device, desc, &ai, data, initialStates, resource);
+}
 
-	//check if it will fit in our budget
-	if (newStartOffsetForResource + ai.SizeInBytes > VRAM_BUDGET)
-	{
-		DebugPrint("Out of GPU memory budget!");
-		return false;
-	}
+bool HeapManager::AllocateAndFillTexture(
+	ID3D12Device *device,
+	const D3D12_RESOURCE_DESC *desc,
+	const void *data,
+	UINT32 dataSize,
+	D3D12_RESOURCE_STATES initialStates,
+	ID3D12Resource **resource
+)
+{
+	//TODO: aren't all resources' initial states set to D3D12_RESOURCE_STATE_COPY_DEST?
+	//because we need to initialise them by copying from the upload heap...
 
-	if FAILED(device->CreatePlacedResource(
-		heap,
-		newStartOffsetForResource,
-		desc,
-		initialStates,
-		nullptr,
-		IID_PPV_ARGS(resource)
-	))
-	{
-		DebugPrint("Failed to create the resource on the GPU's default heap.");
+	if (!PlaceResource(device, desc, initialStates, nullptr, resource))
 		return false;
-	}
-
-	currentOffset = newStartOffsetForResource + ai.SizeInBytes;
 
-	return uploadHeap.ImmediatelyUploadTextureToHeap(device, desc, &ai, data, dataSize, initialStates, *resource);
+	D3D12_RESOURCE_ALLOCATION_INFO ai = device->GetResourceAllocationInfo(0, 1, desc);
+	return uploadHeap.UploadTextureToHeap(device, desc, &ai, data, dataSize, initialStates, *resource);
 }
 
 /*
@@ -165,54 +191,110 @@ bool HeapManager::AllocateImage(ID3D12Device *device, DXGI_FORMAT format, UINT w
 	resourceDesc.SampleDesc.Count = 1;
 	resourceDesc.Flags = flags;
 
-	//get the size we need to use on the heap as well as the alignment
-	D3D12_RESOURCE_ALLOCATION_INFO ai = device->GetResourceAllocationInfo(0, 1, &resourceDesc);
-	UINT64 newStartOffsetForResource = AlignOffset(currentOffset, ai.Alignment);
-
-	//check if it will fit in our budget
-	if (newStartOffsetForResource + ai.SizeInBytes > VRAM_BUDGET)
+	if (!PlaceResource(device, &resourceDesc, initialState, clearValue, imageResource))
 	{
-		DebugPrint("Out of GPU memory budget!");
+		DebugPrint("Failed to create image.");
 		return false;
 	}
+	return true;
+}
 
-	if FAILED(device->CreatePlacedResource(
-		heap,
-		newStartOffsetForResource,
-		&resourceDesc,
-		initialState,
-		clearValue, //should be nullptr on non-depth-stencil images
-		IID_PPV_ARGS(imageResource)
-	))
+void HeapManager::Free(ID3D12Resource *resource)
+{
+	//only the placed resources have an allocation
+	HeapAllocator::Allocation allocation;
+	UINT size = sizeof(allocation);
+	if (!resource || FAILED(resource->GetPrivateData(HEAP_ALLOCATION_GUID, &size, &allocation)) || size != sizeof(allocation))
+		return;
+
+	//the GPU may still be drawing with it, the range is kept until the frames in flight are done
+	PendingFree &pendingFree = AddPendingFree();
+	pendingFree.allocation = allocation;
+}
+
+void HeapManager::FreeDescriptor(DescriptorSlotAllocator &descriptorSlots, uint32_t descriptor)
+{
+	assert(descriptorSlots.IsValid(descriptor)); //freed twice
+
+	PendingFree &pendingFree = AddPendingFree();
+	pendingFree.descriptorSlots = &descriptorSlots;
+	pendingFree.descriptor = descriptor;
+}
+
+HeapManager::PendingFree &HeapManager::AddPendingFree()
+{
+	assert(numPendingFrees < MAX_PENDING_FREES);
+	PendingFree &pendingFree = pendingFrees[(firstPendingFree + numPendingFrees) % MAX_PENDING_FREES];
+	pendingFree.allocation.blockIndex = HeapAllocator::INVALID_INDEX;
+	pendingFree.descriptorSlots = nullptr;
+	pendingFree.descriptor = DescriptorSlotAllocator::INVALID_HANDLE;
+	pendingFree.frameNumber = frameNumber;
+	pendingFree.uploadFenceValue = uploadHeap.GetRecordingFenceValue();
+	numPendingFrees++;
+	return pendingFree;
+}
+
+void HeapManager::RetirePendingFrees(UINT64 completedFrameNumber, UINT64 completedUploadFenceValue)
+{
+	while (numPendingFrees &&
+		pendingFrees[firstPendingFree].frameNumber <= completedFrameNumber &&
+		pendingFrees[firstPendingFree].uploadFenceValue <= completedUploadFenceValue)
 	{
-		DebugPrint("Failed to create image.");
-		return false;
+		const PendingFree &pendingFree = pendingFrees[firstPendingFree];
+		if (pendingFree.allocation.IsValid())
+			allocator.Free(pendingFree.allocation);
+		if (pendingFree.descriptorSlots && !pendingFree.descriptorSlots->Free(pendingFree.descriptor))
+			assert(0); //the slot was freed twice
+		firstPendingFree = (firstPendingFree + 1) % MAX_PENDING_FREES;
+		numPendingFrees--;
 	}
+}
 
-	currentOffset = newStartOffsetForResource + ai.SizeInBytes;
-	return true;
+void HeapManager::StartFrame()
+{
+	frameNumber++;
+	if (frameNumber >= FRAMES_IN_FLIGHT)
+		RetirePendingFrees(frameNumber - FRAMES_IN_FLIGHT, uploadHeap.GetCompletedFenceValue());
+}
+
+void HeapManager::SubmitUploads(ID3D12CommandQueue *queue)
+{
+	if (!uploadHeap.Submit())
+	{
+		DebugPrint("Failed to submit the uploads.");
+		return;
+	}
+
+	uploadHeap.WaitOnQueue(queue);
 }
 
 void HeapManager::SetSafeResetCheckpoint()
 {
 	assert(heap);
 
-	safeOffset = currentOffset;
+	safeSerial = allocator.GetNextSerial();
 }
 
 void HeapManager::Reset()
 {
 	assert(heap);
-	assert(safeOffset > 0); //there needs to be something inside the heap, and we must have already called SetSafeResetCheckpoint
+	assert(safeSerial > 0); //there needs to be something inside the heap, and we must have already called SetSafeResetCheckpoint
 
 	//WARNING: make sure all created heap resources are released before resetting
 	//if this is not the case, D3D12 debug layers will inform us of memory leaks
 
-	currentOffset = safeOffset;
+	//the released resources are gone as well, so their ranges do not need to wait once their copies are done
+	uploadHeap.WaitForUploads();
+	RetirePendingFrees(frameNumber, uploadHeap.GetCompletedFenceValue());
+	allocator.FreeAllocatedSince(safeSerial);
+}
+
+uint64_t HeapManager::UploadToDynamicBuffer(const void *data, uint32_t size) const
+{
+	return dynamicHeap.UpdateData(data, size);
 }
 
-uint64_t HeapManager::UploadToDynamicBuffer(void *data, uint32_t size) const
+void HeapManager::ResetDynamicBuffer()
 {
-	dynamicHeap.UpdateData(data, size);
-	return dynamicHeap.GetGPUAddress();
+	dynamicHeap.Reset();
 }
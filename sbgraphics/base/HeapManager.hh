@@ -1,17 +1,46 @@
 #pragma once
 
+#include "heap/HeapAllocator.hh"
 #include "heap/UploadHeap.hh"
 #include "heap/DynamicHeap.hh"
+#include "DescriptorSlotAllocator.hh"
 
 /*
 *	Manual video memory management.
 */
 class HeapManager
 {
+public:
+	//the GPU may still use a released resource for that many frames
+	static constexpr uint32_t FRAMES_IN_FLIGHT = DynamicHeap::FRAMES_IN_FLIGHT;
+
+private:
+	//the resources that can be alive at once in the default heap
+	static constexpr uint32_t MAX_HEAP_ALLOCATIONS = 16384;
+
+	//a resource and its descriptor each take an entry of the ring
+	static constexpr uint32_t MAX_PENDING_FREES = MAX_HEAP_ALLOCATIONS * 2;
+
+	//a range of the default heap or a descriptor slot, given back once the GPU is done with its resource
+	struct PendingFree
+	{
+		HeapAllocator::Allocation allocation; //invalid for a descriptor
+		DescriptorSlotAllocator *descriptorSlots; //null for a range of the heap
+		uint32_t descriptor;
+		UINT64 frameNumber;
+		UINT64 uploadFenceValue; //the copies recorded until then may still write to it
+	};
+
 	//default, fastest heap
 	ID3D12Heap *heap = nullptr;
-	UINT64 currentOffset = 0; //resource offset in the heap, the current VRAM pointer
-	UINT64 safeOffset = 0;
+	HeapAllocator allocator; //the ranges taken by the placed resources
+	uint32_t safeSerial = 0; //the allocations made before that one stay on Reset
+
+	//a ring of the ranges released in the last frames
+	PendingFree *pendingFrees = nullptr;
+	uint32_t firstPendingFree = 0;
+	uint32_t numPendingFrees = 0;
+	UINT64 frameNumber = 0;
 
 	//upload heap
 	UploadHeap uploadHeap;
@@ -19,17 +48,35 @@ class HeapManager
 	//dynamic heap
 	DynamicHeap dynamicHeap;
 
-	//align the current offset to 64 KiB (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
-	UINT64 AlignOffset(UINT64 offset, UINT64 alignment)
-	{
-		UINT64 a = alignment - 1;
-		return ((offset + a) & ~a);
-	}
+	bool PlaceResource(
+		ID3D12Device *device,
+		const D3D12_RESOURCE_DESC *desc,
+		D3D12_RESOURCE_STATES initialStates,
+		const D3D12_CLEAR_VALUE *clearValue,
+		ID3D12Resource **resource
+	);
+	PendingFree &AddPendingFree();
+	void RetirePendingFrees(UINT64 completedFrameNumber, UINT64 completedUploadFenceValue);
 
 public:
 	bool Create(ID3D12Device *device);
 	void Destroy();
 
+	bool AllocateBuffer(
+		ID3D12Device *device,
+		const D3D12_RESOURCE_DESC *desc,
+		D3D12_RESOURCE_STATES initialStates,
+		ID3D12Resource **resource
+	);
+
+	bool FillBuffer(
+		ID3D12Device *device,
+		ID3D12Resource *buffer,
+		UINT64 offset,
+		const void *data,
+		UINT64 size
+	);
+
 	bool AllocateAndFillBuffer(
 		ID3D12Device *device,
 		const D3D12_RESOURCE_DESC *desc,
@@ -57,8 +104,28 @@ public:
 		ID3D12Resource **resource
 	);
 
+	//gives the heap range of a resource back, to be called when releasing it
+	void Free(ID3D12Resource *resource);
+
+	//gives the slot of a descriptor back once the frames that may still read it are done, so that no other view takes it meanwhile
+	void FreeDescriptor(DescriptorSlotAllocator &descriptorSlots, uint32_t descriptor);
+
 	void SetSafeResetCheckpoint();
 	void Reset();
 
-	uint64_t UploadToDynamicBuffer(void *data, uint32_t size) const;
+	//to be called when a frame starts, returns the ranges of the resources released a few frames ago
+	void StartFrame();
+
+	//sends the copies recorded since the last call, and has @queue wait for them before drawing with their resources
+	void SubmitUploads(ID3D12CommandQueue *queue);
+
+	//how much of the default heap is used, and how scattered its free space is
+	HeapAllocator::Stats GetStats() const
+	{
+		return allocator.GetStats();
+	}
+
+	//returns the GPU address of the uploaded data, or 0 if the dynamic buffer is full for this frame
+	uint64_t UploadToDynamicBuffer(const void *data, uint32_t size) const;
+	void ResetDynamicBuffer();
 };
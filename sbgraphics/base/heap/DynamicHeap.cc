@@ -13,7 +13,11 @@
 #define DebugPrint(x)
 #endif
 
-static constexpr UINT64 CPU_VISIBLE_VRAM_BUDGET = 1024 * 1024;
+//the dynamic data of a single frame, debug lines and gizmos included
+static constexpr UINT64 FRAME_BUDGET = 4 * 1024 * 1024;
+
+//the start of every data, enough for vertex and instance buffers
+static constexpr uint32_t DATA_ALIGNMENT = 16;
 
 bool DynamicHeap::Create(ID3D12Device *device)
 {
@@ -24,7 +28,7 @@ bool DynamicHeap::Create(ID3D12Device *device)
 	heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD; //an upload heap is CPU-visible
 
 	D3D12_HEAP_DESC heapDesc = {};
-	heapDesc.SizeInBytes = CPU_VISIBLE_VRAM_BUDGET;
+	heapDesc.SizeInBytes = FRAME_BUDGET * FRAMES_IN_FLIGHT;
 	heapDesc.Properties = heapProperties;
 	heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
 	heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
@@ -33,7 +37,7 @@ bool DynamicHeap::Create(ID3D12Device *device)
 
 	D3D12_RESOURCE_DESC bufferDesc = {};
 	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	bufferDesc.Width = CPU_VISIBLE_VRAM_BUDGET; //we fill the whole heap with that one buffer
+	bufferDesc.Width = FRAME_BUDGET * FRAMES_IN_FLIGHT; //we fill the whole heap with that one buffer
 	bufferDesc.Height = 1;
 	bufferDesc.DepthOrArraySize = 1;
 	bufferDesc.MipLevels = 1;
@@ -52,30 +56,46 @@ bool DynamicHeap::Create(ID3D12Device *device)
 	))
 		return false;
 
+	//upload heap resources can stay mapped, the CPU never reads them
+	CD3DX12_RANGE readRange(0, 0);
+	if FAILED(dynamicBuffer->Map(0, &readRange, reinterpret_cast<void **>(&mappedData)))
+	{
+		DebugPrint("Could not access contents of the dynamic buffer!");
+		return false;
+	}
+
+	frameIndex = 0;
+	offset = 0;
 	return true;
 }
 
 void DynamicHeap::Destroy()
 {
+	dynamicBuffer->Unmap(0, nullptr);
 	dynamicBuffer->Release();
 	heap->Release();
 }
 
-void DynamicHeap::UpdateData(void *data, uint32_t size) const
+void DynamicHeap::Reset()
 {
-	assert(size <= CPU_VISIBLE_VRAM_BUDGET);
+	frameIndex = (frameIndex + 1) % FRAMES_IN_FLIGHT;
+	offset = 0;
+}
 
-	void *pData;
-	CD3DX12_RANGE readRange(0, 0); //zero, the CPU is not reading anything from the GPU
-	HRESULT hr = dynamicBuffer->Map(0, &readRange, &pData);
-	if (FAILED(hr))
+uint64_t DynamicHeap::UpdateData(const void *data, uint32_t size) const
+{
+	uint32_t start = (offset + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+	if (start + (UINT64)size > FRAME_BUDGET)
 	{
-		DebugPrint("Could not access contents of the dynamic buffer!");
-		return;
+		assert(0); //too much dynamic data in a single frame
+		return 0;
 	}
 
-	memcpy(pData, data, size);
-	dynamicBuffer->Unmap(0, nullptr);
+	UINT64 bufferOffset = frameIndex * FRAME_BUDGET + start;
+	memcpy(mappedData + bufferOffset, data, size);
+
+	offset = start + size;
+	return dynamicBuffer->GetGPUVirtualAddress() + bufferOffset;
 }
 
 uint64_t DynamicHeap::GetGPUAddress() const
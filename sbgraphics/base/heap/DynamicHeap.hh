@@ -6,17 +6,31 @@
 #include <stdint.h>
 
 //CPU-visible heap, used exclusively for uploading/modifying data, slowest heap
+//every frame in flight has its own region of the buffer, which stays mapped
 class DynamicHeap
 {
+public:
+	//the frames the GPU may still be working on, as many as the swap chain's render targets
+	//the heap manager and the swap chain go by this one
+	static constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+
+private:
 	ID3D12Heap *heap;
 	ID3D12Resource *dynamicBuffer;
+	uint8_t *mappedData; //the CPU address of the buffer, mapped for as long as the heap lives
+	uint32_t frameIndex; //the region the data of the current frame go to
+	mutable uint32_t offset; //where the next data goes in the region, so that the data of a frame do not overwrite each other
 
 public:
-	constexpr DynamicHeap(): heap(nullptr), dynamicBuffer(nullptr) { }
+	constexpr DynamicHeap(): heap(nullptr), dynamicBuffer(nullptr), mappedData(nullptr), frameIndex(0), offset(0) { }
 
 	bool Create(ID3D12Device *device);
 	void Destroy();
 
-	void UpdateData(void *data, uint32_t size) const;
+	//to be called when a frame starts, once the GPU is done with the frame that used the next region
+	void Reset();
+
+	//copies the data after the data already copied this frame, returns 0 if there is no room left
+	uint64_t UpdateData(const void *data, uint32_t size) const;
 	uint64_t GetGPUAddress() const;
 };
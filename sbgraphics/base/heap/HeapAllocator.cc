@@ -0,0 +1,335 @@
+////////////////////////////////////////////////////////////////////////////////////////////////
+//	Sabre Engine Graphics - heap allocator
+//	(C) Moczulski Alan, 2023.
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "HeapAllocator.hh"
+#include <stdlib.h> //malloc
+#ifdef _MSC_VER
+#include <intrin.h> //_BitScanForward
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t FindFirstBit(uint32_t bits)
+{
+	assert(bits);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return index;
+#else
+	return __builtin_ctz(bits);
+#endif
+}
+
+static inline uint32_t FindLastBit(uint64_t bits)
+{
+	assert(bits);
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, bits);
+	return index;
+#else
+	return 63 - __builtin_clzll(bits);
+#endif
+}
+
+static inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeapAllocator::GetListIndices(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel)
+{
+	//the smallest sizes have a first level of their own, split linearly
+	uint64_t units = size / GRANULARITY;
+	if (units < NUM_SECOND_LEVELS)
+	{
+		firstLevel = 0;
+		secondLevel = (uint32_t)units;
+		return;
+	}
+
+	uint32_t log = FindLastBit(units);
+	firstLevel = log - SECOND_LEVEL_BITS + 1;
+	secondLevel = (uint32_t)(units >> (log - SECOND_LEVEL_BITS)) - NUM_SECOND_LEVELS;
+}
+
+bool HeapAllocator::Create(uint64_t heapSize, uint32_t maxAllocations)
+{
+	assert(heapSize >= GRANULARITY && maxAllocations != 0);
+	uint32_t firstLevel, secondLevel;
+	GetListIndices(heapSize, firstLevel, secondLevel);
+	assert(firstLevel < NUM_FIRST_LEVELS);
+
+	//there is at most a free block between two allocations
+	maxBlocks = 2 * maxAllocations + 2;
+	blocks = (Block *)malloc(maxBlocks * sizeof(Block));
+	if (!blocks)
+		return false;
+
+	for (uint32_t i = 0; i < maxBlocks; i++)
+	{
+		blocks[i].state = BLOCK_UNUSED;
+		blocks[i].previousFree = i + 1 < maxBlocks ? i + 1 : INVALID_INDEX;
+	}
+	firstUnusedBlock = 0;
+
+	firstLevelBitmap = 0;
+	for (uint32_t fl = 0; fl < NUM_FIRST_LEVELS; fl++)
+	{
+		secondLevelBitmaps[fl] = 0;
+		for (uint32_t sl = 0; sl < NUM_SECOND_LEVELS; sl++)
+			freeLists[fl][sl] = INVALID_INDEX;
+	}
+
+	stats = {};
+	stats.heapSize = heapSize / GRANULARITY * GRANULARITY;
+	nextSerial = 0;
+
+	uint32_t index = AcquireBlock();
+	Block &block = blocks[index];
+	block.offset = 0;
+	block.size = stats.heapSize;
+	block.previousPhysical = INVALID_INDEX;
+	block.nextPhysical = INVALID_INDEX;
+	InsertFreeBlock(index);
+	return true;
+}
+
+void HeapAllocator::Destroy()
+{
+	free(blocks);
+	blocks = nullptr;
+	maxBlocks = 0;
+	firstUnusedBlock = INVALID_INDEX;
+	stats = {};
+}
+
+uint32_t HeapAllocator::AcquireBlock()
+{
+	uint32_t index = firstUnusedBlock;
+	assert(index != INVALID_INDEX);
+	firstUnusedBlock = blocks[index].previousFree;
+	return index;
+}
+
+void HeapAllocator::ReleaseBlock(uint32_t index)
+{
+	blocks[index].state = BLOCK_UNUSED;
+	blocks[index].previousFree = firstUnusedBlock;
+	firstUnusedBlock = index;
+}
+
+void HeapAllocator::InsertFreeBlock(uint32_t index)
+{
+	Block &block = blocks[index];
+	uint32_t firstLevel, secondLevel;
+	GetListIndices(block.size, firstLevel, secondLevel);
+
+	block.state = BLOCK_FREE;
+	block.previousFree = INVALID_INDEX;
+	block.nextFree = freeLists[firstLevel][secondLevel];
+	if (block.nextFree != INVALID_INDEX)
+		blocks[block.nextFree].previousFree = index;
+	freeLists[firstLevel][secondLevel] = index;
+
+	firstLevelBitmap |= 1u << firstLevel;
+	secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	stats.numFreeBlocks++;
+}
+
+void HeapAllocator::RemoveFreeBlock(uint32_t index)
+{
+	Block &block = blocks[index];
+	assert(block.state == BLOCK_FREE);
+	if (block.previousFree != INVALID_INDEX)
+		blocks[block.previousFree].nextFree = block.nextFree;
+	if (block.nextFree != INVALID_INDEX)
+		blocks[block.nextFree].previousFree = block.previousFree;
+
+	uint32_t firstLevel, secondLevel;
+	GetListIndices(block.size, firstLevel, secondLevel);
+	if (freeLists[firstLevel][secondLevel] == index)
+	{
+		freeLists[firstLevel][secondLevel] = block.nextFree;
+		if (block.nextFree == INVALID_INDEX)
+		{
+			secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+			if (!secondLevelBitmaps[firstLevel])
+				firstLevelBitmap &= ~(1u << firstLevel);
+		}
+	}
+	stats.numFreeBlocks--;
+}
+
+uint32_t HeapAllocator::FindFreeBlock(uint64_t size) const
+{
+	//rounded up to the sizes of the next list, so that any block of the list found is large enough
+	uint64_t units = size / GRANULARITY;
+	if (units >= NUM_SECOND_LEVELS)
+		units += (1ull << (FindLastBit(units) - SECOND_LEVEL_BITS)) - 1;
+
+	uint32_t firstLevel, secondLevel;
+	GetListIndices(units * GRANULARITY, firstLevel, secondLevel);
+	if (firstLevel >= NUM_FIRST_LEVELS)
+		return INVALID_INDEX;
+
+	//a larger list of the same first level, or else the smallest list of a larger one
+	uint32_t secondLevelBits = secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+	if (!secondLevelBits)
+	{
+		uint32_t firstLevelBits = firstLevel + 1 < NUM_FIRST_LEVELS ? firstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+		if (!firstLevelBits)
+			return INVALID_INDEX;
+
+		firstLevel = FindFirstBit(firstLevelBits);
+		secondLevelBits = secondLevelBitmaps[firstLevel];
+	}
+
+	return freeLists[firstLevel][FindFirstBit(secondLevelBits)];
+}
+
+uint32_t HeapAllocator::SplitBlock(uint32_t index, uint64_t size)
+{
+	//the block keeps the first @size bytes, the rest goes to a new block right after it
+	uint32_t restIndex = AcquireBlock();
+	Block &block = blocks[index];
+	Block &rest = blocks[restIndex];
+	assert(size < block.size);
+
+	rest.offset = block.offset + size;
+	rest.size = block.size - size;
+	rest.previousPhysical = index;
+	rest.nextPhysical = block.nextPhysical;
+	if (block.nextPhysical != INVALID_INDEX)
+		blocks[block.nextPhysical].previousPhysical = restIndex;
+	block.nextPhysical = restIndex;
+	block.size = size;
+	return restIndex;
+}
+
+HeapAllocator::Allocation HeapAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	assert(blocks);
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	size = AlignUp(size ? size : 1, GRANULARITY);
+	alignment = alignment > GRANULARITY ? alignment : GRANULARITY;
+
+	Allocation allocation = { 0, 0, INVALID_INDEX, 0 };
+	if (stats.numAllocations == (maxBlocks - 2) / 2)
+	{
+		stats.numFailed++;
+		return allocation;
+	}
+
+	//the block found for the size may not have room left once its start is aligned,
+	//in which case a block large enough for any alignment is looked for
+	uint32_t index = FindFreeBlock(size);
+	if (index != INVALID_INDEX && AlignUp(blocks[index].offset, alignment) + size > blocks[index].offset + blocks[index].size)
+		index = FindFreeBlock(size + alignment - GRANULARITY);
+	if (index == INVALID_INDEX)
+	{
+		stats.numFailed++;
+		return allocation;
+	}
+	RemoveFreeBlock(index);
+
+	//the space skipped for the alignment stays free, its previous block being allocated
+	uint64_t padding = AlignUp(blocks[index].offset, alignment) - blocks[index].offset;
+	if (padding)
+	{
+		uint32_t alignedIndex = SplitBlock(index, padding);
+		InsertFreeBlock(index);
+		index = alignedIndex;
+	}
+
+	//and so does the space left after the allocation
+	if (blocks[index].size > size)
+		InsertFreeBlock(SplitBlock(index, size));
+
+	Block &block = blocks[index];
+	block.state = BLOCK_ALLOCATED;
+	block.serial = nextSerial++;
+	stats.usedSize += block.size;
+	stats.numAllocations++;
+
+	allocation.offset = block.offset;
+	allocation.size = block.size;
+	allocation.blockIndex = index;
+	allocation.serial = block.serial;
+	return allocation;
+}
+
+bool HeapAllocator::Free(const Allocation &allocation)
+{
+	uint32_t index = allocation.blockIndex;
+	if (index >= maxBlocks || blocks[index].state != BLOCK_ALLOCATED || blocks[index].serial != allocation.serial)
+		return false;
+
+	Block &block = blocks[index];
+	assert(block.offset == allocation.offset && block.size == allocation.size);
+	stats.usedSize -= block.size;
+	stats.numAllocations--;
+
+	//merge with the following block
+	uint32_t nextIndex = block.nextPhysical;
+	if (nextIndex != INVALID_INDEX && blocks[nextIndex].state == BLOCK_FREE)
+	{
+		Block &next = blocks[nextIndex];
+		RemoveFreeBlock(nextIndex);
+		block.size += next.size;
+		block.nextPhysical = next.nextPhysical;
+		if (next.nextPhysical != INVALID_INDEX)
+			blocks[next.nextPhysical].previousPhysical = index;
+		ReleaseBlock(nextIndex);
+	}
+
+	//and with the previous one
+	uint32_t previousIndex = block.previousPhysical;
+	if (previousIndex != INVALID_INDEX && blocks[previousIndex].state == BLOCK_FREE)
+	{
+		Block &previous = blocks[previousIndex];
+		RemoveFreeBlock(previousIndex);
+		previous.size += block.size;
+		previous.nextPhysical = block.nextPhysical;
+		if (block.nextPhysical != INVALID_INDEX)
+			blocks[block.nextPhysical].previousPhysical = previousIndex;
+		ReleaseBlock(index);
+		index = previousIndex;
+	}
+
+	InsertFreeBlock(index);
+	return true;
+}
+
+void HeapAllocator::FreeAllocatedSince(uint32_t serial)
+{
+	for (uint32_t i = 0; i < maxBlocks; i++)
+	{
+		const Block &block = blocks[i];
+		if (block.state == BLOCK_ALLOCATED && block.serial - serial < nextSerial - serial)
+			Free({ block.offset, block.size, i, block.serial });
+	}
+}
+
+HeapAllocator::Stats HeapAllocator::GetStats() const
+{
+	Stats result = stats;
+	result.largestFreeSize = 0;
+	if (!firstLevelBitmap)
+		return result;
+
+	//the largest block is in the last list that is not empty
+	uint32_t firstLevel = FindLastBit(firstLevelBitmap);
+	uint32_t secondLevel = FindLastBit(secondLevelBitmaps[firstLevel]);
+	for (uint32_t i = freeLists[firstLevel][secondLevel]; i != INVALID_INDEX; i = blocks[i].nextFree)
+	{
+		if (blocks[i].size > result.largestFreeSize)
+			result.largestFreeSize = blocks[i].size;
+	}
+	return result;
+}
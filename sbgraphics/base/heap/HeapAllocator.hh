@@ -0,0 +1,133 @@
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+
+/// <summary>
+/// Hands out ranges of a heap it never touches itself, like the placed resources of a GPU heap, with a two-level segregated fit.
+/// The free ranges are kept in lists by size, the first level being the power of two below the size and the second one splitting it into 16,
+/// so that allocating and freeing take the same time whatever the number of ranges, and adjacent free ranges are merged right away.
+/// It only deals with offsets, so it can be driven without any device.
+/// </summary>
+class HeapAllocator
+{
+public:
+	static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	//every offset and size is a multiple of it
+	static constexpr uint64_t GRANULARITY = 256;
+
+	struct Allocation
+	{
+		uint64_t offset;
+		uint64_t size; //rounded up to the granularity
+		uint32_t blockIndex;
+		uint32_t serial; //tells a freed allocation from the one that took its block afterwards
+
+		bool IsValid() const
+		{
+			return blockIndex != INVALID_INDEX;
+		}
+	};
+
+	struct Stats
+	{
+		uint64_t heapSize;
+		uint64_t usedSize;
+		uint64_t largestFreeSize; //the largest allocation that would still succeed, without any alignment
+		uint32_t numAllocations;
+		uint32_t numFreeBlocks;
+		uint32_t numFailed; //the allocations that did not fit since the allocator was created
+
+		//0 when the free space is in one block, close to 1 when it is scattered in small ones
+		float GetFragmentation() const
+		{
+			uint64_t freeSize = heapSize - usedSize;
+			return freeSize ? 1.0f - (float)largestFreeSize / (float)freeSize : 0.0f;
+		}
+	};
+
+private:
+	static constexpr uint32_t SECOND_LEVEL_BITS = 4;
+	static constexpr uint32_t NUM_SECOND_LEVELS = 1 << SECOND_LEVEL_BITS;
+	static constexpr uint32_t NUM_FIRST_LEVELS = 32;
+
+	enum BlockState : uint8_t
+	{
+		BLOCK_UNUSED, //not part of the heap
+		BLOCK_FREE,
+		BLOCK_ALLOCATED
+	};
+
+	//a range of the heap, linked to its neighbours in the heap and to the other free blocks of its list
+	struct Block
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint32_t previousPhysical;
+		uint32_t nextPhysical;
+		uint32_t previousFree; //or the next unused block
+		uint32_t nextFree;
+		uint32_t serial;
+		BlockState state;
+	};
+
+	Block *blocks;
+	uint32_t maxBlocks;
+	uint32_t firstUnusedBlock;
+
+	uint32_t firstLevelBitmap; //a bit for every first level with free blocks
+	uint32_t secondLevelBitmaps[NUM_FIRST_LEVELS]; //a bit for every list with free blocks
+	uint32_t freeLists[NUM_FIRST_LEVELS][NUM_SECOND_LEVELS];
+
+	uint32_t nextSerial;
+	Stats stats;
+
+	static void GetListIndices(uint64_t size, uint32_t &firstLevel, uint32_t &secondLevel);
+
+	uint32_t AcquireBlock();
+	void ReleaseBlock(uint32_t index);
+	void InsertFreeBlock(uint32_t index);
+	void RemoveFreeBlock(uint32_t index);
+	uint32_t FindFreeBlock(uint64_t size) const;
+	uint32_t SplitBlock(uint32_t index, uint64_t size);
+
+public:
+	HeapAllocator():
+		blocks(nullptr),
+		maxBlocks(0),
+		firstUnusedBlock(INVALID_INDEX),
+		firstLevelBitmap(0),
+		secondLevelBitmaps(),
+		freeLists(),
+		nextSerial(0),
+		stats()
+	{}
+
+	/// <summary>
+	/// Starts with the whole heap free.
+	/// </summary>
+	/// <param name="maxAllocations">how many allocations can be alive at once</param>
+	bool Create(uint64_t heapSize, uint32_t maxAllocations);
+	void Destroy();
+
+	/// <summary>
+	/// Finds a free range of the heap, its offset being a multiple of @alignment (a power of two).
+	/// Returns an invalid allocation if there is no room left.
+	/// </summary>
+	Allocation Allocate(uint64_t size, uint64_t alignment);
+
+	//gives the range back, returns false if it had already been freed
+	bool Free(const Allocation &allocation);
+
+	//the serial of the next allocation, to free everything allocated after that point with FreeAllocatedSince
+	uint32_t GetNextSerial() const
+	{
+		return nextSerial;
+	}
+
+	//frees every allocation made since GetNextSerial returned @serial
+	void FreeAllocatedSince(uint32_t serial);
+
+	//walks the largest free blocks, so not meant for every allocation
+	Stats GetStats() const;
+};
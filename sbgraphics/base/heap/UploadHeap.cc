@@ -16,7 +16,10 @@
 
 static constexpr UINT64 ONE_MEGABYTE = 1024 * 1024;
 //upload heap, used exclusively for uploading data to the default, fastest heap
-static constexpr UINT64 UPLOAD_VRAM_BUDGET = ONE_MEGABYTE * 8;
+static constexpr UINT64 UPLOAD_VRAM_BUDGET = ONE_MEGABYTE * 32;
+
+//buffer copies have no placement requirements, this keeps the copied data aligned for the CPU
+static constexpr UINT64 BUFFER_COPY_ALIGNMENT = 16;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -36,6 +39,37 @@ bool UploadHeap::Create(ID3D12Device *device)
 	if FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)))
 		return false;
 
+	//a single buffer covers the whole heap, the copies take their room in it with the ring
+	D3D12_RESOURCE_DESC bufferDesc = {};
+	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferDesc.Width = UPLOAD_VRAM_BUDGET;
+	bufferDesc.Height = 1;
+	bufferDesc.DepthOrArraySize = 1;
+	bufferDesc.MipLevels = 1;
+	bufferDesc.SampleDesc.Count = 1;
+	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	if FAILED(device->CreatePlacedResource(
+		heap,
+		0,
+		&bufferDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&stagingBuffer)
+	))
+	{
+		DebugPrint("Failed to create the staging buffer.");
+		return false;
+	}
+
+	//upload heap resources can stay mapped, the CPU never reads them
+	CD3DX12_RANGE readRange(0, 0);
+	if FAILED(stagingBuffer->Map(0, &readRange, reinterpret_cast<void **>(&stagingData)))
+	{
+		DebugPrint("Failed to map the staging buffer.");
+		return false;
+	}
+	ring.Create(UPLOAD_VRAM_BUDGET);
+
 	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
 	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
 	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
@@ -46,31 +80,82 @@ bool UploadHeap::Create(ID3D12Device *device)
 		return false;
 	}
 
-	if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&copyCommandAllocator))))
+	for (uint32_t i = 0; i < NUM_COMMAND_ALLOCATORS; i++)
 	{
-		DebugPrint("Failed to create command allocator.");
-		return false;
+		if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&copyCommandAllocators[i]))))
+		{
+			DebugPrint("Failed to create command allocator.");
+			return false;
+		}
+		commandAllocatorFenceValues[i] = 0;
 	}
+	commandAllocatorIndex = 0;
 
-	if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, copyCommandAllocator, nullptr, IID_PPV_ARGS(&copyCommandList))))
+	if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, copyCommandAllocators[0], nullptr, IID_PPV_ARGS(&copyCommandList))))
 	{
 		DebugPrint("Failed to create command list.");
 		return false;
 	}
+	numRecordedCopies = 0;
+
+	//a single fence for all the batches, its value growing with every batch
+	fenceValue = 0;
+	if (FAILED(device->CreateFence(fenceValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		DebugPrint("Failed to create fence.");
+		return false;
+	}
+
+	fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (fenceEvent == nullptr)
+	{
+		DebugPrint("Failed to create event.");
+		return false;
+	}
 
 	return true;
 }
 
 void UploadHeap::Destroy()
 {
+	//the copies still running must not lose their resources
+	WaitForUploads();
+
+	CloseHandle(fenceEvent);
+	fence->Release();
 	copyCommandList->Release();
-	copyCommandAllocator->Release();
+	for (uint32_t i = 0; i < NUM_COMMAND_ALLOCATORS; i++)
+		copyCommandAllocators[i]->Release();
 	copyCommandQueue->Release();
+	stagingBuffer->Unmap(0, nullptr);
+	stagingBuffer->Release();
 	heap->Release();
 }
 
+bool UploadHeap::WaitForFenceValue(UINT64 value)
+{
+	if (fence->GetCompletedValue() < value)
+	{
+		if (FAILED(fence->SetEventOnCompletion(value, fenceEvent)))
+		{
+			DebugPrint("Failed to set event on completion.");
+			return false;
+		}
+		WaitForSingleObject(fenceEvent, INFINITE);
+	}
+
+	ring.Retire(fence->GetCompletedValue());
+	return true;
+}
+
 bool UploadHeap::PrepareCommandList()
 {
+	//the next allocator in turn, once the batch recorded with it is done
+	commandAllocatorIndex = (commandAllocatorIndex + 1) % NUM_COMMAND_ALLOCATORS;
+	if (!WaitForFenceValue(commandAllocatorFenceValues[commandAllocatorIndex]))
+		return false;
+
+	ID3D12CommandAllocator *copyCommandAllocator = copyCommandAllocators[commandAllocatorIndex];
 	if (FAILED(copyCommandAllocator->Reset()))
 	{
 		DebugPrint("Failed to reset command allocator.");
@@ -86,118 +171,118 @@ bool UploadHeap::PrepareCommandList()
 	return true;
 }
 
-bool UploadHeap::ImmediatelyUploadToHeap(
-	ID3D12Device *device,
-	const D3D12_RESOURCE_DESC *desc,
-	const D3D12_RESOURCE_ALLOCATION_INFO *ai,
-	const void *data,
-	D3D12_RESOURCE_STATES initialStates,
-	ID3D12Resource **bufferResource
-)
+/*
+*	Returns the offset of @size bytes in the staging buffer, waiting for the oldest batches if it is full.
+*/
+UINT64 UploadHeap::AllocateStagingSpace(UINT64 size, UINT64 alignment)
 {
 	//check if it will fit in our upload budget
-	if (ai->SizeInBytes > UPLOAD_VRAM_BUDGET)
+	if (size > UPLOAD_VRAM_BUDGET)
 	{
 		DebugPrint("Out of GPU upload memory budget!");
-		return false;
+		return UploadRing::INVALID_OFFSET;
 	}
 
-	//create a buffer on the upload heap
-	ID3D12Resource *uploadBuffer;
-	if FAILED(device->CreatePlacedResource(
-		heap,
-		0,
-		desc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&uploadBuffer)
-	))
+	ring.Retire(fence->GetCompletedValue());
+	UINT64 offset = ring.Allocate(size, alignment);
+	while (offset == UploadRing::INVALID_OFFSET)
 	{
-		DebugPrint("Failed to create the resource on the GPU's default heap.");
-		return false;
-	}
+		//the copies recorded so far take part of the ring, they need to be done as well
+		if (ring.HasOpenBatch() && !Submit())
+			return UploadRing::INVALID_OFFSET;
 
-	//copy data to the upload buffer
-	UINT8 *pData;
-	CD3DX12_RANGE readRange(0, 0);
-	HRESULT hr = uploadBuffer->Map(0, &readRange, reinterpret_cast<void **>(&pData));
+		UINT64 oldestFenceValue = ring.GetOldestFenceValue();
+		if (!oldestFenceValue || !WaitForFenceValue(oldestFenceValue))
+			return UploadRing::INVALID_OFFSET;
 
-	if (FAILED(hr))
-	{
-		DebugPrint("Failed to map upload buffer.");
-		uploadBuffer->Release();
-		return false;
+		offset = ring.Allocate(size, alignment);
 	}
-	UINT64 dataSize = desc->Width * desc->Height;
-	memcpy(pData, data, dataSize);
-	uploadBuffer->Unmap(0, nullptr);
 
-//	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(*bufferResource, initialStates, D3D12_RESOURCE_STATE_COPY_DEST));
-	copyCommandList->CopyBufferRegion(*bufferResource, 0, uploadBuffer, 0, dataSize);
-//	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(*bufferResource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER));
+	return offset;
+}
+
+bool UploadHeap::Submit()
+{
+	if (!numRecordedCopies)
+		return true;
 
 	if (FAILED(copyCommandList->Close()))
 	{
 		DebugPrint("Failed to close command list.");
-		uploadBuffer->Release();
 		return false;
 	}
 
 	ID3D12CommandList *ppCommandLists[] = { copyCommandList };
 	copyCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
 
-	//create a fence and wait for the copy to complete
-	ID3D12Fence *fence;
-	if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	//every batch is done at the next fence value
+	if (FAILED(copyCommandQueue->Signal(fence, fenceValue + 1)))
 	{
-		DebugPrint("Failed to create fence.");
-		uploadBuffer->Release();
+		DebugPrint("Failed to signal fence.");
 		return false;
 	}
+	fenceValue++;
+	commandAllocatorFenceValues[commandAllocatorIndex] = fenceValue;
+	numRecordedCopies = 0;
 
-	HANDLE hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-	if (hEvent == nullptr)
-	{
-		DebugPrint("Failed to create event.");
-		fence->Release();
-		uploadBuffer->Release();
+	if (ring.IsBatchListFull() && !WaitForFenceValue(ring.GetOldestFenceValue()))
 		return false;
-	}
+	ring.CloseBatch(fenceValue);
 
-	hr = copyCommandQueue->Signal(fence, 1);
-	if (FAILED(hr))
-	{
-		DebugPrint("Failed to signal fence.");
-		CloseHandle(hEvent);
-		fence->Release();
-		uploadBuffer->Release();
-		return false;
-	}
+	return PrepareCommandList();
+}
 
-	if (fence->GetCompletedValue() < 1)
-	{
-		hr = fence->SetEventOnCompletion(1, hEvent);
-		if (SUCCEEDED(hr))
-		{
-			WaitForSingleObject(hEvent, INFINITE);
-		}
-		else
-		{
-			DebugPrint("Failed to set event on completion.");
-		}
-	}
+void UploadHeap::WaitOnQueue(ID3D12CommandQueue *queue) const
+{
+	if (fenceValue && fence->GetCompletedValue() < fenceValue)
+		queue->Wait(fence, fenceValue);
+}
 
-	CloseHandle(hEvent);
-	fence->Release();
-	uploadBuffer->Release();
+bool UploadHeap::WaitForUploads()
+{
+	if (!Submit())
+		return false;
 
-	if (!PrepareCommandList())
+	return WaitForFenceValue(fenceValue);
+}
+
+bool UploadHeap::UploadToBuffer(
+	ID3D12Device *device,
+	const void *data,
+	UINT64 dataSize,
+	ID3D12Resource *buffer,
+	UINT64 bufferOffset
+)
+{
+	UINT64 stagingOffset = AllocateStagingSpace(dataSize, BUFFER_COPY_ALIGNMENT);
+	if (stagingOffset == UploadRing::INVALID_OFFSET)
 		return false;
 
+	//copy data to the staging buffer
+	memcpy(stagingData + stagingOffset, data, dataSize);
+
+//	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(*bufferResource, initialStates, D3D12_RESOURCE_STATE_COPY_DEST));
+	copyCommandList->CopyBufferRegion(buffer, bufferOffset, stagingBuffer, stagingOffset, dataSize);
+//	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(*bufferResource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER));
+	numRecordedCopies++;
+
 	return true;
 }
 
-bool UploadHeap::ImmediatelyUploadTextureToHeap(
+bool UploadHeap::UploadToHeap(
+	ID3D12Device *device,
+	const D3D12_RESOURCE_DESC *desc,
+	const D3D12_RESOURCE_ALLOCATION_INFO *ai,
+	const void *data,
+	D3D12_RESOURCE_STATES initialStates,
+	ID3D12Resource **bufferResource
+)
+{
+	//the whole buffer is filled, starting from its beginning
+	return UploadToBuffer(device, data, desc->Width * desc->Height, *bufferResource, 0);
+}
+
+bool UploadHeap::UploadTextureToHeap(
 	ID3D12Device *device,
 	const D3D12_RESOURCE_DESC *desc,
 	const D3D12_RESOURCE_ALLOCATION_INFO *ai,
@@ -207,59 +292,24 @@ bool UploadHeap::ImmediatelyUploadTextureToHeap(
 	ID3D12Resource *texture
 )
 {
-	//check if it will fit in our upload budget
-	if (ai->SizeInBytes > UPLOAD_VRAM_BUDGET)
-	{
-		DebugPrint("Out of GPU upload memory budget!");
-		return false;
-	}
-
-	//create the intermediate buffer on the upload heap
-	//remember that we cannot use @desc since that is for a texture buffer
-	//and we cannot create a texture buffer on the upload heap,
-	//so it must be a generic, one dimensional buffer
-	D3D12_RESOURCE_DESC bufferDesc = {};
-	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	bufferDesc.Width = ai->SizeInBytes; //IMPORTANT: this number is greater that @dataSize since it involves alignment
-	bufferDesc.Height = 1;
-	bufferDesc.DepthOrArraySize = 1;
-	bufferDesc.MipLevels = 1;
-//	bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
-	bufferDesc.SampleDesc.Count = 1;
-	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	//the texture's layout in the staging buffer
+	UINT64 requiredSize;
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+	device->GetCopyableFootprints(desc, 0, 1, 0, &footprint, nullptr, nullptr, &requiredSize);
 
-	ID3D12Resource *intermediateBuffer;
-	if FAILED(device->CreatePlacedResource(
-		heap, 0, &bufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr, IID_PPV_ARGS(&intermediateBuffer)
-	))
-	{
-		DebugPrint("Failed to create a placed resource.");
+	UINT64 stagingOffset = AllocateStagingSpace(requiredSize > dataSize ? requiredSize : dataSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	if (stagingOffset == UploadRing::INVALID_OFFSET)
 		return false;
-	}
 
-	//copy texture data to the upload buffer
-	UINT8 *pData;
-	CD3DX12_RANGE readRange(0, 0);
-	HRESULT hr = intermediateBuffer->Map(0, &readRange, reinterpret_cast<void **>(&pData));
-	if (FAILED(hr))
-	{
-		DebugPrint("Failed to map upload buffer.");
-		intermediateBuffer->Release();
-		return false;
-	}
-	memcpy(pData, data, dataSize);
-	intermediateBuffer->Unmap(0, nullptr);
+	//copy texture data to the staging buffer
+	memcpy(stagingData + stagingOffset, data, dataSize);
 
-	//START COPY TO HEAP
-	UINT64 requiredSize;
-	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
-	device->GetCopyableFootprints(desc, 0, 1, 0, &footprint, nullptr, nullptr, &requiredSize);
-	//copy the texture data from the intermediate buffer to the texture resource using CopyTextureRegion
+	//copy the texture data from the staging buffer to the texture resource using CopyTextureRegion
 	D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
-	srcLocation.pResource = intermediateBuffer;
+	srcLocation.pResource = stagingBuffer;
 	srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
 	srcLocation.PlacedFootprint = footprint;
+	srcLocation.PlacedFootprint.Offset = stagingOffset;
 
 	D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
 	dstLocation.pResource = texture;
@@ -269,62 +319,7 @@ bool UploadHeap::ImmediatelyUploadTextureToHeap(
 //	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(*bufferResource, initialStates, D3D12_RESOURCE_STATE_COPY_DEST));
 	copyCommandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
 //	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(*bufferResource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER));
-
-	if (FAILED(copyCommandList->Close()))
-	{
-		DebugPrint("Failed to close command list.");
-		intermediateBuffer->Release();
-		return false;
-	}
-
-	ID3D12CommandList *ppCommandLists[] = { copyCommandList };
-	copyCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
-
-	//create a fence and wait for the copy to complete
-	ID3D12Fence *fence;
-	if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
-	{
-		DebugPrint("Failed to create fence.");
-		intermediateBuffer->Release();
-		return false;
-	}
-
-	HANDLE hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-	if (hEvent == nullptr)
-	{
-		DebugPrint("Failed to create event.");
-		fence->Release();
-		intermediateBuffer->Release();
-		return false;
-	}
-
-	if (FAILED(copyCommandQueue->Signal(fence, 1)))
-	{
-		DebugPrint("Failed to signal fence.");
-		CloseHandle(hEvent);
-		fence->Release();
-		intermediateBuffer->Release();
-		return false;
-	}
-
-	if (fence->GetCompletedValue() < 1)
-	{
-		if (SUCCEEDED(fence->SetEventOnCompletion(1, hEvent)))
-		{
-			WaitForSingleObject(hEvent, INFINITE);
-		}
-		else
-		{
-			DebugPrint("Failed to set event on completion.");
-		}
-	}
-
-	CloseHandle(hEvent);
-	fence->Release();
-	intermediateBuffer->Release();
-
-	if (!PrepareCommandList())
-		return false;
+	numRecordedCopies++;
 
 	return true;
 }
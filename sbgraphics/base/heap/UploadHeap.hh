@@ -1,32 +1,70 @@
 #pragma once
 
+#include "UploadRing.hh"
+
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
 #include <d3d12.h>
 
+/*
+*	Copies data to the default heap through a persistently mapped staging buffer.
+*	The copies are recorded and submitted to the copy queue in batches, a single fence telling which batches are done.
+*/
 class UploadHeap
 {
+	//a command allocator can only be reset once the GPU is done with the batch recorded with it
+	static constexpr uint32_t NUM_COMMAND_ALLOCATORS = 4;
+
 	ID3D12Heap *heap;
+	ID3D12Resource *stagingBuffer;
+	UINT8 *stagingData; //mapped for as long as the heap lives
+
 	ID3D12CommandQueue *copyCommandQueue;
-	ID3D12CommandAllocator *copyCommandAllocator;
+	ID3D12CommandAllocator *copyCommandAllocators[NUM_COMMAND_ALLOCATORS];
+	UINT64 commandAllocatorFenceValues[NUM_COMMAND_ALLOCATORS];
+	uint32_t commandAllocatorIndex;
 	ID3D12GraphicsCommandList *copyCommandList;
+	uint32_t numRecordedCopies;
+
+	UploadRing ring;
+	ID3D12Fence *fence;
+	HANDLE fenceEvent;
+	UINT64 fenceValue; //the value of the last submitted batch
 
+	bool WaitForFenceValue(UINT64 value);
 	bool PrepareCommandList();
+	UINT64 AllocateStagingSpace(UINT64 size, UINT64 alignment);
 
 public:
 	constexpr UploadHeap():
 		heap(nullptr),
+		stagingBuffer(nullptr),
+		stagingData(nullptr),
 		copyCommandQueue(nullptr),
-		copyCommandAllocator(nullptr),
-		copyCommandList(nullptr)
+		copyCommandAllocators(),
+		commandAllocatorFenceValues(),
+		commandAllocatorIndex(0),
+		copyCommandList(nullptr),
+		numRecordedCopies(0),
+		ring(),
+		fence(nullptr),
+		fenceEvent(nullptr),
+		fenceValue(0)
 	{ }
 
 	bool Create(ID3D12Device *device);
 	void Destroy();
 
+	//records a copy of @dataSize bytes to a buffer residing on the default heap, starting at @bufferOffset
+	bool UploadToBuffer(
+		ID3D12Device *device,
+		const void *data,
+		UINT64 dataSize,
+		ID3D12Resource *buffer,
+		UINT64 bufferOffset
+	);
 
-
-	bool ImmediatelyUploadToHeap(
+	bool UploadToHeap(
 		ID3D12Device *device,
 		const D3D12_RESOURCE_DESC *desc,
 		const D3D12_RESOURCE_ALLOCATION_INFO *ai,
@@ -35,7 +73,7 @@ public:
 		ID3D12Resource **resource
 	);
 
-	bool ImmediatelyUploadTextureToHeap(
+	bool UploadTextureToHeap(
 		ID3D12Device *device,
 		const D3D12_RESOURCE_DESC *desc,
 		const D3D12_RESOURCE_ALLOCATION_INFO *ai,
@@ -44,4 +82,24 @@ public:
 		D3D12_RESOURCE_STATES initialStates,
 		ID3D12Resource *texture
 	);
+
+	//sends the recorded copies to the copy queue, without waiting for them
+	bool Submit();
+
+	//has @queue wait on the GPU for the submitted copies, before running what is executed on it next
+	void WaitOnQueue(ID3D12CommandQueue *queue) const;
+
+	//submits the recorded copies and blocks until they are all done
+	bool WaitForUploads();
+
+	//the fence value the recorded copies will be done at
+	UINT64 GetRecordingFenceValue() const
+	{
+		return fenceValue + 1;
+	}
+
+	UINT64 GetCompletedFenceValue() const
+	{
+		return fence->GetCompletedValue();
+	}
 };
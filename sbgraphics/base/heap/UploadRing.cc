@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////////////////////
+//	Sabre Engine Graphics - upload ring
+//	(C) Moczulski Alan, 2023.
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "UploadRing.hh"
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+void UploadRing::Create(uint64_t size)
+{
+	capacity = size;
+	head = 0;
+	usedSize = 0;
+	openSize = 0;
+	firstBatch = 0;
+	numBatches = 0;
+}
+
+uint64_t UploadRing::Allocate(uint64_t size, uint64_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	if (size > capacity)
+		return INVALID_OFFSET;
+
+	//the free space always starts at the head, going around the end of the buffer,
+	//so whatever is skipped to align the allocation or to wrap around is taken as well
+	uint64_t offset = (head + alignment - 1) & ~(alignment - 1);
+	if (offset + size > capacity)
+		offset = 0;
+	uint64_t takenSize = (offset >= head ? offset - head : capacity - head) + size;
+	if (takenSize > capacity - usedSize)
+		return INVALID_OFFSET;
+
+	head = offset + size;
+	if (head == capacity)
+		head = 0;
+	usedSize += takenSize;
+	openSize += takenSize;
+	return offset;
+}
+
+void UploadRing::CloseBatch(uint64_t fenceValue)
+{
+	assert(numBatches < MAX_BATCHES);
+	assert(!numBatches || batches[(firstBatch + numBatches - 1) % MAX_BATCHES].fenceValue < fenceValue);
+
+	Batch &batch = batches[(firstBatch + numBatches) % MAX_BATCHES];
+	batch.fenceValue = fenceValue;
+	batch.size = openSize;
+	numBatches++;
+	openSize = 0;
+}
+
+void UploadRing::Retire(uint64_t completedFenceValue)
+{
+	//the batches complete in the order they were submitted
+	while (numBatches && batches[firstBatch].fenceValue <= completedFenceValue)
+	{
+		usedSize -= batches[firstBatch].size;
+		firstBatch = (firstBatch + 1) % MAX_BATCHES;
+		numBatches--;
+	}
+
+	//once nothing is used, the next allocation can start from the beginning
+	if (!usedSize)
+		head = 0;
+}
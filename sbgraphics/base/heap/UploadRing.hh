@@ -0,0 +1,84 @@
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+
+/// <summary>
+/// Hands out the space of a staging buffer in a ring, for the copies to the default heap.
+/// The copies are submitted in batches, every batch taking the next value of a single fence, so the space of all the batches
+/// the GPU is done with is reclaimed by comparing their values with the fence's completed value.
+/// It only deals with offsets and fence values, so it can be driven without any device.
+/// </summary>
+class UploadRing
+{
+public:
+	static constexpr uint64_t INVALID_OFFSET = 0xFFFFFFFFFFFFFFFF;
+	static constexpr uint32_t MAX_BATCHES = 64;
+
+private:
+	//the space taken by a submitted batch, padding included
+	struct Batch
+	{
+		uint64_t fenceValue;
+		uint64_t size;
+	};
+
+	uint64_t capacity;
+	uint64_t head; //where the next allocation starts looking
+	uint64_t usedSize; //the submitted batches and the open one
+	uint64_t openSize; //the space taken since the last batch was closed
+
+	Batch batches[MAX_BATCHES];
+	uint32_t firstBatch;
+	uint32_t numBatches;
+
+public:
+	constexpr UploadRing():
+		capacity(0),
+		head(0),
+		usedSize(0),
+		openSize(0),
+		batches(),
+		firstBatch(0),
+		numBatches(0)
+	{}
+
+	void Create(uint64_t size);
+
+	/// <summary>
+	/// Finds room for @size bytes after the previous allocation, its offset being a multiple of @alignment (a power of two).
+	/// Returns INVALID_OFFSET if the batches still used by the GPU are in the way.
+	/// </summary>
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+	//the allocations made since the previous batch will be done once the fence reaches @fenceValue
+	void CloseBatch(uint64_t fenceValue);
+
+	//reclaims the space of the batches whose fence value has been reached
+	void Retire(uint64_t completedFenceValue);
+
+	uint64_t GetCapacity() const
+	{
+		return capacity;
+	}
+
+	uint64_t GetUsedSize() const
+	{
+		return usedSize;
+	}
+
+	bool HasOpenBatch() const
+	{
+		return openSize != 0;
+	}
+
+	bool IsBatchListFull() const
+	{
+		return numBatches == MAX_BATCHES;
+	}
+
+	//the value to wait for before some space gets reclaimed, 0 if there are no submitted batches
+	uint64_t GetOldestFenceValue() const
+	{
+		return numBatches ? batches[firstBatch].fenceValue : 0;
+	}
+};
@@ -226,11 +226,14 @@ void sbSwapChain::ClearRenderTarget(ID3D12GraphicsCommandList *commandList) cons
 	commandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 }
 
-void sbSwapChain::ExecuteAndPresent(UINT numCommandLists, ID3D12CommandList *const *commandLists)
+void sbSwapChain::ExecuteAndPresent(HeapManager &heapManager, UINT numCommandLists, ID3D12CommandList *const *commandLists)
 {
 	assert(swapChain);
 	assert(queue);
 
+	//the frame may draw with resources whose copies are still to be submitted
+	heapManager.SubmitUploads(queue);
+
 	//execute the recorded commands
 	queue->ExecuteCommandLists(numCommandLists, commandLists);
 
@@ -517,7 +520,7 @@ void sbBaseRenderer::EndAndPresentFrame()
 	}
 
 	ID3D12CommandList *commandLists[] = { commandList };
-	swapChain.ExecuteAndPresent(_countof(commandLists), commandLists);
+	swapChain.ExecuteAndPresent(heapManager, _countof(commandLists), commandLists);
 
 	swapChain.MoveToNextFrame();
 }
@@ -534,6 +537,8 @@ void sbBaseRenderer::DrawDynamic(void *verts, uint32_t numVertices, uint32_t ver
 //	assert((char*)verts + verticesSize == (char*)indices); //TODO: vertices must be followed by indices, since we have only one buffer
 
 	auto bufferAddress = heapManager.UploadToDynamicBuffer(verts, verticesSize + indicesSize);
+	if (!bufferAddress)
+		return;
 
 	D3D12_VERTEX_BUFFER_VIEW vbv{};
 	vbv.BufferLocation = bufferAddress;
@@ -18,6 +18,9 @@ class sbSwapChain
 {
 	static constexpr UINT NUM_RENDER_TARGETS = 2; //double-buffered
 
+	//the heaps recycle the memory of a frame once the swap chain has waited for its render target
+	static_assert(NUM_RENDER_TARGETS == HeapManager::FRAMES_IN_FLIGHT, "The heaps must keep as many frames in flight as there are render targets!");
+
 	//resolution limits, so that we know how much VRAM to allocate on the heap
 	//for the swapchain images
 	static constexpr UINT MAX_RESOLUTION_WIDTH = 3840;
@@ -60,7 +63,7 @@ public:
 
 	void BindRenderTarget(ID3D12GraphicsCommandList *commandList) const;
 	void ClearRenderTarget(ID3D12GraphicsCommandList *commandList) const;
-	void ExecuteAndPresent(UINT numCommandLists, ID3D12CommandList *const *commandLists);
+	void ExecuteAndPresent(HeapManager &heapManager, UINT numCommandLists, ID3D12CommandList *const *commandLists);
 	void WaitForGpu();
 	void MoveToNextFrame();
 };
@@ -30,6 +30,9 @@ bool sbDescriptorHeap::Create(ID3D12Device *device)
 
 		srvDescriptorHandle = srvDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
 		srvDescriptorHandleIncrementSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+		if (!textureSlots.Create(MAX_NUM_TEXTURES))
+			return false;
 	}
 	
 	//create a descriptor heap for the sampler
@@ -72,6 +75,7 @@ void sbDescriptorHeap::Destroy()
 		samplerDescriptorHeap->Release();
 	if (srvDescriptorHeap)
 		srvDescriptorHeap->Release();
+	textureSlots.Destroy();
 }
 
 void sbDescriptorHeap::SetWorldViewProjectionMatrix(ID3D12GraphicsCommandList *commandList, const Matrix &m)
@@ -79,15 +83,25 @@ void sbDescriptorHeap::SetWorldViewProjectionMatrix(ID3D12GraphicsCommandList *c
 	commandList->SetGraphicsRoot32BitConstants(MATRIX_ROOT_PARAM_INDEX, 16, m, 0);
 }
 
-void sbDescriptorHeap::SetTexture(ID3D12GraphicsCommandList *commandList, uint32_t textureIndex0)
+void sbDescriptorHeap::SetTexture(ID3D12GraphicsCommandList *commandList, uint32_t descriptor0)
 {
-	uint32_t data[] = { textureIndex0 };
+	//the slot of a destroyed texture may already hold another view
+	if (!textureSlots.IsValid(descriptor0))
+		descriptor0 = fallbackDescriptor;
+
+	//the shaders index the table with the slots
+	uint32_t data[] = { DescriptorSlotAllocator::GetSlot(descriptor0) };
 	commandList->SetGraphicsRoot32BitConstants(TEXINDEX_ROOT_PARAM_INDEX, 1, &data, 0);
 }
 
-void sbDescriptorHeap::SetTexture(ID3D12GraphicsCommandList *commandList, uint32_t textureIndex0, uint32_t textureIndex1)
+void sbDescriptorHeap::SetTexture(ID3D12GraphicsCommandList *commandList, uint32_t descriptor0, uint32_t descriptor1)
 {
-	uint32_t data[] = { textureIndex0, textureIndex1 };
+	if (!textureSlots.IsValid(descriptor0))
+		descriptor0 = fallbackDescriptor;
+	if (!textureSlots.IsValid(descriptor1))
+		descriptor1 = fallbackDescriptor;
+
+	uint32_t data[] = { DescriptorSlotAllocator::GetSlot(descriptor0), DescriptorSlotAllocator::GetSlot(descriptor1) };
 	commandList->SetGraphicsRoot32BitConstants(TEXINDEX_ROOT_PARAM_INDEX, 2, &data, 0);
 }
 
@@ -99,9 +113,14 @@ void sbDescriptorHeap::Use(ID3D12GraphicsCommandList *commandList)
 	commandList->SetGraphicsRootDescriptorTable(SAMPLER_ROOT_PARAM_INDEX, samplerDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
 }
 
-D3D12_CPU_DESCRIPTOR_HANDLE sbDescriptorHeap::CreateSRV(ID3D12Device *device, DXGI_FORMAT format, uint32_t index, ID3D12Resource *texture)
+uint32_t sbDescriptorHeap::CreateSRV(ID3D12Device *device, DXGI_FORMAT format, ID3D12Resource *texture)
 {
-	assert(index < MAX_NUM_TEXTURES);
+	uint32_t descriptor = textureSlots.Allocate();
+	if (descriptor == DescriptorSlotAllocator::INVALID_HANDLE)
+	{
+		DebugPrint("Out of texture descriptors!");
+		return descriptor;
+	}
 
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Format = format;
@@ -111,9 +130,15 @@ D3D12_CPU_DESCRIPTOR_HANDLE sbDescriptorHeap::CreateSRV(ID3D12Device *device, DX
 
 	//create a shader resource view at the given offset in memory
 	CD3DX12_CPU_DESCRIPTOR_HANDLE handle(srvDescriptorHandle);
-	handle.Offset(index, srvDescriptorHandleIncrementSize);
+	handle.Offset(DescriptorSlotAllocator::GetSlot(descriptor), srvDescriptorHandleIncrementSize);
 	device->CreateShaderResourceView(texture, &srvDesc, handle); //can also be used to overwrite an already-existing SRV in the heap
-	return handle;
+	return descriptor;
+}
+
+void sbDescriptorHeap::DestroySRV(HeapManager &heapManager, uint32_t descriptor)
+{
+	//the view stays in the heap until its slot is taken again, which the command lists in flight may still read
+	heapManager.FreeDescriptor(textureSlots, descriptor);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -127,10 +152,22 @@ bool sbRasterRenderer::Create(HWND hwnd)
 	if (!descriptorHeap.Create(device))
 		return false;
 
+	//create the fallback texture, before any checkpoint so that it survives the resets
+	{
+		uint32_t data[4 * 4];
+		for (auto &texel : data)
+			texel = 0xFFFFFFFF;
+		fallbackTexture = CreateTexture(data, sizeof(data), 4, 4, DXGI_FORMAT_R8G8B8A8_UNORM);
+		if (!fallbackTexture.resource)
+			return false;
+		descriptorHeap.SetFallbackDescriptor(fallbackTexture.descriptor);
+	}
+
 	//create the root signature
 	{
 		CD3DX12_DESCRIPTOR_RANGE1 ranges[2];
-		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
+		//the slots that are not taken hold no view, and the views change while the table is set
+		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, sbDescriptorHeap::MAX_NUM_TEXTURES, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE);
 		ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, 1, 0);
 
 		CD3DX12_ROOT_PARAMETER1 rootParameters[4];
@@ -175,6 +212,7 @@ void sbRasterRenderer::Destroy()
 	if (rootSignature)
 		rootSignature->Release();
 
+	DestroyTexture(fallbackTexture);
 	descriptorHeap.Destroy();
 
 	//destroy the base renderer
@@ -213,6 +251,16 @@ bool sbRasterRenderer::StartFrame()
 
 	descriptorHeap.Use(commandList);
 
+	//the command list starts with nothing set
+	stateFilter.Invalidate();
+	stateFilter.ResetStats();
+
+	//the frame that used the next region of the dynamic buffer is done with it
+	heapManager.ResetDynamicBuffer();
+
+	//and the heap ranges released a few frames ago can be reused
+	heapManager.StartFrame();
+
 	return true;
 }
 
@@ -233,26 +281,106 @@ void sbRasterRenderer::DestroyPipeline(Pipeline &pipeline) const
 
 void sbRasterRenderer::UsePipeline(const Pipeline &pipeline) const
 {
-	pipeline.Use(commandList);
+	if (stateFilter.SetPipeline(&pipeline))
+		pipeline.Use(commandList);
 }
 
 void sbRasterRenderer::DestroyMesh(sbMesh &mesh)
 {
 	if (mesh.vertexBuffer)
+	{
+		heapManager.Free((ID3D12Resource*)mesh.vertexBuffer);
 		((ID3D12Resource*)mesh.vertexBuffer)->Release();
+	}
 	if (mesh.indexBuffer)
+	{
+		heapManager.Free((ID3D12Resource*)mesh.indexBuffer);
 		((ID3D12Resource*)mesh.indexBuffer)->Release();
+	}
+}
+
+void sbRasterRenderer::DrawBoundMesh(uint32_t numIndices, uint32_t startIndex, int32_t baseVertex)
+{
+	commandList->DrawIndexedInstanced(numIndices, 1, startIndex, baseVertex, 0);
+}
+
+void sbRasterRenderer::DrawBoundMeshInstances(uint32_t numIndices, uint32_t numInstances, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+{
+	commandList->DrawIndexedInstanced(numIndices, numInstances, startIndex, baseVertex, startInstance);
+}
+
+GPUResource sbRasterRenderer::CreateBuffer(uint32_t size)
+{
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Width = size;
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.SampleDesc.Count = 1;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	ID3D12Resource *buffer;
+	if (!heapManager.AllocateBuffer(device, &desc, D3D12_RESOURCE_STATE_COPY_DEST, &buffer))
+		return nullptr;
+
+	return buffer;
+}
+
+bool sbRasterRenderer::UpdateBuffer(GPUResource buffer, uint32_t offset, const void *data, uint32_t size)
+{
+	assert(buffer);
+	assert(offset + size <= ((ID3D12Resource *)buffer)->GetDesc().Width);
+	if (size == 0)
+		return true;
+
+	return heapManager.FillBuffer(device, (ID3D12Resource *)buffer, offset, data, size);
 }
 
-void sbRasterRenderer::DrawBoundMesh(uint32_t numIndices, uint32_t startIndex)
+void sbRasterRenderer::DestroyBuffer(GPUResource &buffer)
 {
-	commandList->DrawIndexedInstanced(numIndices, 1, startIndex, 0, 0);
+	if (buffer)
+	{
+		heapManager.Free((ID3D12Resource*)buffer);
+		((ID3D12Resource*)buffer)->Release();
+	}
+	buffer = nullptr;
 }
 
-GPUResource sbRasterRenderer::CreateTexture(
-	const void *data, uint32_t dataSize, uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t index
+void sbRasterRenderer::BindIndexBuffer(GPUResource buffer)
+{
+	if (!stateFilter.SetIndexBuffer(buffer))
+		return;
+
+	ID3D12Resource *ib = (ID3D12Resource *)buffer;
+
+	D3D12_INDEX_BUFFER_VIEW ibv{};
+	ibv.BufferLocation = ib->GetGPUVirtualAddress();
+	ibv.SizeInBytes = (UINT)ib->GetDesc().Width;
+	ibv.Format = DXGI_FORMAT_R32_UINT;
+	commandList->IASetIndexBuffer(&ibv);
+}
+
+bool sbRasterRenderer::BindInstanceData(const void *data, uint32_t stride, uint32_t numInstances)
+{
+	uint32_t size = stride * numInstances;
+	uint64_t bufferAddress = heapManager.UploadToDynamicBuffer(data, size);
+	if (!bufferAddress)
+		return false;
+
+	D3D12_VERTEX_BUFFER_VIEW vbv{};
+	vbv.BufferLocation = bufferAddress;
+	vbv.StrideInBytes = stride;
+	vbv.SizeInBytes = size;
+	commandList->IASetVertexBuffers(1, 1, &vbv);
+	return true;
+}
+
+sbTexture sbRasterRenderer::CreateTexture(
+	const void *data, uint32_t dataSize, uint32_t width, uint32_t height, DXGI_FORMAT format
 )
 {
+	sbTexture result;
 	ID3D12Resource *texture;
 	D3D12_RESOURCE_DESC desc = {};
 	desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
@@ -267,31 +395,53 @@ GPUResource sbRasterRenderer::CreateTexture(
 	desc.Format = format;
 	desc.SampleDesc.Count = 1;
 	if (!heapManager.AllocateAndFillTexture(device, &desc, data, dataSize, D3D12_RESOURCE_STATE_COPY_DEST, &texture))
-		return nullptr;
+		return result;
 
 	//create a shader resource view so that we can access the texture from a shader
-	D3D12_CPU_DESCRIPTOR_HANDLE descriptorHandle = descriptorHeap.CreateSRV(device, format, index, texture);
+	result.descriptor = descriptorHeap.CreateSRV(device, format, texture);
+	if (result.descriptor == DescriptorSlotAllocator::INVALID_HANDLE)
+	{
+		heapManager.Free(texture);
+		texture->Release();
+		return result;
+	}
+
+	result.resource = texture;
+	return result;
+}
 
-	return texture;
+void sbRasterRenderer::DestroyTexture(sbTexture &texture)
+{
+	if (texture.resource)
+	{
+		descriptorHeap.DestroySRV(heapManager, texture.descriptor);
+		heapManager.Free((ID3D12Resource*)texture.resource);
+		((ID3D12Resource*)texture.resource)->Release();
+	}
+	texture = sbTexture();
 }
 
-void sbRasterRenderer::DestroyTexture(GPUResource& texture)
+void sbRasterRenderer::DrawDynamic(void *verts, uint32_t numVertices, uint32_t vertexSize, uint32_t *indices, uint32_t numIndices) const
 {
-	if (texture)
-		((ID3D12Resource*)texture)->Release();
+	sbBaseRenderer::DrawDynamic(verts, numVertices, vertexSize, indices, numIndices);
+	stateFilter.InvalidateVertexBuffer();
 }
 
 void sbRasterRenderer::SetWorldViewProjectionMatrix(const Matrix &m)
 {
-	descriptorHeap.SetWorldViewProjectionMatrix(commandList, m);
+	if (stateFilter.SetMatrix(m))
+		descriptorHeap.SetWorldViewProjectionMatrix(commandList, m);
 }
 
-void sbRasterRenderer::UseOneTexture(uint32_t textureIndex0)
+void sbRasterRenderer::UseOneTexture(uint32_t descriptor0)
 {
-	descriptorHeap.SetTexture(commandList, textureIndex0);
+	if (stateFilter.SetTextures(&descriptor0, 1))
+		descriptorHeap.SetTexture(commandList, descriptor0);
 }
 
-void sbRasterRenderer::UseTwoTextures(uint32_t textureIndex0, uint32_t textureIndex1)
+void sbRasterRenderer::UseTwoTextures(uint32_t descriptor0, uint32_t descriptor1)
 {
-	descriptorHeap.SetTexture(commandList, textureIndex0, textureIndex1);
+	uint32_t descriptors[] = { descriptor0, descriptor1 };
+	if (stateFilter.SetTextures(descriptors, 2))
+		descriptorHeap.SetTexture(commandList, descriptor0, descriptor1);
 }
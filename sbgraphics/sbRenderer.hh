@@ -4,6 +4,10 @@
 //use the ray-tracing renderer
 #include "sbRTRenderer.hh"
 #define sbRenderer sbRTRenderer
+#elif defined(SOFTWARE_RASTER)
+//use the software renderer, drawing on the CPU
+#include "sbSoftRenderer.hh"
+#define sbRenderer sbSoftRenderer
 #else
 //use the raster renderer
 #include "sbRasterRenderer.hh"
@@ -0,0 +1,1442 @@
+////////////////////////////////////////////////////////////////////////////////////////////////
+//	Sabre Engine Graphics - Software Renderer implementation
+//	(C) Moczulski Alan, 2023.
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "sbSoftRenderer.hh"
+#include <math.h>
+#include <stdio.h> //fopen
+#include <stdlib.h> //malloc
+#include <string.h> //memcpy
+#include <chrono> //std::chrono::steady_clock
+#include <smmintrin.h>
+
+//the color the image is cleared with, like the swap chain's
+static const __m128 CLEAR_COLOR = _mm_setr_ps(0.3f, 0.3f, 0.3f, 1.0f);
+
+//lines are drawn as quads of that width, in pixels
+static constexpr float LINE_WIDTH = 1.0f;
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+//the colors are kept as 4 floats, red first
+static inline uint32_t PackColor(__m128 color)
+{
+	__m128 clamped = _mm_min_ps(_mm_max_ps(color, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	__m128i channels = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+	channels = _mm_packus_epi32(channels, channels);
+	return (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(channels, channels));
+}
+
+static inline __m128 UnpackColor(uint32_t packed)
+{
+	__m128i channels = _mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)packed));
+	return _mm_mul_ps(_mm_cvtepi32_ps(channels), _mm_set1_ps(1.0f / 255.0f));
+}
+
+static inline uint32_t MakeTexel(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+	return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+//expands a 5:6:5 color to 8 bits per channel
+static inline void Expand565(uint16_t color, uint32_t rgb[3])
+{
+	uint32_t r = (color >> 11) & 31;
+	uint32_t g = (color >> 5) & 63;
+	uint32_t b = color & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+//decodes the color half of a BC1, BC2 or BC3 block, only BC1 having the mode with a transparent color
+static void DecodeColorBlock(const uint8_t *block, bool allowTransparency, uint32_t texels[16])
+{
+	uint16_t color0 = (uint16_t)(block[0] | (block[1] << 8));
+	uint16_t color1 = (uint16_t)(block[2] | (block[3] << 8));
+	uint32_t c0[3], c1[3];
+	Expand565(color0, c0);
+	Expand565(color1, c1);
+
+	uint32_t palette[4];
+	palette[0] = MakeTexel(c0[0], c0[1], c0[2], 255);
+	palette[1] = MakeTexel(c1[0], c1[1], c1[2], 255);
+	if (color0 > color1 || !allowTransparency)
+	{
+		palette[2] = MakeTexel((2 * c0[0] + c1[0]) / 3, (2 * c0[1] + c1[1]) / 3, (2 * c0[2] + c1[2]) / 3, 255);
+		palette[3] = MakeTexel((c0[0] + 2 * c1[0]) / 3, (c0[1] + 2 * c1[1]) / 3, (c0[2] + 2 * c1[2]) / 3, 255);
+	}
+	else
+	{
+		palette[2] = MakeTexel((c0[0] + c1[0]) / 2, (c0[1] + c1[1]) / 2, (c0[2] + c1[2]) / 2, 255);
+		palette[3] = 0;
+	}
+
+	uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+	for (uint32_t i = 0; i < 16; i++)
+		texels[i] = palette[(indices >> (2 * i)) & 3];
+}
+
+//replaces the alpha of the texels with the 4-bit values of a BC2 block
+static void DecodeExplicitAlphaBlock(const uint8_t *block, uint32_t texels[16])
+{
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		uint32_t alpha = (block[i / 2] >> (4 * (i & 1))) & 15;
+		texels[i] = (texels[i] & 0x00FFFFFF) | ((alpha * 17) << 24);
+	}
+}
+
+//replaces the alpha of the texels with the interpolated values of a BC3 block
+static void DecodeInterpolatedAlphaBlock(const uint8_t *block, uint32_t texels[16])
+{
+	uint32_t alphas[8];
+	alphas[0] = block[0];
+	alphas[1] = block[1];
+	if (alphas[0] > alphas[1])
+	{
+		for (uint32_t i = 1; i < 7; i++)
+			alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1]) / 7;
+	}
+	else
+	{
+		for (uint32_t i = 1; i < 5; i++)
+			alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1]) / 5;
+		alphas[6] = 0;
+		alphas[7] = 255;
+	}
+
+	uint64_t indices = 0;
+	for (uint32_t i = 0; i < 6; i++)
+		indices |= (uint64_t)block[2 + i] << (8 * i);
+	for (uint32_t i = 0; i < 16; i++)
+		texels[i] = (texels[i] & 0x00FFFFFF) | (alphas[(indices >> (3 * i)) & 7] << 24);
+}
+
+//decodes a whole texture to 8 bits per channel, returns false if its format or its size are not supported
+static bool DecodeTexture(const void *data, uint32_t dataSize, uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t *texels)
+{
+	const uint8_t *bytes = (const uint8_t *)data;
+	if (format == DXGI_FORMAT_R8G8B8A8_UNORM)
+	{
+		if (dataSize < width * height * 4)
+			return false;
+		memcpy(texels, bytes, width * height * 4);
+		return true;
+	}
+
+	uint32_t blockSize = format == DXGI_FORMAT_BC1_UNORM ? 8 : 16;
+	if (format != DXGI_FORMAT_BC1_UNORM && format != DXGI_FORMAT_BC2_UNORM && format != DXGI_FORMAT_BC3_UNORM)
+		return false;
+
+	uint32_t numBlocksX = (width + 3) / 4;
+	uint32_t numBlocksY = (height + 3) / 4;
+	if (dataSize < numBlocksX * numBlocksY * blockSize)
+		return false;
+
+	for (uint32_t by = 0; by < numBlocksY; by++)
+	{
+		for (uint32_t bx = 0; bx < numBlocksX; bx++)
+		{
+			const uint8_t *block = bytes + (by * numBlocksX + bx) * blockSize;
+			uint32_t blockTexels[16];
+			if (format == DXGI_FORMAT_BC1_UNORM)
+				DecodeColorBlock(block, true, blockTexels);
+			else
+			{
+				DecodeColorBlock(block + 8, false, blockTexels);
+				if (format == DXGI_FORMAT_BC2_UNORM)
+					DecodeExplicitAlphaBlock(block, blockTexels);
+				else
+					DecodeInterpolatedAlphaBlock(block, blockTexels);
+			}
+
+			//the blocks may go past the edges of the smallest textures
+			for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++)
+			{
+				for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++)
+					texels[(by * 4 + y) * width + bx * 4 + x] = blockTexels[y * 4 + x];
+			}
+		}
+	}
+	return true;
+}
+
+//bilinear filtering with wrapping, like the sampler of the descriptor heap
+static __m128 SampleTexture(const sbSoftRenderer::Texture *texture, float u, float v)
+{
+	//a missing texture reads as opaque white
+	if (!texture)
+		return _mm_set1_ps(1.0f);
+
+	float x = u * (float)texture->width - 0.5f;
+	float y = v * (float)texture->height - 0.5f;
+	float floorX = floorf(x);
+	float floorY = floorf(y);
+	__m128 fracX = _mm_set1_ps(x - floorX);
+	__m128 fracY = _mm_set1_ps(y - floorY);
+
+	//wrap the texel coordinates, even far from the texture
+	int32_t w = (int32_t)texture->width;
+	int32_t h = (int32_t)texture->height;
+	int32_t x0 = (int32_t)((int64_t)floorX % w);
+	int32_t y0 = (int32_t)((int64_t)floorY % h);
+	if (x0 < 0)
+		x0 += w;
+	if (y0 < 0)
+		y0 += h;
+	int32_t x1 = x0 + 1 == w ? 0 : x0 + 1;
+	int32_t y1 = y0 + 1 == h ? 0 : y0 + 1;
+
+	__m128 c00 = UnpackColor(texture->texels[y0 * w + x0]);
+	__m128 c10 = UnpackColor(texture->texels[y0 * w + x1]);
+	__m128 c01 = UnpackColor(texture->texels[y1 * w + x0]);
+	__m128 c11 = UnpackColor(texture->texels[y1 * w + x1]);
+	__m128 top = _mm_add_ps(c00, _mm_mul_ps(_mm_sub_ps(c10, c00), fracX));
+	__m128 bottom = _mm_add_ps(c01, _mm_mul_ps(_mm_sub_ps(c11, c01), fracX));
+	return _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fracY));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+//a vertex in clip space, before the division by w
+struct ClipVertex
+{
+	float position[4];
+	float attributes[4];
+};
+
+//the triangles are clipped against the near plane, and against a guard band around the image
+//so that the edge functions of the triangles that cross it keep their precision
+static constexpr float GUARD_BAND = 4.0f;
+static constexpr uint32_t NUM_CLIP_PLANES = 5;
+static constexpr float CLIP_PLANES[NUM_CLIP_PLANES][4] = {
+	{ 0.0f, 0.0f, 1.0f, 0.0f },
+	{ 1.0f, 0.0f, 0.0f, GUARD_BAND },
+	{ -1.0f, 0.0f, 0.0f, GUARD_BAND },
+	{ 0.0f, 1.0f, 0.0f, GUARD_BAND },
+	{ 0.0f, -1.0f, 0.0f, GUARD_BAND }
+};
+static constexpr uint32_t MAX_CLIPPED_VERTICES = 3 + NUM_CLIP_PLANES;
+
+static inline void TransformPosition(const Matrix &m, const float *position, float clip[4])
+{
+	clip[0] = position[0] * m[0].x + position[1] * m[1].x + position[2] * m[2].x + m[3].x;
+	clip[1] = position[0] * m[0].y + position[1] * m[1].y + position[2] * m[2].y + m[3].y;
+	clip[2] = position[0] * m[0].z + position[1] * m[1].z + position[2] * m[2].z + m[3].z;
+	clip[3] = position[0] * m[0].w + position[1] * m[1].w + position[2] * m[2].w + m[3].w;
+}
+
+static inline float GetPlaneDistance(const float plane[4], const float position[4])
+{
+	return plane[0] * position[0] + plane[1] * position[1] + plane[2] * position[2] + plane[3] * position[3];
+}
+
+//a bit for every plane of the view frustum the position is outside of
+static inline uint32_t GetFrustumCode(const float p[4])
+{
+	uint32_t code = 0;
+	if (p[0] < -p[3])
+		code |= 1;
+	if (p[0] > p[3])
+		code |= 2;
+	if (p[1] < -p[3])
+		code |= 4;
+	if (p[1] > p[3])
+		code |= 8;
+	if (p[2] < 0.0f)
+		code |= 16;
+	if (p[2] > p[3])
+		code |= 32;
+	return code;
+}
+
+//a bit for every clip plane the position is behind
+static inline uint32_t GetClipCode(const float p[4])
+{
+	uint32_t code = 0;
+	for (uint32_t i = 0; i < NUM_CLIP_PLANES; i++)
+	{
+		if (GetPlaneDistance(CLIP_PLANES[i], p) < 0.0f)
+			code |= 1 << i;
+	}
+	return code;
+}
+
+static inline void InterpolateVertex(const ClipVertex &a, const ClipVertex &b, float t, ClipVertex &result)
+{
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		result.position[c] = a.position[c] + (b.position[c] - a.position[c]) * t;
+		result.attributes[c] = a.attributes[c] + (b.attributes[c] - a.attributes[c]) * t;
+	}
+}
+
+//clips a convex polygon against the planes of @clipCode, returns its new number of vertices
+static uint32_t ClipPolygon(ClipVertex vertices[MAX_CLIPPED_VERTICES], uint32_t numVertices, uint32_t clipCode)
+{
+	ClipVertex scratch[MAX_CLIPPED_VERTICES];
+	ClipVertex *source = vertices;
+	ClipVertex *destination = scratch;
+	for (uint32_t i = 0; i < NUM_CLIP_PLANES && numVertices >= 3; i++)
+	{
+		if (!(clipCode & (1 << i)))
+			continue;
+
+		uint32_t numClipped = 0;
+		for (uint32_t v = 0; v < numVertices; v++)
+		{
+			const ClipVertex &a = source[v];
+			const ClipVertex &b = source[v + 1 == numVertices ? 0 : v + 1];
+			float distanceA = GetPlaneDistance(CLIP_PLANES[i], a.position);
+			float distanceB = GetPlaneDistance(CLIP_PLANES[i], b.position);
+			if (distanceA >= 0.0f)
+				destination[numClipped++] = a;
+			if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+				InterpolateVertex(a, b, distanceA / (distanceA - distanceB), destination[numClipped++]);
+		}
+
+		numVertices = numClipped;
+		ClipVertex *swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	if (source != vertices)
+		memcpy(vertices, source, numVertices * sizeof(ClipVertex));
+	return numVertices;
+}
+
+//clips a line against the planes of @clipCode, returns false if nothing is left of it
+static bool ClipLine(ClipVertex &a, ClipVertex &b, uint32_t clipCode)
+{
+	for (uint32_t i = 0; i < NUM_CLIP_PLANES; i++)
+	{
+		if (!(clipCode & (1 << i)))
+			continue;
+
+		float distanceA = GetPlaneDistance(CLIP_PLANES[i], a.position);
+		float distanceB = GetPlaneDistance(CLIP_PLANES[i], b.position);
+		if (distanceA < 0.0f && distanceB < 0.0f)
+			return false;
+		if (distanceA < 0.0f)
+			InterpolateVertex(a, b, distanceA / (distanceA - distanceB), a);
+		else if (distanceB < 0.0f)
+			InterpolateVertex(b, a, distanceB / (distanceB - distanceA), b);
+	}
+	return true;
+}
+
+//the vertices are snapped to a 16th of a pixel, like the rasterizers of the GPUs
+static inline float SnapToSubpixel(float value)
+{
+	return floorf(value * 16.0f + 0.5f) * (1.0f / 16.0f);
+}
+
+//the edge function of a triangle's edge, positive inside the triangle
+struct EdgeFunction
+{
+	float a, b, c;
+	__m128 isInclusive; //all bits set when the pixels on the edge are drawn
+};
+
+static inline void SetUpEdge(float x0, float y0, float x1, float y1, EdgeFunction &edge)
+{
+	//the pixels exactly on an edge belong to the triangle on one side of it only
+	float dx = x1 - x0;
+	float dy = y1 - y0;
+	bool isInclusive = dy < 0.0f || (dy == 0.0f && dx > 0.0f);
+	edge.isInclusive = _mm_castsi128_ps(_mm_set1_epi32(isInclusive ? -1 : 0));
+
+	//always computed from the same end, so that the triangles sharing the edge get exactly the opposite values
+	bool isSwapped = y0 > y1 || (y0 == y1 && x0 > x1);
+	if (isSwapped)
+	{
+		float swapX = x0, swapY = y0;
+		x0 = x1;
+		y0 = y1;
+		x1 = swapX;
+		y1 = swapY;
+	}
+
+	edge.a = y0 - y1;
+	edge.b = x1 - x0;
+	edge.c = (y1 - y0) * x0 - (x1 - x0) * y0;
+	if (isSwapped)
+	{
+		edge.a = -edge.a;
+		edge.b = -edge.b;
+		edge.c = -edge.c;
+	}
+}
+
+static inline __m128 EvaluateEdge(const EdgeFunction &edge, __m128 x, float rowValue, __m128 &value)
+{
+	value = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge.a), x), _mm_set1_ps(rowValue));
+	__m128 isInside = _mm_cmpgt_ps(value, _mm_setzero_ps());
+	__m128 isOnEdge = _mm_and_ps(_mm_cmpeq_ps(value, _mm_setzero_ps()), edge.isInclusive);
+	return _mm_or_ps(isInside, isOnEdge);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+//each thread gets a few runs of draws, so that one taking longer does not hold the others back
+static constexpr uint32_t CHUNKS_PER_THREAD = 4;
+
+sbSoftRenderer::sbSoftRenderer():
+	width(0),
+	height(0),
+	colors(nullptr),
+	depths(nullptr),
+	numTilesX(0),
+	numTilesY(0),
+	textures(),
+	textureSlots(),
+	fallbackTexture(),
+	pipeline(nullptr),
+	vertexBuffer(nullptr),
+	vertexStride(0),
+	indexBuffer(nullptr),
+	instanceMatrices(nullptr),
+	numInstanceMatrices(0),
+	textureDescriptors(),
+	draws(nullptr),
+	numDraws(0),
+	frameData(nullptr),
+	frameDataOffset(0),
+	isRecording(false),
+	triangles(nullptr),
+	blockNext(nullptr),
+	nextBlock(0),
+	chunks(),
+	numChunks(0),
+	chunkTileCounts(nullptr),
+	tileStart(nullptr),
+	tileNumTriangles(nullptr),
+	binnedTriangles(nullptr),
+	stats(),
+	numThreads(0),
+	stepNumber(0),
+	quit(false),
+	step(STEP_SET_UP),
+	numStepItems(0),
+	nextStepItem(0),
+	numStepItemsDone(0)
+#ifdef _WIN32
+	,
+	hWnd(nullptr),
+	presentColors(nullptr)
+#endif
+{}
+
+bool sbSoftRenderer::CreateFramebuffer(uint32_t newWidth, uint32_t newHeight)
+{
+	width = newWidth < 1 ? 1 : (newWidth > MAX_RESOLUTION_WIDTH ? MAX_RESOLUTION_WIDTH : newWidth);
+	height = newHeight < 1 ? 1 : (newHeight > MAX_RESOLUTION_HEIGHT ? MAX_RESOLUTION_HEIGHT : newHeight);
+	numTilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	numTilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+	colors = (uint32_t *)malloc(width * height * sizeof(uint32_t));
+	depths = (float *)malloc(width * height * sizeof(float));
+#ifdef _WIN32
+	presentColors = (uint32_t *)malloc(width * height * sizeof(uint32_t));
+	if (!presentColors)
+		return false;
+#endif
+	if (!colors || !depths)
+		return false;
+
+	//until the first frame is drawn
+	ClearTile(0, 0, width, height);
+	return true;
+}
+
+void sbSoftRenderer::DestroyFramebuffer()
+{
+	free(colors);
+	free(depths);
+	colors = nullptr;
+	depths = nullptr;
+#ifdef _WIN32
+	free(presentColors);
+	presentColors = nullptr;
+#endif
+	width = height = 0;
+	numTilesX = numTilesY = 0;
+}
+
+bool sbSoftRenderer::Create(uint32_t newWidth, uint32_t newHeight, uint32_t numRequestedThreads)
+{
+	draws = (Draw *)malloc(MAX_DRAWS * sizeof(Draw));
+	frameData = (uint8_t *)malloc(FRAME_DATA_SIZE);
+	triangles = (Triangle *)malloc(MAX_TRIANGLES * sizeof(Triangle));
+	blockNext = (uint32_t *)malloc(NUM_TRIANGLE_BLOCKS * sizeof(uint32_t));
+	chunkTileCounts = (uint32_t *)malloc(MAX_CHUNKS * MAX_TILES * sizeof(uint32_t));
+	tileStart = (uint32_t *)malloc(MAX_TILES * sizeof(uint32_t));
+	tileNumTriangles = (uint32_t *)malloc(MAX_TILES * sizeof(uint32_t));
+	binnedTriangles = (uint32_t *)malloc(MAX_BINNED_TRIANGLES * sizeof(uint32_t));
+	if (!draws || !frameData || !triangles || !blockNext || !chunkTileCounts || !tileStart || !tileNumTriangles || !binnedTriangles ||
+		!textureSlots.Create(MAX_NUM_TEXTURES) || !CreateFramebuffer(newWidth, newHeight))
+	{
+		Destroy();
+		return false;
+	}
+
+	{
+		uint32_t data[4 * 4];
+		for (auto &texel : data)
+			texel = 0xFFFFFFFF;
+		fallbackTexture = CreateTexture(data, sizeof(data), 4, 4, DXGI_FORMAT_R8G8B8A8_UNORM);
+		if (!fallbackTexture.resource)
+		{
+			Destroy();
+			return false;
+		}
+	}
+
+	numThreads = numRequestedThreads != 0 ? numRequestedThreads : std::thread::hardware_concurrency();
+	if (numThreads > MAX_THREADS)
+		numThreads = MAX_THREADS;
+	if (numThreads == 0)
+		numThreads = 1;
+
+	//the calling thread draws too
+	quit = false;
+	stepNumber = 0;
+	for (uint32_t i = 1; i < numThreads; i++)
+		workers[i - 1] = std::thread(&sbSoftRenderer::WorkerLoop, this);
+	return true;
+}
+
+#ifdef _WIN32
+bool sbSoftRenderer::Create(HWND newHWnd)
+{
+	RECT rect;
+	if (!GetClientRect(newHWnd, &rect) || !Create(rect.right - rect.left, rect.bottom - rect.top))
+		return false;
+
+	hWnd = newHWnd;
+	return true;
+}
+#endif
+
+void sbSoftRenderer::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	stepStarted.notify_all();
+	for (uint32_t i = 1; i < numThreads; i++)
+	{
+		if (workers[i - 1].joinable())
+			workers[i - 1].join();
+	}
+	numThreads = 0;
+
+	free(draws);
+	free(frameData);
+	free(triangles);
+	free(blockNext);
+	free(chunkTileCounts);
+	free(tileStart);
+	free(tileNumTriangles);
+	free(binnedTriangles);
+	draws = nullptr;
+	frameData = nullptr;
+	triangles = nullptr;
+	blockNext = nullptr;
+	chunkTileCounts = nullptr;
+	tileStart = nullptr;
+	tileNumTriangles = nullptr;
+	binnedTriangles = nullptr;
+	DestroyFramebuffer();
+
+	DestroyTexture(fallbackTexture);
+	//the other textures belong to whoever created them
+	for (auto &texture : textures)
+		texture = nullptr;
+	textureSlots.Destroy();
+	isRecording = false;
+#ifdef _WIN32
+	hWnd = nullptr;
+#endif
+}
+
+bool sbSoftRenderer::IsReady() const
+{
+	return colors != nullptr;
+}
+
+void sbSoftRenderer::SaveInternalState()
+{
+}
+
+void sbSoftRenderer::RestoreInternalState()
+{
+}
+
+void sbSoftRenderer::ClearAndPresentImmediately()
+{
+	if (!StartFrame())
+		return;
+
+	EndAndPresentFrame();
+}
+
+bool sbSoftRenderer::StartFrame()
+{
+	if (!IsReady())
+		return false;
+
+	isRecording = true;
+	numDraws = 0;
+	frameDataOffset = 0;
+	instanceMatrices = nullptr;
+	numInstanceMatrices = 0;
+	stats = {};
+
+	//nothing is bound when the frame starts
+	pipeline = nullptr;
+	vertexBuffer = nullptr;
+	indexBuffer = nullptr;
+	stateFilter.Invalidate();
+	stateFilter.ResetStats();
+	return true;
+}
+
+void sbSoftRenderer::EndAndPresentFrame()
+{
+	if (!isRecording)
+		return;
+	isRecording = false;
+	auto startTime = std::chrono::steady_clock::now();
+
+	//split the draws into runs of about the same number of vertices
+	uint64_t totalWork = 0;
+	for (uint32_t d = 0; d < numDraws; d++)
+		totalWork += (uint64_t)draws[d].count * draws[d].numInstances;
+
+	uint32_t numWantedChunks = numThreads * CHUNKS_PER_THREAD < MAX_CHUNKS ? numThreads * CHUNKS_PER_THREAD : MAX_CHUNKS;
+	uint64_t chunkWork = totalWork / numWantedChunks + 1;
+	uint64_t work = 0;
+	numChunks = 0;
+	for (uint32_t d = 0; d < numDraws; d++)
+	{
+		if (numChunks == 0 || (work >= chunkWork && numChunks < MAX_CHUNKS))
+		{
+			Chunk &chunk = chunks[numChunks++];
+			chunk.firstDraw = d;
+			chunk.numDraws = 0;
+			chunk.firstBlock = INVALID_BLOCK;
+			chunk.lastBlock = INVALID_BLOCK;
+			chunk.numTriangles = 0;
+			chunk.numDropped = 0;
+			work = 0;
+		}
+
+		chunks[numChunks - 1].numDraws++;
+		work += (uint64_t)draws[d].count * draws[d].numInstances;
+	}
+
+	//set up the triangles of every run, counting how many of them each tile gets
+	uint32_t numTiles = numTilesX * numTilesY;
+	nextBlock = 0;
+	for (uint32_t c = 0; c < numChunks; c++)
+		memset(chunkTileCounts + c * MAX_TILES, 0, numTiles * sizeof(uint32_t));
+	RunStep(STEP_SET_UP, numChunks);
+
+	//every tile gets the triangles of the first run, then those of the second one, and so on,
+	//so that they stay in the order they were drawn in whichever thread set them up
+	uint32_t offset = 0;
+	for (uint32_t t = 0; t < numTiles; t++)
+	{
+		tileStart[t] = offset;
+		for (uint32_t c = 0; c < numChunks; c++)
+		{
+			uint32_t count = chunkTileCounts[c * MAX_TILES + t];
+			chunkTileCounts[c * MAX_TILES + t] = offset;
+			offset += count;
+		}
+
+		uint32_t end = offset < MAX_BINNED_TRIANGLES ? offset : MAX_BINNED_TRIANGLES;
+		tileNumTriangles[t] = end > tileStart[t] ? end - tileStart[t] : 0;
+	}
+	RunStep(STEP_BIN, numChunks);
+
+	//every tile is cleared and drawn by one thread only
+	RunStep(STEP_RASTERIZE, numTiles);
+
+	stats.numDraws = numDraws;
+	for (uint32_t c = 0; c < numChunks; c++)
+	{
+		stats.numTriangles += chunks[c].numTriangles;
+		stats.numDropped += chunks[c].numDropped;
+	}
+	if (offset > MAX_BINNED_TRIANGLES)
+		stats.numDropped += offset - MAX_BINNED_TRIANGLES;
+	stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+#ifdef _WIN32
+	if (hWnd)
+	{
+		//the window expects blue first
+		for (uint32_t i = 0; i < width * height; i++)
+		{
+			uint32_t color = colors[i];
+			presentColors[i] = (color & 0xFF00FF00) | ((color >> 16) & 0xFF) | ((color & 0xFF) << 16);
+		}
+
+		BITMAPINFO bitmapInfo = {};
+		bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		bitmapInfo.bmiHeader.biWidth = width;
+		bitmapInfo.bmiHeader.biHeight = -(LONG)height; //from the top
+		bitmapInfo.bmiHeader.biPlanes = 1;
+		bitmapInfo.bmiHeader.biBitCount = 32;
+		bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+		HDC hdc = GetDC(hWnd);
+		SetDIBitsToDevice(hdc, 0, 0, width, height, 0, 0, 0, height, presentColors, &bitmapInfo, DIB_RGB_COLORS);
+		ReleaseDC(hWnd, hdc);
+	}
+#endif
+}
+
+void sbSoftRenderer::ResizeFramebuffer(uint32_t newWidth, uint32_t newHeight)
+{
+	if (newWidth == width && newHeight == height)
+		return;
+
+	DestroyFramebuffer();
+	if (!CreateFramebuffer(newWidth, newHeight))
+		DestroyFramebuffer();
+}
+
+bool sbSoftRenderer::CreatePipeline(Pipeline &) const
+{
+	return true;
+}
+
+void sbSoftRenderer::DestroyPipeline(Pipeline &) const
+{
+}
+
+void sbSoftRenderer::UsePipeline(const Pipeline &newPipeline) const
+{
+	if (stateFilter.SetPipeline(&newPipeline))
+		pipeline = &newPipeline;
+}
+
+void sbSoftRenderer::DestroyMesh(sbMesh &mesh)
+{
+	DestroyBuffer(mesh.vertexBuffer);
+	DestroyBuffer(mesh.indexBuffer);
+}
+
+void *sbSoftRenderer::AllocateFrameData(const void *data, uint32_t size) const
+{
+	//aligned for the matrices
+	uint32_t offset = (frameDataOffset + 15) & ~15u;
+	if (size > FRAME_DATA_SIZE - offset)
+		return nullptr;
+
+	memcpy(frameData + offset, data, size);
+	frameDataOffset = offset + size;
+	return frameData + offset;
+}
+
+void sbSoftRenderer::AddDraw(const uint8_t *vertices, uint32_t numVertices, uint32_t stride, const uint32_t *indices, uint32_t count,
+	uint32_t numInstances, const Matrix *drawInstanceMatrices) const
+{
+	assert(isRecording && pipeline);
+	if (!isRecording || !pipeline || count == 0 || numInstances == 0)
+		return;
+
+	if (numDraws == MAX_DRAWS || (pipeline->IsInstanced() && !drawInstanceMatrices))
+	{
+		stats.numDropped++;
+		return;
+	}
+
+	Draw &draw = draws[numDraws++];
+	draw.worldViewProjection = worldViewProjection;
+	draw.instanceMatrices = pipeline->IsInstanced() ? drawInstanceMatrices : nullptr;
+	draw.vertices = vertices;
+	draw.indices = indices;
+	draw.vertexStride = stride;
+	draw.numVertices = numVertices;
+	draw.count = count;
+	draw.numInstances = numInstances;
+	draw.textureDescriptors[0] = textureDescriptors[0];
+	draw.textureDescriptors[1] = textureDescriptors[1];
+	draw.shading = pipeline->GetShading();
+}
+
+void sbSoftRenderer::DrawBound(uint32_t numIndices, uint32_t startIndex, int32_t baseVertex, uint32_t numInstances, const Matrix *drawInstanceMatrices)
+{
+	assert(vertexBuffer && indexBuffer);
+	if (!vertexBuffer || !indexBuffer || vertexStride == 0)
+		return;
+
+	uint32_t numBufferVertices = vertexBuffer->size / vertexStride;
+	assert(startIndex + numIndices <= indexBuffer->size / sizeof(uint32_t));
+	assert(baseVertex >= 0 && (uint32_t)baseVertex <= numBufferVertices);
+	if (startIndex + numIndices > indexBuffer->size / sizeof(uint32_t) || baseVertex < 0 || (uint32_t)baseVertex > numBufferVertices)
+		return;
+
+	//the buffers stay as they are until the frame ends, only the vertices from the base one can be read
+	AddDraw(vertexBuffer->data + baseVertex * vertexStride, numBufferVertices - baseVertex, vertexStride,
+		(const uint32_t *)indexBuffer->data + startIndex, numIndices, numInstances, drawInstanceMatrices);
+}
+
+void sbSoftRenderer::DrawBoundMesh(uint32_t numIndices, uint32_t startIndex, int32_t baseVertex)
+{
+	DrawBound(numIndices, startIndex, baseVertex, 1, instanceMatrices);
+}
+
+void sbSoftRenderer::DrawBoundMeshInstances(uint32_t numIndices, uint32_t numInstances, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+{
+	assert(startInstance + numInstances <= numInstanceMatrices);
+	if (startInstance + numInstances > numInstanceMatrices)
+		return;
+
+	DrawBound(numIndices, startIndex, baseVertex, numInstances, instanceMatrices + startInstance);
+}
+
+GPUResource sbSoftRenderer::CreateBuffer(uint32_t size)
+{
+	Buffer *buffer = (Buffer *)malloc(sizeof(Buffer));
+	if (!buffer)
+		return nullptr;
+
+	buffer->data = (uint8_t *)calloc(size ? size : 1, 1);
+	buffer->size = size;
+	if (!buffer->data)
+	{
+		free(buffer);
+		return nullptr;
+	}
+	return buffer;
+}
+
+bool sbSoftRenderer::UpdateBuffer(GPUResource buffer, uint32_t offset, const void *data, uint32_t size)
+{
+	assert(buffer);
+	Buffer *destination = (Buffer *)buffer;
+	assert(offset + size <= destination->size);
+	if (offset + size > destination->size)
+		return false;
+
+	memcpy(destination->data + offset, data, size);
+	return true;
+}
+
+void sbSoftRenderer::DestroyBuffer(GPUResource &buffer)
+{
+	if (buffer)
+	{
+		free(((Buffer *)buffer)->data);
+		free(buffer);
+	}
+	buffer = nullptr;
+}
+
+void sbSoftRenderer::BindIndexBuffer(GPUResource buffer)
+{
+	if (stateFilter.SetIndexBuffer(buffer))
+		indexBuffer = (const Buffer *)buffer;
+}
+
+bool sbSoftRenderer::BindInstanceData(const void *data, uint32_t stride, uint32_t numInstances)
+{
+	//the only instance data there is are the world-view-projection matrices
+	assert(stride == sizeof(Matrix));
+	if (stride != sizeof(Matrix))
+		return false;
+
+	const Matrix *matrices = (const Matrix *)AllocateFrameData(data, stride * numInstances);
+	if (!matrices)
+		return false;
+
+	instanceMatrices = matrices;
+	numInstanceMatrices = numInstances;
+	return true;
+}
+
+void sbSoftRenderer::DrawDynamic(void *verts, uint32_t numVertices, uint32_t vertexSize, uint32_t *, uint32_t) const
+{
+	//drawn in order, without the indices, like the raster renderer does
+	const uint8_t *vertices = (const uint8_t *)AllocateFrameData(verts, numVertices * vertexSize);
+	if (!vertices)
+	{
+		stats.numDropped++;
+		return;
+	}
+
+	AddDraw(vertices, numVertices, vertexSize, nullptr, numVertices, 1, instanceMatrices);
+	stateFilter.InvalidateVertexBuffer();
+}
+
+sbTexture sbSoftRenderer::CreateTexture(const void *data, uint32_t dataSize, uint32_t width, uint32_t height, DXGI_FORMAT format)
+{
+	sbTexture result;
+	if (width == 0 || height == 0)
+		return result;
+
+	Texture *texture = (Texture *)malloc(sizeof(Texture));
+	if (!texture)
+		return result;
+
+	texture->texels = (uint32_t *)malloc(width * height * sizeof(uint32_t));
+	texture->width = width;
+	texture->height = height;
+	if (!texture->texels || !DecodeTexture(data, dataSize, width, height, format, texture->texels))
+	{
+		assert(0);
+		free(texture->texels);
+		free(texture);
+		return result;
+	}
+
+	result.descriptor = textureSlots.Allocate();
+	if (result.descriptor == DescriptorSlotAllocator::INVALID_HANDLE)
+	{
+		assert(0); //out of texture slots
+		free(texture->texels);
+		free(texture);
+		return result;
+	}
+
+	textures[DescriptorSlotAllocator::GetSlot(result.descriptor)] = texture;
+	result.resource = texture;
+	return result;
+}
+
+void sbSoftRenderer::DestroyTexture(sbTexture &texture)
+{
+	if (!texture.resource)
+		return;
+
+	if (!textureSlots.Free(texture.descriptor))
+	{
+		assert(0); //destroyed twice
+		return;
+	}
+	textures[DescriptorSlotAllocator::GetSlot(texture.descriptor)] = nullptr;
+	free(((Texture *)texture.resource)->texels);
+	free(texture.resource);
+	texture = sbTexture();
+}
+
+void sbSoftRenderer::SetWorldViewProjectionMatrix(const Matrix &m)
+{
+	if (stateFilter.SetMatrix(m))
+		worldViewProjection = m;
+}
+
+void sbSoftRenderer::UseOneTexture(uint32_t descriptor0)
+{
+	assert(textureSlots.IsValid(descriptor0)); //the texture has been destroyed
+	if (stateFilter.SetTextures(&descriptor0, 1))
+		textureDescriptors[0] = descriptor0;
+}
+
+void sbSoftRenderer::UseTwoTextures(uint32_t descriptor0, uint32_t descriptor1)
+{
+	assert(textureSlots.IsValid(descriptor0) && textureSlots.IsValid(descriptor1));
+	uint32_t descriptors[] = { descriptor0, descriptor1 };
+	if (stateFilter.SetTextures(descriptors, 2))
+	{
+		textureDescriptors[0] = descriptor0;
+		textureDescriptors[1] = descriptor1;
+	}
+}
+
+bool sbSoftRenderer::SaveImage(const char *path) const
+{
+	if (!IsReady())
+		return false;
+
+	FILE *file = fopen(path, "wb");
+	if (!file)
+		return false;
+
+	//uncompressed true-color, 32 bits per pixel, from the top left
+	uint8_t header[18] = {};
+	header[2] = 2;
+	header[12] = (uint8_t)width;
+	header[13] = (uint8_t)(width >> 8);
+	header[14] = (uint8_t)height;
+	header[15] = (uint8_t)(height >> 8);
+	header[16] = 32;
+	header[17] = 0x28;
+	bool isWritten = fwrite(header, sizeof(header), 1, file) == 1;
+
+	//one row at a time, blue first
+	uint32_t row[MAX_RESOLUTION_WIDTH];
+	for (uint32_t y = 0; y < height && isWritten; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			uint32_t color = colors[y * width + x];
+			row[x] = (color & 0xFF00FF00) | ((color >> 16) & 0xFF) | ((color & 0xFF) << 16);
+		}
+		isWritten = fwrite(row, width * sizeof(uint32_t), 1, file) == 1;
+	}
+
+	fclose(file);
+	return isWritten;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+void sbSoftRenderer::RunStep(Step newStep, uint32_t numItems)
+{
+	if (numItems == 0)
+		return;
+
+	uint32_t number;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		number = ++stepNumber;
+		step = newStep;
+		numStepItems = numItems;
+		nextStepItem = (uint64_t)number << 32;
+		numStepItemsDone = 0;
+	}
+
+	//wake the workers only if there is enough for them to do
+	if (numThreads > 1 && numItems > 1)
+		stepStarted.notify_all();
+
+	RunStepItems(number, newStep, numItems);
+
+	//the last items may still be in the hands of the workers
+	while (numStepItemsDone.load(std::memory_order_acquire) < numItems)
+		std::this_thread::yield();
+}
+
+void sbSoftRenderer::RunStepItems(uint32_t number, Step currentStep, uint32_t numItems)
+{
+	uint64_t tag = (uint64_t)number << 32;
+	uint64_t next = nextStepItem.load(std::memory_order_relaxed);
+	while ((next & 0xFFFFFFFF00000000ull) == tag && (uint32_t)next < numItems)
+	{
+		if (!nextStepItem.compare_exchange_weak(next, next + 1, std::memory_order_relaxed))
+			continue;
+
+		uint32_t item = (uint32_t)next;
+		switch (currentStep)
+		{
+		case STEP_SET_UP:
+			SetUpChunk(item);
+			break;
+		case STEP_BIN:
+			BinChunk(item);
+			break;
+		case STEP_RASTERIZE:
+			RasterizeTile(item);
+			break;
+		}
+
+		numStepItemsDone.fetch_add(1, std::memory_order_release);
+		next = nextStepItem.load(std::memory_order_relaxed);
+	}
+}
+
+void sbSoftRenderer::WorkerLoop()
+{
+	uint32_t lastStepNumber = 0;
+	while (true)
+	{
+		Step currentStep;
+		uint32_t numItems;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			stepStarted.wait(lock, [&]() { return quit || stepNumber != lastStepNumber; });
+			if (quit)
+				return;
+			lastStepNumber = stepNumber;
+			currentStep = step;
+			numItems = numStepItems;
+		}
+
+		RunStepItems(lastStepNumber, currentStep, numItems);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+sbSoftRenderer::Triangle *sbSoftRenderer::AllocateTriangle(Chunk &chunk)
+{
+	uint32_t slot = chunk.numTriangles % TRIANGLE_BLOCK_SIZE;
+	if (slot == 0)
+	{
+		uint32_t block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+		if (block >= NUM_TRIANGLE_BLOCKS)
+			return nullptr;
+
+		blockNext[block] = INVALID_BLOCK;
+		if (chunk.lastBlock == INVALID_BLOCK)
+			chunk.firstBlock = block;
+		else
+			blockNext[chunk.lastBlock] = block;
+		chunk.lastBlock = block;
+	}
+
+	chunk.numTriangles++;
+	return &triangles[chunk.lastBlock * TRIANGLE_BLOCK_SIZE + slot];
+}
+
+void sbSoftRenderer::SetUpTriangle(Chunk &chunk, uint32_t drawIndex, const ScreenVertex &v0, const ScreenVertex &v1, const ScreenVertex &v2, bool cullBackFaces)
+{
+	//the front faces are counter-clockwise on the screen, so their area is negative with y going down
+	const ScreenVertex *vertices[3] = { &v0, &v1, &v2 };
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+	if (area == 0.0f || (area > 0.0f && cullBackFaces))
+		return;
+	if (area < 0.0f)
+	{
+		vertices[1] = &v2;
+		vertices[2] = &v1;
+	}
+
+	//the pixels whose centers are inside the bounds
+	float minX = v0.x < v1.x ? (v0.x < v2.x ? v0.x : v2.x) : (v1.x < v2.x ? v1.x : v2.x);
+	float maxX = v0.x > v1.x ? (v0.x > v2.x ? v0.x : v2.x) : (v1.x > v2.x ? v1.x : v2.x);
+	float minY = v0.y < v1.y ? (v0.y < v2.y ? v0.y : v2.y) : (v1.y < v2.y ? v1.y : v2.y);
+	float maxY = v0.y > v1.y ? (v0.y > v2.y ? v0.y : v2.y) : (v1.y > v2.y ? v1.y : v2.y);
+	int32_t firstX = (int32_t)ceilf(minX - 0.5f);
+	int32_t lastX = (int32_t)floorf(maxX - 0.5f);
+	int32_t firstY = (int32_t)ceilf(minY - 0.5f);
+	int32_t lastY = (int32_t)floorf(maxY - 0.5f);
+	firstX = firstX < 0 ? 0 : firstX;
+	firstY = firstY < 0 ? 0 : firstY;
+	lastX = lastX >= (int32_t)width ? (int32_t)width - 1 : lastX;
+	lastY = lastY >= (int32_t)height ? (int32_t)height - 1 : lastY;
+	if (firstX > lastX || firstY > lastY)
+		return;
+
+	Triangle *triangle = AllocateTriangle(chunk);
+	if (!triangle)
+	{
+		chunk.numDropped++;
+		return;
+	}
+
+	for (uint32_t v = 0; v < 3; v++)
+	{
+		triangle->x[v] = vertices[v]->x;
+		triangle->y[v] = vertices[v]->y;
+		triangle->z[v] = vertices[v]->z;
+		triangle->invW[v] = vertices[v]->invW;
+		for (uint32_t c = 0; c < 4; c++)
+			triangle->attributes[v][c] = vertices[v]->attributes[c];
+	}
+	triangle->minX = (int16_t)firstX;
+	triangle->minY = (int16_t)firstY;
+	triangle->maxX = (int16_t)lastX;
+	triangle->maxY = (int16_t)lastY;
+	triangle->drawIndex = drawIndex;
+
+	uint32_t *tileCounts = chunkTileCounts + (&chunk - chunks) * MAX_TILES;
+	for (int32_t ty = firstY / TILE_SIZE; ty <= lastY / (int32_t)TILE_SIZE; ty++)
+	{
+		for (int32_t tx = firstX / TILE_SIZE; tx <= lastX / (int32_t)TILE_SIZE; tx++)
+			tileCounts[ty * numTilesX + tx]++;
+	}
+}
+
+void sbSoftRenderer::SetUpLine(Chunk &chunk, uint32_t drawIndex, const ScreenVertex &v0, const ScreenVertex &v1)
+{
+	//drawn as a thin quad, whose two triangles share an edge so that no pixel is drawn twice
+	float dx = v1.x - v0.x;
+	float dy = v1.y - v0.y;
+	float length = sqrtf(dx * dx + dy * dy);
+	if (length == 0.0f)
+		return;
+
+	float offsetX = -dy / length * (0.5f * LINE_WIDTH);
+	float offsetY = dx / length * (0.5f * LINE_WIDTH);
+	ScreenVertex corners[4] = { v0, v0, v1, v1 };
+	corners[0].x += offsetX;
+	corners[0].y += offsetY;
+	corners[1].x -= offsetX;
+	corners[1].y -= offsetY;
+	corners[2].x -= offsetX;
+	corners[2].y -= offsetY;
+	corners[3].x += offsetX;
+	corners[3].y += offsetY;
+	SetUpTriangle(chunk, drawIndex, corners[0], corners[1], corners[2], false);
+	SetUpTriangle(chunk, drawIndex, corners[0], corners[2], corners[3], false);
+}
+
+void sbSoftRenderer::SetUpChunk(uint32_t chunkIndex)
+{
+	Chunk &chunk = chunks[chunkIndex];
+
+	auto project = [&](const ClipVertex &clip, ScreenVertex &screen)
+	{
+		float invW = 1.0f / clip.position[3];
+		screen.x = SnapToSubpixel((clip.position[0] * invW * 0.5f + 0.5f) * (float)width);
+		screen.y = SnapToSubpixel((0.5f - clip.position[1] * invW * 0.5f) * (float)height);
+		screen.z = clip.position[2] * invW;
+		screen.invW = invW;
+		for (uint32_t c = 0; c < 4; c++)
+			screen.attributes[c] = clip.attributes[c] * invW;
+	};
+
+	for (uint32_t d = chunk.firstDraw; d < chunk.firstDraw + chunk.numDraws; d++)
+	{
+		const Draw &draw = draws[d];
+
+		//the colored pipeline draws lists of lines, the others lists of triangles
+		uint32_t numPrimitiveVertices = draw.shading == SHADING_COLORED ? 2 : 3;
+		for (uint32_t instance = 0; instance < draw.numInstances; instance++)
+		{
+			const Matrix &m = draw.instanceMatrices ? draw.instanceMatrices[instance] : draw.worldViewProjection;
+			for (uint32_t i = 0; i + numPrimitiveVertices <= draw.count; i += numPrimitiveVertices)
+			{
+				ClipVertex vertices[MAX_CLIPPED_VERTICES];
+				uint32_t frustumCodes = 0xFFFFFFFF;
+				uint32_t clipCodes = 0;
+				bool isValid = true;
+				for (uint32_t v = 0; v < numPrimitiveVertices && isValid; v++)
+				{
+					uint32_t index = draw.indices ? draw.indices[i + v] : i + v;
+					isValid = index < draw.numVertices;
+					if (!isValid)
+						break;
+
+					//the attributes follow the position, as laid out by the pipelines' input layouts
+					const float *vertex = (const float *)(draw.vertices + index * draw.vertexStride);
+					ClipVertex &clip = vertices[v];
+					TransformPosition(m, vertex, clip.position);
+					switch (draw.shading)
+					{
+					case SHADING_COLORED:
+						clip.attributes[0] = vertex[3];
+						clip.attributes[1] = vertex[4];
+						clip.attributes[2] = vertex[5];
+						clip.attributes[3] = 1.0f;
+						break;
+					case SHADING_LIGHTMAPPED:
+						clip.attributes[0] = vertex[3];
+						clip.attributes[1] = vertex[4];
+						clip.attributes[2] = vertex[5];
+						clip.attributes[3] = vertex[6];
+						break;
+					case SHADING_PHONG:
+						clip.attributes[0] = vertex[6];
+						clip.attributes[1] = vertex[7];
+						clip.attributes[2] = 0.0f;
+						clip.attributes[3] = 0.0f;
+						break;
+					}
+
+					frustumCodes &= GetFrustumCode(clip.position);
+					clipCodes |= GetClipCode(clip.position);
+				}
+
+				//all outside of the same plane
+				if (!isValid || frustumCodes != 0)
+					continue;
+
+				ScreenVertex screenVertices[MAX_CLIPPED_VERTICES];
+				if (numPrimitiveVertices == 2)
+				{
+					if (clipCodes && !ClipLine(vertices[0], vertices[1], clipCodes))
+						continue;
+
+					project(vertices[0], screenVertices[0]);
+					project(vertices[1], screenVertices[1]);
+					SetUpLine(chunk, d, screenVertices[0], screenVertices[1]);
+					continue;
+				}
+
+				uint32_t numVertices = clipCodes ? ClipPolygon(vertices, 3, clipCodes) : 3;
+				for (uint32_t v = 0; v < numVertices; v++)
+					project(vertices[v], screenVertices[v]);
+				for (uint32_t v = 2; v < numVertices; v++)
+					SetUpTriangle(chunk, d, screenVertices[0], screenVertices[v - 1], screenVertices[v], true);
+			}
+		}
+	}
+}
+
+void sbSoftRenderer::BinChunk(uint32_t chunkIndex)
+{
+	//the prefix pass left where the chunk's triangles start in every tile
+	const Chunk &chunk = chunks[chunkIndex];
+	uint32_t *tileOffsets = chunkTileCounts + chunkIndex * MAX_TILES;
+	uint32_t block = chunk.firstBlock;
+	for (uint32_t i = 0; i < chunk.numTriangles; i++)
+	{
+		if (i != 0 && i % TRIANGLE_BLOCK_SIZE == 0)
+			block = blockNext[block];
+
+		uint32_t triangleIndex = block * TRIANGLE_BLOCK_SIZE + i % TRIANGLE_BLOCK_SIZE;
+		const Triangle &triangle = triangles[triangleIndex];
+		for (int32_t ty = triangle.minY / TILE_SIZE; ty <= triangle.maxY / (int32_t)TILE_SIZE; ty++)
+		{
+			for (int32_t tx = triangle.minX / TILE_SIZE; tx <= triangle.maxX / (int32_t)TILE_SIZE; tx++)
+			{
+				uint32_t position = tileOffsets[ty * numTilesX + tx]++;
+				if (position < MAX_BINNED_TRIANGLES)
+					binnedTriangles[position] = triangleIndex;
+			}
+		}
+	}
+}
+
+void sbSoftRenderer::ClearTile(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+	uint32_t clearColor = PackColor(CLEAR_COLOR);
+	for (uint32_t y = y0; y < y1; y++)
+	{
+		for (uint32_t x = x0; x < x1; x++)
+		{
+			colors[y * width + x] = clearColor;
+			depths[y * width + x] = 1.0f;
+		}
+	}
+}
+
+void sbSoftRenderer::RasterizeTile(uint32_t tileIndex)
+{
+	int32_t tileX0 = (int32_t)((tileIndex % numTilesX) * TILE_SIZE);
+	int32_t tileY0 = (int32_t)((tileIndex / numTilesX) * TILE_SIZE);
+	int32_t tileX1 = tileX0 + (int32_t)TILE_SIZE < (int32_t)width ? tileX0 + (int32_t)TILE_SIZE : (int32_t)width;
+	int32_t tileY1 = tileY0 + (int32_t)TILE_SIZE < (int32_t)height ? tileY0 + (int32_t)TILE_SIZE : (int32_t)height;
+	ClearTile(tileX0, tileY0, tileX1, tileY1);
+
+	const __m128 laneCenters = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const uint32_t *tileTriangles = binnedTriangles + tileStart[tileIndex];
+	for (uint32_t t = 0; t < tileNumTriangles[tileIndex]; t++)
+	{
+		const Triangle &triangle = triangles[tileTriangles[t]];
+		const Draw &draw = draws[triangle.drawIndex];
+		int32_t minX = triangle.minX > tileX0 ? triangle.minX : tileX0;
+		int32_t maxX = triangle.maxX < tileX1 - 1 ? triangle.maxX : tileX1 - 1;
+		int32_t minY = triangle.minY > tileY0 ? triangle.minY : tileY0;
+		int32_t maxY = triangle.maxY < tileY1 - 1 ? triangle.maxY : tileY1 - 1;
+
+		//w0 is the weight of the first vertex, and so on
+		EdgeFunction edges[3];
+		SetUpEdge(triangle.x[1], triangle.y[1], triangle.x[2], triangle.y[2], edges[0]);
+		SetUpEdge(triangle.x[2], triangle.y[2], triangle.x[0], triangle.y[0], edges[1]);
+		SetUpEdge(triangle.x[0], triangle.y[0], triangle.x[1], triangle.y[1], edges[2]);
+		float area = edges[2].a * triangle.x[2] + edges[2].b * triangle.y[2] + edges[2].c;
+		if (area <= 0.0f)
+			continue;
+
+		__m128 invArea = _mm_set1_ps(1.0f / area);
+		__m128 z0 = _mm_set1_ps(triangle.z[0]);
+		__m128 dz1 = _mm_set1_ps(triangle.z[1] - triangle.z[0]);
+		__m128 dz2 = _mm_set1_ps(triangle.z[2] - triangle.z[0]);
+		for (int32_t y = minY; y <= maxY; y++)
+		{
+			float centerY = (float)y + 0.5f;
+			float rowValues[3];
+			for (uint32_t e = 0; e < 3; e++)
+				rowValues[e] = edges[e].b * centerY + edges[e].c;
+
+			for (int32_t x = minX; x <= maxX; x += 4)
+			{
+				__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), laneCenters);
+				__m128 w0, w1, w2;
+				__m128 isInside = EvaluateEdge(edges[0], centerX, rowValues[0], w0);
+				isInside = _mm_and_ps(isInside, EvaluateEdge(edges[1], centerX, rowValues[1], w1));
+				isInside = _mm_and_ps(isInside, EvaluateEdge(edges[2], centerX, rowValues[2], w2));
+
+				uint32_t numLanes = maxX - x + 1 < 4 ? maxX - x + 1 : 4;
+				uint32_t mask = _mm_movemask_ps(isInside) & ((1 << numLanes) - 1);
+				if (!mask)
+					continue;
+
+				__m128 b1 = _mm_mul_ps(w1, invArea);
+				__m128 b2 = _mm_mul_ps(w2, invArea);
+				__m128 z = _mm_add_ps(z0, _mm_add_ps(_mm_mul_ps(b1, dz1), _mm_mul_ps(b2, dz2)));
+
+				//the depths past the tile belong to another thread
+				float *depthRow = depths + y * width + x;
+				__m128 depth;
+				if (x + 4 <= tileX1)
+					depth = _mm_loadu_ps(depthRow);
+				else
+				{
+					float rowDepths[4] = {};
+					for (uint32_t lane = 0; lane < numLanes; lane++)
+						rowDepths[lane] = depthRow[lane];
+					depth = _mm_loadu_ps(rowDepths);
+				}
+				mask &= _mm_movemask_ps(_mm_cmplt_ps(z, depth));
+				if (!mask)
+					continue;
+
+				float laneB1[4], laneB2[4], laneZ[4];
+				_mm_storeu_ps(laneB1, b1);
+				_mm_storeu_ps(laneB2, b2);
+				_mm_storeu_ps(laneZ, z);
+				uint32_t *colorRow = colors + y * width + x;
+				for (uint32_t lane = 0; lane < 4; lane++)
+				{
+					if (!(mask & (1 << lane)))
+						continue;
+
+					depthRow[lane] = laneZ[lane];
+					ShadePixel(draw, triangle, laneB1[lane], laneB2[lane], colorRow[lane]);
+				}
+			}
+		}
+	}
+}
+
+const sbSoftRenderer::Texture *sbSoftRenderer::GetTexture(uint32_t descriptor) const
+{
+	//a stale descriptor reads as no texture
+	return textureSlots.IsValid(descriptor) ? textures[DescriptorSlotAllocator::GetSlot(descriptor)] : nullptr;
+}
+
+void sbSoftRenderer::ShadePixel(const Draw &draw, const Triangle &triangle, float b1, float b2, uint32_t &color) const
+{
+	//perspective-correct attributes
+	float invW = triangle.invW[0] + b1 * (triangle.invW[1] - triangle.invW[0]) + b2 * (triangle.invW[2] - triangle.invW[0]);
+	float w = 1.0f / invW;
+	float attributes[4];
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		float a0 = triangle.attributes[0][c];
+		attributes[c] = (a0 + b1 * (triangle.attributes[1][c] - a0) + b2 * (triangle.attributes[2][c] - a0)) * w;
+	}
+
+	__m128 source;
+	switch (draw.shading)
+	{
+	case SHADING_COLORED:
+		source = _mm_setr_ps(attributes[0], attributes[1], attributes[2], 1.0f);
+		break;
+	case SHADING_LIGHTMAPPED:
+	{
+		//the lightmap leaves the alpha as it is
+		__m128 diffuse = SampleTexture(GetTexture(draw.textureDescriptors[0]), attributes[0], attributes[1]);
+		__m128 lightmap = SampleTexture(GetTexture(draw.textureDescriptors[1]), attributes[2], attributes[3]);
+		source = _mm_mul_ps(diffuse, _mm_blend_ps(lightmap, _mm_set1_ps(1.0f), 8));
+		break;
+	}
+	default:
+		source = SampleTexture(GetTexture(draw.textureDescriptors[0]), attributes[0], attributes[1]);
+		break;
+	}
+
+	//alpha blending on the colors, the Phong pipeline blends the alpha too while the others write it as it is
+	__m128 alpha = _mm_min_ps(_mm_max_ps(_mm_shuffle_ps(source, source, _MM_SHUFFLE(3, 3, 3, 3)), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	__m128 destination = UnpackColor(color);
+	__m128 blended = _mm_add_ps(destination, _mm_mul_ps(_mm_sub_ps(source, destination), alpha));
+	if (draw.shading == SHADING_PHONG)
+		blended = _mm_blend_ps(blended, _mm_add_ps(alpha, _mm_mul_ps(destination, _mm_sub_ps(_mm_set1_ps(1.0f), alpha))), 8);
+	else
+		blended = _mm_blend_ps(blended, source, 8);
+	color = PackColor(blended);
+}
@@ -0,0 +1,418 @@
+#pragma once
+#include "base/DescriptorSlotAllocator.hh"
+#include "sbStateFilter.hh"
+#include "matrix.inl"
+#include <assert.h>
+#include <stdint.h>
+#include <atomic> //std::atomic
+#include <condition_variable> //std::condition_variable
+#include <mutex> //std::mutex
+#include <thread> //std::thread
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <stdio.h> //fprintf
+#endif
+
+#ifndef NDEBUG
+#ifdef _WIN32
+#define DebugPrint(x) {OutputDebugString(x); DebugBreak();}
+#else
+#define DebugPrint(x) {fprintf(stderr, "%s\n", x);}
+#endif
+#else
+#define DebugPrint(x)
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+//the texture formats the software renderer can read, numbered like their DXGI counterparts
+#ifndef __dxgiformat_h__
+enum DXGI_FORMAT
+{
+	DXGI_FORMAT_UNKNOWN = 0,
+	DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+	DXGI_FORMAT_BC1_UNORM = 71,
+	DXGI_FORMAT_BC2_UNORM = 74,
+	DXGI_FORMAT_BC3_UNORM = 77
+};
+#endif
+
+//how the pixels of a pipeline are shaded, following the shaders of the Direct3D 12 pipelines
+enum sbShading
+{
+	SHADING_COLORED, //lines of colored vertices
+	SHADING_LIGHTMAPPED, //a diffuse texture modulated by a lightmap
+	SHADING_PHONG //a diffuse texture
+};
+
+//describes a graphics shading pipeline, drawn with alpha blending, back-face culling and a less-than depth test
+class Pipeline
+{
+protected:
+	sbShading shading;
+	bool isInstanced; //reads the world-view-projection matrix of every instance from the instance data
+
+public:
+	Pipeline(sbShading shading, bool isInstanced = false):
+		shading(shading), isInstanced(isInstanced)
+	{}
+
+	sbShading GetShading() const
+	{
+		return shading;
+	}
+
+	bool IsInstanced() const
+	{
+		return isInstanced;
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+//this is the device-specific resource (used for textures and vertex/index buffers)
+typedef void* GPUResource; //actually sbSoftRenderer::Buffer* or sbSoftRenderer::Texture* for the software renderer
+
+//describes a mesh residing in the renderer's memory
+struct sbMesh
+{
+	GPUResource vertexBuffer;
+	GPUResource indexBuffer;
+	uint32_t numIndices;
+
+	sbMesh():
+		vertexBuffer(nullptr), indexBuffer(nullptr), numIndices(0) {}
+	sbMesh(GPUResource vertexBuffer, GPUResource indexBuffer, uint32_t numIndices):
+		vertexBuffer(vertexBuffer), indexBuffer(indexBuffer), numIndices(numIndices) {}
+};
+
+//describes a texture residing in the renderer's memory, and its slot in the bindless textures
+struct sbTexture
+{
+	GPUResource resource;
+	uint32_t descriptor; //a handle of the descriptor slot allocator, telling stale textures apart
+
+	sbTexture():
+		resource(nullptr), descriptor(DescriptorSlotAllocator::INVALID_HANDLE) {}
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// <summary>
+/// Draws on the CPU what the raster renderer draws with Direct3D 12, into an image that stays in memory,
+/// so that rendering can be run and timed on machines without a GPU, and its frames saved as reference images.
+/// The draws of a frame are only recorded, then drawn when the frame ends, on every core:
+/// the triangles are transformed, clipped against the near plane and set up draw by draw, then binned into screen tiles,
+/// and every tile is rasterized by a single thread, 4 pixels at a time, in the order the draws were made.
+/// The result does not depend on the number of threads.
+/// </summary>
+class sbSoftRenderer
+{
+public:
+	//resolution limits, like the swap chain's
+	static constexpr uint32_t MAX_RESOLUTION_WIDTH = 3840;
+	static constexpr uint32_t MAX_RESOLUTION_HEIGHT = 2160;
+
+	static constexpr uint32_t TILE_SIZE = 64;
+	static constexpr uint32_t MAX_TILES = ((MAX_RESOLUTION_WIDTH + TILE_SIZE - 1) / TILE_SIZE) * ((MAX_RESOLUTION_HEIGHT + TILE_SIZE - 1) / TILE_SIZE);
+
+	static constexpr uint32_t MAX_NUM_TEXTURES = 4096; //like the descriptor heap
+	static constexpr uint32_t MAX_DRAWS = 65536;
+	static constexpr uint32_t MAX_TRIANGLES = 1 << 18; //the triangles left after culling, in a frame
+	static constexpr uint32_t MAX_BINNED_TRIANGLES = 1 << 22; //as many triangles as tiles each covers
+	static constexpr uint32_t FRAME_DATA_SIZE = 16 * 1024 * 1024; //the dynamic vertices and instance data of a frame
+
+	static constexpr uint32_t MAX_THREADS = 16; //the calling thread included
+	static constexpr uint32_t MAX_CHUNKS = 4 * MAX_THREADS; //the draws are set up in that many runs
+
+	struct Buffer
+	{
+		uint8_t *data;
+		uint32_t size;
+	};
+
+	//always decoded to 8 bits per channel
+	struct Texture
+	{
+		uint32_t *texels;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	struct Stats
+	{
+		uint32_t numDraws;
+		uint32_t numTriangles; //set up and binned, after culling and clipping
+		uint32_t numDropped; //draws and triangles that did not fit
+		float milliseconds; //spent drawing the frame when it ended
+	};
+
+private:
+	//a draw, along with the states it was made with
+	struct Draw
+	{
+		Matrix worldViewProjection;
+		const Matrix *instanceMatrices; //for the instanced pipelines
+		const uint8_t *vertices;
+		const uint32_t *indices; //null to draw the vertices in order
+		uint32_t vertexStride;
+		uint32_t numVertices; //that can be read
+		uint32_t count; //of indices, or of vertices
+		uint32_t numInstances;
+		uint32_t textureDescriptors[2];
+		sbShading shading;
+	};
+
+	//a vertex projected on the image, its attributes divided by w
+	struct ScreenVertex
+	{
+		float x, y, z, invW;
+		float attributes[4];
+	};
+
+	//a triangle ready to be rasterized, its attributes divided by w
+	struct Triangle
+	{
+		float x[3], y[3]; //in pixels
+		float z[3];
+		float invW[3];
+		float attributes[3][4];
+		int16_t minX, minY, maxX, maxY;
+		uint32_t drawIndex;
+	};
+
+	//the triangles are allocated in blocks, a chunk of draws keeping a list of its own
+	static constexpr uint32_t TRIANGLE_BLOCK_SIZE = 256;
+	static constexpr uint32_t NUM_TRIANGLE_BLOCKS = MAX_TRIANGLES / TRIANGLE_BLOCK_SIZE;
+	static constexpr uint32_t INVALID_BLOCK = 0xFFFFFFFF;
+
+	struct Chunk
+	{
+		uint32_t firstDraw;
+		uint32_t numDraws;
+		uint32_t firstBlock;
+		uint32_t lastBlock;
+		uint32_t numTriangles;
+		uint32_t numDropped;
+	};
+
+	//the steps of a frame, each run on every thread
+	enum Step
+	{
+		STEP_SET_UP,
+		STEP_BIN,
+		STEP_RASTERIZE
+	};
+
+	//the image
+	uint32_t width;
+	uint32_t height;
+	uint32_t *colors;
+	float *depths;
+	uint32_t numTilesX;
+	uint32_t numTilesY;
+
+	//bindless textures, like the descriptor heap's
+	Texture *textures[MAX_NUM_TEXTURES];
+	DescriptorSlotAllocator textureSlots;
+	sbTexture fallbackTexture; //opaque white, like the raster renderer's
+
+	//the states, as set by the last calls, mutable as drawing is const
+	mutable const Pipeline *pipeline;
+	const Buffer *vertexBuffer;
+	uint32_t vertexStride;
+	const Buffer *indexBuffer;
+	const Matrix *instanceMatrices;
+	uint32_t numInstanceMatrices;
+	Matrix worldViewProjection;
+	uint32_t textureDescriptors[2];
+	mutable sbStateFilter stateFilter;
+
+	//the frame being recorded
+	Draw *draws;
+	mutable uint32_t numDraws;
+	uint8_t *frameData;
+	mutable uint32_t frameDataOffset;
+	bool isRecording;
+
+	Triangle *triangles;
+	uint32_t *blockNext;
+	std::atomic<uint32_t> nextBlock;
+	Chunk chunks[MAX_CHUNKS];
+	uint32_t numChunks;
+	uint32_t *chunkTileCounts; //MAX_CHUNKS by MAX_TILES, then where every chunk's triangles start in the tiles' lists
+	uint32_t *tileStart;
+	uint32_t *tileNumTriangles;
+	uint32_t *binnedTriangles;
+
+	mutable Stats stats;
+
+	//worker threads, waiting for the next step of a frame
+	std::thread workers[MAX_THREADS - 1];
+	uint32_t numThreads;
+	std::mutex mutex;
+	std::condition_variable stepStarted;
+	uint32_t stepNumber;
+	bool quit;
+	Step step;
+	uint32_t numStepItems;
+	std::atomic<uint64_t> nextStepItem; //the step number in the upper bits, so that a late worker cannot take the items of the next step
+	std::atomic<uint32_t> numStepItemsDone;
+
+#ifdef _WIN32
+	HWND hWnd;
+	uint32_t *presentColors; //in the order the window expects
+#endif
+
+	void *AllocateFrameData(const void *data, uint32_t size) const;
+	void AddDraw(const uint8_t *vertices, uint32_t numVertices, uint32_t stride, const uint32_t *indices, uint32_t count,
+		uint32_t numInstances, const Matrix *instanceMatrices) const;
+	void DrawBound(uint32_t numIndices, uint32_t startIndex, int32_t baseVertex, uint32_t numInstances, const Matrix *instanceMatrices);
+
+	Triangle *AllocateTriangle(Chunk &chunk);
+	void SetUpTriangle(Chunk &chunk, uint32_t drawIndex, const ScreenVertex &v0, const ScreenVertex &v1, const ScreenVertex &v2, bool cullBackFaces);
+	void SetUpLine(Chunk &chunk, uint32_t drawIndex, const ScreenVertex &v0, const ScreenVertex &v1);
+	void SetUpChunk(uint32_t chunkIndex);
+	void BinChunk(uint32_t chunkIndex);
+	void RasterizeTile(uint32_t tileIndex);
+	const Texture *GetTexture(uint32_t descriptor) const;
+	void ShadePixel(const Draw &draw, const Triangle &triangle, float b1, float b2, uint32_t &color) const;
+	void ClearTile(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+
+	void RunStep(Step newStep, uint32_t numItems);
+	void RunStepItems(uint32_t number, Step currentStep, uint32_t numItems);
+	void WorkerLoop();
+
+	bool CreateFramebuffer(uint32_t newWidth, uint32_t newHeight);
+	void DestroyFramebuffer();
+
+public:
+	sbSoftRenderer();
+
+	/// <summary>
+	/// Creates a renderer drawing into an image of its own.
+	/// </summary>
+	/// <param name="numRequestedThreads">how many threads draw the frames, the calling thread included, 0 for one per core</param>
+	bool Create(uint32_t width, uint32_t height, uint32_t numRequestedThreads = 0);
+#ifdef _WIN32
+	//creates a renderer presenting its frames in a window
+	bool Create(HWND hWnd);
+#endif
+	void Destroy();
+
+	bool IsReady() const;
+
+	//nothing is kept on a heap of its own, the buffers and the textures are freed when destroyed
+	void SaveInternalState();
+	void RestoreInternalState();
+
+	//frame
+	void ClearAndPresentImmediately();
+	bool StartFrame();
+	void EndAndPresentFrame();
+
+	void ResizeFramebuffer(uint32_t width, uint32_t height);
+
+	//pipelines
+	bool CreatePipeline(Pipeline &pipeline) const;
+	void DestroyPipeline(Pipeline &pipeline) const;
+	void UsePipeline(const Pipeline &pipeline) const;
+
+	//meshes
+	template <typename VertexFormat>
+	sbMesh CreateMesh(const VertexFormat *verts, uint32_t numVerts, const uint32_t *indices, uint32_t numIndices)
+	{
+		GPUResource vertexBuffer = CreateBuffer(numVerts * sizeof(VertexFormat));
+		GPUResource indexBuffer = CreateBuffer(numIndices * sizeof(uint32_t));
+		if (!vertexBuffer || !indexBuffer)
+		{
+			assert(0);
+			DestroyBuffer(vertexBuffer);
+			DestroyBuffer(indexBuffer);
+			return sbMesh();
+		}
+
+		UpdateBuffer(vertexBuffer, 0, verts, numVerts * sizeof(VertexFormat));
+		UpdateBuffer(indexBuffer, 0, indices, numIndices * sizeof(uint32_t));
+		return sbMesh(vertexBuffer, indexBuffer, numIndices);
+	}
+	void DestroyMesh(sbMesh &mesh);
+
+	template <typename VertexFormat>
+	void BindMesh(const sbMesh &mesh)
+	{
+		BindVertexBuffer<VertexFormat>(mesh.vertexBuffer);
+		BindIndexBuffer(mesh.indexBuffer);
+	}
+	void DrawBoundMesh(uint32_t numIndices, uint32_t startIndex = 0, int32_t baseVertex = 0);
+	void DrawBoundMeshInstances(uint32_t numIndices, uint32_t numInstances, uint32_t startIndex = 0, int32_t baseVertex = 0, uint32_t startInstance = 0);
+
+	//buffers, so that many meshes can share the same vertex and index buffers
+	GPUResource CreateBuffer(uint32_t size);
+	bool UpdateBuffer(GPUResource buffer, uint32_t offset, const void *data, uint32_t size);
+	void DestroyBuffer(GPUResource &buffer);
+
+	template <typename VertexFormat>
+	void BindVertexBuffer(GPUResource buffer)
+	{
+		if (!stateFilter.SetVertexBuffer(buffer, sizeof(VertexFormat)))
+			return;
+
+		vertexBuffer = (const Buffer *)buffer;
+		vertexStride = sizeof(VertexFormat);
+	}
+	void BindIndexBuffer(GPUResource buffer);
+
+	//copies per-instance data for this frame only
+	bool BindInstanceData(const void *data, uint32_t stride, uint32_t numInstances);
+
+	//draws vertices directly, they are copied
+	void DrawDynamic(void *verts, uint32_t numVertices, uint32_t vertexSize, uint32_t *indices, uint32_t numIndices) const;
+
+	//textures
+	sbTexture CreateTexture(const void *data, uint32_t dataSize, uint32_t width, uint32_t height, DXGI_FORMAT format);
+	void DestroyTexture(sbTexture &texture);
+	//opaque white, for what has no texture of its own
+	const sbTexture &GetFallbackTexture() const
+	{
+		return fallbackTexture;
+	}
+
+	//transformation
+	void SetWorldViewProjectionMatrix(const Matrix &m);
+	void UseOneTexture(uint32_t descriptor0);
+	void UseTwoTextures(uint32_t descriptor0, uint32_t descriptor1);
+
+	//how many state calls were issued and skipped since the frame started
+	const sbStateFilter::Stats &GetStateStats() const
+	{
+		return stateFilter.GetStats();
+	}
+
+	//the last frame, as R8G8B8A8 pixels, row after row from the top
+	const uint32_t *GetPixels() const
+	{
+		return colors;
+	}
+
+	uint32_t GetWidth() const
+	{
+		return width;
+	}
+
+	uint32_t GetHeight() const
+	{
+		return height;
+	}
+
+	//writes the last frame as an uncompressed TGA image
+	bool SaveImage(const char *path) const;
+
+	const Stats &GetStats() const
+	{
+		return stats;
+	}
+};
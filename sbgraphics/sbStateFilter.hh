@@ -0,0 +1,151 @@
+#pragma once
+#include "matrix.inl"
+#include <assert.h>
+#include <stdint.h>
+#include <string.h> //memcmp
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+//remembers the state last set on a command list, so that setting the same state again can be skipped
+//it does not know about the command list itself, the renderer asks it before every call
+class sbStateFilter
+{
+public:
+	enum StateType
+	{
+		STATE_PIPELINE,
+		STATE_VERTEX_BUFFER,
+		STATE_INDEX_BUFFER,
+		STATE_TEXTURES,
+		STATE_MATRIX,
+		NUM_STATE_TYPES
+	};
+
+	struct Stats
+	{
+		uint32_t numIssued[NUM_STATE_TYPES];
+		uint32_t numSkipped[NUM_STATE_TYPES];
+
+		uint32_t GetTotalIssued() const
+		{
+			uint32_t total = 0;
+			for (uint32_t count : numIssued)
+				total += count;
+			return total;
+		}
+
+		uint32_t GetTotalSkipped() const
+		{
+			uint32_t total = 0;
+			for (uint32_t count : numSkipped)
+				total += count;
+			return total;
+		}
+	};
+
+private:
+	static constexpr uint32_t MAX_TEXTURES = 2;
+
+	const void *pipeline;
+	const void *vertexBuffer;
+	uint32_t vertexStride;
+	const void *indexBuffer;
+	uint32_t numValidTextures; //the first ones are known
+	uint32_t textureIndices[MAX_TEXTURES];
+	bool isMatrixValid;
+	Matrix matrix;
+	Stats stats;
+
+	bool Filter(StateType type, bool isSame)
+	{
+		if (isSame)
+		{
+			stats.numSkipped[type]++;
+			return false;
+		}
+
+		stats.numIssued[type]++;
+		return true;
+	}
+
+public:
+	sbStateFilter()
+	{
+		Invalidate();
+		ResetStats();
+	}
+
+	//forgets everything, to be called whenever the command list is reset or its root signature is set
+	void Invalidate()
+	{
+		pipeline = nullptr;
+		InvalidateVertexBuffer();
+		indexBuffer = nullptr;
+		numValidTextures = 0;
+		isMatrixValid = false;
+	}
+
+	//to be called when the vertex buffer is set without asking, like when drawing dynamic vertices
+	void InvalidateVertexBuffer()
+	{
+		vertexBuffer = nullptr;
+		vertexStride = 0;
+	}
+
+	void ResetStats()
+	{
+		stats = {};
+	}
+
+	//the following return true when the call has to be issued
+
+	bool SetPipeline(const void *newPipeline)
+	{
+		bool isSame = pipeline == newPipeline;
+		pipeline = newPipeline;
+		return Filter(STATE_PIPELINE, isSame);
+	}
+
+	bool SetVertexBuffer(const void *buffer, uint32_t stride)
+	{
+		bool isSame = vertexBuffer == buffer && vertexStride == stride;
+		vertexBuffer = buffer;
+		vertexStride = stride;
+		return Filter(STATE_VERTEX_BUFFER, isSame);
+	}
+
+	bool SetIndexBuffer(const void *buffer)
+	{
+		bool isSame = indexBuffer == buffer;
+		indexBuffer = buffer;
+		return Filter(STATE_INDEX_BUFFER, isSame);
+	}
+
+	//only the first @numTextures indices are set, the others stay as they were
+	bool SetTextures(const uint32_t *indices, uint32_t numTextures)
+	{
+		assert(numTextures <= MAX_TEXTURES);
+		bool isSame = numValidTextures >= numTextures;
+		for (uint32_t i = 0; i < numTextures && isSame; i++)
+			isSame = textureIndices[i] == indices[i];
+
+		for (uint32_t i = 0; i < numTextures; i++)
+			textureIndices[i] = indices[i];
+		if (numValidTextures < numTextures)
+			numValidTextures = numTextures;
+		return Filter(STATE_TEXTURES, isSame);
+	}
+
+	bool SetMatrix(const Matrix &m)
+	{
+		bool isSame = isMatrixValid && memcmp(&matrix, &m, sizeof(Matrix)) == 0;
+		matrix = m;
+		isMatrixValid = true;
+		return Filter(STATE_MATRIX, isSame);
+	}
+
+	const Stats &GetStats() const
+	{
+		return stats;
+	}
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <stdint.h>
 #include <assert.h>
+#include <utility> //std::move, the arrays are handed over with it
 
 /*
 *	A simple array whose size is known.
@@ -54,6 +55,11 @@ public:
 		return data;
 	}
 
+	const T* Data() const
+	{
+		return data;
+	}
+
 	const uint32_t Count() const
 	{
 		return numElements;
@@ -25,11 +25,11 @@ void MemoryPool::Destroy()
 {
 	if (data)
 		free(data);
-#ifndef NDEBUG
+
+	//cleared in every build, so that destroying twice does not free twice
 	data = nullptr;
 	currentOffset = 0;
 	size = 0;
-#endif
 }
 
 const uint32_t MemoryPool::GetOffset() const
@@ -1,6 +1,7 @@
 #pragma once
 #include "Array.hh"
 #include <assert.h>
+#include <stddef.h> //size_t
 #include <new>
 
 /// <summary>
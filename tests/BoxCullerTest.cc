@@ -0,0 +1,110 @@
+/*
+*	Room Editor Application
+*	Tests the SIMD frustum culling against testing every box on its own, and compares how long both take.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "roomedit/render/BoxCuller.hh"
+#include <algorithm> //std::equal
+#include <random> //std::mt19937
+#include <vector> //std::vector
+
+static constexpr uint32_t NUM_BOXES = 5000;
+static constexpr uint32_t NUM_FRAMES = 200;
+static constexpr float WORLD_SIZE = 20000.0f;
+
+struct Random
+{
+	std::mt19937 rng;
+
+	float operator()(float a, float b)
+	{
+		return std::uniform_real_distribution<float>(a, b)(rng);
+	}
+};
+
+//boxes the size of rooms and objects spread over a level, culled from random points of view
+static int TestAgainstEveryBox()
+{
+	Random random{ std::mt19937(7) };
+	std::vector<BBox> boxes(NUM_BOXES);
+	BoxCuller culler;
+	CHECK(culler.Create(NUM_BOXES));
+	for (uint32_t i = 0; i < NUM_BOXES; i++)
+	{
+		Vector center(random(-WORLD_SIZE, WORLD_SIZE), random(-WORLD_SIZE, WORLD_SIZE), random(-WORLD_SIZE * 0.1f, WORLD_SIZE * 0.1f));
+		Vector extent(random(10.0f, 1000.0f), random(10.0f, 1000.0f), random(10.0f, 300.0f));
+		boxes[i] = BBox(center - extent, center + extent);
+		CHECK(culler.Add(boxes[i]) == i);
+	}
+
+	std::vector<uint32_t> visible(culler.GetCapacity());
+	std::vector<uint32_t> expected(NUM_BOXES);
+	Matrix projection = Matrix::PerspectiveFovRH(1.4f, 1.33f, 1.0f, 16384.0f);
+	double cullerTime = 0.0;
+	double everyBoxTime = 0.0;
+	uint64_t numFound = 0;
+	for (uint32_t frame = 0; frame < NUM_FRAMES; frame++)
+	{
+		Vector eye(random(-WORLD_SIZE, WORLD_SIZE), random(-WORLD_SIZE, WORLD_SIZE), random(-WORLD_SIZE * 0.1f, WORLD_SIZE * 0.1f));
+		Vector direction(random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-0.2f, 0.2f));
+		Frustum frustum(projection * Matrix::LookAtRH(eye, eye + direction));
+
+		double start = GetMicroseconds();
+		uint32_t numVisible = culler.Cull(frustum, visible.data());
+		cullerTime += GetMicroseconds() - start;
+
+		start = GetMicroseconds();
+		uint32_t numExpected = 0;
+		for (uint32_t i = 0; i < NUM_BOXES; i++)
+		{
+			if (frustum.IsBoxVisible(boxes[i]))
+				expected[numExpected++] = i;
+		}
+		everyBoxTime += GetMicroseconds() - start;
+
+		//both write the indices in increasing order
+		CHECK(numVisible == numExpected);
+		CHECK(std::equal(visible.begin(), visible.begin() + numVisible, expected.begin()));
+		numFound += numVisible;
+	}
+
+	printf("%u boxes, %u lanes: culler %.2f us, every box %.2f us (%.1fx), %.0f visible\n", NUM_BOXES, BoxSet::LANE_WIDTH,
+		cullerTime / NUM_FRAMES, everyBoxTime / NUM_FRAMES, everyBoxTime / cullerTime, numFound / (double)NUM_FRAMES);
+
+	culler.Destroy();
+	return 0;
+}
+
+//the boxes that do not fill the last group of lanes are tested like the others, and the padding is never reported
+static int TestPartialGroup()
+{
+	BoxCuller culler;
+	CHECK(culler.Create(BoxSet::LANE_WIDTH + 1));
+
+	//all in front of the camera, looking down +x from the origin
+	for (uint32_t i = 0; i < BoxSet::LANE_WIDTH + 1; i++)
+		culler.Add(BBox(Vector(9.0f + i, -1.0f, -1.0f), Vector(10.0f + i, 1.0f, 1.0f)));
+	Frustum frustum(Matrix::PerspectiveFovRH(1.4f, 1.0f, 1.0f, 1000.0f) * Matrix::LookAtRH(Vector(0.0f, 0.0f, 0.0f), Vector(1.0f, 0.0f, 0.0f)));
+
+	std::vector<uint32_t> visible(culler.GetCapacity());
+	CHECK(culler.Cull(frustum, visible.data()) == BoxSet::LANE_WIDTH + 1);
+	for (uint32_t i = 0; i < BoxSet::LANE_WIDTH + 1; i++)
+		CHECK(visible[i] == i);
+
+	//moved behind the camera
+	culler.Set(BoxSet::LANE_WIDTH, BBox(Vector(-10.0f, -1.0f, -1.0f), Vector(-9.0f, 1.0f, 1.0f)));
+	CHECK(culler.Cull(frustum, visible.data()) == BoxSet::LANE_WIDTH);
+
+	culler.Destroy();
+	return 0;
+}
+
+int main()
+{
+	int failed = 0;
+	failed += TestAgainstEveryBox();
+	failed += TestPartialGroup();
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+/*
+*	Room Editor Application
+*	Tests of the collision queries, on a box-shaped room built in memory.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "roomedit/spatial/collision.hh"
+#include <float.h> //FLT_MAX
+#include <math.h> //fabsf
+
+static constexpr float ROOM_SIZE = 100.0f;
+static constexpr uint32_t NUM_CORNERS = 8;
+static constexpr uint32_t NUM_FACES = 12;
+
+//a room spanning 0 to ROOM_SIZE on every axis, its faces seen from the inside, with the surface property being the face's index
+struct BoxRoom
+{
+	Vector3 positions[NUM_CORNERS];
+	Corner corners[NUM_CORNERS];
+	Face faces[NUM_FACES];
+	uint16_t vertexIndices[NUM_FACES][3];
+	HitTree::Node nodes[3];
+	uint16_t faceIndices[NUM_FACES];
+	Mesh mesh;
+
+	BoxRoom():
+		positions(),
+		corners(),
+		faces(),
+		mesh()
+	{
+		for (uint32_t i = 0; i < NUM_CORNERS; i++)
+		{
+			positions[i].x = i & 1 ? ROOM_SIZE : 0.0f;
+			positions[i].y = i & 2 ? ROOM_SIZE : 0.0f;
+			positions[i].z = i & 4 ? ROOM_SIZE : 0.0f;
+			corners[i].index = (uint16_t)i;
+		}
+
+		//-x, +x, -y, +y, -z then +z, each side being two triangles
+		static const uint16_t quads[6][4] =
+		{
+			{ 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 1, 3, 2 }, { 4, 6, 7, 5 }
+		};
+		const Vector center(ROOM_SIZE * 0.5f, ROOM_SIZE * 0.5f, ROOM_SIZE * 0.5f);
+		for (uint32_t i = 0; i < NUM_FACES; i++)
+		{
+			const uint16_t *quad = quads[i / 2];
+			uint16_t a = quad[0];
+			uint16_t b = quad[i % 2 ? 2 : 1];
+			uint16_t c = quad[i % 2 ? 3 : 2];
+
+			//wound so that the face is seen from the center
+			Vector pa = GetPosition(a);
+			if ((GetPosition(c) - pa).Cross(GetPosition(b) - pa).Dot(center - pa) < 0.0f)
+			{
+				uint16_t swap = b;
+				b = c;
+				c = swap;
+			}
+			vertexIndices[i][0] = a;
+			vertexIndices[i][1] = b;
+			vertexIndices[i][2] = c;
+
+			faces[i].indexSurfaceProperty = (int32_t)i;
+			faces[i].typePoly = 4;
+			faces[i].numVerts = 3;
+			faces[i].vertexIndices = Array<uint16_t>(vertexIndices[i], 3);
+			faceIndices[i] = (uint16_t)i;
+		}
+
+		//a root with the faces split between two leaves, every node bounding the whole room
+		for (auto &node : nodes)
+		{
+			node.minExtent = Vector3();
+			node.maxExtent.x = node.maxExtent.y = node.maxExtent.z = ROOM_SIZE;
+			node.children[0] = node.children[1] = HitTree::NO_CHILD;
+			node.firstFace = 0;
+			node.numFaces = 0;
+		}
+		nodes[0].children[0] = 1;
+		nodes[0].children[1] = 2;
+		nodes[1].numFaces = NUM_FACES / 2;
+		nodes[2].firstFace = NUM_FACES / 2;
+		nodes[2].numFaces = NUM_FACES / 2;
+
+		mesh.positions = positions;
+		mesh.numVerts = NUM_CORNERS;
+		mesh.corners = Array<Corner>(corners, NUM_CORNERS);
+		mesh.faces = Array<Face>(faces, NUM_FACES);
+		mesh.hitTree.nodes = Array<HitTree::Node>(nodes, 3);
+		mesh.hitTree.faceIndices = Array<uint16_t>(faceIndices, NUM_FACES);
+	}
+
+	Vector GetPosition(uint32_t index) const
+	{
+		return Vector(positions[index].x, positions[index].y, positions[index].z);
+	}
+};
+
+static BoxRoom room;
+
+//the closest face along the ray is found, within the distance asked for
+static int TestRaycast()
+{
+	RayHit hit;
+	CHECK(RaycastMesh(room.mesh, Ray(Vector(50.0f, 50.0f, 50.0f), Vector(0.0f, 0.0f, -1.0f)), FLT_MAX, hit));
+	CHECK(fabsf(hit.distance - 50.0f) < 0.001f);
+	CHECK(hit.faceIndex == 8 || hit.faceIndex == 9); //the floor
+	CHECK(hit.indexSurfaceProperty == (int32_t)hit.faceIndex);
+
+	//from a corner of the floor towards the far wall
+	CHECK(RaycastMesh(room.mesh, Ray(Vector(10.0f, 20.0f, 30.0f), Vector(1.0f, 0.0f, 0.0f)), FLT_MAX, hit));
+	CHECK(fabsf(hit.distance - 90.0f) < 0.001f);
+	CHECK(hit.faceIndex == 2 || hit.faceIndex == 3);
+
+	//the wall is too far, or behind the ray
+	CHECK(!RaycastMesh(room.mesh, Ray(Vector(50.0f, 50.0f, 50.0f), Vector(0.0f, 0.0f, -1.0f)), 40.0f, hit));
+	CHECK(!RaycastMesh(room.mesh, Ray(Vector(150.0f, 50.0f, 50.0f), Vector(1.0f, 0.0f, 0.0f)), FLT_MAX, hit));
+	return 0;
+}
+
+//the inside of a room is open space, the outside is behind its walls
+static int TestPointInSolid()
+{
+	CHECK(!IsPointInSolid(room.mesh, Vector(50.0f, 50.0f, 50.0f)));
+	CHECK(!IsPointInSolid(room.mesh, Vector(1.0f, 99.0f, 2.0f)));
+	CHECK(IsPointInSolid(room.mesh, Vector(150.0f, 50.0f, 50.0f)));
+	CHECK(IsPointInSolid(room.mesh, Vector(50.0f, -20.0f, 50.0f)));
+	return 0;
+}
+
+//the faces near the sphere are found with their closest point, and no more than asked for
+static int TestOverlapSphere()
+{
+	SphereContact contacts[NUM_FACES];
+
+	//the middle of the room touches nothing
+	CHECK(OverlapSphere(room.mesh, Vector(50.0f, 50.0f, 50.0f), 10.0f, contacts, NUM_FACES) == 0);
+
+	//near the middle of the -x wall, both of its triangles meeting on the diagonal under the center
+	uint32_t numContacts = OverlapSphere(room.mesh, Vector(5.0f, 50.0f, 50.0f), 10.0f, contacts, NUM_FACES);
+	CHECK(numContacts == 2);
+	for (uint32_t i = 0; i < numContacts; i++)
+	{
+		CHECK(contacts[i].faceIndex == 0 || contacts[i].faceIndex == 1);
+		CHECK(fabsf(contacts[i].distance - 5.0f) < 0.001f);
+		CHECK((contacts[i].point - Vector(0.0f, 50.0f, 50.0f)).Length() < 0.001f);
+	}
+
+	//in a corner, the three walls around it
+	numContacts = OverlapSphere(room.mesh, Vector(5.0f, 5.0f, 5.0f), 10.0f, contacts, NUM_FACES);
+	CHECK(numContacts == 6);
+	for (uint32_t i = 0; i < numContacts; i++)
+		CHECK(contacts[i].faceIndex % 4 < 2); //the -x, -y and -z walls
+	CHECK(OverlapSphere(room.mesh, Vector(5.0f, 5.0f, 5.0f), 10.0f, contacts, 3) == 3);
+	return 0;
+}
+
+int main()
+{
+	int failed = 0;
+	failed += TestRaycast();
+	failed += TestPointInSolid();
+	failed += TestOverlapSphere();
+	return failed ? 1 : 0;
+}
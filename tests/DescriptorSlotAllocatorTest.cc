@@ -0,0 +1,136 @@
+/*
+*	Room Editor Application
+*	Tests of the descriptor slot allocator, driven without any device.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "sbgraphics/base/DescriptorSlotAllocator.hh"
+#include <algorithm> //std::max
+#include <random> //std::mt19937
+#include <set> //std::set
+#include <vector> //std::vector
+
+//the handles are never 0, and the slots are handed out from the start of the table
+static int TestFirstHandles()
+{
+	DescriptorSlotAllocator slots;
+	CHECK(slots.Create(4096));
+
+	uint32_t handle0 = slots.Allocate();
+	uint32_t handle1 = slots.Allocate();
+	CHECK(handle0 != DescriptorSlotAllocator::INVALID_HANDLE && handle1 != DescriptorSlotAllocator::INVALID_HANDLE);
+	CHECK(DescriptorSlotAllocator::GetSlot(handle0) == 0 && DescriptorSlotAllocator::GetSlot(handle1) == 1);
+	CHECK(slots.GetNumUsedSlots() == 2 && slots.GetNumAllocated() == 2);
+	CHECK(!slots.IsValid(DescriptorSlotAllocator::INVALID_HANDLE));
+
+	slots.Destroy();
+	return 0;
+}
+
+//a freed handle goes stale, and its slot is taken again under another generation
+static int TestStaleHandles()
+{
+	DescriptorSlotAllocator slots;
+	CHECK(slots.Create(4096));
+
+	uint32_t handle0 = slots.Allocate();
+	slots.Allocate();
+	CHECK(slots.Free(handle0));
+	CHECK(!slots.IsValid(handle0));
+	CHECK(!slots.Free(handle0)); //freed twice
+
+	uint32_t handle2 = slots.Allocate();
+	CHECK(DescriptorSlotAllocator::GetSlot(handle2) == 0);
+	CHECK(handle2 != handle0 && slots.IsValid(handle2) && !slots.IsValid(handle0));
+	CHECK(slots.GetNumUsedSlots() == 2 && slots.GetNumAllocated() == 2);
+
+	//the generations wrap around, a handle only coming back after 2048 cycles of its slot
+	uint32_t previous = handle2;
+	for (int i = 0; i < 5000; i++)
+	{
+		CHECK(slots.Free(previous));
+		uint32_t handle = slots.Allocate();
+		CHECK(DescriptorSlotAllocator::GetSlot(handle) == 0 && handle != DescriptorSlotAllocator::INVALID_HANDLE);
+		CHECK(!slots.IsValid(previous) || i % 2048 == 2047);
+		previous = handle;
+	}
+
+	slots.Destroy();
+	return 0;
+}
+
+//a full table hands out nothing, and the handles past the slots used are not valid
+static int TestFullTable()
+{
+	DescriptorSlotAllocator slots;
+	CHECK(slots.Create(8));
+
+	for (int i = 0; i < 8; i++)
+		CHECK(slots.Allocate() != DescriptorSlotAllocator::INVALID_HANDLE);
+	CHECK(slots.Allocate() == DescriptorSlotAllocator::INVALID_HANDLE);
+	CHECK(!slots.IsValid((1 << DescriptorSlotAllocator::SLOT_BITS) | 9));
+
+	slots.Destroy();
+	return 0;
+}
+
+//allocates and frees at random, the live handles must keep distinct slots and the table must only cover the peak
+static int TestRandomUse()
+{
+	DescriptorSlotAllocator slots;
+	CHECK(slots.Create(4096));
+
+	std::mt19937 rng(3);
+	std::vector<uint32_t> live;
+	std::vector<uint32_t> freed;
+	size_t peak = 0;
+	for (int step = 0; step < 1000000; step++)
+	{
+		if (live.empty() || (rng() % 100 < 52 && live.size() < 3000))
+		{
+			uint32_t handle = slots.Allocate();
+			CHECK(slots.IsValid(handle));
+			live.push_back(handle);
+		}
+		else
+		{
+			size_t i = rng() % live.size();
+			CHECK(slots.Free(live[i]));
+			freed.push_back(live[i]);
+			live[i] = live.back();
+			live.pop_back();
+		}
+		peak = std::max(peak, live.size());
+
+		if (step % 1000 == 0)
+		{
+			std::set<uint32_t> liveSlots;
+			for (uint32_t handle : live)
+			{
+				CHECK(slots.IsValid(handle));
+				liveSlots.insert(DescriptorSlotAllocator::GetSlot(handle));
+			}
+			CHECK(liveSlots.size() == live.size());
+
+			//the recently freed handles are stale, unless the very same handle was handed out again
+			for (size_t i = freed.size() > 50 ? freed.size() - 50 : 0; i < freed.size(); i++)
+				CHECK(!slots.IsValid(freed[i]) || std::find(live.begin(), live.end(), freed[i]) != live.end());
+		}
+	}
+	CHECK(slots.GetNumUsedSlots() == peak);
+	CHECK(slots.GetNumAllocated() == live.size());
+
+	slots.Destroy();
+	return 0;
+}
+
+int main()
+{
+	int failed = 0;
+	failed += TestFirstHandles();
+	failed += TestStaleHandles();
+	failed += TestFullTable();
+	failed += TestRandomUse();
+	return failed ? 1 : 0;
+}
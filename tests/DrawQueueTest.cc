@@ -0,0 +1,227 @@
+/*
+*	Room Editor Application
+*	Tests of the draw queue's keys, sorting and submission, and benchmark of a frame's worth of packets.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "roomedit/render/DrawQueue.hh"
+#include <random> //std::mt19937
+#include <vector> //std::vector
+
+//remembers what the queue asked for, like the renderer would receive it
+struct RecordingBackend
+{
+	struct SubmittedDraw
+	{
+		uint32_t pipeline;
+		uint32_t textureIndices[2];
+		uint32_t numIndices;
+		uint32_t startIndex;
+		int32_t baseVertex;
+		uint32_t matrixIndex;
+		uint32_t numInstances;
+		float matrixValue; //the first element of the last matrix set
+	};
+
+	std::vector<SubmittedDraw> draws;
+	SubmittedDraw state = {};
+	uint32_t numPipelines = 0;
+	uint32_t numTextures = 0;
+	uint32_t numMatrices = 0;
+
+	void UsePipeline(uint32_t pipeline)
+	{
+		state.pipeline = pipeline;
+		numPipelines++;
+	}
+
+	void UseTextures(uint32_t textureIndex0, uint32_t textureIndex1)
+	{
+		state.textureIndices[0] = textureIndex0;
+		state.textureIndices[1] = textureIndex1;
+		numTextures++;
+	}
+
+	void SetMatrix(const Matrix &m)
+	{
+		state.matrixValue = m[0].x;
+		numMatrices++;
+	}
+
+	void Draw(uint32_t numIndices, uint32_t startIndex, int32_t baseVertex, uint32_t matrixIndex, uint32_t numInstances)
+	{
+		SubmittedDraw draw = state;
+		draw.numIndices = numIndices;
+		draw.startIndex = startIndex;
+		draw.baseVertex = baseVertex;
+		draw.matrixIndex = matrixIndex;
+		draw.numInstances = numInstances;
+		draws.push_back(draw);
+	}
+};
+
+static Matrix MakeMatrix(float value)
+{
+	Matrix m;
+	m[0].x = value;
+	return m;
+}
+
+//the pipeline matters the most, then the second texture, the first texture, the matrix and the depth
+static int TestKeyOrder()
+{
+	uint64_t key = DrawQueue::MakeKey(1, 2, 3, 4, 5.0f);
+	CHECK(DrawQueue::MakeKey(2, 0, 0, 0, 0.0f) > key);
+	CHECK(DrawQueue::MakeKey(1, 0, 4, 0, 0.0f) > key);
+	CHECK(DrawQueue::MakeKey(1, 3, 3, 0, 0.0f) > key);
+	CHECK(DrawQueue::MakeKey(1, 2, 3, 5, 0.0f) > key);
+	CHECK(DrawQueue::MakeKey(1, 2, 3, 4, 6.0f) > key);
+	CHECK(DrawQueue::MakeKey(1, 2, 3, 4, 4.0f) < key);
+
+	//the highest values of every field stay in their own bits
+	uint32_t maxTexture = (1u << DrawQueue::TEXTURE_BITS) - 1;
+	uint32_t maxMesh = (1u << DrawQueue::MESH_BITS) - 1;
+	uint64_t highest = DrawQueue::MakeKey(0, maxTexture, maxTexture, maxMesh, 1e30f);
+	CHECK(highest < DrawQueue::MakeKey(1, 0, 0, 0, 0.0f));
+	CHECK(DrawQueue::MakeKey(0, 0, 0, maxMesh, 1e30f) < DrawQueue::MakeKey(0, 1, 0, 0, 0.0f));
+
+	//behind the camera is the nearest
+	CHECK(DrawQueue::MakeKey(0, 0, 0, 0, -1.0f) == DrawQueue::MakeKey(0, 0, 0, 0, 0.0f));
+	return 0;
+}
+
+//the packets come out in the order of their keys, the states only being set when they change
+static int TestSortAndSubmit()
+{
+	DrawQueue queue;
+	CHECK(queue.Create(16, 16));
+
+	uint32_t m0 = queue.AddMatrix(MakeMatrix(10.0f));
+	uint32_t m1 = queue.AddMatrix(MakeMatrix(11.0f));
+	queue.Add(1, 5, 0, m0, 30.0f, 3, 0, 0);
+	queue.Add(0, 7, 0, m1, 20.0f, 6, 3, 0);
+	queue.Add(1, 5, 0, m0, 10.0f, 9, 9, 4);
+	queue.Add(0, 7, 0, m1, 5.0f, 12, 18, 8);
+	queue.Add(1, 4, 0, m1, 1.0f, 15, 30, 0);
+	CHECK(queue.GetNumPackets() == 5);
+
+	queue.Sort();
+	RecordingBackend backend;
+	queue.Submit(backend);
+	CHECK(backend.draws.size() == 5);
+
+	//pipeline 0 first, the nearest first, then pipeline 1 with texture 4 before texture 5
+	static const uint32_t expectedNumIndices[] = { 12, 6, 15, 9, 3 };
+	for (uint32_t i = 0; i < 5; i++)
+		CHECK(backend.draws[i].numIndices == expectedNumIndices[i]);
+	CHECK(backend.draws[0].pipeline == 0 && backend.draws[0].textureIndices[0] == 7 && backend.draws[0].matrixValue == 11.0f);
+	CHECK(backend.draws[2].pipeline == 1 && backend.draws[2].textureIndices[0] == 4 && backend.draws[2].matrixValue == 11.0f);
+	CHECK(backend.draws[3].startIndex == 9 && backend.draws[3].baseVertex == 4 && backend.draws[3].matrixValue == 10.0f);
+
+	//two pipelines, each setting its textures and matrix, then texture 5 with the other matrix
+	CHECK(backend.numPipelines == 2 && backend.numTextures == 3 && backend.numMatrices == 3);
+	CHECK(queue.GetStats().numStateChanges == 8);
+	CHECK(queue.GetStats().numUnsortedStateChanges == 3 + 3 + 3 + 3 + 3);
+	CHECK(queue.GetStats().numPackets == 5);
+
+	queue.Destroy();
+	return 0;
+}
+
+//a full queue drops the packets and the matrices that do not fit, and Reset empties it
+static int TestFullQueue()
+{
+	DrawQueue queue;
+	CHECK(queue.Create(2, 3));
+
+	Matrix matrices[2] = { MakeMatrix(1.0f), MakeMatrix(2.0f) };
+	CHECK(queue.AddMatrices(matrices, 2) == 0);
+	CHECK(queue.AddMatrices(matrices, 2) == DrawQueue::INVALID_INDEX);
+	CHECK(queue.AddMatrix(matrices[0]) == 2);
+	CHECK(queue.AddMatrix(matrices[0]) == DrawQueue::INVALID_INDEX);
+
+	queue.Add(0, 0, 0, 0, 1.0f, 3, 0, 0, 2);
+	queue.Add(0, 0, 0, 2, 1.0f, 3, 0, 0);
+	queue.Add(0, 0, 0, 2, 1.0f, 3, 0, 0);
+	CHECK(queue.GetNumPackets() == 2 && queue.GetStats().numDropped == 1);
+
+	queue.Reset();
+	CHECK(queue.GetNumPackets() == 0 && queue.GetNumMatrices() == 0 && queue.GetStats().numDropped == 0);
+	queue.Sort();
+	RecordingBackend backend;
+	queue.Submit(backend);
+	CHECK(backend.draws.empty());
+
+	queue.Destroy();
+	return 0;
+}
+
+//a frame of 300 rooms of 20 parts, each room with its lightmap and matrix, and 2000 objects sharing 50 meshes of 3 parts
+static int BenchmarkFrame()
+{
+	static constexpr uint32_t NUM_ROOMS = 300;
+	static constexpr uint32_t NUM_ROOM_PARTS = 20;
+	static constexpr uint32_t NUM_OBJECTS = 2000;
+	static constexpr uint32_t NUM_PACKETS = NUM_ROOMS * NUM_ROOM_PARTS + NUM_OBJECTS * 3;
+	static constexpr uint32_t NUM_FRAMES = 100;
+
+	DrawQueue queue;
+	CHECK(queue.Create(NUM_PACKETS, NUM_ROOMS + NUM_OBJECTS));
+
+	std::mt19937 rng(4);
+	std::uniform_real_distribution<float> depth(1.0f, 10000.0f);
+	double buildTime = 0.0;
+	double sortTime = 0.0;
+	double submitTime = 0.0;
+	RecordingBackend backend;
+	for (uint32_t frame = 0; frame < NUM_FRAMES; frame++)
+	{
+		double start = GetMicroseconds();
+		queue.Reset();
+		for (uint32_t r = 0; r < NUM_ROOMS; r++)
+		{
+			uint32_t matrixIndex = queue.AddMatrix(MakeMatrix((float)r));
+			float roomDepth = depth(rng);
+			for (uint32_t p = 0; p < NUM_ROOM_PARTS; p++)
+				queue.Add(1, (r * NUM_ROOM_PARTS + p) % 2000, r, matrixIndex, roomDepth, 300, p * 300, 0);
+		}
+		for (uint32_t o = 0; o < NUM_OBJECTS; o++)
+		{
+			uint32_t matrixIndex = queue.AddMatrix(MakeMatrix((float)o));
+			float objectDepth = depth(rng);
+			for (uint32_t p = 0; p < 3; p++)
+				queue.Add(2, 2000 + (o % 50) * 3 + p, 0, matrixIndex, objectDepth, 150, (o % 50) * 450 + p * 150, 0);
+		}
+		buildTime += GetMicroseconds() - start;
+
+		start = GetMicroseconds();
+		queue.Sort();
+		sortTime += GetMicroseconds() - start;
+
+		backend.draws.clear();
+		start = GetMicroseconds();
+		queue.Submit(backend);
+		submitTime += GetMicroseconds() - start;
+		CHECK(backend.draws.size() == NUM_PACKETS);
+	}
+
+	const DrawQueue::Stats &stats = queue.GetStats();
+	printf("%u packets: building %.3f ms, sorting %.3f ms, submitting %.3f ms\n", NUM_PACKETS,
+		buildTime / NUM_FRAMES / 1000.0, sortTime / NUM_FRAMES / 1000.0, submitTime / NUM_FRAMES / 1000.0);
+	printf("state changes: %u sorted, %u in the order they were added\n", stats.numStateChanges, stats.numUnsortedStateChanges);
+	CHECK(stats.numStateChanges < stats.numUnsortedStateChanges);
+
+	queue.Destroy();
+	return 0;
+}
+
+int main()
+{
+	int failed = 0;
+	failed += TestKeyOrder();
+	failed += TestSortAndSubmit();
+	failed += TestFullQueue();
+	failed += BenchmarkFrame();
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,292 @@
+/*
+*	Room Editor Application
+*	Tests that recording the draws on several threads submits the same frame as recording them on one,
+*	along with the appending and batching it relies on.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "roomedit/render/DrawRecorder.hh"
+
+static Matrix MakeMatrix(float value)
+{
+	Matrix m;
+	m[0].x = value;
+	m[3].y = value * 0.5f;
+	return m;
+}
+
+//a backend that draws nothing, and only hashes the calls it gets with their arguments
+struct HashingBackend
+{
+	uint64_t hash = 14695981039346656037ull;
+	uint32_t numCalls = 0;
+
+	void Mix(const void *data, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+			hash = (hash ^ ((const uint8_t *)data)[i]) * 1099511628211ull;
+	}
+
+	void Mix(uint32_t value)
+	{
+		Mix(&value, sizeof(value));
+	}
+
+	void UsePipeline(uint32_t pipeline)
+	{
+		Mix(1);
+		Mix(pipeline);
+		numCalls++;
+	}
+
+	void UseTextures(uint32_t textureIndex0, uint32_t textureIndex1)
+	{
+		Mix(2);
+		Mix(textureIndex0);
+		Mix(textureIndex1);
+		numCalls++;
+	}
+
+	void SetMatrix(const Matrix &m)
+	{
+		Mix(3);
+		Mix(&m, sizeof(Matrix));
+		numCalls++;
+	}
+
+	void Draw(uint32_t numIndices, uint32_t startIndex, int32_t baseVertex, uint32_t matrixIndex, uint32_t numInstances)
+	{
+		Mix(4);
+		Mix(numIndices);
+		Mix(startIndex);
+		Mix((uint32_t)baseVertex);
+		Mix(matrixIndex);
+		Mix(numInstances);
+		numCalls++;
+	}
+
+	//the instanced draws, with the transforms gathered for them
+	void MixBatches(const InstanceBatcher &batcher)
+	{
+		for (uint32_t b = 0; b < batcher.GetNumBatches(); b++)
+		{
+			const InstanceBatcher::Batch &batch = batcher.GetBatch(b);
+			Mix(5);
+			Mix(&batch, sizeof(batch));
+			Mix(batcher.GetGatheredTransforms() + batch.firstInstance, batch.numInstances * sizeof(Matrix));
+			numCalls++;
+		}
+	}
+};
+
+//what a room or an object of the frame records: a few packets with their matrices, and a few instanced parts
+struct FrameWork
+{
+	uint32_t frame;
+
+	void operator()(DrawRecorder::Stream &stream, uint32_t item) const
+	{
+		uint32_t seed = item * 2654435761u + frame * 40503u;
+		uint32_t numPackets = seed % 5;
+		if (numPackets)
+		{
+			uint32_t matrixIndex = stream.drawQueue.AddMatrix(MakeMatrix((float)item));
+			for (uint32_t p = 0; p < numPackets; p++)
+			{
+				uint32_t textureIndex = (seed >> 8) % 16 + p;
+				stream.drawQueue.Add(seed % 3, textureIndex, item % 7, matrixIndex, (float)((seed >> 4) % 1000), 3 * (p + 1), item * 16 + p, (int32_t)item);
+			}
+		}
+
+		//two instances of the same shared mesh part, the depth telling them apart
+		if (item % 3 == 0)
+		{
+			uint32_t transformIndex = stream.instanceBatcher.AddTransform(MakeMatrix((float)item + 0.25f));
+			uint32_t part = (seed >> 12) % 4;
+			stream.instanceBatcher.Add(part, 36, part * 36, 0, transformIndex, (float)item);
+			stream.instanceBatcher.Add(part + 1, 36, part * 36, 0, transformIndex, (float)item);
+		}
+	}
+};
+
+static constexpr uint32_t MAX_PACKETS = 8192;
+static constexpr uint32_t MAX_TRANSFORMS = 4096;
+
+//appended packets keep their keys, with their matrix indices moved past those already in the queue
+static int TestDrawQueueAppend()
+{
+	DrawQueue source, appended, expected;
+	CHECK(source.Create(16, 16) && appended.Create(16, 16) && expected.Create(16, 16));
+
+	//the destination already holds a packet and two matrices
+	for (DrawQueue *queue : { &appended, &expected })
+	{
+		queue->AddMatrix(MakeMatrix(100.0f));
+		uint32_t matrixIndex = queue->AddMatrix(MakeMatrix(101.0f));
+		queue->Add(1, 3, 0, matrixIndex, 50.0f, 6, 0, 0);
+	}
+
+	//only the packets 1 and 2 and the matrices 1 to 3 of the source are appended
+	Matrix sourceMatrices[4] = { MakeMatrix(0.0f), MakeMatrix(1.0f), MakeMatrix(2.0f), MakeMatrix(3.0f) };
+	CHECK(source.AddMatrices(sourceMatrices, 4) == 0);
+	source.Add(0, 1, 0, 0, 1.0f, 3, 0, 0);
+	source.Add(1, 3, 0, 2, 10.0f, 9, 6, 2, 2);
+	source.Add(1, 3, 0, 1, 60.0f, 12, 9, 0);
+	appended.Append(source, 1, 2, 1, 3);
+	CHECK(appended.GetNumPackets() == 3 && appended.GetNumMatrices() == 5);
+	CHECK(appended.GetMatrix(2)[0].x == 1.0f && appended.GetMatrix(4)[0].x == 3.0f);
+
+	//as if they had been added there
+	CHECK(expected.AddMatrices(sourceMatrices + 1, 3) == 2);
+	expected.Add(1, 3, 0, 3, 10.0f, 9, 6, 2, 2);
+	expected.Add(1, 3, 0, 2, 60.0f, 12, 9, 0);
+
+	HashingBackend appendedBackend, expectedBackend;
+	appended.Sort();
+	appended.Submit(appendedBackend);
+	expected.Sort();
+	expected.Submit(expectedBackend);
+	CHECK(appendedBackend.numCalls == expectedBackend.numCalls && appendedBackend.hash == expectedBackend.hash);
+	CHECK(appended.GetStats().numStateChanges == expected.GetStats().numStateChanges);
+
+	//what does not fit is dropped as a whole
+	appended.Reset();
+	for (uint32_t i = 0; i < 15; i++)
+		appended.AddMatrix(MakeMatrix(0.0f));
+	appended.Append(source, 1, 2, 1, 3);
+	CHECK(appended.GetNumPackets() == 0 && appended.GetStats().numDropped == 2);
+
+	source.Destroy();
+	appended.Destroy();
+	expected.Destroy();
+	return 0;
+}
+
+//the parts drawing the same indices with the same texture become one batch, their transforms gathered in the order they were added
+static int TestInstanceBatcher()
+{
+	InstanceBatcher batcher;
+	CHECK(batcher.Create(8, 8));
+
+	uint32_t t0 = batcher.AddTransform(MakeMatrix(0.0f));
+	uint32_t t1 = batcher.AddTransform(MakeMatrix(1.0f));
+	uint32_t t2 = batcher.AddTransform(MakeMatrix(2.0f));
+	batcher.Add(5, 36, 72, 10, t2, 30.0f);
+	batcher.Add(5, 36, 0, 0, t0, 20.0f);
+	batcher.Add(5, 36, 72, 10, t0, 10.0f);
+	batcher.Add(6, 36, 72, 10, t1, 5.0f); //another texture
+	batcher.Add(5, 36, 72, 10, t1, 40.0f);
+	batcher.Build();
+
+	CHECK(batcher.GetNumBatches() == 3);
+	const InstanceBatcher::Batch &first = batcher.GetBatch(0);
+	CHECK(first.startIndex == 0 && first.numInstances == 1 && first.firstInstance == 0);
+	const InstanceBatcher::Batch &shared = batcher.GetBatch(1);
+	CHECK(shared.startIndex == 72 && shared.textureIndex == 5 && shared.baseVertex == 10);
+	CHECK(shared.firstInstance == 1 && shared.numInstances == 3 && shared.depth == 10.0f);
+	const Matrix *gathered = batcher.GetGatheredTransforms();
+	CHECK(gathered[1][0].x == 2.0f && gathered[2][0].x == 0.0f && gathered[3][0].x == 1.0f);
+	CHECK(batcher.GetBatch(2).textureIndex == 6 && batcher.GetBatch(2).numInstances == 1);
+	CHECK(batcher.GetStats().numInstances == 5 && batcher.GetStats().numBatches == 3 && batcher.GetStats().numInstancedBatches == 1);
+
+	//appended parts point at the appended transforms
+	InstanceBatcher merged;
+	CHECK(merged.Create(8, 8));
+	merged.AddTransform(MakeMatrix(9.0f));
+	merged.Append(batcher, 1, 2, 3, 2); //t1 and t2, and the last two parts, both drawn with t1
+	CHECK(merged.GetNumTransforms() == 3 && merged.GetNumInstances() == 2);
+	merged.Build();
+	CHECK(merged.GetNumBatches() == 2);
+	CHECK(merged.GetGatheredTransforms()[0][0].x == 1.0f && merged.GetGatheredTransforms()[1][0].x == 1.0f);
+
+	//the parts that no longer fit are dropped with their transforms
+	merged.Append(batcher, 0, 3, 0, 5);
+	merged.Append(batcher, 0, 3, 0, 5);
+	CHECK(merged.GetStats().numDropped == 5);
+
+	batcher.Destroy();
+	merged.Destroy();
+	return 0;
+}
+
+//records the frame's items on @recorder, merges and submits them, and returns the hash of the submission
+static uint64_t RecordFrame(DrawRecorder &recorder, DrawQueue &drawQueue, InstanceBatcher &instanceBatcher, uint32_t frame, uint32_t numItems, uint32_t &numCalls)
+{
+	FrameWork work{ frame };
+	recorder.Record(numItems, work);
+
+	drawQueue.Reset();
+	instanceBatcher.Reset();
+	recorder.Merge(drawQueue, instanceBatcher);
+	drawQueue.Sort();
+	instanceBatcher.Build();
+
+	HashingBackend backend;
+	drawQueue.Submit(backend);
+	backend.MixBatches(instanceBatcher);
+	numCalls = backend.numCalls;
+	return backend.hash;
+}
+
+//1, 2, 4 and 8 threads submit the very same calls as recording every item in order on the calling thread
+static int TestSameSubmission()
+{
+	DrawQueue drawQueue;
+	InstanceBatcher instanceBatcher;
+	CHECK(drawQueue.Create(MAX_PACKETS, MAX_PACKETS) && instanceBatcher.Create(MAX_TRANSFORMS, MAX_TRANSFORMS));
+
+	static const uint32_t threadCounts[] = { 1, 2, 4, 8 };
+	static constexpr uint32_t NUM_FRAMES = 30;
+	for (uint32_t frame = 0; frame < NUM_FRAMES; frame++)
+	{
+		//from a handful of items, fewer than a chunk, to more than there are chunks
+		uint32_t numItems = frame * 97 % 2300 + 1;
+
+		//the reference, without the recorder
+		FrameWork work{ frame };
+		DrawRecorder::Stream reference;
+		CHECK(reference.drawQueue.Create(MAX_PACKETS, MAX_PACKETS) && reference.instanceBatcher.Create(MAX_TRANSFORMS, MAX_TRANSFORMS));
+		for (uint32_t item = 0; item < numItems; item++)
+			work(reference, item);
+		reference.drawQueue.Sort();
+		reference.instanceBatcher.Build();
+		HashingBackend expected;
+		reference.drawQueue.Submit(expected);
+		expected.MixBatches(reference.instanceBatcher);
+		reference.drawQueue.Destroy();
+		reference.instanceBatcher.Destroy();
+		CHECK(expected.numCalls > 0);
+
+		for (uint32_t numThreads : threadCounts)
+		{
+			DrawRecorder recorder;
+			CHECK(recorder.Create(numThreads, MAX_PACKETS, MAX_PACKETS, MAX_TRANSFORMS, MAX_TRANSFORMS));
+			CHECK(recorder.GetNumThreads() == numThreads);
+
+			uint32_t numCalls;
+			uint64_t hash = RecordFrame(recorder, drawQueue, instanceBatcher, frame, numItems, numCalls);
+			CHECK(numCalls == expected.numCalls && hash == expected.hash);
+			CHECK(recorder.GetStats().numItems == numItems && recorder.GetStats().numChunks <= DrawRecorder::MAX_CHUNKS);
+			CHECK(drawQueue.GetStats().numDropped == 0 && instanceBatcher.GetStats().numDropped == 0);
+
+			//the same recorder gives the same frame again
+			hash = RecordFrame(recorder, drawQueue, instanceBatcher, frame, numItems, numCalls);
+			CHECK(hash == expected.hash);
+			recorder.Destroy();
+		}
+	}
+
+	drawQueue.Destroy();
+	instanceBatcher.Destroy();
+	return 0;
+}
+
+int main()
+{
+	int failed = 0;
+	failed += TestDrawQueueAppend();
+	failed += TestInstanceBatcher();
+	failed += TestSameSubmission();
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+/*
+*	Room Editor Application
+*	Tests of where the geometry layout places the meshes in the shared buffers.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "roomedit/render/GeometryLayout.hh"
+
+//the vertices of each format follow each other, and the indices of every format share one buffer
+static int TestPlacement()
+{
+	GeometryLayout layout;
+	uint32_t small = layout.AddVertexFormat(20);
+	uint32_t large = layout.AddVertexFormat(48);
+	CHECK(small == 0 && large == 1 && layout.GetNumFormats() == 2);
+
+	GeometryLayout::Range a = layout.Place(small, 10, 12);
+	GeometryLayout::Range b = layout.Place(large, 7, 9);
+	GeometryLayout::Range c = layout.Place(small, 5, 6);
+
+	CHECK(a.format == small && a.baseVertex == 0 && a.numVertices == 10 && a.startIndex == 0 && a.numIndices == 12);
+	CHECK(b.format == large && b.baseVertex == 0 && b.numVertices == 7 && b.startIndex == 12 && b.numIndices == 9);
+	CHECK(c.format == small && c.baseVertex == 10 && c.numVertices == 5 && c.numIndices == 6);
+	CHECK(layout.GetNumVertices(small) == 15 && layout.GetNumVertices(large) == 7);
+
+	CHECK(layout.GetVertexDataOffset(c) == 10 * 20);
+	CHECK(layout.GetVertexDataOffset(b) == 0);
+	CHECK(layout.GetIndexDataOffset(b) == 12 * sizeof(uint32_t));
+	return 0;
+}
+
+//every start index is a multiple of INDEX_ALIGNMENT indices, and the buffer sizes are rounded up to BUFFER_SIZE_ALIGNMENT bytes
+static int TestAlignment()
+{
+	GeometryLayout layout;
+	uint32_t format = layout.AddVertexFormat(12);
+
+	uint32_t end = 0;
+	for (uint32_t numIndices = 1; numIndices < 20; numIndices++)
+	{
+		GeometryLayout::Range range = layout.Place(format, 3, numIndices);
+		CHECK(range.startIndex % GeometryLayout::INDEX_ALIGNMENT == 0);
+		CHECK(layout.GetIndexDataOffset(range) % 16 == 0);
+		CHECK(range.startIndex >= end && range.startIndex < end + GeometryLayout::INDEX_ALIGNMENT);
+		end = range.startIndex + numIndices;
+	}
+	CHECK(layout.GetNumIndices() == end);
+
+	CHECK(layout.GetIndexBufferSize() % GeometryLayout::BUFFER_SIZE_ALIGNMENT == 0);
+	CHECK(layout.GetIndexBufferSize() >= end * sizeof(uint32_t) && layout.GetIndexBufferSize() < end * sizeof(uint32_t) + GeometryLayout::BUFFER_SIZE_ALIGNMENT);
+	CHECK(layout.GetVertexBufferSize(format) == 768); //19 meshes of 3 vertices of 12 bytes, 684 bytes rounded up
+	return 0;
+}
+
+//there is room for a fixed number of vertex formats, and resetting gives it back along with the placed meshes
+static int TestExhaustion()
+{
+	GeometryLayout layout;
+	for (uint32_t i = 0; i < GeometryLayout::MAX_VERTEX_FORMATS; i++)
+		CHECK(layout.AddVertexFormat(16 + i) == i);
+	CHECK(layout.AddVertexFormat(16) == GeometryLayout::INVALID_FORMAT);
+	CHECK(layout.GetNumFormats() == GeometryLayout::MAX_VERTEX_FORMATS);
+
+	layout.Place(0, 100, 300);
+	layout.Reset();
+	CHECK(layout.GetNumFormats() == 0 && layout.GetNumIndices() == 0 && layout.GetIndexBufferSize() == 0);
+
+	//the formats added again start empty
+	uint32_t format = layout.AddVertexFormat(32);
+	CHECK(format == 0 && layout.GetNumVertices(format) == 0 && layout.GetVertexBufferSize(format) == 0);
+	GeometryLayout::Range range = layout.Place(format, 4, 6);
+	CHECK(range.baseVertex == 0 && range.startIndex == 0);
+	return 0;
+}
+
+int main()
+{
+	int failed = 0;
+	failed += TestPlacement();
+	failed += TestAlignment();
+	failed += TestExhaustion();
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+/*
+*	Room Editor Application
+*	Tests and benchmark of the heap allocator, driven without any device.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "sbgraphics/base/heap/HeapAllocator.hh"
+#include <algorithm> //std::sort
+#include <random> //std::mt19937
+#include <vector> //std::vector
+
+static constexpr uint64_t HEAP_SIZE = 128ull << 20;
+static constexpr uint32_t MAX_ALLOCATIONS = 16384;
+
+//whether the allocations all fit in the heap without overlapping each other
+static bool AreDisjoint(std::vector<HeapAllocator::Allocation> allocations)
+{
+	std::sort(allocations.begin(), allocations.end(), [](const HeapAllocator::Allocation &a, const HeapAllocator::Allocation &b)
+		{
+			return a.offset < b.offset;
+		});
+	for (size_t i = 0; i < allocations.size(); i++)
+	{
+		if (allocations[i].offset + allocations[i].size > HEAP_SIZE)
+			return false;
+		if (i > 0 && allocations[i - 1].offset + allocations[i - 1].size > allocations[i].offset)
+			return false;
+	}
+	return true;
+}
+
+//allocates and frees at random, the ranges handed out must stay aligned and apart, and the heap must be whole again in the end
+static int TestRandomUse()
+{
+	HeapAllocator allocator;
+	CHECK(allocator.Create(HEAP_SIZE, MAX_ALLOCATIONS));
+
+	static const uint64_t alignments[] = { 256, 4096, 65536, 4 << 20 };
+	std::mt19937 rng(1);
+	std::vector<HeapAllocator::Allocation> live;
+	for (int step = 0; step < 200000; step++)
+	{
+		bool allocate = live.empty() || rng() % 100 < 55;
+		if (allocate && live.size() < MAX_ALLOCATIONS - 1)
+		{
+			uint64_t size = rng() % 4 == 0 ? rng() % (2 << 20) + 1 : rng() % 65536 + 1;
+			uint64_t alignment = alignments[rng() % 3 == 0 ? rng() % 4 : 2];
+			HeapAllocator::Allocation allocation = allocator.Allocate(size, alignment);
+			if (!allocation.IsValid())
+				continue; //the heap is too scattered for it
+
+			CHECK(allocation.offset % alignment == 0);
+			CHECK(allocation.size >= size && allocation.size % HeapAllocator::GRANULARITY == 0);
+			live.push_back(allocation);
+		}
+		else if (!live.empty())
+		{
+			size_t i = rng() % live.size();
+			CHECK(allocator.Free(live[i]));
+			CHECK(!allocator.Free(live[i])); //freed twice
+			live[i] = live.back();
+			live.pop_back();
+		}
+
+		if (step % 5000 == 0)
+			CHECK(AreDisjoint(live));
+	}
+	CHECK(allocator.GetStats().numAllocations == live.size());
+
+	//the neighbouring free ranges are merged, so the heap ends up in one block
+	for (const auto &allocation : live)
+		CHECK(allocator.Free(allocation));
+	HeapAllocator::Stats stats = allocator.GetStats();
+	CHECK(stats.usedSize == 0);
+	CHECK(stats.numFreeBlocks == 1);
+	CHECK(stats.largestFreeSize == HEAP_SIZE);
+	CHECK(stats.GetFragmentation() == 0.0f);
+
+	allocator.Destroy();
+	return 0;
+}
+
+//everything allocated after a checkpoint goes at once, the older allocations stay
+static int TestFreeAllocatedSince()
+{
+	HeapAllocator allocator;
+	CHECK(allocator.Create(HEAP_SIZE, MAX_ALLOCATIONS));
+
+	HeapAllocator::Allocation kept[16];
+	for (auto &allocation : kept)
+		allocation = allocator.Allocate(1000, 256);
+
+	uint32_t checkpoint = allocator.GetNextSerial();
+	for (int i = 0; i < 100; i++)
+		CHECK(allocator.Allocate(1000, 256).IsValid());
+	allocator.FreeAllocatedSince(checkpoint);
+
+	CHECK(allocator.GetStats().numAllocations == 16);
+	for (const auto &allocation : kept)
+		CHECK(allocator.Free(allocation));
+	CHECK(allocator.GetStats().numFreeBlocks == 1);
+
+	allocator.Destroy();
+	return 0;
+}
+
+//an allocation that does not fit fails without changing anything, and is counted
+static int TestOutOfRoom()
+{
+	HeapAllocator allocator;
+	CHECK(allocator.Create(1 << 20, 4));
+
+	CHECK(!allocator.Allocate(2 << 20, 256).IsValid());
+	CHECK(allocator.GetStats().numFailed == 1);
+
+	//there are only as many blocks as allocations asked for
+	HeapAllocator::Allocation allocations[4];
+	for (auto &allocation : allocations)
+		allocation = allocator.Allocate(256, 256);
+	CHECK(!allocator.Allocate(256, 256).IsValid());
+	CHECK(allocator.GetStats().numFailed == 2);
+	CHECK(allocator.GetStats().numAllocations == 4);
+
+	allocator.Destroy();
+	return 0;
+}
+
+//frees and allocates again with a steady number of live allocations, like a level streaming its resources
+static int BenchmarkSteadyState()
+{
+	HeapAllocator allocator;
+	CHECK(allocator.Create(HEAP_SIZE, MAX_ALLOCATIONS));
+
+	static constexpr uint32_t NUM_LIVE = 4096;
+	static constexpr uint32_t NUM_PAIRS = 1000000;
+	std::mt19937 rng(2);
+	std::vector<HeapAllocator::Allocation> live(NUM_LIVE);
+	for (auto &allocation : live)
+		allocation = allocator.Allocate(rng() % 32768 + 1, 256);
+	std::vector<uint64_t> sizes(NUM_PAIRS);
+	for (auto &size : sizes)
+		size = rng() % 32768 + 1;
+
+	double start = GetMicroseconds();
+	for (uint32_t i = 0; i < NUM_PAIRS; i++)
+	{
+		auto &allocation = live[i % NUM_LIVE];
+		allocator.Free(allocation);
+		allocation = allocator.Allocate(sizes[i], 256);
+	}
+	double elapsed = GetMicroseconds() - start;
+
+	HeapAllocator::Stats stats = allocator.GetStats();
+	printf("free and allocate: %.1f ns, %u free blocks, fragmentation %.3f\n", elapsed * 1000.0 / NUM_PAIRS, stats.numFreeBlocks, stats.GetFragmentation());
+	CHECK(stats.numAllocations == NUM_LIVE);
+
+	allocator.Destroy();
+	return 0;
+}
+
+int main()
+{
+	int failed = 0;
+	failed += TestRandomUse();
+	failed += TestFreeAllocatedSince();
+	failed += TestOutOfRoom();
+	failed += BenchmarkSteadyState();
+	return failed ? 1 : 0;
+}
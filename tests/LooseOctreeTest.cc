@@ -0,0 +1,154 @@
+/*
+*	Room Editor Application
+*	Tests the loose octree's queries against testing every box, and compares how long both take.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "roomedit/spatial/LooseOctree.hh"
+#include <math.h> //fmaxf
+#include <algorithm> //std::sort
+#include <random> //std::mt19937
+#include <vector> //std::vector
+
+static constexpr uint32_t NUM_ITEMS = 20000;
+static constexpr uint32_t NUM_FRAMES = 200;
+static constexpr float WORLD_SIZE = 50000.0f;
+
+enum QueryType
+{
+	QUERY_SPHERE,
+	QUERY_BOX,
+	QUERY_FRUSTUM,
+	NUM_QUERY_TYPES
+};
+
+static const char *const queryNames[NUM_QUERY_TYPES] = { "sphere", "box", "frustum" };
+
+struct Random
+{
+	std::mt19937 rng;
+
+	float operator()(float a, float b)
+	{
+		return std::uniform_real_distribution<float>(a, b)(rng);
+	}
+};
+
+static bool IsBoxOverlappingSphere(const BBox &box, const Vector &center, float radius)
+{
+	float dx = fmaxf(fmaxf(box.min.x - center.x, center.x - box.max.x), 0.0f);
+	float dy = fmaxf(fmaxf(box.min.y - center.y, center.y - box.max.y), 0.0f);
+	float dz = fmaxf(fmaxf(box.min.z - center.z, center.z - box.max.z), 0.0f);
+	return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+//mostly small boxes with a few large ones, like the objects of a level, some of them outside of the tree's bounds
+static BBox MakeBox(Random &random, uint32_t index)
+{
+	Vector center(random(-WORLD_SIZE, WORLD_SIZE), random(-WORLD_SIZE, WORLD_SIZE), random(-WORLD_SIZE * 0.2f, WORLD_SIZE * 0.2f));
+	if (index % 100 == 0)
+		center.x += 2.0f * WORLD_SIZE + 5000.0f;
+	float radius = index % 50 == 1 ? random(500.0f, 3000.0f) : random(10.0f, 200.0f);
+	return BBox(center - Vector(radius, radius, radius), center + Vector(radius, radius, radius));
+}
+
+//moves some of the boxes every frame and queries the tree, which must find what testing every box finds
+static int TestAgainstBruteForce()
+{
+	Random random{ std::mt19937(5) };
+	std::vector<BBox> boxes(NUM_ITEMS);
+	LooseOctree octree;
+	CHECK(octree.Create(BBox(Vector(-WORLD_SIZE, -WORLD_SIZE, -WORLD_SIZE * 0.2f), Vector(WORLD_SIZE, WORLD_SIZE, WORLD_SIZE * 0.2f)), NUM_ITEMS));
+
+	double start = GetMicroseconds();
+	for (uint32_t i = 0; i < NUM_ITEMS; i++)
+	{
+		boxes[i] = MakeBox(random, i);
+		octree.Insert(i, boxes[i]);
+	}
+	double buildTime = GetMicroseconds() - start;
+
+	std::vector<uint32_t> found(NUM_ITEMS);
+	std::vector<uint32_t> expected(NUM_ITEMS);
+	Matrix projection = Matrix::PerspectiveFovRH(1.4f, 1.33f, 1.0f, 16384.0f);
+	double octreeTimes[NUM_QUERY_TYPES] = {};
+	double bruteForceTimes[NUM_QUERY_TYPES] = {};
+	uint64_t numFound[NUM_QUERY_TYPES] = {};
+	for (uint32_t frame = 0; frame < NUM_FRAMES; frame++)
+	{
+		for (uint32_t k = 0; k < NUM_ITEMS / 50; k++)
+		{
+			uint32_t i = random.rng() % NUM_ITEMS;
+			Vector offset(random(-300.0f, 300.0f), random(-300.0f, 300.0f), random(-100.0f, 100.0f));
+			boxes[i].min += offset;
+			boxes[i].max += offset;
+			octree.Update(i, boxes[i]);
+		}
+		if (frame % 10 == 0)
+		{
+			uint32_t i = random.rng() % NUM_ITEMS;
+			octree.Remove(i);
+			octree.Insert(i, boxes[i]);
+		}
+
+		Vector center(random(-WORLD_SIZE, WORLD_SIZE), random(-WORLD_SIZE, WORLD_SIZE), random(-WORLD_SIZE * 0.2f, WORLD_SIZE * 0.2f));
+		float radius = random(200.0f, 3000.0f);
+		BBox queryBox(center - Vector(radius, radius * 2.0f, radius * 0.5f), center + Vector(radius, radius * 2.0f, radius * 0.5f));
+		Vector direction(random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-0.2f, 0.2f));
+		Frustum frustum(projection * Matrix::LookAtRH(center, center + direction));
+
+		for (int type = 0; type < NUM_QUERY_TYPES; type++)
+		{
+			start = GetMicroseconds();
+			uint32_t numResults;
+			if (type == QUERY_SPHERE)
+				numResults = octree.QuerySphere(center, radius, found.data(), NUM_ITEMS);
+			else if (type == QUERY_BOX)
+				numResults = octree.QueryBox(queryBox, found.data(), NUM_ITEMS);
+			else
+				numResults = octree.QueryFrustum(frustum, found.data(), NUM_ITEMS);
+			octreeTimes[type] += GetMicroseconds() - start;
+
+			start = GetMicroseconds();
+			uint32_t numExpected = 0;
+			for (uint32_t i = 0; i < NUM_ITEMS; i++)
+			{
+				bool isInside;
+				if (type == QUERY_SPHERE)
+					isInside = IsBoxOverlappingSphere(boxes[i], center, radius);
+				else if (type == QUERY_BOX)
+					isInside = queryBox.IsIntersectBox(boxes[i]);
+				else
+					isInside = frustum.IsBoxVisible(boxes[i]);
+				if (isInside)
+					expected[numExpected++] = i;
+			}
+			bruteForceTimes[type] += GetMicroseconds() - start;
+
+			//the tree finds the items in no particular order
+			std::sort(found.begin(), found.begin() + numResults);
+			CHECK(numResults == numExpected);
+			CHECK(std::equal(found.begin(), found.begin() + numResults, expected.begin()));
+			numFound[type] += numResults;
+		}
+	}
+
+	printf("%u items, built in %.0f us\n", NUM_ITEMS, buildTime);
+	for (int type = 0; type < NUM_QUERY_TYPES; type++)
+	{
+		printf("%s: octree %.1f us, every box %.1f us (%.1fx), %.0f found\n", queryNames[type], octreeTimes[type] / NUM_FRAMES,
+			bruteForceTimes[type] / NUM_FRAMES, bruteForceTimes[type] / octreeTimes[type], numFound[type] / (double)NUM_FRAMES);
+	}
+
+	//a query with room for fewer results stops there
+	CHECK(octree.QueryBox(BBox(Vector(-2.0f * WORLD_SIZE, -2.0f * WORLD_SIZE, -WORLD_SIZE), Vector(4.0f * WORLD_SIZE, 2.0f * WORLD_SIZE, WORLD_SIZE)), found.data(), 10) == 10);
+
+	octree.Destroy();
+	return 0;
+}
+
+int main()
+{
+	return TestAgainstBruteForce();
+}
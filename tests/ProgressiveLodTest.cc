@@ -0,0 +1,158 @@
+/*
+*	Room Editor Application
+*	Tests of the levels of detail built from a progressive-reduction collapse map, on strips built in memory.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "roomedit/geometry/progressive.hh"
+
+static constexpr uint32_t NUM_POSITIONS = 32; //per strip
+static constexpr uint32_t NUM_TRIANGLES = NUM_POSITIONS - 2;
+static constexpr uint32_t NUM_INDICES = NUM_TRIANGLES * 3;
+
+//a strip of quads, positions 2i and 2i + 1 being across from each other, with a corner per position
+//its first half of triangles is the first part, the other half the second part
+struct Strip
+{
+	Corner corners[NUM_POSITIONS];
+	uint32_t indices[NUM_INDICES];
+	uint32_t partNumIndices[2];
+	Mesh mesh;
+
+	Strip():
+		corners(),
+		mesh()
+	{
+		for (uint32_t i = 0; i < NUM_POSITIONS; i++)
+			corners[i].index = (uint16_t)i;
+		for (uint32_t i = 0; i < NUM_POSITIONS / 2 - 1; i++)
+		{
+			uint32_t *quad = indices + i * 6;
+			quad[0] = 2 * i;
+			quad[1] = 2 * i + 1;
+			quad[2] = 2 * i + 2;
+			quad[3] = 2 * i + 1;
+			quad[4] = 2 * i + 3;
+			quad[5] = 2 * i + 2;
+		}
+		partNumIndices[0] = NUM_INDICES / 2;
+		partNumIndices[1] = NUM_INDICES / 2;
+
+		mesh.numVerts = NUM_POSITIONS;
+		mesh.corners = Array<Corner>(corners, NUM_POSITIONS);
+	}
+};
+
+static Strip strip;
+
+//the positions of two strips one after the other, each position collapsing into the one across the previous quad,
+//the first two positions of the second strip collapsing into the last two of the first one
+static uint16_t remap[NUM_POSITIONS * 2];
+
+static void MakeRemap()
+{
+	for (uint32_t v = 0; v < NUM_POSITIONS * 2; v++)
+		remap[v] = (uint16_t)(v < 2 ? v : v - 2);
+}
+
+//every index of the reduced level sits on one of the first @numKept positions
+static bool AreIndicesKept(const LodSet &lods, uint32_t level, uint32_t numKept)
+{
+	for (uint32_t i = 0; i < lods.levelNumIndices[level]; i++)
+	{
+		uint32_t index = lods.indices[lods.levelStartIndex[level] - NUM_INDICES + i];
+		if (index >= NUM_POSITIONS || strip.corners[index].index >= numKept)
+			return false;
+	}
+	return true;
+}
+
+//keeping n positions of the first strip keeps its first n / 2 - 1 quads, in the first part for as long as it can
+static int TestFirstMesh()
+{
+	MemoryPool pool;
+	CHECK(pool.Create(1024 * 1024));
+
+	static const uint16_t levelNumPositions[] = { 16, 8, 4 };
+	LodSet lods;
+	BuildProgressiveLods(lods, pool, strip.mesh, strip.indices, NUM_INDICES, strip.partNumIndices, 2, remap, NUM_POSITIONS * 2, 0, levelNumPositions, 3);
+
+	//halving the model's 64 positions asks for 32, 16 then 8, the closest authored counts being 16, 16 and 8, the second 16 not being any lighter
+	CHECK(lods.numLevels == 3);
+	CHECK(lods.levelStartIndex[0] == 0 && lods.levelNumIndices[0] == NUM_INDICES);
+	CHECK(lods.levelStartIndex[1] == NUM_INDICES && lods.levelNumIndices[1] == 7 * 6);
+	CHECK(lods.levelStartIndex[2] == NUM_INDICES + 7 * 6 && lods.levelNumIndices[2] == 3 * 6);
+	CHECK(lods.GetNumIndices() == NUM_INDICES + 10 * 6);
+	CHECK(AreIndicesKept(lods, 1, 16));
+	CHECK(AreIndicesKept(lods, 2, 8));
+
+	//the first part holds the first 7.5 quads, so the second part is empty from the first reduced level on
+	CHECK(lods.GetPartNumIndices(0, 0) == NUM_INDICES / 2 && lods.GetPartNumIndices(0, 1) == NUM_INDICES / 2);
+	CHECK(lods.GetPartNumIndices(1, 0) == 7 * 6 && lods.GetPartNumIndices(1, 1) == 0);
+	CHECK(lods.GetPartNumIndices(2, 0) == 3 * 6 && lods.GetPartNumIndices(2, 1) == 0);
+
+	//the triangles keep their order
+	CHECK(lods.indices[0] == 0 && lods.indices[1] == 1 && lods.indices[2] == 2);
+
+	pool.Destroy();
+	return 0;
+}
+
+//the second strip's positions start after the first's, and its corners are still its own
+static int TestSecondMesh()
+{
+	MemoryPool pool;
+	CHECK(pool.Create(1024 * 1024));
+
+	//keeping 40 of the model's positions keeps the second strip's first 8
+	static const uint16_t levelNumPositions[] = { 40 };
+	LodSet lods;
+	BuildProgressiveLods(lods, pool, strip.mesh, strip.indices, NUM_INDICES, strip.partNumIndices, 2, remap, NUM_POSITIONS * 2, NUM_POSITIONS, levelNumPositions, 1);
+	CHECK(lods.numLevels == 2);
+	CHECK(lods.levelStartIndex[1] == NUM_INDICES && lods.levelNumIndices[1] == 3 * 6);
+	CHECK(AreIndicesKept(lods, 1, 8));
+
+	//the same tables leave the first strip whole, so it gets no reduced level
+	LodSet firstLods;
+	BuildProgressiveLods(firstLods, pool, strip.mesh, strip.indices, NUM_INDICES, strip.partNumIndices, 2, remap, NUM_POSITIONS * 2, 0, levelNumPositions, 1);
+	CHECK(firstLods.numLevels == 1 && firstLods.GetNumIndices() == NUM_INDICES);
+
+	pool.Destroy();
+	return 0;
+}
+
+//the triangles whose corners collapse into another mesh are dropped, and a map that does not reach the mesh leaves it whole
+static int TestOutsideOfMesh()
+{
+	MemoryPool pool;
+	CHECK(pool.Create(1024 * 1024));
+
+	//keeping 32 positions collapses the whole second strip into the first
+	static const uint16_t levelNumPositions[] = { 32 };
+	LodSet lods;
+	BuildProgressiveLods(lods, pool, strip.mesh, strip.indices, NUM_INDICES, strip.partNumIndices, 2, remap, NUM_POSITIONS * 2, NUM_POSITIONS, levelNumPositions, 1);
+	CHECK(lods.numLevels == 1);
+
+	BuildProgressiveLods(lods, pool, strip.mesh, strip.indices, NUM_INDICES, strip.partNumIndices, 2, remap, NUM_POSITIONS, NUM_POSITIONS, nullptr, 0);
+	CHECK(lods.numLevels == 1 && lods.GetNumIndices() == NUM_INDICES);
+
+	//without any authored counts, the levels halve the positions
+	BuildProgressiveLods(lods, pool, strip.mesh, strip.indices, NUM_INDICES, strip.partNumIndices, 2, remap, NUM_POSITIONS, 0, nullptr, 0);
+	CHECK(lods.numLevels == 4);
+	CHECK(lods.levelNumIndices[1] == 7 * 6 && lods.levelNumIndices[2] == 3 * 6 && lods.levelNumIndices[3] == 1 * 6);
+
+	pool.Destroy();
+	return 0;
+}
+
+int main()
+{
+	MakeRemap();
+
+	int failed = 0;
+	failed += TestFirstMesh();
+	failed += TestSecondMesh();
+	failed += TestOutsideOfMesh();
+	return failed ? 1 : 0;
+}
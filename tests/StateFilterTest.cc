@@ -0,0 +1,145 @@
+/*
+*	Room Editor Application
+*	Tests that the renderer drops the state calls setting what is already set, on the software renderer.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "sbgraphics/sbSoftRenderer.hh"
+
+struct SmallVertex
+{
+	float position[3];
+	float texcoord[2];
+};
+
+struct LargeVertex
+{
+	float position[3];
+	float texcoord[2];
+	float lightmapTexcoord[2];
+};
+
+static uint32_t GetIssued(const sbSoftRenderer &renderer, sbStateFilter::StateType type)
+{
+	return renderer.GetStateStats().numIssued[type];
+}
+
+static uint32_t GetSkipped(const sbSoftRenderer &renderer, sbStateFilter::StateType type)
+{
+	return renderer.GetStateStats().numSkipped[type];
+}
+
+//a pipeline set again is dropped, another one goes through
+static int TestPipelines(sbSoftRenderer &renderer)
+{
+	Pipeline pipeline0(SHADING_PHONG);
+	Pipeline pipeline1(SHADING_LIGHTMAPPED);
+	CHECK(renderer.CreatePipeline(pipeline0) && renderer.CreatePipeline(pipeline1));
+
+	CHECK(renderer.StartFrame());
+	renderer.UsePipeline(pipeline0);
+	renderer.UsePipeline(pipeline0);
+	renderer.UsePipeline(pipeline0);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_PIPELINE) == 1 && GetSkipped(renderer, sbStateFilter::STATE_PIPELINE) == 2);
+
+	renderer.UsePipeline(pipeline1);
+	renderer.UsePipeline(pipeline0);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_PIPELINE) == 3 && GetSkipped(renderer, sbStateFilter::STATE_PIPELINE) == 2);
+	renderer.EndAndPresentFrame();
+
+	//a new frame starts with nothing bound
+	CHECK(renderer.StartFrame());
+	renderer.UsePipeline(pipeline0);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_PIPELINE) == 1 && GetSkipped(renderer, sbStateFilter::STATE_PIPELINE) == 0);
+	renderer.EndAndPresentFrame();
+
+	renderer.DestroyPipeline(pipeline0);
+	renderer.DestroyPipeline(pipeline1);
+	return 0;
+}
+
+//a buffer bound again is dropped, another buffer or the same one read with another stride goes through
+static int TestBuffers(sbSoftRenderer &renderer)
+{
+	GPUResource buffer0 = renderer.CreateBuffer(1024);
+	GPUResource buffer1 = renderer.CreateBuffer(1024);
+	CHECK(buffer0 && buffer1);
+
+	CHECK(renderer.StartFrame());
+	renderer.BindVertexBuffer<SmallVertex>(buffer0);
+	renderer.BindVertexBuffer<SmallVertex>(buffer0);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_VERTEX_BUFFER) == 1 && GetSkipped(renderer, sbStateFilter::STATE_VERTEX_BUFFER) == 1);
+	renderer.BindVertexBuffer<LargeVertex>(buffer0);
+	renderer.BindVertexBuffer<LargeVertex>(buffer1);
+	renderer.BindVertexBuffer<LargeVertex>(buffer1);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_VERTEX_BUFFER) == 3 && GetSkipped(renderer, sbStateFilter::STATE_VERTEX_BUFFER) == 2);
+
+	renderer.BindIndexBuffer(buffer0);
+	renderer.BindIndexBuffer(buffer0);
+	renderer.BindIndexBuffer(buffer1);
+	renderer.BindIndexBuffer(buffer0);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_INDEX_BUFFER) == 3 && GetSkipped(renderer, sbStateFilter::STATE_INDEX_BUFFER) == 1);
+
+	//the buffers of a mesh are bound the same way
+	sbMesh mesh(buffer1, buffer0, 0);
+	renderer.BindMesh<LargeVertex>(mesh);
+	CHECK(GetSkipped(renderer, sbStateFilter::STATE_VERTEX_BUFFER) == 3 && GetSkipped(renderer, sbStateFilter::STATE_INDEX_BUFFER) == 2);
+	renderer.EndAndPresentFrame();
+
+	renderer.DestroyBuffer(buffer0);
+	renderer.DestroyBuffer(buffer1);
+	return 0;
+}
+
+//the textures set again are dropped, setting one texture only compares the first
+static int TestTextures(sbSoftRenderer &renderer)
+{
+	static const uint32_t texels[4 * 4] = {};
+	sbTexture texture0 = renderer.CreateTexture(texels, sizeof(texels), 4, 4, DXGI_FORMAT_R8G8B8A8_UNORM);
+	sbTexture texture1 = renderer.CreateTexture(texels, sizeof(texels), 4, 4, DXGI_FORMAT_R8G8B8A8_UNORM);
+	CHECK(texture0.resource && texture1.resource);
+
+	CHECK(renderer.StartFrame());
+	renderer.UseOneTexture(texture0.descriptor);
+	renderer.UseOneTexture(texture0.descriptor);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_TEXTURES) == 1 && GetSkipped(renderer, sbStateFilter::STATE_TEXTURES) == 1);
+
+	//the second texture was never set
+	renderer.UseTwoTextures(texture0.descriptor, texture1.descriptor);
+	renderer.UseTwoTextures(texture0.descriptor, texture1.descriptor);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_TEXTURES) == 2 && GetSkipped(renderer, sbStateFilter::STATE_TEXTURES) == 2);
+
+	//one texture leaves the second one as it was
+	renderer.UseOneTexture(texture0.descriptor);
+	renderer.UseOneTexture(texture1.descriptor);
+	renderer.UseTwoTextures(texture1.descriptor, texture1.descriptor);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_TEXTURES) == 3 && GetSkipped(renderer, sbStateFilter::STATE_TEXTURES) == 4);
+
+	renderer.UseTwoTextures(texture1.descriptor, texture0.descriptor);
+	CHECK(GetIssued(renderer, sbStateFilter::STATE_TEXTURES) == 4);
+	CHECK(renderer.GetStateStats().GetTotalIssued() == 4 && renderer.GetStateStats().GetTotalSkipped() == 4);
+	renderer.EndAndPresentFrame();
+
+	renderer.DestroyTexture(texture0);
+	renderer.DestroyTexture(texture1);
+	return 0;
+}
+
+int main()
+{
+	sbSoftRenderer renderer;
+	if (!renderer.Create(64, 64, 1))
+	{
+		printf("Failed to create the renderer.\n");
+		return 1;
+	}
+
+	int failed = 0;
+	failed += TestPipelines(renderer);
+	failed += TestBuffers(renderer);
+	failed += TestTextures(renderer);
+
+	renderer.Destroy();
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/*
+*	Room Editor Application
+*	Tests of the upload ring, driven by a fence faked on the CPU.
+*	(C) Moczulski Alan, 2023.
+*/
+
+#include "check.hh"
+#include "sbgraphics/base/heap/UploadRing.hh"
+
+static constexpr uint64_t RING_SIZE = 1024;
+
+//stands for the copy queue's fence: every submitted batch signals the next value, and the GPU completes them in order
+struct FakeFence
+{
+	uint64_t lastSignaled;
+	uint64_t completed;
+
+	uint64_t Signal()
+	{
+		return ++lastSignaled;
+	}
+
+	void Complete(uint64_t value)
+	{
+		assert(value <= lastSignaled);
+		completed = value;
+	}
+};
+
+//an allocation that does not fit before the end starts over from the beginning, once the batches there are done
+static int TestWrapAround()
+{
+	FakeFence fence = {};
+	UploadRing ring;
+	ring.Create(RING_SIZE);
+
+	CHECK(ring.Allocate(400, 4) == 0);
+	ring.CloseBatch(fence.Signal());
+	CHECK(ring.Allocate(400, 4) == 400);
+	ring.CloseBatch(fence.Signal());
+
+	//the first batch is done, the second one still holds the middle of the ring
+	fence.Complete(1);
+	ring.Retire(fence.completed);
+	CHECK(ring.GetUsedSize() == 400);
+
+	//the end of the ring is skipped and taken with the allocation
+	CHECK(ring.Allocate(300, 4) == 0);
+	CHECK(ring.GetUsedSize() == 400 + 224 + 300);
+	CHECK(ring.Allocate(100, 4) == 300);
+	CHECK(ring.GetUsedSize() == RING_SIZE);
+	CHECK(ring.Allocate(1, 1) == UploadRing::INVALID_OFFSET);
+	ring.CloseBatch(fence.Signal());
+
+	//everything done, the ring is empty and starts over
+	fence.Complete(3);
+	ring.Retire(fence.completed);
+	CHECK(ring.GetUsedSize() == 0);
+	CHECK(ring.Allocate(16, 4) == 0);
+	return 0;
+}
+
+//an allocation larger than what is left before the end wraps around if the beginning is free, and fails without changing anything if it is not
+static int TestLargerThanTail()
+{
+	FakeFence fence = {};
+	UploadRing ring;
+	ring.Create(RING_SIZE);
+
+	CHECK(ring.Allocate(RING_SIZE + 1, 4) == UploadRing::INVALID_OFFSET);
+
+	CHECK(ring.Allocate(600, 4) == 0);
+	ring.CloseBatch(fence.Signal());
+	CHECK(ring.Allocate(300, 4) == 600);
+	ring.CloseBatch(fence.Signal());
+
+	//only 124 bytes are left at the end, and the beginning is still in use
+	CHECK(ring.Allocate(200, 4) == UploadRing::INVALID_OFFSET);
+	CHECK(ring.GetUsedSize() == 900 && !ring.HasOpenBatch());
+
+	fence.Complete(1);
+	ring.Retire(fence.completed);
+	CHECK(ring.Allocate(700, 4) == UploadRing::INVALID_OFFSET); //600 free before the batch still in use
+	CHECK(ring.Allocate(200, 256) == 0); //aligned past the end
+	CHECK(ring.GetUsedSize() == 300 + 124 + 200);
+	ring.CloseBatch(fence.Signal());
+
+	//the skipped end of the ring goes back with the batch that skipped it
+	fence.Complete(2);
+	ring.Retire(fence.completed);
+	CHECK(ring.GetUsedSize() == 124 + 200);
+	fence.Complete(3);
+	ring.Retire(fence.completed);
+	CHECK(ring.GetUsedSize() == 0);
+	return 0;
+}
+
+//the space of a batch only comes back once the fence has reached its value, the batches completing in order
+static int TestReclaimAfterFence()
+{
+	FakeFence fence = {};
+	UploadRing ring;
+	ring.Create(RING_SIZE);
+
+	//four batches of a quarter of the ring fill it
+	uint64_t values[4];
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		CHECK(ring.Allocate(RING_SIZE / 4, 256) == i * RING_SIZE / 4);
+		CHECK(ring.HasOpenBatch());
+		values[i] = fence.Signal();
+		ring.CloseBatch(values[i]);
+	}
+	CHECK(ring.GetUsedSize() == RING_SIZE && ring.GetOldestFenceValue() == values[0]);
+	CHECK(ring.Allocate(16, 4) == UploadRing::INVALID_OFFSET);
+
+	//nothing done yet
+	ring.Retire(fence.completed);
+	CHECK(ring.GetUsedSize() == RING_SIZE);
+	CHECK(ring.Allocate(16, 4) == UploadRing::INVALID_OFFSET);
+
+	//the oldest batch done, its quarter can be taken again but not more
+	fence.Complete(values[0]);
+	ring.Retire(fence.completed);
+	CHECK(ring.GetUsedSize() == RING_SIZE * 3 / 4 && ring.GetOldestFenceValue() == values[1]);
+	CHECK(ring.Allocate(RING_SIZE / 4 + 1, 4) == UploadRing::INVALID_OFFSET);
+	CHECK(ring.Allocate(RING_SIZE / 4, 4) == 0);
+	values[0] = fence.Signal();
+	ring.CloseBatch(values[0]);
+
+	//a fence past several batches reclaims all of them
+	fence.Complete(values[2]);
+	ring.Retire(fence.completed);
+	CHECK(ring.GetUsedSize() == RING_SIZE / 2 && ring.GetOldestFenceValue() == values[3]);
+	CHECK(ring.Allocate(RING_SIZE / 2, 4) == RING_SIZE / 4);
+
+	fence.Complete(fence.lastSignaled);
+	ring.Retire(fence.completed);
+	CHECK(ring.GetUsedSize() == RING_SIZE / 2 && ring.GetOldestFenceValue() == 0 && ring.HasOpenBatch());
+	ring.CloseBatch(fence.Signal());
+	fence.Complete(fence.lastSignaled);
+	ring.Retire(fence.completed);
+	CHECK(ring.GetUsedSize() == 0);
+	return 0;
+}
+
+//there is room for a bounded number of batches in flight
+static int TestBatchList()
+{
+	FakeFence fence = {};
+	UploadRing ring;
+	ring.Create(RING_SIZE * UploadRing::MAX_BATCHES);
+
+	for (uint32_t i = 0; i < UploadRing::MAX_BATCHES; i++)
+	{
+		CHECK(!ring.IsBatchListFull());
+		CHECK(ring.Allocate(16, 4) != UploadRing::INVALID_OFFSET);
+		ring.CloseBatch(fence.Signal());
+	}
+	CHECK(ring.IsBatchListFull());
+
+	fence.Complete(1);
+	ring.Retire(fence.completed);
+	CHECK(!ring.IsBatchListFull() && ring.GetOldestFenceValue() == 2);
+	return 0;
+}
+
+int main()
+{
+	int failed = 0;
+	failed += TestWrapAround();
+	failed += TestLargerThanTail();
+	failed += TestReclaimAfterFence();
+	failed += TestBatchList();
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdio.h> //printf
+#include <chrono> //std::chrono::steady_clock
+
+//fails the test that it is in, the tests being functions returning 0 when they pass
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			printf("%s(%d): failed %s\n", __FILE__, __LINE__, #condition); \
+			return 1; \
+		} \
+	} while (0)
+
+//the time since some point in the past, for the benchmarks
+inline double GetMicroseconds()
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}